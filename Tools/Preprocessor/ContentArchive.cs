@@ -0,0 +1,242 @@
+﻿using System.Text;
+using K4os.Compression.LZ4;
+
+namespace Preprocessor;
+
+/// <summary>
+/// Packs the processed content directory into one archive, which the engine memory-maps and mounts in place of the
+/// loose files (see Vulcanal/Include/Core/FileSystem/PackedArchive.h, which has to match this layout).
+/// Layout, all little-endian:
+///     Header (32 bytes): magic "VPAK", version, entry count, chunk size, entry table offset (u64), path table offset (u64)
+///     Entries (32 bytes each), sorted by path hash: hash, path offset, path length, flags, data offset (u64), size (u64)
+///     Path table: every entry's path, UTF-8, no terminators
+///     Data: each file's bytes, aligned to 16
+/// Paths are relative to the content directory, with forward slashes, and hashed with the same CRC32 as the engine's.
+/// Files that compress well enough are split into chunks of ChunkSize bytes, each compressed on its own as an LZ4 block,
+/// so the engine can decode them in parallel, or just the ones a read needs. A compressed file's data starts with a u32
+/// per chunk, where that chunk's compressed bytes end (counting from the end of the table); a chunk that didn't shrink is
+/// stored as is. Size is always the decompressed size.
+/// </summary>
+internal static class ContentArchive
+{
+    public const string FileName = "Content.vpak";
+
+    private const uint Magic = 0x4B415056; // "VPAK"
+    private const uint Version = 2;
+    private const int HeaderSize = 32;
+    private const int EntrySize = 32;
+    private const int DataAlignment = 16;
+    private const int ChunkSize = 64 * 1024;
+    private const uint CompressedFlag = 1;
+
+    // Files are only stored compressed if it saves at least this much; otherwise decoding them isn't worth it.
+    private const double MaxCompressedRatio = 0.9;
+
+    private static readonly uint[] CrcTable = BuildCrcTable();
+
+    private struct Entry
+    {
+        public string Path;
+        public string SourceFile;
+        public uint Hash;
+        public uint PathOffset;
+        public uint PathLength;
+        public uint Flags;
+        public ulong Offset;
+        public ulong Size;
+        public byte[]? Compressed; // The chunk table and chunks, if it's compressed.
+
+        public ulong StoredSize => Compressed != null ? (ulong)Compressed.Length : Size;
+    }
+
+    /// <summary>
+    /// Whether the archive exists, and was written in the format this version writes, so doesn't need repacking on
+    /// that account.
+    /// </summary>
+    public static bool IsCurrent(string archivePath)
+    {
+        if (!File.Exists(archivePath))
+            return false;
+
+        using var reader = new BinaryReader(File.OpenRead(archivePath));
+        return reader.BaseStream.Length >= HeaderSize && reader.ReadUInt32() == Magic && reader.ReadUInt32() == Version;
+    }
+
+    public static void Write(string contentDir, string archivePath, bool compress)
+    {
+        var entries = new List<Entry>();
+        foreach (var file in Directory.GetFiles(contentDir, "*", SearchOption.AllDirectories))
+        {
+            if (Path.GetFullPath(file) == Path.GetFullPath(archivePath))
+                continue;
+
+            var relativePath = Path.GetRelativePath(contentDir, file).Replace('\\', '/');
+            entries.Add(new Entry
+            {
+                Path = relativePath,
+                SourceFile = file,
+                Hash = Crc32(relativePath),
+                Size = (ulong)new FileInfo(file).Length
+            });
+        }
+
+        // Sorted by hash, so the engine can binary search it; ties by path, so the output's deterministic.
+        entries.Sort((a, b) => a.Hash != b.Hash ? a.Hash.CompareTo(b.Hash) : string.CompareOrdinal(a.Path, b.Path));
+
+        // High compression is slow, but decoding's just as fast, and we only pay for it when content changes.
+        if (compress)
+        {
+            Parallel.For(0, entries.Count, i =>
+            {
+                var entry = entries[i];
+                entry.Compressed = Compress(File.ReadAllBytes(entry.SourceFile));
+                entry.Flags = entry.Compressed != null ? CompressedFlag : 0;
+                entries[i] = entry;
+            });
+        }
+
+        // Lay everything out before writing anything.
+        var paths = new MemoryStream();
+        for (int i = 0; i < entries.Count; i++)
+        {
+            var entry = entries[i];
+            var pathBytes = Encoding.UTF8.GetBytes(entry.Path);
+            entry.PathOffset = (uint)paths.Length;
+            entry.PathLength = (uint)pathBytes.Length;
+            paths.Write(pathBytes);
+            entries[i] = entry;
+        }
+
+        ulong entriesOffset = HeaderSize;
+        ulong pathsOffset = entriesOffset + (ulong)(entries.Count * EntrySize);
+        ulong dataOffset = Align(pathsOffset + (ulong)paths.Length);
+        for (int i = 0; i < entries.Count; i++)
+        {
+            var entry = entries[i];
+            entry.Offset = dataOffset;
+            dataOffset = Align(dataOffset + entry.StoredSize);
+            entries[i] = entry;
+        }
+
+        // Written alongside and moved over, so a failed pack never leaves a half-written archive to be mounted.
+        var tempPath = archivePath + ".tmp";
+        using (var stream = new FileStream(tempPath, FileMode.Create, FileAccess.Write))
+        using (var writer = new BinaryWriter(stream))
+        {
+            writer.Write(Magic);
+            writer.Write(Version);
+            writer.Write((uint)entries.Count);
+            writer.Write((uint)ChunkSize);
+            writer.Write(entriesOffset);
+            writer.Write(pathsOffset);
+
+            foreach (var entry in entries)
+            {
+                writer.Write(entry.Hash);
+                writer.Write(entry.PathOffset);
+                writer.Write(entry.PathLength);
+                writer.Write(entry.Flags);
+                writer.Write(entry.Offset);
+                writer.Write(entry.Size);
+            }
+
+            writer.Write(paths.ToArray());
+
+            foreach (var entry in entries)
+            {
+                Pad(writer, entry.Offset);
+                if (entry.Compressed != null)
+                {
+                    writer.Write(entry.Compressed);
+                    continue;
+                }
+
+                writer.Flush();
+                using var source = File.OpenRead(entry.SourceFile);
+                source.CopyTo(stream);
+            }
+        }
+
+        File.Move(tempPath, archivePath, true);
+
+        var compressedCount = entries.Count(entry => entry.Compressed != null);
+        var totalSize = entries.Aggregate(0UL, (total, entry) => total + entry.Size);
+        var storedSize = entries.Aggregate(0UL, (total, entry) => total + entry.StoredSize);
+        Log.Info($"Packed {entries.Count} files ({compressedCount} compressed, {totalSize} bytes stored in {storedSize}) into {archivePath}");
+    }
+
+    /// <summary>
+    /// Compresses the file in chunks, returning the chunk table followed by the chunks, or null if it isn't worth it.
+    /// </summary>
+    private static byte[]? Compress(byte[] data)
+    {
+        if (data.Length == 0)
+            return null;
+
+        var chunkCount = (data.Length + ChunkSize - 1) / ChunkSize;
+        var chunkEnds = new uint[chunkCount];
+        var chunks = new MemoryStream();
+        var buffer = new byte[LZ4Codec.MaximumOutputSize(ChunkSize)];
+        for (int i = 0; i < chunkCount; i++)
+        {
+            var chunk = data.AsSpan(i * ChunkSize, Math.Min(ChunkSize, data.Length - i * ChunkSize));
+            var length = LZ4Codec.Encode(chunk, buffer, LZ4Level.L09_HC);
+
+            // The engine tells stored chunks apart by their size, so a compressed one must come out smaller.
+            if (length > 0 && length < chunk.Length)
+                chunks.Write(buffer, 0, length);
+            else
+                chunks.Write(chunk);
+            chunkEnds[i] = (uint)chunks.Length;
+        }
+
+        var compressedSize = chunkCount * sizeof(uint) + chunks.Length;
+        if (compressedSize > data.Length * MaxCompressedRatio)
+            return null;
+
+        var result = new MemoryStream((int)compressedSize);
+        using (var writer = new BinaryWriter(result, Encoding.UTF8, true))
+        {
+            foreach (var end in chunkEnds)
+                writer.Write(end);
+        }
+        chunks.Position = 0;
+        chunks.CopyTo(result);
+        return result.ToArray();
+    }
+
+    /// <summary>
+    /// The standard reflected CRC32 (polynomial 0xEDB88320), matching crc32() in VulcanalCore.h.
+    /// </summary>
+    public static uint Crc32(string text)
+    {
+        uint crc = 0xFFFFFFFF;
+        foreach (var b in Encoding.UTF8.GetBytes(text))
+            crc = (crc >> 8) ^ CrcTable[(crc ^ b) & 0xFF];
+        return crc ^ 0xFFFFFFFF;
+    }
+
+    private static uint[] BuildCrcTable()
+    {
+        var table = new uint[256];
+        for (uint i = 0; i < 256; i++)
+        {
+            uint c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) != 0 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+
+        return table;
+    }
+
+    private static ulong Align(ulong offset) =>
+        (offset + DataAlignment - 1) & ~(ulong)(DataAlignment - 1);
+
+    private static void Pad(BinaryWriter writer, ulong offset)
+    {
+        writer.Flush();
+        while ((ulong)writer.BaseStream.Position < offset)
+            writer.Write((byte)0);
+    }
+}
@@ -65,6 +65,9 @@ internal static class Program
     // Current highest priority global processor (processor with accepted file extension "*")
     private static (IProcessor?, int) _globalProcessor = (null, 0);
 
+    // Whether any asset was (re)processed this run, and so whether the content archive needs repacking.
+    private static bool _contentChanged = false;
+
     // Preprocessor settings! Contains library copies, ignored file patterns, and processor settings (such as file extensions).
     public static PreprocessorSettings PreprocessorSettings = new();
     public static string ContentDir = "", OutputDir = "";
@@ -127,6 +130,7 @@ internal static class Program
         LoadProcessors();
         DoLibCopies();
         DoAssetProcessing();
+        PackContent();
         SaveLastProcessedTimes();
 
         Log.ResetLog();
@@ -324,6 +328,7 @@ internal static class Program
                 continue;
             }
 
+            _contentChanged = true;
             if (!FileLastProcessed.TryAdd(file, lastWrite))
             {
                 // Technically TryAdd could fail for other reasons than the key already existing, but we'll just assume for now that it won't...
@@ -332,6 +337,35 @@ internal static class Program
         }
     }
 
+    /// <summary>
+    /// Pack the output directory into a single archive that the engine can mount, if anything's changed. The loose files
+    /// are left where they are, so the engine can still fall back to them.
+    /// Set the "PackContent" processor setting to "false" to skip it, or "CompressContent" to "false" to store everything
+    /// uncompressed (faster packing, bigger archive).
+    /// </summary>
+    private static void PackContent()
+    {
+        if (PreprocessorSettings.GetProcessorSetting("PackContent", "true") != "true")
+            return;
+
+        var archivePath = Path.Join(OutputDir, ContentArchive.FileName);
+        if (!_contentChanged && ContentArchive.IsCurrent(archivePath))
+        {
+            Log.Trace("No content changed; not repacking.");
+            return;
+        }
+
+        try
+        {
+            var compress = PreprocessorSettings.GetProcessorSetting("CompressContent", "true") == "true";
+            ContentArchive.Write(OutputDir, archivePath, compress);
+        }
+        catch (Exception e)
+        {
+            Log.Error($"Failed to pack content into {archivePath}: {e.Message}");
+        }
+    }
+
     /// <summary>
     /// Save the last time each processed file was modified, so we can skip reprocessing it next time if it hasn't changed.
     /// </summary>
@@ -0,0 +1,291 @@
+#include "vulcpch.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <cstring>
+#include <semaphore>
+
+#include "Core/Concurrency/SPSCQueue.h"
+#include "Core/Concurrency/MPSCQueue.h"
+#include "Core/Concurrency/MPMCQueue.h"
+#include "Core/Concurrency/SpinMutex.h"
+#include "Core/Concurrency/FutexMutex.h"
+#include "Core/Concurrency/Event.h"
+#include "Core/Concurrency/Semaphore.h"
+
+// Puts each Core/Concurrency primitive up against the standard library equivalent it replaced, under contention, and
+// prints how long each took. Nothing's checked here; that's the tests' job. Run a Release build, with nothing else
+// busy, and take the numbers as relative rather than absolute.
+
+namespace
+{
+	constexpr u32 QueueItems     = 2000000;
+	constexpr u32 LockIncrements = 1000000;
+	constexpr u32 PingPongRounds = 200000;
+
+	// A mutex and a deque, as the queues were before.
+	template <typename T>
+	class LockedQueue
+	{
+	public:
+		explicit LockedQueue(u32 capacity) : m_Capacity(capacity) {}
+
+		bool TryPush(T item)
+		{
+			std::lock_guard lock(m_Mutex);
+			if (m_Items.size() >= m_Capacity)
+				return false;
+			m_Items.push_back(item);
+			return true;
+		}
+
+		std::optional<T> TryPop()
+		{
+			std::lock_guard lock(m_Mutex);
+			if (m_Items.empty())
+				return std::nullopt;
+			T item = m_Items.front();
+			m_Items.pop_front();
+			return item;
+		}
+
+	protected:
+		std::mutex    m_Mutex;
+		std::deque<T> m_Items;
+		u32           m_Capacity;
+	};
+
+	// Blocks on a condition variable, as Event replaces.
+	class CondVarEvent
+	{
+	public:
+		void Set()
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				m_Set = true;
+			}
+			m_CondVar.notify_one();
+		}
+
+		void Wait()
+		{
+			std::unique_lock lock(m_Mutex);
+			m_CondVar.wait(lock, [this]() { return m_Set; });
+			m_Set = false;
+		}
+
+	protected:
+		std::mutex              m_Mutex;
+		std::condition_variable m_CondVar;
+		bool                    m_Set = false;
+	};
+
+	template <typename Function>
+	f64 TimeMs(Function&& function)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Report(const char* name, f64 ms, u64 operations)
+	{
+		fmt::print("  {:<28} {:>9.2f}ms {:>8.1f}ns/op\n", name, ms, ms * 1000000.0 / static_cast<f64>(operations));
+	}
+
+	// Splits the items between the producers, and has the consumers take turns at whatever comes out.
+	template <typename Queue>
+	f64 RunQueue(u32 producers, u32 consumers)
+	{
+		Queue            queue(1024);
+		std::atomic<u32> consumed = 0;
+
+		return TimeMs([&]()
+		{
+			std::vector<std::thread> threads;
+			for (u32 p = 0; p < producers; p++)
+			{
+				threads.emplace_back([&queue, producers]()
+				{
+					for (u32 i = 0; i < QueueItems / producers; i++)
+					{
+						while (!queue.TryPush(i))
+							std::this_thread::yield();
+					}
+				});
+			}
+			for (u32 c = 0; c < consumers; c++)
+			{
+				threads.emplace_back([&queue, &consumed, producers]()
+				{
+					const u32 total = QueueItems / producers * producers;
+					while (consumed.load(std::memory_order_relaxed) < total)
+					{
+						if (queue.TryPop())
+							consumed.fetch_add(1, std::memory_order_relaxed);
+						else
+							std::this_thread::yield();
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+		});
+	}
+
+	template <typename Mutex>
+	f64 RunLock(u32 threadCount)
+	{
+		Mutex mutex;
+		u64   counter = 0;
+
+		return TimeMs([&]()
+		{
+			std::vector<std::thread> threads;
+			for (u32 t = 0; t < threadCount; t++)
+			{
+				threads.emplace_back([&mutex, &counter, threadCount]()
+				{
+					for (u32 i = 0; i < LockIncrements / threadCount; i++)
+					{
+						std::lock_guard lock(mutex);
+						counter++;
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+		});
+	}
+
+	template <typename Signal>
+	f64 RunPingPong()
+	{
+		Signal ping;
+		Signal pong;
+
+		return TimeMs([&]()
+		{
+			std::thread other([&]()
+			{
+				for (u32 i = 0; i < PingPongRounds; i++)
+				{
+					ping.Wait();
+					pong.Set();
+				}
+			});
+
+			for (u32 i = 0; i < PingPongRounds; i++)
+			{
+				ping.Set();
+				pong.Wait();
+			}
+			other.join();
+		});
+	}
+
+	// A pool of slots handed back and forth, as BoundedQueue's semaphores count them.
+	f64 RunSemaphore(u32 threadCount)
+	{
+		Semaphore semaphore(2);
+
+		return TimeMs([&]()
+		{
+			std::vector<std::thread> threads;
+			for (u32 t = 0; t < threadCount; t++)
+			{
+				threads.emplace_back([&semaphore, threadCount]()
+				{
+					for (u32 i = 0; i < LockIncrements / threadCount; i++)
+					{
+						semaphore.Acquire();
+						semaphore.Release();
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+		});
+	}
+
+	f64 RunCountingSemaphore(u32 threadCount)
+	{
+		std::counting_semaphore<> semaphore(2);
+
+		return TimeMs([&]()
+		{
+			std::vector<std::thread> threads;
+			for (u32 t = 0; t < threadCount; t++)
+			{
+				threads.emplace_back([&semaphore, threadCount]()
+				{
+					for (u32 i = 0; i < LockIncrements / threadCount; i++)
+					{
+						semaphore.acquire();
+						semaphore.release();
+					}
+				});
+			}
+			for (std::thread& thread : threads)
+				thread.join();
+		});
+	}
+}
+
+// Assertions want a window to put their message box on; there isn't one here.
+SDL_Window* GetAppWindow()
+{
+	return nullptr;
+}
+
+// Runs every benchmark, or only those in the group named by the first argument ("queues", "locks" or "signals").
+int main(int argc, char** argv)
+{
+	g_VulcanalLogger = spdlog::stdout_color_mt("Bench");
+
+	const char* group = argc > 1 ? argv[1] : nullptr;
+	const auto  wants = [group](const char* name) { return !group || std::strcmp(group, name) == 0; };
+
+	const u32 threads = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+
+	if (wants("queues"))
+	{
+		fmt::print("Queues ({} items):\n", QueueItems);
+		Report("SPSCQueue 1:1", RunQueue<SPSCQueue<u32>>(1, 1), QueueItems);
+		Report("LockedQueue 1:1", RunQueue<LockedQueue<u32>>(1, 1), QueueItems);
+		Report(fmt::format("MPSCQueue {}:1", threads - 1).c_str(), RunQueue<MPSCQueue<u32>>(threads - 1, 1), QueueItems);
+		Report(fmt::format("LockedQueue {}:1", threads - 1).c_str(), RunQueue<LockedQueue<u32>>(threads - 1, 1),
+		       QueueItems);
+		Report(fmt::format("MPMCQueue {}:{}", threads / 2, threads / 2).c_str(),
+		       RunQueue<MPMCQueue<u32>>(threads / 2, threads / 2), QueueItems);
+		Report(fmt::format("LockedQueue {}:{}", threads / 2, threads / 2).c_str(),
+		       RunQueue<LockedQueue<u32>>(threads / 2, threads / 2), QueueItems);
+	}
+
+	if (wants("locks"))
+	{
+		fmt::print("Locks ({} increments, {} threads):\n", LockIncrements, threads);
+		Report("SpinMutex", RunLock<SpinMutex>(threads), LockIncrements);
+		Report("FutexMutex", RunLock<FutexMutex>(threads), LockIncrements);
+		Report("std::mutex", RunLock<std::mutex>(threads), LockIncrements);
+		Report("SpinMutex uncontended", RunLock<SpinMutex>(1), LockIncrements);
+		Report("FutexMutex uncontended", RunLock<FutexMutex>(1), LockIncrements);
+		Report("std::mutex uncontended", RunLock<std::mutex>(1), LockIncrements);
+	}
+
+	if (wants("signals"))
+	{
+		fmt::print("Signals ({} round trips):\n", PingPongRounds);
+		Report("Event ping-pong", RunPingPong<Event>(), PingPongRounds);
+		Report("Condition variable ping-pong", RunPingPong<CondVarEvent>(), PingPongRounds);
+		Report("Semaphore", RunSemaphore(threads), LockIncrements);
+		Report("std::counting_semaphore", RunCountingSemaphore(threads), LockIncrements);
+	}
+
+	g_VulcanalLogger = nullptr;
+	return 0;
+}
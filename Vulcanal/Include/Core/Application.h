@@ -1,5 +1,12 @@
 ﻿#pragma once
 
+#include "Core/Assets/AssetManager.h"
+#include "Core/Concurrency/BoundedQueue.h"
+#include "Core/FileSystem/VirtualFileSystem.h"
+#include "Core/FileSystem/AsyncFileIO.h"
+#include "Core/FrameLimiter.h"
+#include "Core/ThreadPool.h"
+#include "Core/Jobs/JobSystem.h"
 #include "Render/Renderer.h"
 #include "Render/Window.h"
 
@@ -30,6 +37,14 @@ public:
 	NODISCARD FORCEINLINE Window&                         GetWindow() { return m_Window; }
 	NODISCARD FORCEINLINE const Window&                   GetWindow() const { return m_Window; }
 	NODISCARD FORCEINLINE bool                            IsRunning() const { return m_Running; }
+	NODISCARD FORCEINLINE ThreadPool&                     GetThreadPool() { return *m_ThreadPool; }
+	NODISCARD FORCEINLINE JobSystem&                      GetJobSystem() { return *m_JobSystem; }
+	NODISCARD FORCEINLINE AssetManager&                   GetAssetManager() { return *m_AssetManager; }
+	NODISCARD FORCEINLINE VirtualFileSystem&              GetFileSystem() { return *m_FileSystem; }
+	NODISCARD FORCEINLINE AsyncFileIO&                    GetAsyncIO() { return *m_AsyncIO; }
+	NODISCARD FORCEINLINE Renderer&                       GetRenderer() { return m_Renderer; }
+	// Where per-user files (logs, caches) go. Empty if SDL couldn't give us one.
+	NODISCARD FORCEINLINE const std::filesystem::path&    GetPrefPath() const { return m_PrefPath; }
 
 	NODISCARD FORCEINLINE static bool ShouldRestart() { return s_ShouldRestart; }
 	NODISCARD FORCEINLINE static void RequestRestart(bool restart = true)
@@ -45,10 +60,33 @@ public:
 protected:
 	bool InitSDL() const;
 	bool InitImGUI() const;
+	void DrawAppSettings();
+
+	void StartRenderThread();
+	void StopRenderThread();
+	void RenderThreadLoop();
 
 	ApplicationSpecification m_Specification;
+	std::filesystem::path    m_PrefPath;
 	Window                   m_Window;
+	Scope<ThreadPool>        m_ThreadPool; // For blocking work: file reads.
+	Scope<JobSystem>         m_JobSystem;  // For short CPU-bound work: culling, command recording.
+	Scope<VirtualFileSystem> m_FileSystem;
+	Scope<AsyncFileIO>       m_AsyncIO; // For streaming big loose files, many reads deep.
+	Scope<AssetManager>      m_AssetManager;
 	Renderer                 m_Renderer;
+	FrameLimiter             m_FrameLimiter;
+	f32                      m_FrameRateLimit = 144.0f; // Remembered while the limiter's off.
+	bool                     m_LimitFrameRate = false;
+
+	// Pipelined rendering: this thread builds frame N+1 while the render thread records and presents frame N. The
+	// queue's bound is how many frames we can get ahead.
+	std::thread                      m_RenderThread;
+	BoundedQueue<Scope<FramePacket>> m_FramePackets{1};
+	bool                             m_PipelinedRendering = false;
+	std::atomic<f32>                 m_MainThreadMs       = 0.0f;
+	std::atomic<f32>                 m_RenderThreadMs     = 0.0f;
+
 	bool                     m_Running = false;
 
 	// Test stuff.
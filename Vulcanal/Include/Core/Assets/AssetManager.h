@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <typeindex>
+
+class JobSystem;
+class ThreadPool;
+class VirtualFileSystem;
+
+// An asset's ID is the CRC32 of its path, so a path known up front can be hashed at compile time:
+// static constexpr AssetID GradientShader("Content/Shaders/GradientTest.spv");
+struct AssetID
+{
+	u32 Value = 0;
+
+	constexpr AssetID() = default;
+	constexpr explicit AssetID(std::string_view path) : Value(crc32(path)) {}
+
+	constexpr bool operator==(const AssetID& other) const = default;
+};
+
+enum class AssetState : u8
+{
+	Unloaded, // The handle's stale, or was never valid.
+	Loading,
+	Ready,
+	Failed,
+};
+
+// Refers to one slot in the manager's table. The generation goes up every time the slot's freed, so a handle that
+// outlives its asset reads as Unloaded rather than as whatever took the slot next. The default handle's never valid.
+template <typename T>
+struct AssetHandle
+{
+	u32 Index      = 0;
+	u32 Generation = 0;
+
+	NODISCARD FORCEINLINE bool IsValid() const { return Generation != 0; }
+	bool                       operator==(const AssetHandle& other) const = default;
+};
+
+// Builds an asset from its file's contents. Runs as a job once the read's done, so it should only do CPU work
+// (decoding, decompressing), and anything it touches besides the bytes has to be thread-safe. Empty on failure.
+template <typename T>
+using AssetLoader = std::function<Scope<T>(std::string_view path, std::vector<u8>&& bytes)>;
+
+struct AssetManagerSpecification
+{
+	// The slot table's allocated up front, so it never moves under a lock-free reader.
+	u32 MaxAssets = 16384;
+};
+
+// Loads assets by path, reading them on the thread pool and building them on the job system, and shares them. Every
+// Load() of a path returns the same handle, whether the asset's loaded, still loading, or not yet requested, so ten
+// requests for one file cost one read. Each Load() (and AddRef()) holds a reference, and the asset's destroyed when the
+// last one's Released.
+// Checking whether an asset's ready, and getting at it once it is, never locks, so it's cheap enough to do per frame.
+class AssetManager
+{
+public:
+	// Files are read through the file system, so they come out of the content archive when there is one.
+	AssetManager(ThreadPool& threadPool, JobSystem& jobSystem, VirtualFileSystem& fileSystem,
+	             AssetManagerSpecification spec = {});
+	// Waits for any loads still running, then destroys whatever's left, referenced or not.
+	~AssetManager();
+
+	AssetManager(const AssetManager& other)                = delete;
+	AssetManager(AssetManager&& other) noexcept            = delete;
+	AssetManager& operator=(const AssetManager& other)     = delete;
+	AssetManager& operator=(AssetManager&& other) noexcept = delete;
+
+	// One per asset type, before anything of that type's loaded.
+	template <typename T>
+	void RegisterLoader(AssetLoader<T>&& loader)
+	{
+		RegisterLoader(typeid(T), [loader = std::move(loader)](std::string_view path, std::vector<u8>&& bytes)
+		{
+			Scope<T> asset = loader(path, std::move(bytes));
+			return LoadedAsset{.Data = asset.release(), .Destroy = [](void* data) { delete static_cast<T*>(data); }};
+		});
+	}
+
+	// Starts loading the asset if nobody's asked for it yet, and returns its handle, holding a reference either way.
+	// Invalid if there's no loader for the type, the path's already loaded as another type, or the table's full.
+	template <typename T>
+	NODISCARD AssetHandle<T> Load(std::string_view path)
+	{
+		const auto [index, generation] = Load(typeid(T), path);
+		return {.Index = index, .Generation = generation};
+	}
+
+	// The handle of an asset someone's already loaded, with a reference of its own. Invalid if nobody has.
+	template <typename T>
+	NODISCARD AssetHandle<T> Find(AssetID id)
+	{
+		const auto [index, generation] = Find(typeid(T), id);
+		return {.Index = index, .Generation = generation};
+	}
+
+	template <typename T>
+	void AddRef(AssetHandle<T> handle) { AddRef(handle.Index, handle.Generation); }
+	// Once the last reference goes, the asset's destroyed, or, if it's still loading, as soon as it's done.
+	template <typename T>
+	void Release(AssetHandle<T> handle) { Release(handle.Index, handle.Generation); }
+
+	// Lock-free. A stale handle reads as unloaded, even if its slot's been reused since.
+	template <typename T>
+	NODISCARD AssetState GetState(AssetHandle<T> handle) const { return GetState(handle.Index, handle.Generation); }
+	template <typename T>
+	NODISCARD bool IsReady(AssetHandle<T> handle) const { return GetState(handle) == AssetState::Ready; }
+	// Lock-free. Null unless it's ready. Only valid while you hold a reference.
+	template <typename T>
+	NODISCARD T* Get(AssetHandle<T> handle) const { return static_cast<T*>(GetData(handle.Index, handle.Generation)); }
+
+	// Blocks until the asset's finished loading, one way or the other.
+	template <typename T>
+	AssetState Wait(AssetHandle<T> handle) { return Wait(handle.Index, handle.Generation); }
+	// Blocks until nothing's loading, including anything released partway through.
+	void WaitIdle();
+
+	NODISCARD FORCEINLINE u32 GetLoadedCount() const { return m_LoadedCount.load(std::memory_order_relaxed); }
+	NODISCARD FORCEINLINE u32 GetLoadingCount() const { return m_LoadingCount.load(std::memory_order_relaxed); }
+
+	void OnDrawIMGui();
+
+protected:
+	using AssetDestructor = void (*)(void* data);
+
+	struct LoadedAsset
+	{
+		void*           Data    = nullptr;
+		AssetDestructor Destroy = nullptr;
+	};
+
+	using ErasedLoader = std::function<LoadedAsset(std::string_view path, std::vector<u8>&& bytes)>;
+
+	// The atomics are what lock-free readers look at; everything else is only touched under the lock, or by the one
+	// worker loading the slot. Readers check the generation again after reading State and Data, seqlock style, since
+	// the slot can be freed and reused between the two.
+	struct Slot
+	{
+		std::atomic<u32>        Generation = 1;
+		std::atomic<u32>        RefCount   = 0;
+		std::atomic<AssetState> State      = AssetState::Unloaded;
+		std::atomic<void*>      Data       = nullptr;
+		AssetDestructor         Destroy    = nullptr;
+		AssetID                 ID         = {};
+		std::type_index         Type       = typeid(void);
+		std::string             Path       = {};
+	};
+
+	void                          RegisterLoader(std::type_index type, ErasedLoader&& loader);
+	NODISCARD std::pair<u32, u32> Load(std::type_index type, std::string_view path);
+	NODISCARD std::pair<u32, u32> Find(std::type_index type, AssetID id);
+	void                          AddRef(u32 index, u32 generation);
+	void                          Release(u32 index, u32 generation);
+	NODISCARD AssetState          GetState(u32 index, u32 generation) const;
+	NODISCARD void*               GetData(u32 index, u32 generation) const;
+	AssetState                    Wait(u32 index, u32 generation);
+	// Null if the handle's stale.
+	NODISCARD Slot* GetSlot(u32 index, u32 generation) const;
+
+	// Reads the file on the thread pool, then hands it to the job system to be built.
+	void ReadSlot(u32 index, ErasedLoader* loader);
+	void FinishLoad(u32 index, LoadedAsset asset);
+	// Called with the lock held.
+	void FreeSlot(u32 index);
+
+	ThreadPool*             m_ThreadPool = nullptr;
+	JobSystem*              m_JobSystem  = nullptr;
+	VirtualFileSystem*      m_FileSystem = nullptr;
+	std::unique_ptr<Slot[]> m_Slots;
+	u32                     m_MaxAssets = 0;
+	std::vector<u32>        m_FreeSlots = {};
+	u32                     m_UsedSlots = 0; // High water mark; slots past it have never been handed out.
+
+	std::mutex                                        m_Mutex    = {};
+	std::condition_variable                           m_LoadDone = {};
+	std::unordered_map<u32, u32>                      m_IDToSlot = {};
+	std::unordered_map<std::type_index, ErasedLoader> m_Loaders  = {};
+
+	std::atomic<u32> m_LoadedCount  = 0;
+	std::atomic<u32> m_LoadingCount = 0;
+};
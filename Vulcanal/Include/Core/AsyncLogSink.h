@@ -0,0 +1,52 @@
+#pragma once
+
+#include <thread>
+#include <atomic>
+
+#include <spdlog/sinks/sink.h>
+#include <spdlog/details/log_msg_buffer.h>
+
+#include "Core/Concurrency/MPSCQueue.h"
+#include "Core/Concurrency/Event.h"
+
+// Hands messages off to a thread of its own, which writes them to the sinks it wraps, so logging from a hot loop costs
+// a copy and a push rather than a file write and a console flush. Messages from any one thread stay in order.
+// flush() waits until everything logged before it has been written and the wrapped sinks flushed, so pair it with
+// flush_on() for anything that has to be on disk before a crash (assertions, say).
+// If the queue fills up, loggers yield until the thread catches up rather than dropping anything.
+class AsyncLogSink : public spdlog::sinks::sink
+{
+public:
+	explicit AsyncLogSink(std::vector<spdlog::sink_ptr> sinks, u32 capacity = 4096);
+	// Writes out whatever's left first.
+	~AsyncLogSink() override;
+
+	AsyncLogSink(const AsyncLogSink& other)                = delete;
+	AsyncLogSink(AsyncLogSink&& other) noexcept            = delete;
+	AsyncLogSink& operator=(const AsyncLogSink& other)     = delete;
+	AsyncLogSink& operator=(AsyncLogSink&& other) noexcept = delete;
+
+	void log(const spdlog::details::log_msg& msg) override;
+	void flush() override;
+	void set_pattern(const std::string& pattern) override;
+	void set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter) override;
+
+protected:
+	struct Entry
+	{
+		Scope<spdlog::details::log_msg_buffer> Message; // Null for a flush.
+		// Set once a flush is done. Shared, as the flushing thread may be gone by the time we've finished waking it.
+		Ref<std::atomic<u32>> Flushed;
+	};
+
+	void Push(Entry&& entry);
+	void ThreadLoop();
+
+	// Only ever touched by our thread once we've started, barring set_pattern() and set_formatter(), which rely on
+	// the sinks being thread safe themselves.
+	std::vector<spdlog::sink_ptr> m_Sinks;
+	MPSCQueue<Entry>              m_Queue;
+	Event                         m_WorkReady;
+	std::atomic<bool>             m_Stopping = false;
+	std::thread                   m_Thread;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+class JobSystem;
+
+struct Ray
+{
+	glm::vec3 Origin      = glm::vec3(0.0f);
+	glm::vec3 Direction   = glm::vec3(0.0f, 0.0f, 1.0f);
+	float     MaxDistance = std::numeric_limits<float>::max();
+};
+
+struct RayHit
+{
+	static constexpr u32 NoHit = ~0u;
+
+	u32   ObjectID = NoHit;
+	float Distance = std::numeric_limits<float>::max();
+
+	NODISCARD FORCEINLINE bool IsHit() const { return ObjectID != NoHit; }
+};
+
+struct BVHStats
+{
+	u32 ObjectCount    = 0;
+	u32 NodeCount      = 0;
+	u32 PendingObjects = 0;
+	u32 Rebuilds       = 0;
+	u32 LastRefitNodes = 0;
+	f32 CostRatio      = 1.0f; // Current SAH estimate relative to the cost straight after the last build.
+};
+
+// Bounding volume hierarchy over scene object bounds, for raycasts, picking and region queries.
+// Built top-down with binned SAH into a flat node array, where siblings are always adjacent. Moving objects only
+// refit the nodes above them, so an update costs roughly (moved objects * tree depth); once the refitted tree has
+// degraded enough (or enough objects have been added since the last build), it gets rebuilt from scratch.
+// Object IDs are dense, and handed out by Build() (the span index) or AddObject().
+class BVH
+{
+public:
+	static constexpr u32 MaxLeafSize = 4;
+	static constexpr u32 BinCount    = 12;
+
+	void Build(std::span<const AABB> bounds);
+	void Clear();
+
+	// New objects aren't in the tree until the next rebuild; until then, queries test them directly.
+	u32  AddObject(const AABB& bounds);
+	void RemoveObject(u32 objectID);
+	void UpdateObject(u32 objectID, const AABB& bounds);
+
+	// Refits the nodes above any objects that moved, then rebuilds if the tree has degraded too far. Call once a frame.
+	void Update();
+
+	NODISCARD RayHit Raycast(const Ray& ray) const;
+	void             Raycast(std::span<const Ray> rays, std::span<RayHit> outHits,
+	                         JobSystem* jobSystem = nullptr) const;
+
+	void QueryAABB(const AABB& bounds, std::vector<u32>& outObjects) const;
+	void QueryAABB(std::span<const AABB> bounds, std::vector<std::vector<u32>>& outObjects,
+	               JobSystem* jobSystem = nullptr) const;
+
+	void SetRebuildThreshold(f32 costRatio) { m_RebuildThreshold = costRatio; }
+
+	NODISCARD FORCEINLINE const AABB& GetObjectBounds(u32 objectID) const { return m_ObjectBounds[objectID]; }
+	NODISCARD FORCEINLINE BVHStats    GetStats() const { return m_Stats; }
+
+protected:
+	// 32 bytes, so two siblings share a cache line.
+	struct Node
+	{
+		glm::vec3 Min;
+		u32       LeftOrFirst; // Index of the left child for internal nodes (the right is always next), or the first object index for leaves.
+		glm::vec3 Max;
+		u32       Count;       // Number of objects; 0 for internal nodes.
+
+		NODISCARD FORCEINLINE bool IsLeaf() const { return Count != 0; }
+	};
+
+	static constexpr u32 InvalidIndex = ~0u;
+
+	void Rebuild();
+	void UpdateBuildStats();
+	void Subdivide(u32 rootIndex);
+	f32  FindBestSplit(const Node& node, u32& outAxis, f32& outSplit) const;
+	void UpdateNodeBounds(u32 nodeIndex);
+	f32  CalculateCost() const;
+
+	NODISCARD FORCEINLINE static f32 SurfaceArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	NODISCARD static f32 IntersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& min,
+	                                  const glm::vec3& max, f32 maxDistance);
+
+	std::vector<Node> m_Nodes         = {};
+	std::vector<u32>  m_Parents       = {}; // Parent of each node; InvalidIndex for the root.
+	std::vector<u32>  m_ObjectIndices = {}; // Leaves reference a range of this.
+	std::vector<AABB> m_ObjectBounds  = {};
+	std::vector<u32>  m_ObjectLeaf    = {}; // Leaf containing each object, or InvalidIndex if it isn't in the tree yet.
+	std::vector<u32>  m_Pending       = {}; // Objects added since the last build.
+	std::vector<u32>  m_DirtyLeaves   = {};
+	std::vector<u8>   m_LeafDirty     = {};
+
+	// The SAH cost is kept up to date incrementally as nodes are refitted, so we don't need to walk the whole tree
+	// every frame to decide whether to rebuild.
+	f32 m_InternalAreaSum  = 0.0f;
+	f32 m_LeafAreaSum      = 0.0f; // Weighted by object count.
+	f32 m_BuildCost        = 0.0f;
+	f32 m_RebuildThreshold = 1.5f;
+
+	BVHStats m_Stats = {};
+};
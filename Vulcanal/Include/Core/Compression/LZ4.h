@@ -0,0 +1,13 @@
+#pragma once
+
+// A decoder for the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md): raw blocks, with no
+// frame around them, as written by LZ4_compress_default()/LZ4_compress_HC() or any other conforming encoder. The content
+// archive's chunks are compressed with it, offline, at a high level; decoding costs the same whatever the level, and runs
+// at memory speed, which is the point. The engine only ever decodes, so this is all of LZ4 it needs; the archives are
+// written by the reference encoder, and the tests check the two agree on the format.
+namespace LZ4
+{
+	// Decodes the whole of source into destination, which has to be exactly the decoded size. Never reads or writes
+	// out of bounds, however malformed the input; false if it's malformed or the sizes don't match.
+	NODISCARD bool DecompressBlock(std::span<const u8> source, std::span<u8> destination);
+}
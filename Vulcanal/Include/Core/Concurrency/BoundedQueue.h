@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+#include "Core/Concurrency/SPSCQueue.h"
+#include "Core/Concurrency/Semaphore.h"
+
+// A blocking queue with a fixed capacity, for handing work from one thread to another at a steady rate: the producer
+// blocks once it's Capacity items ahead, and the consumer blocks while there's nothing to do. Closing it wakes both;
+// pushes then fail, and pops drain what's left before failing too.
+// It's an SPSC queue with a semaphore counting each side's slots, so neither side takes a lock, and a push or pop only
+// goes near the kernel when the other side's actually asleep. One producer and one consumer only, and the producer
+// should be the one to close it.
+template <typename T>
+class BoundedQueue
+{
+public:
+	explicit BoundedQueue(u32 capacity = 1)
+		: m_Items(std::max(1u, capacity)), m_Free(std::max(1u, capacity)), m_Capacity(std::max(1u, capacity))
+	{
+	}
+
+	BoundedQueue(const BoundedQueue& other)                = delete;
+	BoundedQueue(BoundedQueue&& other) noexcept            = delete;
+	BoundedQueue& operator=(const BoundedQueue& other)     = delete;
+	BoundedQueue& operator=(BoundedQueue&& other) noexcept = delete;
+
+	// False if the queue was closed, in which case the item's dropped.
+	bool Push(T&& item)
+	{
+		m_Free.Acquire();
+		if (m_Closed.load(std::memory_order_acquire))
+		{
+			// Might've been Close()'s wake-up; leave it for the next push.
+			m_Free.Release();
+			return false;
+		}
+
+		// Can't fail, as the semaphore held us to the capacity.
+		m_Items.TryPush(std::move(item));
+		m_Used.Release();
+		return true;
+	}
+
+	// Empty once the queue's closed and drained.
+	std::optional<T> Pop()
+	{
+		m_Used.Acquire();
+		if (std::optional<T> item = m_Items.TryPop())
+		{
+			m_Free.Release();
+			return item;
+		}
+
+		// Nothing there, so that was Close()'s wake-up. Put it back, so every later pop fails straight away too.
+		m_Used.Release();
+		return std::nullopt;
+	}
+
+	void Close()
+	{
+		m_Closed.store(true, std::memory_order_release);
+		m_Free.Release();
+		m_Used.Release();
+	}
+
+	// Opens it again, empty, e.g. to restart the consumer. Neither side can be using it at the time.
+	void Reset()
+	{
+		while (m_Items.TryPop())
+		{
+		}
+		while (m_Free.TryAcquire())
+		{
+		}
+		while (m_Used.TryAcquire())
+		{
+		}
+		m_Free.Release(m_Capacity);
+		m_Closed.store(false, std::memory_order_release);
+	}
+
+	NODISCARD FORCEINLINE u32 GetCapacity() const { return m_Capacity; }
+
+protected:
+	SPSCQueue<T>      m_Items;
+	Semaphore         m_Free; // Slots the producer can fill.
+	Semaphore         m_Used; // Items the consumer can take, plus one once we're closed.
+	u32               m_Capacity = 1;
+	std::atomic<bool> m_Closed   = false;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <thread>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+// What we pad shared atomics out to, so two threads writing neighbouring ones don't keep stealing the same line from
+// each other. std::hardware_destructive_interference_size would be the portable spelling, but GCC warns whenever it's
+// used in a header, as its value can change between compiler flags. 64 is right for x64 and most ARM64.
+constexpr size_t CacheLineSize = 64;
+
+// Tells the core we're spinning, so it can give the pipeline to its sibling hyperthread and not mispredict the exit.
+FORCEINLINE void CpuRelax()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#else
+	std::this_thread::yield();
+#endif
+}
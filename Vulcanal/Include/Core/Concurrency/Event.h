@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/Concurrency/Futex.h"
+
+// A flag threads can sleep on until another thread sets it. Auto-reset events let exactly one waiter through per Set(),
+// and clear themselves as it goes; manual-reset ones stay set, letting everyone through, until Reset().
+// Setting an event nobody's waiting on costs a single atomic, which makes it a cheap way to park the consumer of one of
+// the lock-free queues: push, then Set().
+class Event
+{
+public:
+	explicit Event(bool manualReset = false, bool initiallySet = false)
+		: m_State(initiallySet ? 1 : 0), m_ManualReset(manualReset)
+	{
+	}
+
+	Event(const Event& other)                = delete;
+	Event(Event&& other) noexcept            = delete;
+	Event& operator=(const Event& other)     = delete;
+	Event& operator=(Event&& other) noexcept = delete;
+
+	void Set()
+	{
+		// Only the transition to set needs a wake; if it was already set, whoever's woken by that is still to come.
+		if (m_State.exchange(1, std::memory_order_release) == 0)
+		{
+			if (m_ManualReset)
+				Futex::WakeAll(m_State);
+			else
+				Futex::WakeOne(m_State);
+		}
+	}
+
+	void Reset() { m_State.store(0, std::memory_order_relaxed); }
+
+	void Wait()
+	{
+		while (!TryConsume())
+			Futex::Wait(m_State, 0);
+	}
+
+	// False if it timed out. Spurious wakes restart the full timeout, so it's a lower bound rather than exact.
+	bool WaitFor(u64 timeoutNs)
+	{
+		while (!TryConsume())
+		{
+			if (!Futex::WaitFor(m_State, 0, timeoutNs))
+				return TryConsume();
+		}
+		return true;
+	}
+
+	NODISCARD bool IsSet() const { return m_State.load(std::memory_order_acquire) != 0; }
+
+protected:
+	// Auto-reset events take the flag as they pass; manual ones just look.
+	bool TryConsume()
+	{
+		if (m_ManualReset)
+			return m_State.load(std::memory_order_acquire) != 0;
+
+		u32 expected = 1;
+		return m_State.compare_exchange_strong(expected, 0, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	std::atomic<u32> m_State       = 0;
+	bool             m_ManualReset = false;
+};
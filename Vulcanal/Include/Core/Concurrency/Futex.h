@@ -0,0 +1,16 @@
+#pragma once
+
+#include <atomic>
+
+// Thin wrappers over the OS's wait-on-address: a futex on Linux, WaitOnAddress on Windows, and std::atomic's own wait
+// anywhere else. These are what FutexMutex, Event and Semaphore sleep on; a thread only ever enters the kernel when it
+// actually has to wait, or when there's someone to wake.
+namespace Futex
+{
+	// Sleeps while the word equals expected. Returns on a wake, on a value change, or spuriously, so always re-check.
+	void Wait(std::atomic<u32>& word, u32 expected);
+	// As above, but gives up after the timeout. False if it timed out.
+	bool WaitFor(std::atomic<u32>& word, u32 expected, u64 timeoutNs);
+	void WakeOne(std::atomic<u32>& word);
+	void WakeAll(std::atomic<u32>& word);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/Concurrency/CacheLine.h"
+#include "Core/Concurrency/Futex.h"
+
+// A mutex that's one u32, and only enters the kernel when there's actually a fight over it. It's Drepper's three-state
+// futex mutex ("Futexes Are Tricky", mutex 2): 0 is unlocked, 1 locked, 2 locked with (maybe) someone asleep on it, so
+// unlocking only needs a wake when it was 2. It spins briefly first, as most of our critical sections are over by then.
+// Not recursive, and no fairness to speak of.
+// lock(), try_lock() and unlock() are lowercase so it works with std::lock_guard and std::unique_lock.
+class FutexMutex
+{
+public:
+	FutexMutex() = default;
+
+	FutexMutex(const FutexMutex& other)                = delete;
+	FutexMutex(FutexMutex&& other) noexcept            = delete;
+	FutexMutex& operator=(const FutexMutex& other)     = delete;
+	FutexMutex& operator=(FutexMutex&& other) noexcept = delete;
+
+	void lock()
+	{
+		u32 state = Unlocked;
+		if (m_State.compare_exchange_strong(state, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+			return;
+
+		for (u32 spin = 0; spin < SpinCount && state == Locked; spin++)
+		{
+			CpuRelax();
+			state = Unlocked;
+			if (m_State.compare_exchange_weak(state, Locked, std::memory_order_acquire, std::memory_order_relaxed))
+				return;
+		}
+
+		// Mark it contended, and sleep until it's handed back. Anyone who takes it this way leaves it marked, since
+		// there may be others still asleep; the cost is one spare wake at the very end.
+		if (state != Contended)
+			state = m_State.exchange(Contended, std::memory_order_acquire);
+		while (state != Unlocked)
+		{
+			Futex::Wait(m_State, Contended);
+			state = m_State.exchange(Contended, std::memory_order_acquire);
+		}
+	}
+
+	NODISCARD bool try_lock()
+	{
+		u32 state = Unlocked;
+		return m_State.compare_exchange_strong(state, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+	}
+
+	void unlock()
+	{
+		if (m_State.exchange(Unlocked, std::memory_order_release) == Contended)
+			Futex::WakeOne(m_State);
+	}
+
+protected:
+	static constexpr u32 Unlocked  = 0;
+	static constexpr u32 Locked    = 1;
+	static constexpr u32 Contended = 2;
+	static constexpr u32 SpinCount = 100;
+
+	std::atomic<u32> m_State = Unlocked;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+#include "Core/Concurrency/CacheLine.h"
+
+// A bounded, lock-free queue for any number of producers and consumers: Dmitry Vyukov's sequenced ring. Each slot
+// carries a sequence number saying whose turn it is, so a push or pop is one CAS on its index to claim a slot, then a
+// release store on that slot's sequence to hand it over. Producers and consumers only ever contend among themselves.
+// Slots are a cache line each, so neighbouring pushes and pops don't false share; keep T small (a pointer or handle).
+// Neither side ever blocks; spin, yield or wait on an Event when TryPush() or TryPop() fail.
+template <typename T>
+class MPMCQueue
+{
+public:
+	// The capacity's rounded up to a power of two.
+	explicit MPMCQueue(u32 capacity = 256)
+	{
+		u32 size = 2;
+		while (size < capacity)
+			size <<= 1;
+		m_Mask  = size - 1;
+		m_Slots = std::make_unique<Slot[]>(size);
+		for (u32 i = 0; i < size; i++)
+			m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	~MPMCQueue()
+	{
+		while (TryPop())
+		{
+		}
+	}
+
+	MPMCQueue(const MPMCQueue& other)                = delete;
+	MPMCQueue(MPMCQueue&& other) noexcept            = delete;
+	MPMCQueue& operator=(const MPMCQueue& other)     = delete;
+	MPMCQueue& operator=(MPMCQueue&& other) noexcept = delete;
+
+	// False if the queue's full, in which case the item's left alone.
+	template <typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		u64   tail = m_Tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true)
+		{
+			slot               = &m_Slots[tail & m_Mask];
+			const u64 sequence = slot->Sequence.load(std::memory_order_acquire);
+			const s64 turn     = static_cast<s64>(sequence - tail);
+			if (turn == 0)
+			{
+				// Ours, if nobody beats us to it. A failed CAS reloads the tail, so just go round again.
+				if (m_Tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (turn < 0)
+			{
+				// The consumer a lap behind hasn't taken this one yet, so we're full.
+				return false;
+			}
+			else
+			{
+				// Another producer's already claimed it.
+				tail = m_Tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		new(slot->Storage) T(std::forward<Args>(args)...);
+		slot->Sequence.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(T&& item) { return TryEmplace(std::move(item)); }
+	bool TryPush(const T& item) { return TryEmplace(item); }
+
+	std::optional<T> TryPop()
+	{
+		u64   head = m_Head.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true)
+		{
+			slot               = &m_Slots[head & m_Mask];
+			const u64 sequence = slot->Sequence.load(std::memory_order_acquire);
+			const s64 turn     = static_cast<s64>(sequence - (head + 1));
+			if (turn == 0)
+			{
+				if (m_Head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (turn < 0)
+			{
+				// Nothing's been pushed here yet, so we're empty.
+				return std::nullopt;
+			}
+			else
+			{
+				head = m_Head.load(std::memory_order_relaxed);
+			}
+		}
+
+		T* value = reinterpret_cast<T*>(slot->Storage);
+		std::optional<T> item(std::move(*value));
+		value->~T();
+		// Free for the producer on the next lap.
+		slot->Sequence.store(head + m_Mask + 1, std::memory_order_release);
+		return item;
+	}
+
+	// Only a snapshot, and possibly stale by the time it's returned.
+	NODISCARD bool IsEmpty() const
+	{
+		return m_Head.load(std::memory_order_acquire) >= m_Tail.load(std::memory_order_acquire);
+	}
+	NODISCARD FORCEINLINE u32 GetCapacity() const { return m_Mask + 1; }
+
+protected:
+	struct alignas(CacheLineSize) Slot
+	{
+		std::atomic<u64>     Sequence = 0;
+		alignas(T) std::byte Storage[sizeof(T)];
+	};
+
+	alignas(CacheLineSize) std::atomic<u64> m_Head = 0;
+	alignas(CacheLineSize) std::atomic<u64> m_Tail = 0;
+	alignas(CacheLineSize) std::unique_ptr<Slot[]> m_Slots;
+	u32                                            m_Mask = 0;
+};
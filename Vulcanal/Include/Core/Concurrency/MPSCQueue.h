@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+#include "Core/Concurrency/CacheLine.h"
+
+// A bounded, lock-free queue for any number of producers and a single consumer, e.g. log messages or job submissions
+// funnelled into one thread. Producers claim slots the same way as MPMCQueue, but the consumer owns the head outright,
+// so popping is just a sequence check and two stores - no CAS.
+template <typename T>
+class MPSCQueue
+{
+public:
+	// The capacity's rounded up to a power of two.
+	explicit MPSCQueue(u32 capacity = 256)
+	{
+		u32 size = 2;
+		while (size < capacity)
+			size <<= 1;
+		m_Mask  = size - 1;
+		m_Slots = std::make_unique<Slot[]>(size);
+		for (u32 i = 0; i < size; i++)
+			m_Slots[i].Sequence.store(i, std::memory_order_relaxed);
+	}
+
+	~MPSCQueue()
+	{
+		while (TryPop())
+		{
+		}
+	}
+
+	MPSCQueue(const MPSCQueue& other)                = delete;
+	MPSCQueue(MPSCQueue&& other) noexcept            = delete;
+	MPSCQueue& operator=(const MPSCQueue& other)     = delete;
+	MPSCQueue& operator=(MPSCQueue&& other) noexcept = delete;
+
+	// Any thread. False if the queue's full, in which case the item's left alone.
+	template <typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		u64   tail = m_Tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		while (true)
+		{
+			slot               = &m_Slots[tail & m_Mask];
+			const u64 sequence = slot->Sequence.load(std::memory_order_acquire);
+			const s64 turn     = static_cast<s64>(sequence - tail);
+			if (turn == 0)
+			{
+				if (m_Tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (turn < 0)
+			{
+				return false;
+			}
+			else
+			{
+				tail = m_Tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		new(slot->Storage) T(std::forward<Args>(args)...);
+		slot->Sequence.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(T&& item) { return TryEmplace(std::move(item)); }
+	bool TryPush(const T& item) { return TryEmplace(item); }
+
+	// Consumer only. Items come out in the order their slots were claimed, so one producer that's been preempted
+	// mid-push holds up everything pushed after it until it finishes.
+	std::optional<T> TryPop()
+	{
+		Slot& slot = m_Slots[m_Head & m_Mask];
+		if (slot.Sequence.load(std::memory_order_acquire) != m_Head + 1)
+			return std::nullopt;
+
+		T* value = reinterpret_cast<T*>(slot.Storage);
+		std::optional<T> item(std::move(*value));
+		value->~T();
+		slot.Sequence.store(m_Head + m_Mask + 1, std::memory_order_release);
+		m_Head++;
+		return item;
+	}
+
+	// Consumer only.
+	NODISCARD bool IsEmpty() const
+	{
+		return m_Slots[m_Head & m_Mask].Sequence.load(std::memory_order_acquire) != m_Head + 1;
+	}
+	NODISCARD FORCEINLINE u32 GetCapacity() const { return m_Mask + 1; }
+
+protected:
+	struct alignas(CacheLineSize) Slot
+	{
+		std::atomic<u64>     Sequence = 0;
+		alignas(T) std::byte Storage[sizeof(T)];
+	};
+
+	alignas(CacheLineSize) u64              m_Head = 0; // Consumer's own, so not atomic.
+	alignas(CacheLineSize) std::atomic<u64> m_Tail = 0;
+	alignas(CacheLineSize) std::unique_ptr<Slot[]> m_Slots;
+	u32                                            m_Mask = 0;
+};
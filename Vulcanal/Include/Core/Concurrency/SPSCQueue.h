@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+#include "Core/Concurrency/CacheLine.h"
+
+// A bounded, lock-free queue between exactly one producer thread and exactly one consumer thread. The two indices live
+// on their own cache lines, and each side keeps a cached copy of the other's, so it only touches the other's line when
+// the queue looks full (or empty). In the steady state, a push or pop is a plain store and a release.
+// Neither side ever blocks; spin, yield or wait on an Event when TryPush() or TryPop() fail.
+template <typename T>
+class SPSCQueue
+{
+public:
+	// The capacity's rounded up to a power of two.
+	explicit SPSCQueue(u32 capacity = 256)
+	{
+		u32 size = 2;
+		while (size < capacity)
+			size <<= 1;
+		m_Mask  = size - 1;
+		m_Slots = std::make_unique<Slot[]>(size);
+	}
+
+	~SPSCQueue()
+	{
+		// Whatever's left is still constructed.
+		while (TryPop())
+		{
+		}
+	}
+
+	SPSCQueue(const SPSCQueue& other)                = delete;
+	SPSCQueue(SPSCQueue&& other) noexcept            = delete;
+	SPSCQueue& operator=(const SPSCQueue& other)     = delete;
+	SPSCQueue& operator=(SPSCQueue&& other) noexcept = delete;
+
+	// Producer only. False if the queue's full, in which case the item's left alone.
+	template <typename... Args>
+	bool TryEmplace(Args&&... args)
+	{
+		const u64 tail = m_Tail.load(std::memory_order_relaxed);
+		if (tail - m_CachedHead > m_Mask)
+		{
+			m_CachedHead = m_Head.load(std::memory_order_acquire);
+			if (tail - m_CachedHead > m_Mask)
+				return false;
+		}
+
+		new(m_Slots[tail & m_Mask].Storage) T(std::forward<Args>(args)...);
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool TryPush(T&& item) { return TryEmplace(std::move(item)); }
+	bool TryPush(const T& item) { return TryEmplace(item); }
+
+	// Consumer only.
+	std::optional<T> TryPop()
+	{
+		const u64 head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_CachedTail)
+		{
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			if (head == m_CachedTail)
+				return std::nullopt;
+		}
+
+		T* slot = reinterpret_cast<T*>(m_Slots[head & m_Mask].Storage);
+		std::optional<T> item(std::move(*slot));
+		slot->~T();
+		m_Head.store(head + 1, std::memory_order_release);
+		return item;
+	}
+
+	// Only a snapshot; exact on the consumer's side, as far as it goes.
+	NODISCARD bool IsEmpty() const
+	{
+		return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+	}
+	NODISCARD FORCEINLINE u32 GetCapacity() const { return m_Mask + 1; }
+
+protected:
+	struct Slot
+	{
+		alignas(T) std::byte Storage[sizeof(T)];
+	};
+
+	// Consumer's line: its index, and what it last saw of the producer's.
+	alignas(CacheLineSize) std::atomic<u64> m_Head       = 0;
+	u64                                     m_CachedTail = 0;
+
+	// Producer's line.
+	alignas(CacheLineSize) std::atomic<u64> m_Tail       = 0;
+	u64                                     m_CachedHead = 0;
+
+	// Read by both, written by neither after construction.
+	alignas(CacheLineSize) std::unique_ptr<Slot[]> m_Slots;
+	u32                                            m_Mask = 0;
+};
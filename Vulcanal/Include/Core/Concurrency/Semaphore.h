@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/Concurrency/Futex.h"
+
+// A counting semaphore on a futex. Acquire() takes one from the count, sleeping while there are none; Release() gives
+// some back. The waiter count means a release only enters the kernel when somebody's actually asleep.
+class Semaphore
+{
+public:
+	explicit Semaphore(u32 initialCount = 0) : m_Count(initialCount) {}
+
+	Semaphore(const Semaphore& other)                = delete;
+	Semaphore(Semaphore&& other) noexcept            = delete;
+	Semaphore& operator=(const Semaphore& other)     = delete;
+	Semaphore& operator=(Semaphore&& other) noexcept = delete;
+
+	void Release(u32 count = 1)
+	{
+		// Both sequentially consistent, like the waiter's increment; otherwise we could read no waiters while one's
+		// about to sleep having seen no count.
+		m_Count.fetch_add(count, std::memory_order_seq_cst);
+		if (m_Waiters.load(std::memory_order_seq_cst) == 0)
+			return;
+
+		if (count == 1)
+			Futex::WakeOne(m_Count);
+		else
+			Futex::WakeAll(m_Count);
+	}
+
+	void Acquire()
+	{
+		while (!TryAcquire())
+		{
+			m_Waiters.fetch_add(1, std::memory_order_seq_cst);
+			// The futex re-checks the count against 0 before sleeping, so a release since the check above isn't lost.
+			Futex::Wait(m_Count, 0);
+			m_Waiters.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	NODISCARD bool TryAcquire()
+	{
+		u32 count = m_Count.load(std::memory_order_relaxed);
+		while (count != 0)
+		{
+			if (m_Count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return true;
+		}
+		return false;
+	}
+
+	NODISCARD u32 GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+
+protected:
+	std::atomic<u32> m_Count   = 0;
+	std::atomic<u32> m_Waiters = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/Concurrency/CacheLine.h"
+
+// A test-and-test-and-set spin lock, for critical sections that are only ever a handful of instructions long. Waiters
+// spin on a plain load, so the line stays shared until the owner lets go, and yield after a while in case the owner's
+// been descheduled. Never hold it across anything that might block; that's what FutexMutex is for.
+// lock(), try_lock() and unlock() are lowercase so it works with std::lock_guard and std::unique_lock.
+class SpinMutex
+{
+public:
+	SpinMutex() = default;
+
+	SpinMutex(const SpinMutex& other)                = delete;
+	SpinMutex(SpinMutex&& other) noexcept            = delete;
+	SpinMutex& operator=(const SpinMutex& other)     = delete;
+	SpinMutex& operator=(SpinMutex&& other) noexcept = delete;
+
+	void lock()
+	{
+		u32 spins = 0;
+		while (m_Locked.exchange(true, std::memory_order_acquire))
+		{
+			while (m_Locked.load(std::memory_order_relaxed))
+			{
+				if (++spins < 64)
+					CpuRelax();
+				else
+					std::this_thread::yield();
+			}
+		}
+	}
+
+	NODISCARD bool try_lock()
+	{
+		return !m_Locked.load(std::memory_order_relaxed) && !m_Locked.exchange(true, std::memory_order_acquire);
+	}
+
+	void unlock() { m_Locked.store(false, std::memory_order_release); }
+
+protected:
+	std::atomic<bool> m_Locked = false;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class ThreadPool;
+
+// An open file, for AsyncFileIO to read from. It has to stay open until every read from it has completed.
+class AsyncFile
+{
+public:
+	AsyncFile() = default;
+	~AsyncFile();
+
+	AsyncFile(const AsyncFile& other)                = delete;
+	AsyncFile(AsyncFile&& other) noexcept;
+	AsyncFile& operator=(const AsyncFile& other)     = delete;
+	AsyncFile& operator=(AsyncFile&& other) noexcept;
+
+	// Direct files bypass the OS's cache, which big streaming reads would only churn, but every read's offset, size and
+	// destination has to be aligned to AsyncFileIO::DirectAlignment. If the file system can't do direct I/O, the file's
+	// opened normally instead, and IsDirect() says so.
+	bool Open(const std::filesystem::path& path, bool direct = false);
+	void Close();
+
+	NODISCARD FORCEINLINE bool     IsOpen() const { return m_Handle != InvalidHandle; }
+	NODISCARD FORCEINLINE bool     IsDirect() const { return m_Direct; }
+	NODISCARD FORCEINLINE u64      GetSize() const { return m_Size; }
+	// A file descriptor on Linux, a HANDLE on Windows.
+	NODISCARD FORCEINLINE intptr_t GetNativeHandle() const { return m_Handle; }
+
+protected:
+	static constexpr intptr_t InvalidHandle = -1;
+
+	intptr_t m_Handle = InvalidHandle;
+	u64      m_Size   = 0;
+	bool     m_Direct = false;
+};
+
+// Called once the read's done, with the number of bytes read (fewer than asked for only at the end of the file), or a
+// negative error (-errno on Linux). Runs on the I/O completion thread, or a thread pool worker, so it should be quick:
+// flag the data as ready, or hand it on (to an upload queue, say), rather than process it there.
+using AsyncReadCallback = std::function<void(s64 result)>;
+
+struct AsyncReadRequest
+{
+	const AsyncFile*  File        = nullptr;
+	u64               Offset      = 0;
+	std::span<u8>     Destination = {};
+	// The registered buffer Destination lies in, if it does, so the kernel can skip mapping it for every read.
+	s32               BufferIndex = -1;
+	AsyncReadCallback OnComplete  = {};
+};
+
+struct AsyncFileIOSpecification
+{
+	// Reads in flight at once, before the rest queue up. Deep queues are what keep an NVMe drive busy.
+	u32  QueueDepth = 256;
+	// Buffers allocated (aligned for direct reads) and registered with the kernel up front, for GetRegisteredBuffer().
+	u32  RegisteredBufferCount = 0;
+	u32  RegisteredBufferSize  = 1024 * 1024;
+	// Skip io_uring even where it's available, and do every read on the thread pool. For comparing the two.
+	bool ForceThreadPool = false;
+};
+
+// Reads files asynchronously, many at once. On Linux it's backed by io_uring: a batch of reads is one system call to
+// submit, however many there are, and a single thread reaps their completions and runs the callbacks, so there's no
+// thread blocked per read, and the queue can be as deep as the drive wants. Elsewhere, or if the kernel won't give us
+// a ring (too old, or locked down), each read's a blocking read on the thread pool instead; slower, but the same API.
+// Safe to call from any thread, including from a completion callback.
+class AsyncFileIO
+{
+public:
+	static constexpr u32 DirectAlignment = 4096;
+
+	explicit AsyncFileIO(ThreadPool& threadPool, AsyncFileIOSpecification spec = {});
+	// Waits for every read in flight.
+	~AsyncFileIO();
+
+	AsyncFileIO(const AsyncFileIO& other)                = delete;
+	AsyncFileIO(AsyncFileIO&& other) noexcept            = delete;
+	AsyncFileIO& operator=(const AsyncFileIO& other)     = delete;
+	AsyncFileIO& operator=(AsyncFileIO&& other) noexcept = delete;
+
+	void Read(AsyncReadRequest&& request);
+	// Submits the whole batch at once.
+	void Read(std::span<AsyncReadRequest> requests);
+
+	// Blocks until every read's completed and its callback has run. Not from a callback.
+	void WaitIdle();
+
+	NODISCARD std::span<u8>    GetRegisteredBuffer(u32 index) const;
+	NODISCARD FORCEINLINE u32  GetRegisteredBufferCount() const { return static_cast<u32>(m_Buffers.size()); }
+	NODISCARD FORCEINLINE bool IsUsingIOUring() const { return m_Ring != nullptr; }
+	NODISCARD FORCEINLINE u32  GetInFlightCount() const { return m_InFlightCount.load(std::memory_order_relaxed); }
+
+	void OnDrawIMGui();
+
+protected:
+	struct IOURing;
+
+	// A read in flight. Short reads are resubmitted for the rest, so Done is how far it's got.
+	struct PendingRead
+	{
+		AsyncReadRequest Request;
+		u64              Done        = 0;
+		s64              SubmitError = 0; // Why the kernel wouldn't take it, if it wouldn't.
+	};
+
+	bool InitIOURing();
+	void ShutdownIOURing();
+	// Both called with the lock held. Moves as many queued reads into the ring as there's room for, and submits them.
+	// Any the kernel refuses are taken back out of the ring and added to `unsubmitted`, for the caller to finish with
+	// FinishUnsubmitted() once it's unlocked, since their callbacks might want to read more.
+	void SubmitQueued(std::vector<PendingRead*>& unsubmitted);
+	// False if the kernel wouldn't take everything.
+	bool EnterRing(u32 toSubmit, std::vector<PendingRead*>& unsubmitted);
+	void FinishUnsubmitted(std::span<PendingRead* const> unsubmitted);
+	void CompletionLoop();
+	void OnReadCompleted(PendingRead* read, s64 result);
+	// Runs the callback, and frees the read.
+	void FinishRead(PendingRead* read, s64 result);
+
+	void ReadOnThreadPool(PendingRead* read);
+
+	ThreadPool*              m_ThreadPool = nullptr;
+	AsyncFileIOSpecification m_Specification;
+	Scope<IOURing>           m_Ring;
+	std::thread              m_CompletionThread;
+	std::vector<u8*>         m_Buffers           = {};
+	bool                     m_BuffersRegistered = false;
+
+	std::mutex               m_Mutex  = {};
+	std::condition_variable  m_Idle   = {};
+	std::deque<PendingRead*> m_Queued = {}; // Waiting for room in the ring.
+	u32                      m_InRing = 0;  // Submitted to the ring, and not yet completed.
+
+	std::atomic<u32> m_InFlightCount = 0; // Everything not yet completed, queued or not.
+	std::atomic<u64> m_BytesRead     = 0;
+	std::atomic<u64> m_ReadCount     = 0;
+	std::atomic<u64> m_FailedCount   = 0;
+};
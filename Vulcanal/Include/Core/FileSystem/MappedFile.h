@@ -0,0 +1,32 @@
+#pragma once
+
+// A read-only view of a whole file, mapped into memory. Reading it is just reading memory; the OS pages it in on first
+// touch, and can drop the pages again under pressure, since they're backed by the file rather than by swap.
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile& other)                = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(const MappedFile& other)     = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// False if the file couldn't be opened or mapped. Empty files open fine, as an empty span.
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	NODISCARD FORCEINLINE bool                 IsOpen() const { return m_Open; }
+	NODISCARD FORCEINLINE std::span<const u8> GetData() const { return {m_Data, m_Size}; }
+	NODISCARD FORCEINLINE size_t               GetSize() const { return m_Size; }
+
+protected:
+	const u8* m_Data = nullptr;
+	size_t    m_Size = 0;
+	bool      m_Open = false;
+#ifdef VULC_PLATFORM_WINDOWS
+	void* m_FileHandle    = nullptr;
+	void* m_MappingHandle = nullptr;
+#endif
+};
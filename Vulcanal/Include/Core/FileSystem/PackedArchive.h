@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Core/FileSystem/MappedFile.h"
+
+class JobSystem;
+
+// One file holding all of the processed content, built by the preprocessor (Tools/Preprocessor/ContentArchive.cs, whose
+// layout this has to match). The whole archive's memory-mapped, so finding a file is a binary search over the entry
+// table, and reading it is a pointer into the mapping. No syscalls, no per-file handles.
+// Entries can be compressed, in independent LZ4 chunks of (usually) 64 KiB, so a range can be read without decoding
+// the whole file, and a big file's chunks can be decoded on every core at once, each straight into its place in the
+// destination. Compressed entries start with a table of where each chunk's compressed data ends, relative to the end
+// of the table; a chunk that didn't compress is stored as is, and its compressed size is its decoded size.
+class PackedArchive
+{
+public:
+	static constexpr u32 Magic   = 0x4B415056; // "VPAK"
+	static constexpr u32 Version = 2;
+
+	static constexpr u32 CompressedFlag = 1u << 0;
+
+	struct Header
+	{
+		u32 Magic;
+		u32 Version;
+		u32 EntryCount;
+		u32 ChunkSize; // Decoded size of every compressed chunk but an entry's last.
+		u64 EntriesOffset;
+		u64 PathsOffset;
+	};
+	static_assert(sizeof(Header) == 32);
+
+	// Entries are sorted by hash, then by path.
+	struct Entry
+	{
+		u32 Hash;       // crc32() of the path.
+		u32 PathOffset; // Into the path table.
+		u32 PathLength;
+		u32 Flags;      // CompressedFlag, or nothing.
+		u64 Offset;     // Of the data (or chunk table), from the start of the archive. Aligned to 16.
+		u64 Size;       // Decoded.
+	};
+	static_assert(sizeof(Entry) == 32);
+
+	PackedArchive() = default;
+
+	PackedArchive(const PackedArchive& other)                = delete;
+	PackedArchive(PackedArchive&& other) noexcept            = default;
+	PackedArchive& operator=(const PackedArchive& other)     = delete;
+	PackedArchive& operator=(PackedArchive&& other) noexcept = default;
+
+	// Maps the archive and checks its header and tables. False (and closed) if it's missing or malformed.
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	// Null if there's no such file. The path's relative to the archive's root, with forward slashes.
+	NODISCARD const Entry*        FindEntry(std::string_view path) const;
+	NODISCARD std::string_view    GetPath(const Entry& entry) const;
+	// The entry's bytes in place. Uncompressed entries only.
+	NODISCARD std::span<const u8> GetData(const Entry& entry) const;
+
+	// Copies (decoding, if need be) destination.size() bytes from the offset into the entry. With a job system, a read
+	// that spans several chunks decodes them in parallel, and waits for them. False if the range is out of bounds, or
+	// the data's corrupt.
+	bool Read(const Entry& entry, u64 offset, std::span<u8> destination, JobSystem* jobSystem = nullptr) const;
+
+	NODISCARD FORCEINLINE static bool IsCompressed(const Entry& entry) { return entry.Flags & CompressedFlag; }
+	NODISCARD u32                     GetChunkCount(const Entry& entry) const;
+
+	NODISCARD FORCEINLINE bool                         IsOpen() const { return m_File.IsOpen(); }
+	NODISCARD FORCEINLINE std::span<const Entry>       GetEntries() const { return m_Entries; }
+	NODISCARD FORCEINLINE size_t                       GetSize() const { return m_File.GetSize(); }
+	NODISCARD FORCEINLINE const std::filesystem::path& GetArchivePath() const { return m_Path; }
+	NODISCARD FORCEINLINE u32                          GetChunkSize() const { return m_ChunkSize; }
+
+protected:
+	// Decodes one whole chunk of a compressed entry; destination has to be exactly its decoded size.
+	bool ReadChunk(const Entry& entry, u32 chunk, std::span<u8> destination) const;
+
+	MappedFile             m_File;
+	std::filesystem::path  m_Path;
+	std::span<const Entry> m_Entries   = {};
+	const char*            m_Paths     = nullptr;
+	u32                    m_ChunkSize = 0;
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+
+#include "Core/FileSystem/PackedArchive.h"
+
+class JobSystem;
+
+struct VirtualFileSystemSpecification
+{
+	// Check the disk before the archives, so edited content shows up without repacking. For development.
+	bool PreferLooseFiles = false;
+};
+
+// Where content's read from. Paths look the same either way ("Content/Shaders/Resolve.spv"): if an archive's mounted
+// over "Content/" and has the file, it comes out of the mapping; otherwise it's read from disk as a loose file, so a
+// build without an archive, or content added since it was packed, still works.
+// Compressed files are decoded chunk by chunk on the job system, so a cold load's limited by how fast every core
+// together can decompress, rather than by one thread reading.
+// Mount everything up front; after that, reads never lock and are safe from any thread.
+class VirtualFileSystem
+{
+public:
+	// Without a job system, compressed files are decoded on the reading thread.
+	explicit VirtualFileSystem(VirtualFileSystemSpecification spec = {}, JobSystem* jobSystem = nullptr);
+	~VirtualFileSystem();
+
+	VirtualFileSystem(const VirtualFileSystem& other)                = delete;
+	VirtualFileSystem(VirtualFileSystem&& other) noexcept            = delete;
+	VirtualFileSystem& operator=(const VirtualFileSystem& other)     = delete;
+	VirtualFileSystem& operator=(VirtualFileSystem&& other) noexcept = delete;
+
+	// Serves the archive's files under the mount point, e.g. "Shaders/Resolve.spv" as "Content/Shaders/Resolve.spv".
+	// Later mounts are searched first, so a patch archive can override the base one.
+	bool Mount(const std::filesystem::path& archivePath, std::string_view mountPoint);
+
+	// The file's bytes in place, if it's stored uncompressed in a mounted archive (and there's no loose file to prefer).
+	// Valid for as long as the file system is.
+	NODISCARD std::optional<std::span<const u8>> Map(std::string_view path) const;
+	// A copy of the file's bytes, from an archive or from disk.
+	NODISCARD std::optional<std::vector<u8>> ReadFile(std::string_view path) const;
+	// Reads destination.size() bytes from the offset into the file, straight into the destination (a staging buffer,
+	// say). Only the compressed chunks the range touches are decoded. False if the file's missing or too short.
+	bool ReadRange(std::string_view path, u64 offset, std::span<u8> destination) const;
+	// Decoded size.
+	NODISCARD std::optional<u64> GetFileSize(std::string_view path) const;
+	NODISCARD bool               Exists(std::string_view path) const;
+	// Whether reads of the file come out of an archive, rather than off the disk. Loose files can be streamed with
+	// AsyncFileIO instead; packed ones have to go through ReadRange, which knows how to decode them.
+	NODISCARD bool               IsPacked(std::string_view path) const;
+
+	void OnDrawIMGui();
+
+	// The application's, once it's made one. Null before that, so anything that can run without one (tools, tests)
+	// should fall back to reading from disk.
+	NODISCARD FORCEINLINE static VirtualFileSystem* Get() { return s_Instance; }
+
+protected:
+	struct MountedArchive
+	{
+		std::string   Prefix; // Normalised, with a trailing slash, or empty for the root.
+		PackedArchive Archive;
+	};
+
+	struct ArchiveFile
+	{
+		const PackedArchive*        Archive = nullptr;
+		const PackedArchive::Entry* Entry   = nullptr;
+	};
+
+	// Forward slashes, no leading "./".
+	NODISCARD static std::string Normalise(std::string_view path);
+	// Empty if no archive has it, or if there's a loose file we'd rather read.
+	NODISCARD std::optional<ArchiveFile> FindInArchives(const std::string& normalisedPath) const;
+	bool ReadFromArchive(const ArchiveFile& file, u64 offset, std::span<u8> destination) const;
+
+	NODISCARD static bool                           IsLooseFile(const std::string& path);
+	NODISCARD static std::optional<std::vector<u8>> ReadLooseFile(const std::string& path);
+
+	static VirtualFileSystem* s_Instance;
+
+	VirtualFileSystemSpecification m_Specification;
+	JobSystem*                     m_JobSystem = nullptr;
+	std::vector<MountedArchive>    m_Mounts;
+
+	mutable std::atomic<u64> m_ArchiveReads      = 0;
+	mutable std::atomic<u64> m_LooseReads        = 0;
+	mutable std::atomic<u64> m_Misses            = 0;
+	mutable std::atomic<u64> m_DecompressedBytes = 0;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+
+// Caps the frame rate without the jitter of a plain sleep.
+// OS sleeps are only good to a millisecond or so (a lot worse on some Windows timers), so we sleep in short steps while
+// there's comfortably more time left than a step tends to take, then spin for the rest. How long a step really takes is
+// measured as we go, so we spin for as little time as this machine allows.
+class FrameLimiter
+{
+public:
+	// 0 means uncapped.
+	void SetTargetFrameRate(f64 frameRate);
+
+	// Blocks until it's time to start the next frame. Called once a frame, at the start.
+	void Wait();
+
+	NODISCARD FORCEINLINE f64 GetTargetFrameRate() const { return m_TargetFrameRate; }
+
+protected:
+	using Clock = std::chrono::steady_clock;
+
+	void SleepUntil(Clock::time_point time);
+
+	f64               m_TargetFrameRate = 0.0;
+	Clock::time_point m_NextFrame       = {};
+
+	// Running mean and variance (Welford's) of how long a short sleep actually takes, in seconds.
+	f64 m_SleepMean  = 0.002;
+	f64 m_SleepM2    = 0.0;
+	u64 m_SleepCount = 1;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "Core/Jobs/WorkStealingDeque.h"
+#include "Core/Concurrency/MPMCQueue.h"
+
+using JobFunction = std::function<void()>;
+
+struct Job;
+
+// Tracks a group of jobs. It goes up by one when a job that signals it is submitted, and down by one when that job
+// finishes, so zero means "everything's done". Jobs can also depend on one, and won't start until it reaches zero.
+// It has to outlive every job that signals or depends on it, so Wait on it before it goes out of scope, and don't add
+// to it again while jobs are still held back on it.
+class JobCounter
+{
+public:
+	JobCounter() = default;
+
+	JobCounter(const JobCounter& other)                = delete;
+	JobCounter(JobCounter&& other) noexcept            = delete;
+	JobCounter& operator=(const JobCounter& other)     = delete;
+	JobCounter& operator=(JobCounter&& other) noexcept = delete;
+
+	NODISCARD FORCEINLINE u32  GetValue() const { return m_Value.load(std::memory_order_acquire); }
+	NODISCARD FORCEINLINE bool IsDone() const { return GetValue() == 0; }
+
+protected:
+	friend class JobSystem;
+
+	std::atomic<u32>  m_Value   = 0;
+	std::atomic<u32>  m_Helpers = 0; // Job threads waiting on us, which need waking when we're done.
+	std::mutex        m_Mutex   = {};
+	std::vector<Job*> m_Waiting = {}; // Jobs held back until we reach zero.
+};
+
+struct JobSystemSpecification
+{
+	// 0 means "one worker per logical core, minus one for the main thread".
+	u32         WorkerCount = 0;
+	// Pins each worker to its own core (worker N to core N, leaving core 0 to the main thread). Steadier timings, but
+	// it fights the OS scheduler when something else wants the cores, so it's off by default.
+	bool        PinThreads = false;
+	std::string Name       = "Job Worker"; // Threads are named "<Name> <index>".
+};
+
+// A work-stealing scheduler for short, CPU-bound jobs: culling, decoding, command recording. Every thread has its own
+// deque, pushing and popping its own jobs at one end, and steals from the others' far end when it runs dry, so
+// there's no shared queue to fight over.
+// The thread that creates the system (the main thread) is thread 0 and takes part whenever it waits on a counter.
+// Other threads can submit and wait too; their jobs go through a lock-free injection queue, and they just block.
+// Should that ever fill up, they wake the workers and yield until there's room.
+// Jobs shouldn't block on anything but counters. Long or blocking work (file reads, say) still goes on the
+// ThreadPool, where it won't tie up a worker.
+class JobSystem
+{
+public:
+	explicit JobSystem(JobSystemSpecification spec = {});
+	~JobSystem();
+
+	JobSystem(const JobSystem& other)                = delete;
+	JobSystem(JobSystem&& other) noexcept            = delete;
+	JobSystem& operator=(const JobSystem& other)     = delete;
+	JobSystem& operator=(JobSystem&& other) noexcept = delete;
+
+	// Queues the function. The counter, if given, is incremented now and decremented once the job finishes. The
+	// dependency, if given, holds the job back until it reaches zero.
+	void Run(JobFunction&& function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+
+	// Blocks until the counter reaches zero. Our own threads run other jobs in the meantime, so this is safe to call
+	// from inside a job.
+	void Wait(JobCounter& counter);
+
+	// Splits [0, count) into batches and runs func(begin, end) over them on every thread, returning once they're all
+	// done. Batches are at least minBatchSize long, and there are a few per thread at most, so the stealing can
+	// even out uneven batches without each one costing more to schedule than to run.
+	void ParallelFor(u32 count, const std::function<void(u32 begin, u32 end)>& func, u32 minBatchSize = 1);
+
+	// The number of threads that run jobs: the workers plus the main thread.
+	NODISCARD FORCEINLINE u32 GetThreadCount() const { return static_cast<u32>(m_Queues.size()); }
+	NODISCARD FORCEINLINE u32 GetWorkerCount() const { return static_cast<u32>(m_Workers.size()); }
+
+	// 0 on the main thread, 1 and up on the workers, -1 on anything else. Handy for indexing per-thread resources.
+	NODISCARD s32 GetCurrentThreadIndex() const;
+
+	NODISCARD FORCEINLINE const JobSystemSpecification& GetSpecification() const { return m_Specification; }
+
+protected:
+	void WorkerLoop(u32 index);
+	void Schedule(Job* job);
+	void Execute(Job* job);
+	void Signal(JobCounter& counter);
+	Job* FindJob(u32 index);
+	// Wakes a sleeping thread, if any. Also bumped when a counter finishes, for the threads waiting on it.
+	void Wake(bool all);
+
+	static constexpr u32 InjectedCapacity = 1024;
+
+	JobSystemSpecification                      m_Specification;
+	std::vector<std::thread>                    m_Workers   = {};
+	std::vector<Scope<WorkStealingDeque<Job*>>> m_Queues    = {}; // One per thread, indexed like the threads.
+	MPMCQueue<Job*>                             m_Injected{InjectedCapacity}; // From threads that aren't ours.
+	std::atomic<u32>                            m_WakeEpoch = 0;
+	std::atomic<u32>                            m_Sleeping  = 0;
+	std::atomic<bool>                           m_Stopping  = false;
+};
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+
+#include "Core/FileSystem/AsyncFileIO.h"
+#include "Core/Jobs/JobSystem.h"
+
+template <typename T = void>
+class Task;
+
+namespace TaskDetail
+{
+	// Written to a promise's continuation slot once it's finished, so a late awaiter knows not to wait.
+	inline char s_DoneMarker = 0;
+	inline void* GetDoneMarker() { return &s_DoneMarker; }
+
+	struct PromiseBase
+	{
+		// Lazy: nothing runs until the task's awaited or started.
+		std::suspend_always initial_suspend() noexcept { return {}; }
+
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			template <typename Promise>
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept
+			{
+				// Hand straight over to whoever's waiting, if anyone is yet. If they turn up later, they'll see the
+				// marker and carry on without suspending.
+				void* continuation = handle.promise().Continuation.exchange(GetDoneMarker(), std::memory_order_acq_rel);
+				if (continuation)
+					return std::coroutine_handle<>::from_address(continuation);
+				return std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		FinalAwaiter final_suspend() noexcept { return {}; }
+
+		// Kept for whoever awaits the task, or asks for its result, to rethrow.
+		void unhandled_exception() noexcept { Exception = std::current_exception(); }
+
+		void RethrowIfFailed() const
+		{
+			if (Exception)
+				std::rethrow_exception(Exception);
+		}
+
+		// Null while running with nobody waiting, the awaiting coroutine's address once someone is, and the done
+		// marker once finished.
+		std::atomic<void*> Continuation = nullptr;
+		std::exception_ptr Exception    = nullptr;
+	};
+
+	template <typename T>
+	struct Promise : PromiseBase
+	{
+		Task<T> get_return_object() noexcept;
+
+		template <typename U> requires std::is_convertible_v<U&&, T>
+		void return_value(U&& value) { Value.emplace(std::forward<U>(value)); }
+
+		std::optional<T> Value;
+	};
+
+	template <>
+	struct Promise<void> : PromiseBase
+	{
+		Task<void> get_return_object() noexcept;
+		void       return_void() noexcept {}
+	};
+
+	// Fire and forget: starts straight away, and frees itself once it's done.
+	struct DetachedTask
+	{
+		struct promise_type
+		{
+			DetachedTask        get_return_object() noexcept { return {}; }
+			std::suspend_never  initial_suspend() noexcept { return {}; }
+			std::suspend_never  final_suspend() noexcept { return {}; }
+			void                return_void() noexcept {}
+
+			// Nobody's waiting to be told, so there's nowhere for it to go.
+			void unhandled_exception() noexcept
+			{
+				try
+				{
+					throw;
+				}
+				catch (const std::exception& exception)
+				{
+					VULC_ERROR("Unhandled exception in a spawned task: {}", exception.what());
+				}
+				catch (...)
+				{
+					VULC_ERROR("Unhandled exception in a spawned task");
+				}
+				std::terminate();
+			}
+		};
+	};
+}
+
+// A coroutine that runs on the job system. It doesn't start until it's awaited (in which case it runs inline, on the
+// awaiting thread) or started with Start(), and it can be awaited from any other task once it has. Anything it throws
+// is rethrown to whoever awaits it, or asks for its result.
+// Whatever it awaits decides where it carries on from: SwitchTo() hops onto a job, ReadFileAsync() hands the read to
+// AsyncFileIO and carries on from a job once it's done, and the GPUAwaitPoller resumes GPU waits on the job system once
+// the work's retired. Like any job, it shouldn't block.
+template <typename T>
+class Task
+{
+public:
+	using promise_type = TaskDetail::Promise<T>;
+	using Handle       = std::coroutine_handle<promise_type>;
+
+	Task() = default;
+	explicit Task(Handle handle) : m_Handle(handle) {}
+
+	~Task() { Reset(); }
+
+	Task(const Task& other)            = delete;
+	Task& operator=(const Task& other) = delete;
+
+	Task(Task&& other) noexcept
+		: m_Handle(std::exchange(other.m_Handle, nullptr)), m_Started(std::exchange(other.m_Started, false)) {}
+
+	Task& operator=(Task&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Reset();
+			m_Handle  = std::exchange(other.m_Handle, nullptr);
+			m_Started = std::exchange(other.m_Started, false);
+		}
+		return *this;
+	}
+
+	// Runs it on a job. The task has to be kept around until it's done; use Spawn() if nobody needs the result.
+	void Start(JobSystem& jobSystem)
+	{
+		VULC_ASSERT(m_Handle && !m_Started, "Task is empty or already started");
+		m_Started = true;
+		jobSystem.Run([handle = m_Handle]() { handle.resume(); });
+	}
+
+	NODISCARD FORCEINLINE bool IsValid() const { return m_Handle != nullptr; }
+	NODISCARD FORCEINLINE bool IsDone() const
+	{
+		return m_Handle && m_Handle.promise().Continuation.load(std::memory_order_acquire) == TaskDetail::GetDoneMarker();
+	}
+
+	// Only once it's done. Rethrows whatever the task threw, so void tasks have one too.
+	decltype(auto) GetResult()
+	{
+		VULC_ASSERT(IsDone(), "Task result read before it finished");
+		m_Handle.promise().RethrowIfFailed();
+		if constexpr (!std::is_void_v<T>)
+			return (*m_Handle.promise().Value);
+	}
+
+	auto operator co_await() && noexcept { return Awaiter{this}; }
+	auto operator co_await() & noexcept { return Awaiter{this}; }
+
+protected:
+	struct Awaiter
+	{
+		Task* Awaited;
+
+		bool await_ready() const noexcept { return Awaited->IsDone(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept
+		{
+			promise_type& promise = Awaited->m_Handle.promise();
+			if (!Awaited->m_Started)
+			{
+				// Nobody else can see it yet, so just leave our address and run it here.
+				Awaited->m_Started = true;
+				promise.Continuation.store(awaiting.address(), std::memory_order_relaxed);
+				return Awaited->m_Handle;
+			}
+
+			// It's running elsewhere. If it finishes before we're in, carry on without suspending.
+			void* expected = nullptr;
+			if (promise.Continuation.compare_exchange_strong(expected, awaiting.address(), std::memory_order_acq_rel))
+				return std::noop_coroutine();
+			return awaiting;
+		}
+
+		decltype(auto) await_resume() const
+		{
+			Awaited->m_Handle.promise().RethrowIfFailed();
+			if constexpr (!std::is_void_v<T>)
+				return std::move(*Awaited->m_Handle.promise().Value);
+		}
+	};
+
+	void Reset()
+	{
+		if (!m_Handle)
+			return;
+
+		VULC_ASSERT(!m_Started || IsDone(), "Task destroyed while it was still running");
+		m_Handle.destroy();
+		m_Handle = nullptr;
+	}
+
+	Handle m_Handle  = nullptr;
+	bool   m_Started = false;
+};
+
+namespace TaskDetail
+{
+	template <typename T>
+	Task<T> Promise<T>::get_return_object() noexcept
+	{
+		return Task<T>(std::coroutine_handle<Promise>::from_promise(*this));
+	}
+
+	inline Task<void> Promise<void>::get_return_object() noexcept
+	{
+		return Task<void>(std::coroutine_handle<Promise>::from_promise(*this));
+	}
+}
+
+// co_await SwitchTo(jobSystem) carries on from a job, e.g. to get off a thread that shouldn't be doing the work.
+struct JobSystemAwaiter
+{
+	JobSystem* Jobs;
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<> handle) const { Jobs->Run([handle]() { handle.resume(); }); }
+	void await_resume() const noexcept {}
+};
+
+NODISCARD inline JobSystemAwaiter SwitchTo(JobSystem& jobSystem) { return {&jobSystem}; }
+
+// Starts the task on the job system with nobody holding on to it. Its frame's freed once it finishes.
+template <typename T>
+void Spawn(JobSystem& jobSystem, Task<T> task)
+{
+	[](JobSystem& jobs, Task<T> spawned) -> TaskDetail::DetachedTask
+	{
+		co_await SwitchTo(jobs);
+		co_await std::move(spawned);
+	}(jobSystem, std::move(task));
+}
+
+// co_await ReadFileAsync(...) reads the whole file through AsyncFileIO, so no thread's blocked on it, then carries on
+// from a job once it's in. Only opening it happens on the awaiting thread. Empty if the file couldn't be read, in which
+// case it carries straight on.
+class FileReadAwaiter
+{
+public:
+	FileReadAwaiter(std::filesystem::path path, AsyncFileIO& asyncIO, JobSystem& jobSystem)
+		: m_Path(std::move(path)), m_AsyncIO(&asyncIO), m_JobSystem(&jobSystem) {}
+
+	bool                           await_ready() const noexcept { return false; }
+	bool                           await_suspend(std::coroutine_handle<> handle);
+	std::optional<std::vector<u8>> await_resume() { return std::move(m_Data); }
+
+protected:
+	std::filesystem::path          m_Path;
+	AsyncFileIO*                   m_AsyncIO   = nullptr;
+	JobSystem*                     m_JobSystem = nullptr;
+	AsyncFile                      m_File;
+	std::vector<u8>                m_Buffer    = {};
+	std::optional<std::vector<u8>> m_Data      = std::nullopt;
+};
+
+NODISCARD inline FileReadAwaiter ReadFileAsync(std::filesystem::path path, AsyncFileIO& asyncIO, JobSystem& jobSystem)
+{
+	return {std::move(path), asyncIO, jobSystem};
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+
+// A Chase-Lev deque: the owning thread pushes and pops at the bottom, like a stack, while any other thread can steal
+// from the top. Only the last item needs a CAS between owner and thieves, so the owner's path is nearly free.
+// The orderings follow Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models" (2013).
+// Items have to be trivially copyable (pointers, really), since a thief may read a slot it then fails to claim.
+template <typename T>
+class WorkStealingDeque
+{
+	static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque items have to be trivially copyable");
+
+public:
+	// The capacity's rounded up to a power of two, and doubles whenever the owner fills it.
+	explicit WorkStealingDeque(u32 capacity = 256)
+	{
+		s64 size = 1;
+		while (size < static_cast<s64>(capacity))
+			size <<= 1;
+		m_Buffer.store(new Buffer(size), std::memory_order_relaxed);
+	}
+
+	~WorkStealingDeque()
+	{
+		delete m_Buffer.load(std::memory_order_relaxed);
+		for (Buffer* buffer : m_Retired)
+			delete buffer;
+	}
+
+	WorkStealingDeque(const WorkStealingDeque& other)                = delete;
+	WorkStealingDeque(WorkStealingDeque&& other) noexcept            = delete;
+	WorkStealingDeque& operator=(const WorkStealingDeque& other)     = delete;
+	WorkStealingDeque& operator=(WorkStealingDeque&& other) noexcept = delete;
+
+	// Owner only.
+	void Push(T item)
+	{
+		const s64 bottom = m_Bottom.load(std::memory_order_relaxed);
+		const s64 top    = m_Top.load(std::memory_order_acquire);
+		Buffer*   buffer = m_Buffer.load(std::memory_order_relaxed);
+		if (bottom - top > buffer->Capacity - 1)
+			buffer = Grow(buffer, top, bottom);
+
+		// A release store rather than the paper's fence and relaxed store: the same thing to the hardware, but
+		// sanitisers can follow it.
+		buffer->Put(bottom, item);
+		m_Bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	// Owner only. Takes the most recently pushed item, which is the one most likely to still be in cache.
+	std::optional<T> Pop()
+	{
+		const s64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		Buffer*   buffer = m_Buffer.load(std::memory_order_relaxed);
+		m_Bottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		s64 top = m_Top.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{
+			// Empty.
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return std::nullopt;
+		}
+
+		T item = buffer->Get(bottom);
+		if (top == bottom)
+		{
+			// The last item, so we're racing the thieves for it.
+			const bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+			                                               std::memory_order_relaxed);
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			if (!won)
+				return std::nullopt;
+		}
+		return item;
+	}
+
+	// Any thread. Takes the oldest item. Can fail spuriously when racing another thief or the owner.
+	std::optional<T> Steal()
+	{
+		s64 top = m_Top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const s64 bottom = m_Bottom.load(std::memory_order_acquire);
+		if (top >= bottom)
+			return std::nullopt;
+
+		// Acquire rather than consume, which compilers promote anyway.
+		Buffer* buffer = m_Buffer.load(std::memory_order_acquire);
+		T       item   = buffer->Get(top);
+		if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return std::nullopt;
+		return item;
+	}
+
+	// Only a hint, as it's stale the moment it returns.
+	NODISCARD FORCEINLINE bool IsEmpty() const
+	{
+		return m_Top.load(std::memory_order_relaxed) >= m_Bottom.load(std::memory_order_relaxed);
+	}
+
+protected:
+	struct Buffer
+	{
+		explicit Buffer(s64 capacity) : Capacity(capacity), Items(new std::atomic<T>[capacity]) {}
+		~Buffer() { delete[] Items; }
+
+		// The slots are atomic only so a thief's read racing the owner's write isn't a data race; relaxed is enough,
+		// as the fences around the indices do the ordering.
+		FORCEINLINE void Put(s64 index, T item) { Items[index & (Capacity - 1)].store(item, std::memory_order_relaxed); }
+		FORCEINLINE T    Get(s64 index) const { return Items[index & (Capacity - 1)].load(std::memory_order_relaxed); }
+
+		s64             Capacity;
+		std::atomic<T>* Items;
+	};
+
+	Buffer* Grow(Buffer* buffer, s64 top, s64 bottom)
+	{
+		auto* grown = new Buffer(buffer->Capacity * 2);
+		for (s64 i = top; i < bottom; i++)
+			grown->Put(i, buffer->Get(i));
+
+		// A thief may still be reading from the old buffer, so it's kept around until we're destroyed. Growth
+		// doubles, so that's never more than the final size again.
+		m_Retired.push_back(buffer);
+		m_Buffer.store(grown, std::memory_order_release);
+		return grown;
+	}
+
+	// On their own cache lines, so the owner's bottom updates don't keep knocking the thieves' top out of cache.
+	alignas(64) std::atomic<s64> m_Top    = 0;
+	alignas(64) std::atomic<s64> m_Bottom = 0;
+	alignas(64) std::atomic<Buffer*> m_Buffer = nullptr;
+	std::vector<Buffer*> m_Retired = {}; // Owner only.
+};
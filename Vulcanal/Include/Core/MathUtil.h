@@ -57,6 +57,143 @@ using FRect = TRect<float>;
 using DRect = TRect<double>;
 using IRect = TRect<int>;
 
+struct AABB
+{
+	glm::vec3 Min = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 Max = glm::vec3(std::numeric_limits<float>::lowest());
+
+	AABB() = default;
+
+	AABB(const glm::vec3& min, const glm::vec3& max)
+		: Min(min), Max(max)
+	{
+	}
+
+	static AABB FromCenterExtents(const glm::vec3& center, const glm::vec3& extents)
+	{
+		return {center - extents, center + extents};
+	}
+
+	NODISCARD bool IsValid() const
+	{
+		return Min.x <= Max.x && Min.y <= Max.y && Min.z <= Max.z;
+	}
+
+	NODISCARD glm::vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+	NODISCARD glm::vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+	NODISCARD glm::vec3 GetSize() const { return Max - Min; }
+
+	NODISCARD float SurfaceArea() const
+	{
+		const glm::vec3 size = Max - Min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	void Expand(const glm::vec3& point)
+	{
+		Min = glm::min(Min, point);
+		Max = glm::max(Max, point);
+	}
+
+	void Expand(const AABB& other)
+	{
+		Min = glm::min(Min, other.Min);
+		Max = glm::max(Max, other.Max);
+	}
+
+	NODISCARD bool OverlapsWith(const AABB& other) const
+	{
+		return Min.x <= other.Max.x && Max.x >= other.Min.x
+			&& Min.y <= other.Max.y && Max.y >= other.Min.y
+			&& Min.z <= other.Max.z && Max.z >= other.Min.z;
+	}
+
+	NODISCARD bool ContainsPoint(const glm::vec3& point) const
+	{
+		return Min.x <= point.x && Max.x >= point.x
+			&& Min.y <= point.y && Max.y >= point.y
+			&& Min.z <= point.z && Max.z >= point.z;
+	}
+
+	// Transforms the box and returns the AABB around the result (Arvo's method), without touching all 8 corners.
+	NODISCARD AABB Transform(const glm::mat4& matrix) const
+	{
+		const glm::vec3 center   = GetCenter();
+		const glm::vec3 extents  = GetExtents();
+		const glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(matrix[0])), glm::abs(glm::vec3(matrix[1])),
+		                                     glm::abs(glm::vec3(matrix[2])));
+
+		const glm::vec3 newCenter  = glm::vec3(matrix * glm::vec4(center, 1.0f));
+		const glm::vec3 newExtents = absolute * extents;
+		return FromCenterExtents(newCenter, newExtents);
+	}
+};
+
+struct BoundingSphere
+{
+	glm::vec3 Center = glm::vec3(0.0f);
+	float     Radius = 0.0f;
+
+	static BoundingSphere FromAABB(const AABB& aabb)
+	{
+		return {aabb.GetCenter(), glm::length(aabb.GetExtents())};
+	}
+};
+
+// Six planes, stored as (normal, distance), with normals pointing into the frustum.
+struct Frustum
+{
+	enum PlaneIndex : u8 { Left = 0, Right, Bottom, Top, Near, Far, Count };
+
+	glm::vec4 Planes[Count] = {};
+
+	// Gribb/Hartmann plane extraction. Vulkan projections map depth to [0, 1], so that's the default;
+	// pass false for OpenGL-style [-1, 1] projections.
+	static Frustum FromViewProjection(const glm::mat4& viewProjection, bool depthZeroToOne = true)
+	{
+		const glm::vec4 row0 = glm::vec4(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+		const glm::vec4 row1 = glm::vec4(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		const glm::vec4 row2 = glm::vec4(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		const glm::vec4 row3 = glm::vec4(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+		Frustum frustum;
+		frustum.Planes[Left]   = row3 + row0;
+		frustum.Planes[Right]  = row3 - row0;
+		frustum.Planes[Bottom] = row3 + row1;
+		frustum.Planes[Top]    = row3 - row1;
+		frustum.Planes[Near]   = depthZeroToOne ? row2 : row3 + row2;
+		frustum.Planes[Far]    = row3 - row2;
+
+		for (glm::vec4& plane : frustum.Planes)
+			plane /= glm::length(glm::vec3(plane));
+
+		return frustum;
+	}
+
+	NODISCARD bool Intersects(const AABB& aabb) const
+	{
+		const glm::vec3 center  = aabb.GetCenter();
+		const glm::vec3 extents = aabb.GetExtents();
+		for (const glm::vec4& plane : Planes)
+		{
+			const glm::vec3 normal = glm::vec3(plane);
+			if (glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), extents))
+				return false;
+		}
+		return true;
+	}
+
+	NODISCARD bool Intersects(const BoundingSphere& sphere) const
+	{
+		for (const glm::vec4& plane : Planes)
+		{
+			if (glm::dot(glm::vec3(plane), sphere.Center) + plane.w < -sphere.Radius)
+				return false;
+		}
+		return true;
+	}
+};
+
 class MathUtil
 {
 public:
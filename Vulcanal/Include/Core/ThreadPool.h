@@ -0,0 +1,41 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// A simple shared worker pool, for work that blocks: file reads, mostly, and whatever can't start until they're done.
+// CPU-bound work goes on the JobSystem instead, which has a thread per core, so this one's kept small. Its threads
+// spend most of their time waiting on the disk rather than on a core, so the two don't fight over the CPU.
+// Tasks are pulled from a single locked queue, which is fine for how few (and how long) they are.
+class ThreadPool
+{
+public:
+	// A thread count of 0 means "enough to keep a few reads in flight": a quarter of the logical cores, 2-4.
+	explicit ThreadPool(u32 threadCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool& other)                = delete;
+	ThreadPool(ThreadPool&& other) noexcept            = delete;
+	ThreadPool& operator=(const ThreadPool& other)     = delete;
+	ThreadPool& operator=(ThreadPool&& other) noexcept = delete;
+
+	void Submit(std::function<void()>&& task);
+
+	// Blocks until the queue is empty and no task is running.
+	void WaitIdle();
+
+	NODISCARD FORCEINLINE u32 GetWorkerCount() const { return static_cast<u32>(m_Workers.size()); }
+
+protected:
+	void WorkerLoop();
+
+	std::vector<std::thread>          m_Workers     = {};
+	std::deque<std::function<void()>> m_Tasks       = {};
+	std::mutex                        m_Mutex       = {};
+	std::condition_variable           m_TaskAdded   = {};
+	std::condition_variable           m_Idle        = {};
+	u32                               m_ActiveTasks = 0;
+	bool                              m_Stopping    = false;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+struct AllocatedBuffer
+{
+	VkBuffer          Buffer     = VK_NULL_HANDLE;
+	VmaAllocation     Allocation = VK_NULL_HANDLE;
+	VmaAllocationInfo Info       = {};
+
+	void Reset()
+	{
+		Buffer     = VK_NULL_HANDLE;
+		Allocation = VK_NULL_HANDLE;
+		Info       = {};
+	}
+};
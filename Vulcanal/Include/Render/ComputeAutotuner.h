@@ -0,0 +1,78 @@
+#pragma once
+
+#include <limits>
+#include <map>
+#include <optional>
+
+#include "Render/ComputeDispatch.h"
+
+class Renderer;
+
+// A compute kernel the autotuner can time. Only the owner knows what the kernel binds, so it creates and records the
+// variants itself.
+struct TunableKernel
+{
+	std::string   Name;     // The cache key, so it has to be stable between runs. No spaces.
+	VkExtent3D    Extent   = {1, 1, 1}; // What a typical dispatch covers.
+	WorkgroupSize Fallback = {};        // Always one of the candidates.
+
+	std::function<VkPipeline(const WorkgroupSize& size)> CreatePipeline;
+	// Binds everything and dispatches once. It's recorded many times back to back, so if consecutive dispatches would
+	// race in real use, put the barrier in here too.
+	std::function<void(VkCommandBuffer cmd, VkPipeline pipeline, const WorkgroupSize& size)> Record;
+	// Optional. Recorded once before each timing run, to get resources into the right layout.
+	std::function<void(VkCommandBuffer cmd)> Prepare;
+};
+
+struct TuningResult
+{
+	WorkgroupSize Size;
+	f32           Time      = 0.0f; // Milliseconds per dispatch; only known if we tuned this run.
+	bool          FromCache = false;
+};
+
+// Picks the fastest workgroup shape for a kernel on this device, by timing a handful of candidates (8x8, 16x16, 32x8,
+// 64x1 and the like) with timestamp queries over many back-to-back dispatches. Winners are saved to a file in the pref
+// path, keyed by device UUID and driver version, so tuning only happens the first time a kernel runs on a given setup.
+class ComputeAutotuner
+{
+public:
+	static constexpr u32 Iterations       = 64;
+	static constexpr u32 WarmupIterations = 8;
+	static constexpr u32 Repetitions      = 3; // We keep the fastest run, which is the one least disturbed by anything else.
+
+	void Init(Renderer* renderer, std::filesystem::path cachePath);
+	void Shutdown();
+
+	// The cached winner for this device, if there is one.
+	NODISCARD std::optional<WorkgroupSize> Find(const std::string& name);
+	// Times the kernel now, blocking on the GPU, and caches the winner. Without timestamps, returns the fallback.
+	WorkgroupSize Tune(const TunableKernel& kernel);
+	// Forgets every result for this device, so kernels are tuned again on the next run.
+	void ClearCache();
+
+	NODISCARD FORCEINLINE bool IsEnabled() const { return m_Enabled; }
+	NODISCARD FORCEINLINE bool CanTune() const { return m_Enabled && m_QueryPool; }
+	void                       SetEnabled(bool enabled) { m_Enabled = enabled; }
+
+	void OnDrawIMGui();
+
+protected:
+	NODISCARD std::vector<WorkgroupSize> GetCandidates(const TunableKernel& kernel) const;
+	NODISCARD f64                        TimeVariant(const TunableKernel& kernel, VkPipeline pipeline,
+	                                                 const WorkgroupSize& size) const;
+	NODISCARD std::string                GetCacheKey(const std::string& name) const { return m_DeviceKey + ' ' + name; }
+
+	void LoadCache();
+	void SaveCache() const;
+
+	Renderer*             m_Renderer  = nullptr;
+	std::filesystem::path m_CachePath = {};
+	std::string           m_DeviceKey = {}; // Device UUID and driver version.
+	VkQueryPool           m_QueryPool = nullptr;
+	bool                  m_Enabled   = true;
+
+	// Every device's results, so other devices' survive us rewriting the file.
+	std::unordered_map<std::string, WorkgroupSize> m_Cache;
+	std::map<std::string, TuningResult>            m_Results; // This device's, this run.
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+// Workgroup sizes are specialisation constants 0, 1 and 2 in every compute shader, so they can be picked at pipeline
+// creation rather than baked into the SPIR-V:
+//     layout (local_size_x_id = 0, local_size_y_id = 1, local_size_z_id = 2) in;
+// Shaders should still bounds check, since group counts round up.
+constexpr u32 WorkgroupSizeXConstantID = 0;
+constexpr u32 WorkgroupSizeYConstantID = 1;
+constexpr u32 WorkgroupSizeZConstantID = 2;
+
+struct WorkgroupSize
+{
+	u32 X = 1, Y = 1, Z = 1;
+
+	NODISCARD FORCEINLINE u32 GetInvocations() const { return X * Y * Z; }
+
+	bool operator==(const WorkgroupSize& other) const = default;
+};
+
+struct SubgroupInfo
+{
+	u32                    Size                = 32;
+	u32                    MinSize             = 32, MaxSize = 32; // Only differ on devices that can vary it (Intel, AMD).
+	VkShaderStageFlags     SupportedStages     = 0;
+	VkSubgroupFeatureFlags SupportedOperations = 0;
+
+	u32                MaxWorkgroupInvocations = 128;
+	std::array<u32, 3> MaxWorkgroupSize        = {128, 128, 64};
+	std::array<u32, 3> MaxWorkgroupCount       = {65535, 65535, 65535};
+
+	NODISCARD FORCEINLINE bool Supports(VkSubgroupFeatureFlags operations) const
+	{
+		return (SupportedOperations & operations) == operations && (SupportedStages & VK_SHADER_STAGE_COMPUTE_BIT);
+	}
+};
+
+NODISCARD SubgroupInfo QuerySubgroupInfo(VkPhysicalDevice gpu);
+
+// A sensible default for kernels that touch each pixel (or element) once: a few subgroups' worth of invocations, so
+// there's enough in flight to hide memory latency without hogging registers, in as square a tile as possible for 2D.
+NODISCARD WorkgroupSize PickWorkgroupSize2D(const SubgroupInfo& subgroups);
+NODISCARD WorkgroupSize PickWorkgroupSize1D(const SubgroupInfo& subgroups);
+
+NODISCARD FORCEINLINE u32 DivideRoundUp(u32 value, u32 divisor)
+{
+	return (value + divisor - 1) / divisor;
+}
+
+// How many groups it takes to cover every element.
+NODISCARD FORCEINLINE VkExtent3D GetGroupCount(VkExtent3D extent, const WorkgroupSize& size)
+{
+	return {DivideRoundUp(extent.width, size.X), DivideRoundUp(extent.height, size.Y), DivideRoundUp(extent.depth, size.Z)};
+}
+
+void Dispatch(VkCommandBuffer cmd, VkExtent3D extent, const WorkgroupSize& size);
+void Dispatch(VkCommandBuffer cmd, VkExtent2D extent, const WorkgroupSize& size);
+void Dispatch(VkCommandBuffer cmd, u32 count, const WorkgroupSize& size);
@@ -0,0 +1,65 @@
+#pragma once
+
+class JobSystem;
+
+enum class CullingPath : u8
+{
+	Auto,
+	Scalar,
+	SSE,
+	AVX2,
+};
+
+struct CullingStats
+{
+	u32         Tested       = 0;
+	u32         Visible      = 0;
+	f64         Milliseconds = 0;
+	CullingPath PathUsed     = CullingPath::Scalar;
+};
+
+// CPU frustum culling over world-space bounds.
+// Bounds are stored as structure-of-arrays (centre, extents and sphere radius in separate streams), so the SIMD paths
+// can test 4 (SSE) or 8 (AVX2) objects against a plane with a handful of instructions. An object is culled if either
+// its sphere or its box is fully behind any of the six planes.
+// The streams are always padded to a multiple of the widest SIMD lane count with objects that can never be visible,
+// so none of the paths need a scalar tail.
+class FrustumCuller
+{
+public:
+	// Objects per parallel chunk. Must be a multiple of the widest SIMD width.
+	static constexpr u32 ChunkSize = 8192;
+
+	u32  Add(const AABB& bounds);
+	u32  Add(const AABB& bounds, const BoundingSphere& sphere);
+	void Set(u32 index, const AABB& bounds);
+	void Set(u32 index, const AABB& bounds, const BoundingSphere& sphere);
+
+	// Removes an object by moving the last object into its slot. Returns the old index of the moved object (which is
+	// now at `index`), or `index` itself if it was the last object.
+	u32  RemoveSwap(u32 index);
+	void Reserve(u32 count);
+	void Clear();
+
+	// Tests every object against the frustum and writes the indices of the visible ones, in ascending order.
+	// If a job system is given, chunks of ChunkSize objects are culled in parallel.
+	CullingStats Cull(const Frustum& frustum, std::vector<u32>& outVisible, JobSystem* jobSystem = nullptr) const;
+
+	void SetPath(CullingPath path) { m_Path = path; }
+
+	NODISCARD FORCEINLINE u32         GetCount() const { return m_Count; }
+	NODISCARD FORCEINLINE CullingPath GetPath() const { return m_Path; }
+
+	NODISCARD static CullingPath GetBestSupportedPath();
+
+protected:
+	void Resize(u32 count);
+	void Write(u32 index, const glm::vec3& center, const glm::vec3& extents, float radius);
+
+	u32         m_Count = 0;
+	CullingPath m_Path  = CullingPath::Auto;
+
+	std::vector<f32> m_CenterX, m_CenterY, m_CenterZ;
+	std::vector<f32> m_ExtentX, m_ExtentY, m_ExtentZ;
+	std::vector<f32> m_Radius;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Render/Image.h"
+
+class Renderer;
+struct ResidencyStats;
+
+// An image the defragmenter is allowed to move.
+struct MovableImage
+{
+	// Updated in place (new image and view, same allocation handle) once moved. Must be a single-layer colour image,
+	// left in SHADER_READ_ONLY_OPTIMAL between frames.
+	AllocatedImage*   Image = nullptr;
+	VkImageUsageFlags Usage = 0; // What it was created with, so the replacement matches.
+
+	std::function<bool()> CanMove; // Optional. Return false while something else is using the image outside of frames.
+	std::function<void()> OnMoved; // Optional. Called once the new image is in place; refresh descriptors here.
+};
+
+struct FragmentationStats
+{
+	u64 BlockBytes       = 0; // Device memory VMA holds, across device local heaps.
+	u64 AllocationBytes  = 0; // How much of that is actually in use.
+	u64 LargestFreeRange = 0;
+	u32 BlockCount       = 0;
+
+	// How much of the free space is unusable for an allocation as big as all of it, from 0 to 1.
+	NODISCARD FORCEINLINE f32 GetFragmentation() const
+	{
+		const u64 freeBytes = BlockBytes - AllocationBytes;
+		return freeBytes ? 1.0f - static_cast<f32>(LargestFreeRange) / static_cast<f32>(freeBytes) : 0.0f;
+	}
+};
+
+struct DefragmentationRun
+{
+	FragmentationStats Before;
+	FragmentationStats After;
+	u64                BytesMoved       = 0;
+	u64                BytesFreed       = 0;
+	u32                AllocationsMoved = 0;
+	u32                BlocksFreed      = 0;
+	u64                StartFrame       = 0, EndFrame = 0;
+};
+
+struct DefragmenterSettings
+{
+	bool Auto          = true;
+	f32  AutoThreshold = 0.3f;
+	u64  BytesPerPass  = 16ull * 1024 * 1024; // Takes effect from the next run.
+	bool DefragmentNow = false;               // One-shot; cleared once it's been handed over.
+};
+
+struct DefragmenterStats
+{
+	FragmentationStats Now;
+	bool               Running       = false;
+	u64                RunStartFrame = 0;
+	bool               HasRun        = false;
+	DefragmentationRun LastRun;
+};
+
+// Compacts VMA's default pools a little at a time, using VMA's incremental defragmentation.
+// Only one pass is ever in flight. Each pass moves at most BytesPerPass, and goes through three stages:
+//  1. Copying: we create replacement images in the new allocations, and record copies into the frame's command buffer.
+//     Owners keep using their old images.
+//  2. Once the copy has retired, owners are switched over to the new images, and told to refresh their descriptors.
+//  3. Once no frame in flight can be using the old images, we destroy them and end the pass, which frees their memory.
+// So the only extra memory we ever hold is one pass' worth of copies, and nothing ever waits on the GPU.
+// Allocations nobody registered (render targets, buffers) are left where they are.
+class Defragmenter
+{
+public:
+	static constexpr u32 DefaultMovesPerPass    = 64;
+	static constexpr u64 DefaultAutoCheckFrames = 240;
+
+	void Init(Renderer* renderer);
+	void Shutdown();
+
+	void Register(const MovableImage& image);
+	// Returns true if the allocation was mid-move, in which case the defragmenter takes ownership and frees the image
+	// itself once the pass ends. Otherwise, the caller destroys it as normal.
+	bool Unregister(const AllocatedImage& image);
+
+	// Starts defragmenting, if we aren't already.
+	void Begin();
+	// Advances the current pass. Called once a frame, while recording the frame's command buffer.
+	void Update(VkCommandBuffer cmd);
+
+	NODISCARD FORCEINLINE bool IsRunning() const { return m_Context != nullptr; }
+	NODISCARD bool             IsMoving(const AllocatedImage& image) const;
+	NODISCARD FragmentationStats CalculateStats() const;
+
+	// Starts a run straight away if the settings ask for one.
+	void ApplySettings(const DefragmenterSettings& settings);
+
+	NODISCARD DefragmenterSettings GetSettings() const;
+	NODISCARD DefragmenterStats    GetStats() const;
+
+	static void OnDrawIMGui(DefragmenterSettings& settings, const DefragmenterStats& stats,
+	                        const ResidencyStats& residency);
+
+protected:
+	enum class PassStage : u8
+	{
+		None,
+		Copying,
+		Retiring,
+	};
+
+	struct Move
+	{
+		VmaAllocation  Allocation = nullptr;
+		AllocatedImage OldImage   = {};
+		AllocatedImage NewImage   = {};
+		bool           Orphaned   = false; // Unregistered mid-move; we own both images now.
+	};
+
+	void BeginPass(VkCommandBuffer cmd);
+	void SwapPass();
+	void EndPass();
+	void FinishDefragmentation();
+	void DestroyImageObjects(AllocatedImage& image) const; // Leaves the allocation alone; VMA owns that mid-pass.
+
+	Renderer* m_Renderer = nullptr;
+
+	std::unordered_map<VmaAllocation, MovableImage> m_Movables;
+
+	VmaDefragmentationContext      m_Context    = nullptr;
+	VmaDefragmentationPassMoveInfo m_PassInfo   = {};
+	PassStage                      m_PassStage  = PassStage::None;
+	u64                            m_StageFrame = 0; // The frame at which the current stage can move on.
+	std::vector<Move>              m_Moves;          // Lines up with m_PassInfo.pMoves.
+
+	DefragmentationRun m_CurrentRun;
+	DefragmentationRun m_LastRun;
+	bool               m_HasRun = false;
+
+	u64  m_BytesPerPass  = DefragmenterSettings{}.BytesPerPass;
+	u32  m_MovesPerPass  = DefaultMovesPerPass;
+	bool m_Auto          = DefragmenterSettings{}.Auto;
+	f32  m_AutoThreshold = DefragmenterSettings{}.AutoThreshold;
+	u64  m_NextAutoCheck = 0;
+};
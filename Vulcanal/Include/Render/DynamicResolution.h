@@ -0,0 +1,64 @@
+#pragma once
+
+// What the UI can change. Handed to the renderer with each frame, rather than poked into it from the main thread.
+struct DynamicResolutionSettings
+{
+	bool Enabled         = true;
+	f32  TargetFrameTime = 1000.0f / 60.0f; // In milliseconds.
+	f32  MinScale        = 0.5f;
+	f32  MaxScale        = 1.0f;
+};
+
+// What the UI shows, copied out at the end of each frame.
+struct DynamicResolutionStats
+{
+	f32        LastGPUTime     = 0.0f;
+	f32        SmoothedGPUTime = 0.0f;
+	f32        Scale           = 1.0f;
+	VkExtent2D DrawExtent      = {};
+};
+
+// Picks the fraction of the draw image we render into each frame, from how long the GPU's been taking.
+// GPU cost mostly scales with pixel count, so the scale that would hit the target is roughly the current one times
+// sqrt(target / time). We drop towards that quickly, so a spike only costs a frame or two, and climb back slowly, so a
+// one-off cheap frame doesn't send us straight back over budget. Nothing's reallocated: the draw image is allocated at
+// the maximum scale, and we just render into (and resolve from) the top left of it.
+class DynamicResolution
+{
+public:
+	// Feeds in the GPU time of a finished frame, in milliseconds.
+	void Update(f32 gpuTime);
+
+	// The extent to render into, for a draw image allocated with GetMaxExtent().
+	NODISCARD VkExtent2D GetDrawExtent(VkExtent2D maxExtent) const;
+	// The size to allocate the draw image at, for a given output size.
+	NODISCARD VkExtent2D GetMaxExtent(VkExtent2D outputExtent) const;
+
+	// Clamps the scale range, and the current scale to it.
+	void ApplySettings(const DynamicResolutionSettings& settings);
+	void SetEnabled(bool enabled) { m_Settings.Enabled = enabled; }
+
+	NODISCARD FORCEINLINE bool IsEnabled() const { return m_Settings.Enabled; }
+	NODISCARD FORCEINLINE f32  GetScale() const { return m_Settings.Enabled ? m_Scale : m_Settings.MaxScale; }
+	NODISCARD FORCEINLINE f32  GetGPUTime() const { return m_SmoothedGPUTime; }
+
+	NODISCARD FORCEINLINE const DynamicResolutionSettings& GetSettings() const { return m_Settings; }
+	NODISCARD DynamicResolutionStats                       GetStats(VkExtent2D drawExtent) const;
+
+	static void OnDrawIMGui(DynamicResolutionSettings& settings, const DynamicResolutionStats& stats);
+
+protected:
+	// Aim a little under the target, so ordinary frame-to-frame noise doesn't push us over.
+	static constexpr f32 TargetHeadroom = 0.9f;
+	static constexpr f32 Smoothing      = 0.1f;
+	static constexpr f32 MaxStepDown    = 0.1f;
+	static constexpr f32 MaxStepUp      = 0.02f;
+	static constexpr f32 Deadband       = 0.01f;
+
+	DynamicResolutionSettings m_Settings;
+	f32                       m_Scale = DynamicResolutionSettings{}.MaxScale;
+
+	f32  m_SmoothedGPUTime = 0.0f;
+	f32  m_LastGPUTime     = 0.0f;
+	bool m_HasSample       = false;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Render/RendererSettings.h"
+
+// What the renderer needs from the main thread's frame, copied out so the main thread can get on with building the next
+// one while this one's recorded. Only used when rendering's pipelined; otherwise the renderer reads ImGui and takes the
+// settings directly.
+class FramePacket
+{
+public:
+	FramePacket() = default;
+	~FramePacket();
+
+	FramePacket(const FramePacket& other)                = delete;
+	FramePacket(FramePacket&& other) noexcept            = delete;
+	FramePacket& operator=(const FramePacket& other)     = delete;
+	FramePacket& operator=(FramePacket&& other) noexcept = delete;
+
+	// Deep-copies the main viewport's draw data (after ImGui::Render()), plus the input that goes into the UI cache
+	// hash. The textures it references aren't copied, so they have to outlive the packet.
+	void Capture();
+
+	RendererSettings Settings;
+
+#ifndef VULC_NO_IMGUI
+	NODISCARD FORCEINLINE const ImDrawData* GetDrawData() const { return m_DrawData.Valid ? &m_DrawData : nullptr; }
+	NODISCARD FORCEINLINE ImDrawData*       GetDrawData() { return m_DrawData.Valid ? &m_DrawData : nullptr; }
+
+	ImVec2                          MousePos   = {};
+	decltype(ImGuiIO::MouseDown)    MouseDown  = {};
+	f32                             MouseWheel = 0.0f;
+#endif
+
+protected:
+	void Release();
+
+#ifndef VULC_NO_IMGUI
+	ImDrawData m_DrawData = {};
+#endif
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <coroutine>
+#include <mutex>
+
+class JobSystem;
+class GPUAwaitPoller;
+
+// co_await-able: suspends until a fence is signalled, or a timeline semaphore reaches a value. Doesn't suspend at all
+// if it's already there. Otherwise the poller resumes it on the job system, within a frame of the GPU getting there.
+class GPUAwaiter
+{
+public:
+	GPUAwaiter(GPUAwaitPoller& poller, VkFence fence) : m_Poller(&poller), m_Fence(fence) {}
+	GPUAwaiter(GPUAwaitPoller& poller, VkSemaphore timeline, u64 value)
+		: m_Poller(&poller), m_Timeline(timeline), m_Value(value) {}
+
+	bool await_ready() const;
+	void await_suspend(std::coroutine_handle<> handle) const;
+	void await_resume() const noexcept {}
+
+protected:
+	GPUAwaitPoller* m_Poller   = nullptr;
+	VkFence         m_Fence    = nullptr;
+	VkSemaphore     m_Timeline = nullptr;
+	u64             m_Value    = 0;
+};
+
+// Keeps track of coroutines waiting on the GPU, and resumes them once their work's retired. Polled once a frame rather
+// than waited on, so nothing ever blocks on the GPU for them.
+class GPUAwaitPoller
+{
+public:
+	// Without a job system, waiters are resumed inline, from Poll().
+	void Init(VkDevice device, JobSystem* jobSystem);
+	// Anything still waiting is abandoned (with a warning), since whatever it'd resume into is being torn down.
+	void Shutdown();
+
+	NODISCARD GPUAwaiter WaitForFence(VkFence fence) { return {*this, fence}; }
+	NODISCARD GPUAwaiter WaitForTimeline(VkSemaphore timeline, u64 value) { return {*this, timeline, value}; }
+
+	// Resumes everything whose fence or timeline value has been reached. The renderer calls this once a frame.
+	void Poll();
+
+	NODISCARD u32 GetWaiterCount() const;
+
+protected:
+	friend class GPUAwaiter;
+
+	struct Waiter
+	{
+		std::coroutine_handle<> Handle   = nullptr;
+		VkFence                 Fence    = nullptr;
+		VkSemaphore             Timeline = nullptr;
+		u64                     Value    = 0;
+	};
+
+	NODISCARD bool IsRetired(VkFence fence, VkSemaphore timeline, u64 value) const;
+	void           Add(const Waiter& waiter);
+
+	VkDevice            m_Device    = nullptr;
+	JobSystem*          m_JobSystem = nullptr;
+	mutable std::mutex  m_Mutex     = {};
+	std::vector<Waiter> m_Waiters   = {};
+};
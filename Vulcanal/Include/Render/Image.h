@@ -7,6 +7,7 @@ struct AllocatedImage
 	VmaAllocation Allocation;
 	VkExtent3D    Extent;
 	VkFormat      Format;
+	u32           MipLevels;
 
 	void Reset()
 	{
@@ -15,5 +16,6 @@ struct AllocatedImage
 		Allocation = VK_NULL_HANDLE;
 		Extent     = {0, 0, 0};
 		Format     = VK_FORMAT_B8G8R8A8_SRGB;
+		MipLevels  = 1;
 	}
 };
@@ -0,0 +1,38 @@
+#pragma once
+
+// Just enough of the KTX2 container to stream pre-compressed textures: we read the header and level index, and then
+// pull individual mip levels straight out of the file on demand. No supercompression (Basis/zstd/zlib) support yet,
+// so textures need exporting with a plain Vulkan block format and supercompression off.
+struct KTX2Level
+{
+	u64 Offset = 0;
+	u64 Size   = 0;
+};
+
+struct KTX2File
+{
+	std::filesystem::path  Path;
+	VkFormat               Format = VK_FORMAT_UNDEFINED;
+	u32                    Width  = 0, Height = 0;
+	std::vector<KTX2Level> Levels; // Level 0 is the largest.
+
+	NODISCARD FORCEINLINE u32        GetMipLevels() const { return static_cast<u32>(Levels.size()); }
+	NODISCARD FORCEINLINE VkExtent3D GetMipExtent(u32 mip) const
+	{
+		return {std::max(Width >> mip, 1u), std::max(Height >> mip, 1u), 1};
+	}
+};
+
+enum class TextureCompressionFamily : u8
+{
+	None,
+	BC,
+	ETC2,
+	ASTC,
+};
+
+// Reads the header and level index. On failure, returns false and sets outError.
+bool LoadKTX2Header(const std::filesystem::path& path, KTX2File& outFile, std::string& outError);
+
+NODISCARD TextureCompressionFamily GetTextureCompressionFamily(VkFormat format);
+NODISCARD const char*              TextureCompressionFamilyToString(TextureCompressionFamily family);
@@ -0,0 +1,67 @@
+#pragma once
+
+// Builds up a hash of everything a pass's output depends on: pipeline, push constants, bound resources, extent.
+// Add fields one at a time rather than whole structs, since padding bytes aren't guaranteed to be stable.
+class PassInputHash
+{
+public:
+	template <typename T> requires std::is_trivially_copyable_v<T>
+	PassInputHash& Add(const T& value) { return AddBytes(&value, sizeof(T)); }
+	PassInputHash& Add(VkExtent2D extent) { return Add(extent.width).Add(extent.height); }
+	PassInputHash& AddBytes(const void* data, size_t size);
+
+	NODISCARD FORCEINLINE u64 Get() const { return m_Hash; }
+
+protected:
+	u64 m_Hash = 14695981039346656037ull; // FNV-1a.
+};
+
+using CachedPassID = u32;
+
+struct PassCacheSettings
+{
+	bool Enabled = true;
+};
+
+struct PassCacheStats
+{
+	std::string Name;
+	u64         Executed = 0, Skipped = 0;
+};
+
+// Lets passes with static or rarely-changing output skip their work. Each frame, a pass hands over the hash of its
+// inputs; if they're the same as the last time it ran, and its output's still intact, there's nothing to redo.
+// Whether the output's intact is up to the caller: it has to be in memory nobody else writes (a persistent transient
+// image, say), and nothing else can have drawn over it since.
+class PassCache
+{
+public:
+	NODISCARD CachedPassID Register(std::string name);
+
+	// True if the pass needs to run this frame. Assumes it will, if so.
+	NODISCARD bool ShouldExecute(CachedPassID pass, u64 inputHash, bool outputRetained);
+	// Forces the pass to run next time, e.g. after something else has written to its output.
+	void Invalidate(CachedPassID pass);
+	void InvalidateAll();
+
+	// Turning it off invalidates everything, so nothing's skipped on stale inputs when it's back on.
+	void ApplySettings(const PassCacheSettings& settings);
+
+	NODISCARD FORCEINLINE bool              IsEnabled() const { return m_Enabled; }
+	NODISCARD FORCEINLINE PassCacheSettings GetSettings() const { return {.Enabled = m_Enabled}; }
+	NODISCARD std::vector<PassCacheStats>   GetStats() const;
+
+	static void OnDrawIMGui(PassCacheSettings& settings, std::span<const PassCacheStats> stats);
+
+protected:
+	struct CachedPass
+	{
+		std::string Name;
+		u64         InputHash = 0;
+		bool        Valid     = false;
+		u64         Executed  = 0, Skipped = 0;
+	};
+
+	std::vector<CachedPass> m_Passes;
+	bool                    m_Enabled = true;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// A VkPipelineCache that persists between runs, so pipelines the driver has compiled before come back almost free.
+// The file starts with the standard Vulkan cache header, which we check against the device ourselves rather than
+// trusting every driver to reject someone else's data gracefully.
+class PipelineCache
+{
+public:
+	void Init(VkDevice device, VkPhysicalDevice gpu, std::filesystem::path path);
+	// Saves, then destroys the cache. Every pipeline created with it must be done compiling.
+	void Shutdown();
+
+	void Save() const;
+
+	NODISCARD FORCEINLINE VkPipelineCache Get() const { return m_Cache; }
+
+protected:
+	NODISCARD bool IsCompatible(const std::vector<u8>& data) const;
+
+	VkDevice              m_Device = nullptr;
+	VkPhysicalDevice      m_GPU    = nullptr;
+	VkPipelineCache       m_Cache  = nullptr;
+	std::filesystem::path m_Path   = {};
+};
@@ -1,3 +1,21 @@
 #pragma once
 
+#include "Render/ComputeDispatch.h"
+
+// One specialisation constant's value. Everything's 32 bits in SPIR-V, and bools are VkBool32, so u32 covers it.
+struct SpecializationValue
+{
+	u32 ID    = 0;
+	u32 Value = 0;
+
+	bool operator==(const SpecializationValue& other) const = default;
+};
+
 bool LoadShaderModule(std::string_view path, VkDevice device, VkShaderModule* outShaderModule);
+
+// Creates a compute pipeline with its workgroup size set through specialisation constants (see ComputeDispatch.h),
+// along with any other constants the shader declares.
+NODISCARD VkPipeline CreateComputePipeline(VkDevice device, VkPipelineLayout layout, VkShaderModule shader,
+                                           const WorkgroupSize& workgroupSize,
+                                           std::span<const SpecializationValue> constants = {},
+                                           VkPipelineCache cache = nullptr);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <optional>
+
+#include "Core/Concurrency/SPSCQueue.h"
+#include "Core/Concurrency/Event.h"
+
+// Owns the swapchain's acquire and present calls, so neither blocks the thread that records frames. With FIFO, either
+// can block for most of a vsync; here, that's only ever this thread's time.
+// It keeps up to MaxAhead images acquired ahead of the renderer, and presents whatever the renderer queues, in order.
+// The renderer only waits if it wants an image and none is ready, which means every image the swapchain will give us
+// is genuinely in use.
+// Everything goes back and forth through SPSC queues, with an event for each side to sleep on, so a frame's handoffs
+// never take a lock. The renderer's side (everything but Start() and Stop()) is for one thread at a time.
+class PresentThread
+{
+public:
+	static constexpr u32 MaxAhead = 2;
+
+	struct AcquiredImage
+	{
+		u32         ImageIndex = 0;
+		VkSemaphore Semaphore  = nullptr; // Signalled once the image is ready to be written. Hand back with Recycle().
+	};
+
+	PresentThread() = default;
+	~PresentThread();
+
+	PresentThread(const PresentThread& other)                = delete;
+	PresentThread(PresentThread&& other) noexcept            = delete;
+	PresentThread& operator=(const PresentThread& other)     = delete;
+	PresentThread& operator=(PresentThread&& other) noexcept = delete;
+
+	// maxAcquired is how many images the swapchain lets us hold at once: its image count, less its minimum, plus one.
+	// The renderer keeps an acquire semaphore per frame in flight until the frame retires, so we need that many spare.
+	// Presents lock the queue mutex, as the queue's shared with the renderer.
+	void Start(VkDevice device, VkQueue queue, std::mutex* queueMutex, VkSwapchainKHR swapchain, u32 maxAcquired,
+	           u32 framesInFlight);
+	// Finishes any queued presents, then waits for the device to go idle so the semaphores can be destroyed. Images
+	// acquired but never presented are simply dropped, which is fine as long as the swapchain's going too.
+	void Stop();
+
+	// Blocks until an image's ready. Empty if the swapchain's out of date and there's nothing left to give.
+	NODISCARD std::optional<AcquiredImage> Acquire();
+	// Queues a present of an image from Acquire(), once the wait semaphore's signalled. A present ID of 0 means none.
+	// Returns a ticket for WaitForPresent().
+	u64 Present(u32 imageIndex, VkSemaphore waitSemaphore, u64 presentID);
+	// Blocks until the present with the ticket's actually been handed to the queue. The wait semaphore can't be
+	// signalled again until then, so the renderer checks this before reusing it.
+	void WaitForPresent(u64 ticket);
+	// Hands an acquire semaphore back, once the submission that waited on it has finished.
+	void Recycle(VkSemaphore semaphore);
+
+	NODISCARD FORCEINLINE bool IsRunning() const { return m_Thread.joinable(); }
+	// Acquire or present said the swapchain no longer matches the surface. Cleared by restarting.
+	NODISCARD bool IsOutOfDate() const;
+
+protected:
+	struct QueuedPresent
+	{
+		u32         ImageIndex    = 0;
+		VkSemaphore WaitSemaphore = nullptr;
+		u64         PresentID     = 0;
+	};
+
+	void ThreadLoop();
+	// Ours only.
+	NODISCARD bool CanAcquire() const;
+
+	VkDevice       m_Device     = nullptr;
+	VkQueue        m_Queue      = nullptr;
+	std::mutex*    m_QueueMutex = nullptr;
+	VkSwapchainKHR m_Swapchain  = nullptr;
+	std::thread    m_Thread;
+
+	// From the renderer. Sized in Start(), to everything that could be in them at once.
+	Scope<SPSCQueue<QueuedPresent>> m_Presents;
+	Scope<SPSCQueue<VkSemaphore>>   m_Recycled;
+	Event                           m_WorkReady; // Something for us to do.
+	// To the renderer.
+	SPSCQueue<AcquiredImage>        m_Acquired{MaxAhead};
+	Event                           m_ImageReady; // Something for the renderer.
+
+	std::vector<VkSemaphore> m_FreeSemaphores = {}; // Ours, once we've started.
+	std::vector<VkSemaphore> m_AllSemaphores  = {};
+	u32                      m_Held           = 0; // Ours. Acquired but not yet presented, wherever they are.
+	u32                      m_MaxAcquired    = 1;
+	u64                      m_PresentsQueued = 0; // The renderer's.
+	std::atomic<u32>         m_Ahead          = 0; // Waiting in m_Acquired.
+	std::atomic<u64>         m_PresentsIssued = 0;
+	std::atomic<bool>        m_OutOfDate      = false;
+	std::atomic<bool>        m_Stopping       = false;
+};
@@ -1,7 +1,22 @@
 ﻿#pragma once
 
+#include "Buffer.h"
+#include "ComputeAutotuner.h"
+#include "ComputeDispatch.h"
+#include "Defragmenter.h"
 #include "Descriptors.h"
+#include "DynamicResolution.h"
+#include "FramePacket.h"
+#include "GPUAwaits.h"
 #include "Image.h"
+#include "PassCache.h"
+#include "PipelineCache.h"
+#include "PresentThread.h"
+#include "ResidencyManager.h"
+#include "ResolvePass.h"
+#include "ShaderPermutations.h"
+#include "TextureStreamer.h"
+#include "TransientImagePool.h"
 
 class Application;
 class Window;
@@ -11,18 +26,60 @@ struct RendererSpecification
 	bool         EnableValidationLayers = false;
 	Application* App                    = nullptr;
 	int          GPUIndexOverride       = -1;
-	bool         VSync = true;
+	// Falls back to FIFO if the surface doesn't support it.
+	VkPresentModeKHR PresentMode = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	// Waits for the last frame to be displayed before starting the next one, if the device has VK_KHR_present_wait.
+	bool LowLatency = false;
+	// Draws ImGui into a cached overlay that's only redrawn when the UI changes, and composited in the resolve.
+	// Ignored (ImGui's drawn straight onto the swapchain) if the resolve pass isn't available.
+	bool CacheImGui = false;
+	// Records independent passes into secondary command buffers across the job system.
+	bool ParallelRecording = true;
+	// Acquires and presents on a thread of their own, so neither blocks recording. Low latency mode's ignored with it,
+	// since that needs the swapchain too.
+	bool UsePresentThread = false;
 };
 
+// A command pool for one recording thread, so no two threads ever share one. Reset wholesale once its frame retires.
+struct WorkerCommandPool
+{
+	VkCommandPool                Pool             = nullptr;
+	std::vector<VkCommandBuffer> SecondaryBuffers = {}; // Allocated as needed, and reused every frame.
+	u32                          UsedBuffers      = 0;
+};
+
+// Records one pass's commands. May run on any thread, so anything it needs that isn't thread-safe (pipeline lookups,
+// pass cache decisions) should be worked out beforehand and captured.
+using PassRecorder = std::function<void(VkCommandBuffer cmd)>;
+
 struct FrameData
 {
 	VkCommandPool   CommandPool       = nullptr;
 	VkCommandBuffer MainCommandBuffer = nullptr;
 
+	// One per job system thread, indexed the same way, so each is only ever touched by the one thread. Plus one more on
+	// the end for whichever thread outside the job system is recording the frame (the render thread, when it's
+	// pipelined), which does its share of the passes inline.
+	std::vector<WorkerCommandPool> WorkerPools;
+
 	VkSemaphore SwapchainSemaphore = nullptr;
 	VkSemaphore RenderSemaphore    = nullptr;
 	VkFence     RenderFence        = nullptr;
 
+	// With the present thread, the acquire semaphore's its, and goes back to it once this frame's retired. The ticket's
+	// for the frame's present, which has to have reached the queue before RenderSemaphore's signalled again.
+	VkSemaphore AcquireSemaphore = nullptr;
+	u64         PresentTicket    = 0;
+
+	// The draw image can change between frames (it comes from the transient pool), so each frame has its own set, which
+	// is only ever rewritten once that frame's previous submission has finished.
+	VkDescriptorSet DrawImageDescriptor           = nullptr;
+	u32             DrawImageDescriptorGeneration = 0;
+
+	// Timestamps at the start and end of the frame's command buffer, read back once its fence has been waited on.
+	VkQueryPool TimestampQueryPool = nullptr;
+	bool        TimestampsWritten  = false;
+
 	DeletionQueue FrameDeletionQueue;
 };
 
@@ -30,6 +87,9 @@ struct PushConstants
 {
 	glm::vec4 Colour1      = {}, Colour2 = {}, Colour3 = {};
 	glm::vec3 ColourPoints = {};
+	// The part of the draw image we're rendering into this frame. Matches the GLSL layout, where an ivec2 after a vec3
+	// is aligned to 8 bytes.
+	alignas(8) glm::ivec2 DrawExtent = {};
 };
 
 constexpr u16 FramesInFlight = 2;
@@ -46,14 +106,71 @@ public:
 	Renderer& operator=(Renderer&& other) noexcept = delete;
 
 	bool Init(RendererSpecification spec);
-	void Render();
+	// With a packet, the UI's drawn and the settings are taken from it rather than from ImGui's live state and the main
+	// thread's copy, which may already be on the next frame.
+	void Render(FramePacket* packet = nullptr);
 	void Present();
 	void ImmediateSubmit(std::function<void(VkCommandBuffer cmd)>&& function) const;
+	// Like ImmediateSubmit, but without the wait, and safe to call from any thread. The function's queued, then
+	// recorded and submitted on the render thread at the start of the next frame. co_await the result from a task to
+	// carry on once the GPU's finished with it.
+	NODISCARD GPUAwaiter SubmitAsync(std::function<void(VkCommandBuffer cmd)>&& function);
 	void Shutdown();
 
-	// Setters
-	void SetVSync(bool vsync);
+	// Runs the function once every frame that's currently in flight has finished on the GPU. Use it for anything that
+	// might still be referenced by a submitted command buffer.
+	void DeferDestruction(std::function<void()>&& function);
+
+	// Resource functions
+	NODISCARD AllocatedBuffer CreateBuffer(size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+	                                       VmaAllocationCreateFlags flags = 0) const;
+	void                     DestroyBuffer(AllocatedBuffer& buffer) const;
+	// With VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT, returns an empty image rather than going over the heap budget.
+	NODISCARD AllocatedImage CreateImage(VkExtent3D extent, VkFormat format, VkImageUsageFlags usage,
+	                                     u32 mipLevels = 1, VmaAllocationCreateFlags allocationFlags = 0) const;
+	void                     DestroyImage(AllocatedImage& image) const;
+
+	// Blocks until it's time to start the next frame, in low latency mode. Called at the very start of a frame, before
+	// input is read, so that input's as fresh as possible by the time the frame's on screen.
+	void WaitForFrameStart();
+	// Waits for the frame slot we're about to record into to come back from the GPU. Render() does this itself, but a
+	// render thread can do it first, so that's out of the way by the time the frame's ready.
+	void WaitForFrameFence();
 
+	// The main thread's copy of the settings, for the UI to edit. Changes take effect from the next frame handed over.
+	NODISCARD FORCEINLINE RendererSettings& GetSettings() { return m_UISettings; }
+	// Copies the settings out for a frame, and clears anything that's one-shot, so it's only acted on once.
+	NODISCARD RendererSettings TakeSettings();
+	// A copy of the last rendered frame's stats. Safe to call from any thread.
+	NODISCARD RendererStats GetStats() const;
+
+	// Anything that submits to or presents on the graphics queue from outside the renderer (ImGui's platform windows,
+	// say) must hold this, as the present thread uses the queue too.
+	NODISCARD std::unique_lock<std::mutex> LockQueue() const { return std::unique_lock(m_QueueMutex); }
+
+	NODISCARD FORCEINLINE VkDevice                        GetDevice() const { return m_Device; }
+	NODISCARD FORCEINLINE VkPhysicalDevice                GetGPU() const { return m_GPU; }
+	NODISCARD FORCEINLINE VmaAllocator                    GetAllocator() const { return m_Allocator; }
+	NODISCARD FORCEINLINE VkQueue                         GetGraphicsQueue() const { return m_GraphicsQueue; }
+	NODISCARD FORCEINLINE u32                             GetGraphicsQueueFamily() const { return m_GraphicsQueueFamily; }
+	NODISCARD FORCEINLINE u64                             GetFrameIndex() const { return m_FrameIndex; }
+	NODISCARD FORCEINLINE TextureStreamer&                GetTextureStreamer() { return m_TextureStreamer; }
+	NODISCARD FORCEINLINE ResidencyManager&               GetResidencyManager() { return m_ResidencyManager; }
+	NODISCARD FORCEINLINE Defragmenter&                   GetDefragmenter() { return m_Defragmenter; }
+	NODISCARD FORCEINLINE TransientImagePool&             GetTransientImagePool() { return m_TransientImages; }
+	NODISCARD FORCEINLINE DynamicResolution&              GetDynamicResolution() { return m_DynamicResolution; }
+	NODISCARD bool                                        SupportsTextureCompression(TextureCompressionFamily family) const;
+	NODISCARD FORCEINLINE bool                            SupportsLowLatency() const { return m_SupportsPresentWait; }
+	NODISCARD FORCEINLINE const SubgroupInfo&             GetSubgroupInfo() const { return m_SubgroupInfo; }
+	NODISCARD FORCEINLINE f32                             GetTimestampPeriod() const { return m_TimestampPeriod; }
+	NODISCARD FORCEINLINE u64                             GetTimestampMask() const { return m_TimestampMask; }
+	NODISCARD FORCEINLINE ComputeAutotuner&               GetComputeAutotuner() { return m_ComputeAutotuner; }
+	NODISCARD FORCEINLINE ResolvePass&                    GetResolvePass() { return m_ResolvePass; }
+	NODISCARD FORCEINLINE PassCache&                      GetPassCache() { return m_PassCache; }
+	NODISCARD FORCEINLINE GPUAwaitPoller&                 GetGPUAwaits() { return m_GPUAwaits; }
+	NODISCARD FORCEINLINE bool                            SupportsImGuiCaching() const { return m_ResolvePass.IsReady(); }
+	NODISCARD FORCEINLINE VkPresentModeKHR                GetPresentMode() const { return m_PresentMode; }
+	NODISCARD FORCEINLINE bool                            IsPresentThreadRunning() const { return m_PresentThread.IsRunning(); }
 	NODISCARD FORCEINLINE const std::vector<std::string>& GetGPUNames() const { return m_GPUNames; }
 	NODISCARD FORCEINLINE s32                             GetSelectedGPUIndex() const { return m_GPUIndex; }
 	NODISCARD FORCEINLINE const RendererSpecification&    GetSpecification() const { return m_Spec; }
@@ -74,14 +191,26 @@ protected:
 	bool CreateSwapchain(u32 width, u32 height);
 	bool DestroySwapchain();
 	void RecreateSwapchain();
+	void StartPresentThread();
+	void StopPresentThread();
 	void ShutdownFrameData(FrameData& frameData) const;
+	void UpdateDrawImageDescriptor(FrameData& frameData) const;
+	void ApplySettings(const RendererSettings& settings);
+	void PublishStats();
+	void ReadFrameTimestamps(FrameData& frameData);
+	NODISCARD WorkgroupSize TuneGradientPipeline(VkShaderModule shader, const WorkgroupSize& fallback);
+	NODISCARD u64           GetGradientInputHash(VkPipeline pipeline) const;
+	NODISCARD u64           GetImGuiInputHash() const;
+	NODISCARD ImDrawData*   GetImGuiDrawData() const;
 
 	// Utility functions
 	void PrintDeviceInfo();
 
 	// Drawing functions
-	void Clear(VkCommandBuffer cmd) const;
-	void DrawImGUI(VkCommandBuffer cmd, VkImageView targetImage);
+	void RecordPasses(VkCommandBuffer cmd, FrameData& frameData, std::span<const PassRecorder> passes);
+	void FlushAsyncSubmits();
+	void Clear(VkCommandBuffer cmd, VkPipeline pipeline) const;
+	void DrawImGUI(VkCommandBuffer cmd, VkImageView targetImage, const VkClearValue* clear = nullptr);
 	void OnDrawIMGui();
 
 	// Event functions
@@ -110,6 +239,21 @@ protected:
 	s32                      m_GPUIndex       = -1;
 	DeletionQueue            m_DeletionQueue  = {};
 
+	// Which block compression formats the device can sample (enabled at device creation if present).
+	bool m_SupportsBC = false, m_SupportsETC2 = false, m_SupportsASTC = false;
+	bool m_SupportsMemoryBudget = false;
+	bool m_SupportsPresentWait  = false; // VK_KHR_present_id and VK_KHR_present_wait, both with their features.
+	// Lets the resolve pass write the swapchain's BGRA images, which have no matching GLSL format.
+	bool m_SupportsStorageWriteWithoutFormat = false;
+
+	PFN_vkWaitForPresentKHR m_WaitForPresent = nullptr;
+
+	SubgroupInfo m_SubgroupInfo = {};
+
+	// Nanoseconds per timestamp tick, or 0 if the graphics queue can't write timestamps.
+	f32 m_TimestampPeriod = 0.0f;
+	u64 m_TimestampMask   = 0;
+
 	// Swapchain objects
 	VkSwapchainKHR           m_Swapchain            = nullptr;
 	VkFormat                 m_SwapchainImageFormat = {};
@@ -117,14 +261,29 @@ protected:
 	std::vector<VkImage>     m_SwapchainImages      = {};
 	std::vector<VkImageView> m_SwapchainImageViews  = {};
 	bool m_SwapchainDirty = false;
+	bool m_SwapchainSupportsStorage = false; // If so, the resolve pass writes it directly rather than blitting.
 	u32 m_SwapchainImageIndex = 0;
+	VkPresentModeKHR              m_PresentMode           = VK_PRESENT_MODE_FIFO_KHR; // What we actually got.
+	std::vector<VkPresentModeKHR> m_SupportedPresentModes = {};
+	// Present IDs only ever go up, but a new swapchain hasn't presented anything yet, so there's nothing to wait on
+	// until it has; that's what the last ID is for.
+	u64 m_NextPresentID = 1;
+	u64 m_LastPresentID = 0;
+	// How many images we can have acquired at once without blocking: the image count, less the minimum, plus one.
+	u32           m_MaxAcquiredImages = 1;
+	PresentThread m_PresentThread;
+	// Set when the present thread had no image to give us, so Render() gave up on the frame and Present() has nothing
+	// to present.
+	bool m_FrameSkipped = false;
 
 	// Descriptors and pipelines
 	DescriptorAllocator   m_DescriptorAllocator       = {};
-	VkDescriptorSet       m_DescriptorSet             = nullptr;
 	VkDescriptorSetLayout m_DrawImageDescriptorLayout = nullptr;
-	VkPipeline            m_GradientPipeline          = nullptr;
 	VkPipelineLayout      m_GradientPipelineLayout    = nullptr;
+	WorkgroupSize         m_GradientWorkgroupSize     = {};
+	ShaderPermutations    m_GradientPermutations;
+	PermutationKey        m_GradientKey;
+	PipelineCache         m_PipelineCache;
 
 	// ImGUI
 	bool             m_ImGUIInitialised    = false;
@@ -135,6 +294,17 @@ protected:
 	VkCommandBuffer m_ImmediateCommandBuffer = nullptr;
 	VkCommandPool   m_ImmediateCommandPool   = nullptr;
 
+	// Async submission structures. Each submission signals the timeline with its own value, so the one semaphore
+	// tracks them all, and their command buffers are recycled once it's passed them.
+	VkSemaphore                                  m_AsyncTimeline           = nullptr;
+	VkCommandPool                                m_AsyncCommandPool        = nullptr;
+	std::vector<std::pair<VkCommandBuffer, u64>> m_AsyncInFlight           = {};
+	std::vector<VkCommandBuffer>                 m_FreeAsyncCommandBuffers = {};
+	// Guards the pending submissions and the next value, which are all any other thread touches.
+	std::mutex                                                        m_AsyncMutex          = {};
+	std::vector<std::pair<u64, std::function<void(VkCommandBuffer)>>> m_PendingAsyncSubmits = {};
+	u64                                                               m_NextAsyncValue      = 1;
+
 	// Test stuff
 	PushConstants m_PushConstants = {};
 
@@ -145,6 +315,35 @@ protected:
 	u32                                   m_GraphicsQueueFamily = 0;
 	AllocatedImage                        m_DrawImage           = {};
 	VkExtent2D                            m_DrawExtent          = {};
+	// The draw image is persistent, so it's left however the last frame left it; these say how that was.
+	VkImageLayout m_DrawImageLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+	u32           m_DrawImageGeneration = 0;
+	u32           m_ImGuiOverlayGeneration = 0; // Always left in SHADER_READ_ONLY_OPTIMAL, so no layout to track.
+
+	// Deletions tagged with the frame index at which they become safe.
+	std::deque<std::pair<u64, std::function<void()>>> m_DeferredDestruction;
+
+	TextureStreamer    m_TextureStreamer;
+	ResidencyManager   m_ResidencyManager;
+	Defragmenter       m_Defragmenter;
+	TransientImagePool m_TransientImages;
+	DynamicResolution  m_DynamicResolution;
+	ComputeAutotuner   m_ComputeAutotuner;
+	ResolvePass        m_ResolvePass;
+	PassCache          m_PassCache;
+	CachedPassID       m_GradientPass = 0;
+	CachedPassID       m_ImGuiPass    = 0;
+	GPUAwaitPoller     m_GPUAwaits;
+
+	// The main thread only ever touches its copy of the settings and the published stats, so while rendering's
+	// pipelined, the two threads only meet for as long as it takes to hand those over.
+	RendererSettings   m_UISettings  = {};
+	RendererStats      m_Stats       = {};
+	mutable std::mutex m_StatsMutex  = {};
+	glm::ivec2         m_WindowSize  = {}; // What the swapchain's sized to; the window itself is the main thread's.
+	FramePacket*       m_FramePacket = nullptr; // Only set during Render().
+	// Guards the graphics queue, which the present thread shares with us.
+	mutable std::mutex m_QueueMutex = {};
 
 	RendererSpecification m_Spec = {};
 };
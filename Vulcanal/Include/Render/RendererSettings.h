@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Render/Defragmenter.h"
+#include "Render/DynamicResolution.h"
+#include "Render/PassCache.h"
+#include "Render/ResidencyManager.h"
+#include "Render/ResolvePass.h"
+
+struct GradientSettings
+{
+	glm::vec4      Colour1      = {1, 0, 0, 1};
+	glm::vec4      Colour2      = {0, 1, 0, 1};
+	glm::vec4      Colour3      = {0, 0, 1, 1};
+	glm::vec3      ColourPoints = {0.1f, 0.5f, 0.8f};
+	PermutationKey Key;
+};
+
+// Everything the UI can change about the renderer. The main thread edits a copy of its own, which goes over with each
+// frame (in the frame's packet, when rendering's pipelined) and is applied before that frame's recorded, so the
+// renderer's own state is only ever touched by whichever thread's rendering.
+struct RendererSettings
+{
+	glm::ivec2       WindowSize        = {}; // Resizes come in with the main thread's events.
+	VkPresentModeKHR PresentMode       = VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	bool             LowLatency        = false;
+	bool             CacheImGui        = false;
+	bool             ParallelRecording = true;
+	bool             UsePresentThread  = false;
+
+	GradientSettings          Gradient;
+	DefragmenterSettings      Defragmenter;
+	DynamicResolutionSettings DynamicResolution;
+	ResolveSettings           Resolve;
+	PassCacheSettings         PassCache;
+};
+
+// What the UI shows, copied out at the end of each frame. It's a frame or so behind when pipelined, which is fine for
+// reading off.
+struct RendererStats
+{
+	std::vector<VkPresentModeKHR> SupportedPresentModes;
+	size_t                        GradientVariantCount = 0;
+	ResidencyStats                Residency;
+	DefragmenterStats             Defragmenter;
+	DynamicResolutionStats        DynamicResolution;
+	ResolveStats                  Resolve;
+	std::vector<PassCacheStats>   PassCache;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Render/TextureStreamer.h"
+
+class Renderer;
+
+struct ResidencyStats
+{
+	u64 Budget     = 0; // Across all device local heaps.
+	u64 Usage      = 0;
+	u64 Target     = 0;
+	u64 Projected  = 0; // Usage once outstanding downgrades, evictions and upgrades have gone through.
+	u32 Downgrades = 0; // Since startup.
+	u32 Evictions  = 0;
+};
+
+// Keeps streamed textures within a fraction of the VRAM budget.
+// Every frame, we compare device local usage (from VK_EXT_memory_budget, when the driver has it) against the target.
+// Over it, we walk the textures least recently used first, dropping their top level, or evicting them outright if they
+// haven't been touched in a while, until the projected usage fits again. Under it, we do the opposite, most recently
+// used first, until each texture is back at its desired level. Everything goes through the streamer, so evicted images
+// are only freed once no frame in flight can still be sampling them.
+class ResidencyManager
+{
+public:
+	static constexpr f32 DefaultTargetFraction   = 0.85f;
+	static constexpr u64 DefaultEvictAfterFrames = 300;
+
+	void Init(Renderer* renderer, TextureStreamer* streamer);
+
+	// Marks the texture as used this frame, and the level it'd like to be sampled at. Textures that aren't touched
+	// stop being upgraded after a while, and are the first to go when we're short on memory.
+	void Touch(StreamedTexture& texture, u32 desiredMip = 0) const;
+
+	// Adjusts each texture's RequestedMip. Called once a frame, before the streamer's update.
+	void Update();
+
+	void SetTargetFraction(f32 fraction) { m_TargetFraction = std::clamp(fraction, 0.1f, 1.0f); }
+	void SetEvictAfterFrames(u64 frames) { m_EvictAfterFrames = frames; }
+
+	NODISCARD FORCEINLINE const ResidencyStats& GetStats() const { return m_Stats; }
+
+protected:
+	// Sums the budget and usage of every device local heap.
+	void QueryBudget(u64& outBudget, u64& outUsage) const;
+
+	Renderer*        m_Renderer = nullptr;
+	TextureStreamer* m_Streamer = nullptr;
+
+	f32 m_TargetFraction   = DefaultTargetFraction;
+	u64 m_EvictAfterFrames = DefaultEvictAfterFrames;
+
+	std::vector<StreamedTexture*> m_SortedTextures; // Reused every frame.
+	ResidencyStats                m_Stats;
+};
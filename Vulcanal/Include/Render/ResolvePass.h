@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Render/Descriptors.h"
+#include "Render/Image.h"
+#include "Render/ShaderPermutations.h"
+
+class Renderer;
+
+struct ResolvePushConstants
+{
+	glm::vec2  SourceScale  = {}; // The draw extent as a fraction of the draw image.
+	glm::ivec2 TargetExtent = {};
+	f32        Exposure     = 1.0f;
+};
+
+// A simple grade, baked into the 3D LUT. Everything's in sRGB-encoded space, where the LUT's indexed.
+struct ColourGrade
+{
+	f32       Contrast   = 1.0f;
+	f32       Saturation = 1.0f;
+	glm::vec3 Lift       = {0.0f, 0.0f, 0.0f};
+	glm::vec3 Gain       = {1.0f, 1.0f, 1.0f};
+
+	bool operator==(const ColourGrade& other) const = default;
+};
+
+struct ResolveSettings
+{
+	PermutationKey Key;
+	ColourGrade    Grade     = {};
+	f32            Exposure  = 1.0f;
+	bool           ForceBlit = false; // For comparing against the fallback.
+};
+
+struct ResolveStats
+{
+	bool   Ready            = false;
+	bool   WritingSwapchain = false;
+	size_t VariantCount     = 0;
+};
+
+// The last pass of the frame. Reads the draw image once, and does the upscale from the draw extent, exposure,
+// tonemapping, the LUT grade and the sRGB encode in the same kernel, where they'd otherwise each be a full-screen read
+// and write. The target's written as storage: the swapchain image itself if the surface allows it, or else an
+// intermediate that's blitted across, which still saves every pass but the copy.
+class ResolvePass
+{
+public:
+	static constexpr u32      LUTSize   = 32;
+	static constexpr VkFormat LUTFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	// For the blit fallback. Any format will do, since the blit converts.
+	static constexpr VkFormat IntermediateFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+	// Fails if the shader can't be loaded; the renderer then blits the draw image without resolving it.
+	bool Init(Renderer* renderer, VkPipelineCache cache, JobSystem* jobSystem);
+	void Shutdown();
+
+	// The source has to be in SHADER_READ_ONLY_OPTIMAL and the target in GENERAL. The frame slot picks which
+	// descriptor set to rewrite, so it has to be one whose previous submission has finished.
+	// The overlay's optional: a premultiplied image the target's size (in SHADER_READ_ONLY_OPTIMAL) composited on top.
+	void Record(VkCommandBuffer cmd, u32 frameSlot, const AllocatedImage& source, VkExtent2D drawExtent,
+	            VkImageView target, VkExtent2D targetExtent, VkImageView overlay = nullptr);
+
+	void SetGrade(const ColourGrade& grade);
+	// Rebuilds the LUT if the grade's changed, so it's best called before the frame's recording starts.
+	void ApplySettings(const ResolveSettings& settings);
+
+	NODISCARD FORCEINLINE bool               IsReady() const { return m_Ready; }
+	NODISCARD FORCEINLINE bool               IsForcingBlit() const { return m_ForceBlit; }
+	NODISCARD FORCEINLINE const ColourGrade& GetGrade() const { return m_Grade; }
+	NODISCARD ResolveSettings                GetSettings() const;
+	NODISCARD ResolveStats                   GetStats(bool writingSwapchain) const;
+
+	static void OnDrawIMGui(ResolveSettings& settings, const ResolveStats& stats);
+
+protected:
+	void CreateLUT();
+
+	Renderer* m_Renderer = nullptr;
+
+	DescriptorAllocator          m_DescriptorAllocator = {};
+	VkDescriptorSetLayout        m_DescriptorLayout    = nullptr;
+	std::vector<VkDescriptorSet> m_DescriptorSets      = {}; // One per frame in flight.
+	VkPipelineLayout             m_PipelineLayout      = nullptr;
+	ShaderPermutations           m_Permutations;
+	PermutationKey               m_Key;
+	VkSampler                    m_Sampler = nullptr;
+	AllocatedImage               m_LUT     = {};
+
+	ColourGrade m_Grade     = {};
+	f32         m_Exposure  = 1.0f;
+	bool        m_Ready     = false;
+	bool        m_ForceBlit = false; // For comparing against the fallback.
+};
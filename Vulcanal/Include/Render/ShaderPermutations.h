@@ -0,0 +1,102 @@
+#pragma once
+
+#include <future>
+#include <mutex>
+#include <optional>
+
+#include "Render/Pipelines.h"
+
+class JobSystem;
+
+// A feature toggle or tunable a shader declares as a specialisation constant, e.g.
+//     layout (constant_id = 3) const bool Smooth = true;
+struct SpecializationConstant
+{
+	std::string Name;
+	u32         ID      = 0; // The constant_id. 0-2 are the workgroup size.
+	bool        IsBool  = false;
+	s32         Default = 0; // Should match the shader's, so an empty key means the same thing in both places.
+	s32         Min     = 0, Max = 1; // Only for the UI; bools are always 0-1.
+};
+
+// Which value each constant takes. Anything left unset takes its default.
+class PermutationKey
+{
+public:
+	PermutationKey& Set(u32 id, s32 value);
+	PermutationKey& Set(u32 id, bool value) { return Set(id, static_cast<s32>(value)); }
+
+	NODISCARD std::optional<s32> Get(u32 id) const;
+	NODISCARD FORCEINLINE const std::vector<std::pair<u32, s32>>& GetValues() const { return m_Values; }
+
+	bool operator==(const PermutationKey& other) const = default;
+
+protected:
+	std::vector<std::pair<u32, s32>> m_Values; // Sorted by ID.
+};
+
+// Compiles, caches and hands out the variants of one compute shader.
+// Toggles that used to be uniform branches become specialisation constants instead, so each variant's compiled with
+// the dead paths gone. Variants are keyed by a hash of their resolved constant values, compiled the first time they're
+// asked for (or ahead of time on the job system with Prewarm()), and go through the pipeline cache, so the driver's
+// work survives between runs too.
+class ShaderPermutations
+{
+public:
+	ShaderPermutations() = default;
+	~ShaderPermutations();
+
+	ShaderPermutations(const ShaderPermutations& other)                = delete;
+	ShaderPermutations(ShaderPermutations&& other) noexcept            = delete;
+	ShaderPermutations& operator=(const ShaderPermutations& other)     = delete;
+	ShaderPermutations& operator=(ShaderPermutations&& other) noexcept = delete;
+
+	bool Init(VkDevice device, std::string_view shaderPath, VkPipelineLayout layout, const WorkgroupSize& workgroupSize,
+	          std::vector<SpecializationConstant> constants, VkPipelineCache cache, JobSystem* jobSystem);
+	// Waits for any variants still compiling in the background, then destroys everything.
+	void Shutdown();
+
+	// Returns the variant, compiling it now if nobody's asked for it before. If it's still being prewarmed, waits for
+	// that instead. Get() and Prewarm() are for the render thread only; the job system just does the compiling.
+	NODISCARD VkPipeline Get(const PermutationKey& key);
+	// Starts compiling variants on the job system, so they're ready by the time they're needed.
+	void Prewarm(std::span<const PermutationKey> keys);
+	// Every combination of values. Only sensible for a handful of toggles.
+	NODISCARD std::vector<PermutationKey> GetAllPermutations() const;
+
+	NODISCARD FORCEINLINE const std::vector<SpecializationConstant>& GetConstants() const { return m_Constants; }
+	NODISCARD FORCEINLINE const WorkgroupSize&                       GetWorkgroupSize() const { return m_WorkgroupSize; }
+	NODISCARD size_t                                                 GetVariantCount() const;
+
+protected:
+	// The key with every constant filled in, in declaration order.
+	NODISCARD std::vector<SpecializationValue> Resolve(const PermutationKey& key) const;
+	NODISCARD static u64                       Hash(std::span<const SpecializationValue> values);
+
+	NODISCARD VkPipeline Compile(const std::vector<SpecializationValue>& values) const;
+
+	struct Variant
+	{
+		std::vector<SpecializationValue> Values; // To tell hash collisions apart.
+		std::shared_future<VkPipeline>   Pipeline;
+	};
+
+	// Call with the mutex held.
+	NODISCARD const Variant* FindVariant(u64 hash, std::span<const SpecializationValue> values) const;
+
+	VkDevice         m_Device        = nullptr;
+	VkShaderModule   m_Shader        = nullptr;
+	VkPipelineLayout m_Layout        = nullptr;
+	VkPipelineCache  m_Cache         = nullptr;
+	JobSystem*       m_JobSystem     = nullptr;
+	WorkgroupSize    m_WorkgroupSize = {};
+
+	std::vector<SpecializationConstant> m_Constants;
+
+	mutable std::mutex                    m_Mutex;
+	std::unordered_multimap<u64, Variant> m_Variants;
+
+	// Get() is mostly called with the same key as last time, so remember that to skip resolving and hashing.
+	PermutationKey m_LastKey;
+	VkPipeline     m_LastPipeline = nullptr;
+};
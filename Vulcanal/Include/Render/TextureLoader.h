@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Render/Image.h"
+
+class JobSystem;
+class Renderer;
+
+struct TextureLoadOptions
+{
+	bool SRGB            = true; // Colour textures want sRGB; data textures (normals, masks etc.) don't.
+	bool GenerateMipmaps = true;
+};
+
+// Loads image files (anything stb_image can read) into sampled GPU images.
+// Files are read, decoded and copied into a staging buffer on the job system. The copies to each image and its whole
+// mip chain (generated with blits) are then recorded into one command buffer per batch, so the calling thread only
+// records commands and waits for the GPU.
+// Images come back in SHADER_READ_ONLY_OPTIMAL; the caller owns them, and frees them with Renderer::DestroyImage().
+class TextureLoader
+{
+public:
+	explicit TextureLoader(Renderer& renderer, JobSystem* jobSystem = nullptr);
+
+	// Failed loads return a null image (and log why).
+	NODISCARD AllocatedImage              Load(const std::filesystem::path& path, const TextureLoadOptions& options = {}) const;
+	NODISCARD std::vector<AllocatedImage> Load(std::span<const std::filesystem::path> paths,
+	                                           const TextureLoadOptions&              options = {}) const;
+
+	// Loads every supported image in a directory, keyed by the path relative to it (with forward slashes).
+	NODISCARD std::unordered_map<std::string, AllocatedImage> LoadDirectory(
+		const std::filesystem::path& directory, const TextureLoadOptions& options = {}, bool recursive = true) const;
+
+	// Caps the size of a single staging buffer; batches bigger than this are split into several submissions.
+	void SetStagingBudget(size_t bytes) { m_StagingBudget = bytes; }
+
+	NODISCARD static bool IsSupportedExtension(const std::filesystem::path& path);
+
+protected:
+	struct DecodedImage;
+
+	void DecodeBatch(std::span<const std::filesystem::path> paths, std::span<DecodedImage> outImages,
+	                 const TextureLoadOptions&              options) const;
+	void UploadBatch(std::span<DecodedImage> images, std::span<AllocatedImage> outImages,
+	                 const TextureLoadOptions& options) const;
+
+	Renderer&   m_Renderer;
+	JobSystem* m_JobSystem     = nullptr;
+	size_t     m_StagingBudget = 256ull * 1024 * 1024;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "Render/Buffer.h"
+#include "Render/Image.h"
+#include "Render/KTX2.h"
+#include "Core/FileSystem/AsyncFileIO.h"
+
+class Renderer;
+class ThreadPool;
+
+// A KTX2 texture whose mip chain streams in from the smallest level up.
+// Image only ever holds the resident levels [ResidentMip, mip count), so changing residency means reallocating it, and
+// the view changes with it. Anything that caches descriptors for it should compare Version.
+struct StreamedTexture
+{
+	KTX2File       File;
+	AllocatedImage Image         = {};
+	u32            TailMip       = 0; // The first level small enough to count as the mip tail, loaded in one go.
+	u32            ResidentMip   = 0; // The most detailed level that's resident, or the mip count if none are.
+	u32            RequestedMip  = 0; // The level we're streaming towards. The mip count means "evict everything".
+	u32            DesiredMip    = 0; // The level the app would like, if the budget allows.
+	u64            LastUsedFrame = 0;
+	u32            Version       = 0; // Bumped every time Image is replaced.
+	bool           Pending       = false;
+	bool           Failed        = false;
+
+	NODISCARD FORCEINLINE bool IsUsable() const { return Image.Image != VK_NULL_HANDLE; }
+	NODISCARD FORCEINLINE u32  GetMipLevels() const { return File.GetMipLevels(); }
+
+	// Bytes needed to hold levels [mip, mip count). Block-compressed levels are the same size on disk as on the GPU.
+	NODISCARD u64 GetSizeFromMip(u32 mip) const;
+	NODISCARD u64 GetResidentSize() const { return GetSizeFromMip(ResidentMip); }
+};
+
+struct TextureStreamerStats
+{
+	u32 TextureCount    = 0;
+	u32 ActiveTransfers = 0;
+	u64 ResidentBytes   = 0;
+	u64 UploadedBytes   = 0; // Since startup.
+};
+
+// Streams KTX2 textures in the background.
+// Level data is read from disk straight into mapped staging memory: loose files through AsyncFileIO, every level in
+// one batch, and packed ones on the thread pool, which decodes them. Once a read lands, we record a
+// small transfer that copies the already-resident levels out of the old image into a bigger one, and the new levels in
+// from staging. The old image is destroyed once no in-flight frame can still be sampling it. Per-frame upload
+// bandwidth is capped, so streaming never causes a hitch on its own.
+class TextureStreamer
+{
+public:
+	static constexpr u32 DefaultTailSize     = 64;
+	static constexpr u32 DefaultMaxTransfers = 16;
+	static constexpr u64 DefaultUploadBudget = 32ull * 1024 * 1024;
+
+	// Without async I/O, loose files are read on the thread pool too.
+	void Init(Renderer* renderer, ThreadPool* threadPool, AsyncFileIO* asyncIO = nullptr);
+	void Shutdown();
+
+	// Reads the KTX2 header and queues the mip tail. Anything above the tail is up to whoever raises RequestedMip
+	// (normally the ResidencyManager). Returns null if the file is invalid, or its format can't be sampled on this GPU.
+	Ref<StreamedTexture> Load(const std::filesystem::path& path);
+	void                 Unload(const Ref<StreamedTexture>& texture);
+
+	// Swaps in finished transfers and kicks off new ones. The renderer calls this once a frame.
+	void Update();
+
+	void SetUploadBudget(u64 bytesPerFrame) { m_UploadBudget = bytesPerFrame; }
+	void SetTailSize(u32 size) { m_TailSize = size; }
+
+	NODISCARD FORCEINLINE const std::vector<Ref<StreamedTexture>>& GetTextures() const { return m_Textures; }
+	NODISCARD TextureStreamerStats                                GetStats() const;
+
+	// Bytes held by replaced or evicted images that are waiting for in-flight frames to finish before they're freed.
+	NODISCARD FORCEINLINE u64 GetRetiringBytes() const { return m_RetiringBytes; }
+
+protected:
+	enum class TransferState : u8
+	{
+		Reading,
+		Ready,
+		Submitted,
+		Failed,
+	};
+
+	struct Transfer
+	{
+		Ref<StreamedTexture>       Texture;
+		u32                        NewResidentMip = 0;
+		AllocatedBuffer            Staging        = {};
+		std::vector<u64>           StagingOffsets;
+		AllocatedImage             NewImage = {};
+		VkCommandBuffer            Cmd      = nullptr;
+		VkFence                    Fence    = nullptr;
+		std::atomic<TransferState> State    = TransferState::Ready;
+		// For async reads, open until they've all landed.
+		AsyncFile                  File;
+		std::atomic<u32>           ReadsLeft  = 0;
+		std::atomic<bool>          ReadFailed = false;
+	};
+
+	bool BeginTransfer(const Ref<StreamedTexture>& texture, u32 newResidentMip);
+	// Hands a transfer's read back to Update(). The transfer can be freed as soon as its state's published, so this is
+	// the last thing a read does with it; after that it only touches the streamer, which Shutdown() waits on.
+	void CompleteRead(Transfer& transfer, bool success);
+	// Reads every level in one batch. False if the file can't be opened, in which case nothing's been submitted.
+	bool BeginAsyncRead(Transfer& transfer, u32 readEnd);
+	bool SubmitTransfer(Transfer& transfer);
+	void FinishTransfer(Transfer& transfer);
+	void ReleaseTransfer(Transfer& transfer);
+	void RetireImage(AllocatedImage& image);
+	bool CanSample(const KTX2File& file) const;
+
+	Renderer*    m_Renderer   = nullptr;
+	ThreadPool*  m_ThreadPool = nullptr;
+	AsyncFileIO* m_AsyncIO    = nullptr;
+
+	std::vector<Ref<StreamedTexture>> m_Textures;
+	std::vector<Scope<Transfer>>      m_Transfers;
+
+	std::mutex              m_ReadMutex     = {};
+	std::condition_variable m_ReadsDone     = {};
+	u32                     m_ReadsInFlight = 0;
+
+	VkCommandPool                                     m_CommandPool = nullptr;
+	std::vector<std::pair<VkCommandBuffer, VkFence>> m_FreeCommandBuffers;
+
+	u32 m_TailSize      = DefaultTailSize;
+	u32 m_MaxTransfers  = DefaultMaxTransfers;
+	u64 m_UploadBudget  = DefaultUploadBudget;
+	u64 m_UploadedBytes = 0;
+	u64 m_RetiringBytes = 0;
+};
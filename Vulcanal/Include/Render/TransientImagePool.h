@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Render/Image.h"
+
+class Renderer;
+
+struct TransientImageDesc
+{
+	VkFormat              Format  = VK_FORMAT_UNDEFINED;
+	VkExtent2D            Extent  = {};
+	VkImageUsageFlags     Usage   = 0;
+	VkSampleCountFlagBits Samples = VK_SAMPLE_COUNT_1_BIT;
+
+	bool operator==(const TransientImageDesc& other) const
+	{
+		return Format == other.Format && Extent.width == other.Extent.width && Extent.height == other.Extent.height &&
+			Usage == other.Usage && Samples == other.Samples;
+	}
+};
+
+using TransientImageHandle = u32;
+
+struct TransientImagePoolStats
+{
+	u32 DeclaredImages = 0; // Declared this frame.
+	u32 PhysicalImages = 0; // After reusing images whose lifetimes don't overlap.
+	u64 AllocatedBytes = 0; // With aliasing.
+	u64 UnaliasedBytes = 0; // What it'd be if every physical image had its own memory.
+	u32 Rebuilds       = 0; // Since startup.
+};
+
+// Hands out intermediate render targets that only live within a frame.
+// Each frame, passes declare the images they need along with the first and last pass that uses them, and then we
+// compile that into a set of physical images. Declarations with the same description and non-overlapping lifetimes
+// share an image, and physical images with non-overlapping lifetimes share memory, so the total stays close to the
+// largest set that's ever live at once.
+// Compiling is cheap when nothing's changed, which is almost every frame: images, views and memory stick around
+// between frames, and are only rebuilt (and the old ones retired safely) when the declarations change - usually a
+// resize.
+// Aliased contents are undefined at the start of each lifetime, so the first use must transition from UNDEFINED.
+// Persistent images are the exception: they never share an image or memory, so whatever was in them last frame is still
+// there, until the pool's rebuilt (which GetGeneration() tells you about). That's what lets a pass skip redrawing them.
+class TransientImagePool
+{
+public:
+	void Init(Renderer* renderer);
+	void Shutdown();
+
+	void                 BeginFrame();
+	TransientImageHandle Declare(const TransientImageDesc& desc, u32 firstPass, u32 lastPass, bool persistent = false);
+	void                 Compile();
+
+	NODISCARD FORCEINLINE const AllocatedImage& Get(TransientImageHandle handle) const
+	{
+		return m_PhysicalImages[m_Declarations[handle].PhysicalIndex].Image;
+	}
+	NODISCARD FORCEINLINE const TransientImagePoolStats& GetStats() const { return m_Stats; }
+	// Changes whenever the images are rebuilt, so anything holding on to views knows to refresh them.
+	NODISCARD FORCEINLINE u32 GetGeneration() const { return m_Stats.Rebuilds; }
+
+protected:
+	struct Declaration
+	{
+		TransientImageDesc Desc;
+		u32                FirstPass = 0, LastPass = 0;
+		bool               Persistent    = false;
+		u32                PhysicalIndex = 0; // Filled in by Compile().
+
+		NODISCARD FORCEINLINE bool Matches(const Declaration& other) const
+		{
+			return Desc == other.Desc && FirstPass == other.FirstPass && LastPass == other.LastPass &&
+				Persistent == other.Persistent;
+		}
+	};
+
+	struct PhysicalImage
+	{
+		TransientImageDesc Desc;
+		u32                FirstPass = 0, LastPass = 0;
+		AllocatedImage     Image     = {};
+
+		VkMemoryRequirements Requirements = {};
+		u32                  MemoryGroup  = 0;
+		VkDeviceSize         Offset       = 0;
+	};
+
+	// Images can only live in the same allocation if they agree on memory types.
+	struct MemoryGroup
+	{
+		u32           MemoryTypeBits = 0;
+		VkDeviceSize  Size           = 0;
+		VkDeviceSize  Alignment      = 1;
+		VmaAllocation Allocation     = nullptr;
+	};
+
+	void Rebuild();
+	void PlaceImages();
+	void Release();
+
+	Renderer* m_Renderer = nullptr;
+
+	std::vector<Declaration>   m_Declarations;
+	std::vector<Declaration>   m_CompiledDeclarations; // What the current images were built for.
+	std::vector<PhysicalImage> m_PhysicalImages;
+	std::vector<MemoryGroup>   m_MemoryGroups;
+
+	TransientImagePoolStats m_Stats;
+};
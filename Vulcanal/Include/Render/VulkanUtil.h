@@ -14,11 +14,29 @@
 #define VK_CHECK(x) x
 #endif
 
-VkImageSubresourceRange ImageSubresourceRange(VkImageAspectFlags flags);
+VkImageSubresourceRange ImageSubresourceRange(VkImageAspectFlags flags, u32 baseMip = 0,
+                                              u32 levelCount = VK_REMAINING_MIP_LEVELS, u32 baseLayer = 0,
+                                              u32 layerCount = VK_REMAINING_ARRAY_LAYERS);
 void                    TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout currentLayout,
                                         VkImageLayout   newLayout);
+void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout currentLayout, VkImageLayout newLayout,
+                     const VkImageSubresourceRange& range);
 void BlitImageToImage(VkCommandBuffer commandBuffer, VkImage   source, VkImage destination, VkExtent2D sourceExt,
-                      VkExtent2D      destinationExt, VkFilter filter = VK_FILTER_LINEAR);
+                      VkExtent2D      destinationExt, VkFilter filter = VK_FILTER_LINEAR, u32 sourceMip = 0,
+                      u32             destinationMip = 0, u32 baseLayer = 0, u32 layerCount = 1);
+
+// Fills mips 1..mipLevels-1 by repeatedly blitting each level down into the next, on the GPU.
+// Every level must be in TRANSFER_DST_OPTIMAL with mip 0 already written; the whole image ends up in finalLayout.
+// The format must support linear blits (see SupportsLinearBlit()).
+void GenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent, u32 mipLevels,
+                     u32             layerCount  = 1,
+                     VkImageLayout   finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+bool SupportsLinearBlit(VkPhysicalDevice gpu, VkFormat format);
+
+NODISCARD FORCEINLINE u32 CalculateMipLevels(VkExtent2D extent)
+{
+	return static_cast<u32>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+}
 
 inline const char* VulkanSeverityToString(VkDebugUtilsMessageSeverityFlagBitsEXT severity)
 {
@@ -52,6 +70,23 @@ inline const char* VulkanMessageTypeToString(VkDebugUtilsMessageTypeFlagsEXT typ
 	}
 }
 
+inline const char* PresentModeToString(VkPresentModeKHR presentMode)
+{
+	switch (presentMode) // NOLINT(clang-diagnostic-switch-enum)
+	{
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return "Immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return "Mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR:
+		return "FIFO";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return "FIFO Relaxed";
+	default:
+		return "Unknown";
+	}
+}
+
 inline VkCommandPoolCreateInfo CreateCommandPoolCreateInfo(u32 queueFamilyIndex, VkCommandPoolCreateFlags flags = 0)
 {
 	VkCommandPoolCreateInfo info;
@@ -31,7 +31,10 @@ bool Application::Initialise()
 	VULC_ASSERT(!s_Instance, "Application already initialised?");
 	s_Instance = this;
 
-	InitLog(SDL_GetPrefPath(m_Specification.Author.c_str(), m_Specification.Name.c_str()));
+	char* prefPath = SDL_GetPrefPath(m_Specification.Author.c_str(), m_Specification.Name.c_str());
+	m_PrefPath     = prefPath ? prefPath : "";
+	InitLog(prefPath);
+	SDL_free(prefPath);
 
 	VULC_INFO("Initialising application: {} by {}", m_Specification.Name, m_Specification.Author);
 	auto workingDir = std::filesystem::current_path().string();
@@ -40,6 +43,29 @@ bool Application::Initialise()
 	if (!InitSDL())
 		return false;
 
+	// Sized together: the job system gets a thread per core for the CPU work, and the thread pool just a few more for
+	// the blocking reads, which mostly sit waiting on the disk rather than taking a core from the jobs.
+	m_ThreadPool = CreateScope<ThreadPool>();
+	VULC_INFO("Started thread pool with {} workers", m_ThreadPool->GetWorkerCount());
+
+	// Made here, so the main thread is the job system's thread 0.
+	m_JobSystem = CreateScope<JobSystem>();
+	VULC_INFO("Started job system with {} workers", m_JobSystem->GetWorkerCount());
+
+	// Packed content's mapped when it's there, and decompressed on the job system; anything it doesn't have is read
+	// from disk as before.
+	m_FileSystem = CreateScope<VirtualFileSystem>(VirtualFileSystemSpecification{}, m_JobSystem.get());
+	if (std::filesystem::exists("Content/Content.vpak"))
+		m_FileSystem->Mount("Content/Content.vpak", "Content/");
+	OnDrawIMGui.BindMethod(m_FileSystem.get(), &VirtualFileSystem::OnDrawIMGui);
+
+	m_AsyncIO = CreateScope<AsyncFileIO>(*m_ThreadPool);
+	OnDrawIMGui.BindMethod(m_AsyncIO.get(), &AsyncFileIO::OnDrawIMGui);
+
+	// Loads are read on the thread pool, since that blocks, and built on the job system.
+	m_AssetManager = CreateScope<AssetManager>(*m_ThreadPool, *m_JobSystem, *m_FileSystem);
+	OnDrawIMGui.BindMethod(m_AssetManager.get(), &AssetManager::OnDrawIMGui);
+
 	if (!m_Window.Create())
 		return false;
 
@@ -90,6 +116,23 @@ void Application::Run()
 
 	while (m_Running)
 	{
+		// Only switched between frames, so no frame's ever half on each path.
+		if (m_PipelinedRendering != m_RenderThread.joinable())
+		{
+			if (m_PipelinedRendering)
+				StartRenderThread();
+			else
+				StopRenderThread();
+		}
+		const bool pipelined = m_RenderThread.joinable();
+
+		// Pacing goes before anything else, so the frame's input is as fresh as it can be. When pipelined, the render
+		// thread does the renderer's part.
+		m_FrameLimiter.Wait();
+		if (!pipelined)
+			m_Renderer.WaitForFrameStart();
+		const auto frameStart = std::chrono::steady_clock::now();
+
 		Input::PreUpdate();
 		m_Window.PollEvents();
 
@@ -107,40 +150,165 @@ void Application::Run()
 
 		BeginImGUI();
 
+		// The renderer's windows only edit its settings, which aren't handed over until the frame is, so none of this
+		// has to wait on the render thread.
 		OnDrawIMGui.Execute();
-		
+
 		// ImGUI commands goes here.
-		ImGui::Begin("App Settings");
-		ImGui::Checkbox("Should Restart", &s_ShouldRestart);
-		const auto& gpuNames = m_Renderer.GetGPUNames();
-		if (ImGui::BeginCombo("GPU", gpuNames[s_SelectedGPU].c_str()))
+		DrawAppSettings();
+
+		ImGui::Render();
+
+		if (!pipelined)
 		{
-			for (s32 i = 0; i < static_cast<s32>(gpuNames.size()); i++)
+			m_Renderer.Render();
+
+			ImGui::UpdatePlatformWindows();
 			{
-				const bool isSelected = (i == s_SelectedGPU);
-				if (ImGui::Selectable(gpuNames[i].c_str(), isSelected))
-					s_SelectedGPU = i;
-				if (isSelected)
-					ImGui::SetItemDefaultFocus();
+				auto queueLock = m_Renderer.LockQueue();
+				ImGui::RenderPlatformWindowsDefault();
 			}
-			ImGui::EndCombo();
-		}
-		bool vsync = m_Renderer.GetSpecification().VSync;
-		if (ImGui::Checkbox("VSync", &vsync))
-			m_Renderer.SetVSync(vsync);
-		ImGui::End();
 
-		ImGui::Render();
+			m_Renderer.Present();
+			continue;
+		}
 
-		m_Renderer.Render();
+		// Copy out what the render thread needs, so ImGui's free to start on the next frame.
+		auto packet = CreateScope<FramePacket>();
+		packet->Capture();
+		packet->Settings = m_Renderer.TakeSettings();
 
+		// The extra viewports are drawn by ImGui's backend, with its own swapchains and buffers, so they only share
+		// the queue with the render thread.
 		ImGui::UpdatePlatformWindows();
-		ImGui::RenderPlatformWindowsDefault();
+		{
+			auto queueLock = m_Renderer.LockQueue();
+			ImGui::RenderPlatformWindowsDefault();
+		}
+
+		m_MainThreadMs.store(std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - frameStart).count(),
+		                     std::memory_order_relaxed);
+
+		// Blocks while the render thread's a whole queue behind.
+		m_FramePackets.Push(std::move(packet));
+	}
+
+	StopRenderThread();
+}
+
+void Application::StartRenderThread()
+{
+	VULC_INFO("Starting render thread");
+	m_FramePackets.Reset();
+	m_RenderThread = std::thread(&Application::RenderThreadLoop, this);
+}
+
+void Application::StopRenderThread()
+{
+	if (!m_RenderThread.joinable())
+		return;
 
+	// It finishes off whatever's queued first.
+	m_FramePackets.Close();
+	m_RenderThread.join();
+	VULC_INFO("Stopped render thread");
+}
+
+void Application::RenderThreadLoop()
+{
+	while (std::optional<Scope<FramePacket>> packet = m_FramePackets.Pop())
+	{
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		// Nothing here's shared with the main thread but the packet, so it's free to get on with the next frame for as
+		// long as these take, presents blocked on the display included.
+		m_Renderer.WaitForFrameStart();
+		m_Renderer.WaitForFrameFence();
+		m_Renderer.Render(packet->get());
 		m_Renderer.Present();
+
+		m_RenderThreadMs.store(std::chrono::duration<f32, std::milli>(std::chrono::steady_clock::now() - frameStart).count(),
+		                       std::memory_order_relaxed);
 	}
 }
 
+void Application::DrawAppSettings()
+{
+	ImGui::Begin("App Settings");
+	ImGui::Checkbox("Should Restart", &s_ShouldRestart);
+	const auto& gpuNames = m_Renderer.GetGPUNames();
+	if (ImGui::BeginCombo("GPU", gpuNames[s_SelectedGPU].c_str()))
+	{
+		for (s32 i = 0; i < static_cast<s32>(gpuNames.size()); i++)
+		{
+			const bool isSelected = (i == s_SelectedGPU);
+			if (ImGui::Selectable(gpuNames[i].c_str(), isSelected))
+				s_SelectedGPU = i;
+			if (isSelected)
+				ImGui::SetItemDefaultFocus();
+		}
+		ImGui::EndCombo();
+	}
+
+	// Only what the surface supports is listed; FIFO's always there.
+	RendererSettings& settings = m_Renderer.GetSettings();
+	if (ImGui::BeginCombo("Present Mode", PresentModeToString(settings.PresentMode)))
+	{
+		for (VkPresentModeKHR presentMode : m_Renderer.GetStats().SupportedPresentModes)
+		{
+			const bool isSelected = (presentMode == settings.PresentMode);
+			if (ImGui::Selectable(PresentModeToString(presentMode), isSelected) && !isSelected)
+				settings.PresentMode = presentMode;
+			if (isSelected)
+				ImGui::SetItemDefaultFocus();
+		}
+		ImGui::EndCombo();
+	}
+
+	bool frameLimitChanged = ImGui::Checkbox("Limit Frame Rate", &m_LimitFrameRate);
+	ImGui::BeginDisabled(!m_LimitFrameRate);
+	frameLimitChanged |= ImGui::SliderFloat("Frame Rate Limit", &m_FrameRateLimit, 10.0f, 500.0f, "%.0f");
+	ImGui::EndDisabled();
+	if (frameLimitChanged)
+		m_FrameLimiter.SetTargetFrameRate(m_LimitFrameRate ? m_FrameRateLimit : 0.0);
+
+	const bool lowLatencyAvailable = m_Renderer.SupportsLowLatency() && !settings.UsePresentThread;
+	ImGui::BeginDisabled(!lowLatencyAvailable);
+	ImGui::Checkbox("Low Latency", &settings.LowLatency);
+	ImGui::EndDisabled();
+	if (!lowLatencyAvailable && ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+	{
+		ImGui::SetTooltip(m_Renderer.SupportsLowLatency()
+			                  ? "Not available with the present thread"
+			                  : "Needs VK_KHR_present_wait");
+	}
+
+	ImGui::Checkbox("Present Thread", &settings.UsePresentThread);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Acquires and presents on a thread of its own, so neither blocks the renderer");
+
+	ImGui::Checkbox("Parallel Recording", &settings.ParallelRecording);
+
+	ImGui::BeginDisabled(!m_Renderer.SupportsImGuiCaching());
+	ImGui::Checkbox("Cache UI", &settings.CacheImGui);
+	ImGui::EndDisabled();
+	if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled))
+		ImGui::SetTooltip(m_Renderer.SupportsImGuiCaching()
+			                  ? "Only redraws the UI when it changes"
+			                  : "Needs the resolve pass");
+
+	ImGui::Checkbox("Pipelined Rendering", &m_PipelinedRendering);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Builds the next frame on this thread while a render thread draws the last one");
+	if (m_RenderThread.joinable())
+	{
+		ImGui::Text("Main thread: %.2f ms, render thread: %.2f ms", m_MainThreadMs.load(std::memory_order_relaxed),
+		            m_RenderThreadMs.load(std::memory_order_relaxed));
+	}
+
+	ImGui::End();
+}
+
 void Application::Shutdown()
 {
 	VULC_INFO("Shutting down application: {}", m_Specification.Name);
@@ -156,6 +324,13 @@ void Application::Shutdown()
 
 	Input::Shutdown();
 
+	m_AssetManager.reset();
+	m_FileSystem.reset();
+	// Before the thread pool, which its fallback reads run on.
+	m_AsyncIO.reset();
+	m_JobSystem.reset();
+	m_ThreadPool.reset();
+
 	if (m_Window.IsValid())
 		m_Window.Destroy();
 
@@ -0,0 +1,321 @@
+#include "vulcpch.h"
+#include "Core/Assets/AssetManager.h"
+
+#include "Core/ThreadPool.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/FileSystem/VirtualFileSystem.h"
+
+namespace
+{
+	const char* AssetStateToString(AssetState state)
+	{
+		switch (state)
+		{
+		case AssetState::Unloaded: return "Unloaded";
+		case AssetState::Loading: return "Loading";
+		case AssetState::Ready: return "Ready";
+		case AssetState::Failed: return "Failed";
+		}
+		return "Unknown";
+	}
+}
+
+AssetManager::AssetManager(ThreadPool& threadPool, JobSystem& jobSystem, VirtualFileSystem& fileSystem,
+                           AssetManagerSpecification spec)
+	: m_ThreadPool(&threadPool), m_JobSystem(&jobSystem), m_FileSystem(&fileSystem),
+	  m_Slots(std::make_unique<Slot[]>(spec.MaxAssets)), m_MaxAssets(spec.MaxAssets)
+{
+}
+
+AssetManager::~AssetManager()
+{
+	// The loads reference our slots, so they have to finish first.
+	WaitIdle();
+
+	std::lock_guard lock(m_Mutex);
+	u32 leaked = 0;
+	for (u32 i = 0; i < m_UsedSlots; i++)
+	{
+		if (m_Slots[i].State.load(std::memory_order_relaxed) == AssetState::Unloaded)
+			continue;
+		leaked++;
+		FreeSlot(i);
+	}
+	if (leaked > 0)
+		VULC_WARN("{} assets were still referenced when the asset manager shut down", leaked);
+}
+
+void AssetManager::RegisterLoader(std::type_index type, ErasedLoader&& loader)
+{
+	std::lock_guard lock(m_Mutex);
+	m_Loaders[type] = std::move(loader);
+}
+
+std::pair<u32, u32> AssetManager::Load(std::type_index type, std::string_view path)
+{
+	const AssetID id(path);
+
+	std::lock_guard lock(m_Mutex);
+
+	// Already requested, so share it, whatever state it's in.
+	if (const auto it = m_IDToSlot.find(id.Value); it != m_IDToSlot.end())
+	{
+		Slot& slot = m_Slots[it->second];
+		if (slot.Path != path)
+		{
+			VULC_ERROR("Asset path {} has the same ID as {}; rename one of them", path, slot.Path);
+			return {0, 0};
+		}
+		if (slot.Type != type)
+		{
+			VULC_ERROR("Asset {} is already loaded as a different type", path);
+			return {0, 0};
+		}
+		slot.RefCount.fetch_add(1, std::memory_order_relaxed);
+		return {it->second, slot.Generation.load(std::memory_order_relaxed)};
+	}
+
+	const auto loader = m_Loaders.find(type);
+	if (loader == m_Loaders.end())
+	{
+		VULC_ERROR("No asset loader registered for {}", path);
+		return {0, 0};
+	}
+
+	u32 index;
+	if (!m_FreeSlots.empty())
+	{
+		index = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	}
+	else if (m_UsedSlots < m_MaxAssets)
+	{
+		index = m_UsedSlots++;
+	}
+	else
+	{
+		VULC_ERROR("Can't load {}: all {} asset slots are in use", path, m_MaxAssets);
+		return {0, 0};
+	}
+
+	Slot& slot = m_Slots[index];
+	slot.ID    = id;
+	slot.Type  = type;
+	slot.Path  = path;
+	slot.RefCount.store(1, std::memory_order_relaxed);
+	slot.State.store(AssetState::Loading, std::memory_order_release);
+	m_IDToSlot.emplace(id.Value, index);
+
+	// Loaders live in a node-based map, so the pointer's stable for as long as the manager is.
+	m_LoadingCount.fetch_add(1, std::memory_order_relaxed);
+	ErasedLoader* erasedLoader = &loader->second;
+	m_ThreadPool->Submit([this, index, erasedLoader]() { ReadSlot(index, erasedLoader); });
+
+	return {index, slot.Generation.load(std::memory_order_relaxed)};
+}
+
+std::pair<u32, u32> AssetManager::Find(std::type_index type, AssetID id)
+{
+	std::lock_guard lock(m_Mutex);
+
+	const auto it = m_IDToSlot.find(id.Value);
+	if (it == m_IDToSlot.end())
+		return {0, 0};
+
+	Slot& slot = m_Slots[it->second];
+	if (slot.Type != type)
+	{
+		VULC_ERROR("Asset {} is loaded as a different type", slot.Path);
+		return {0, 0};
+	}
+	slot.RefCount.fetch_add(1, std::memory_order_relaxed);
+	return {it->second, slot.Generation.load(std::memory_order_relaxed)};
+}
+
+void AssetManager::AddRef(u32 index, u32 generation)
+{
+	// We already hold a reference, so it can't be going anywhere, and there's nothing to lock.
+	if (Slot* slot = GetSlot(index, generation))
+		slot->RefCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AssetManager::Release(u32 index, u32 generation)
+{
+	Slot* slot = GetSlot(index, generation);
+	if (!slot)
+		return;
+	if (slot->RefCount.fetch_sub(1, std::memory_order_acq_rel) != 1)
+		return;
+
+	// That was the last one, unless a Load() has picked it up again since, or its load's finished and freed it
+	// already. A slot that's still loading is freed by the load.
+	std::lock_guard lock(m_Mutex);
+	if (slot->Generation.load(std::memory_order_relaxed) == generation &&
+		slot->RefCount.load(std::memory_order_relaxed) == 0 &&
+		slot->State.load(std::memory_order_relaxed) != AssetState::Loading)
+	{
+		FreeSlot(index);
+	}
+}
+
+AssetState AssetManager::GetState(u32 index, u32 generation) const
+{
+	const Slot* slot = GetSlot(index, generation);
+	if (!slot)
+		return AssetState::Unloaded;
+
+	// The slot could have been freed, and even reused, since GetSlot() looked. FreeSlot() bumps the generation before
+	// it release-stores anything else, so if we've read one of its stores, the acquire means we see the new
+	// generation here, and it stops later loads moving above the state's.
+	const AssetState state = slot->State.load(std::memory_order_acquire);
+	return slot->Generation.load(std::memory_order_relaxed) == generation ? state : AssetState::Unloaded;
+}
+
+void* AssetManager::GetData(u32 index, u32 generation) const
+{
+	// The data's written before the state's published as ready, so seeing ready means seeing the data.
+	const Slot* slot = GetSlot(index, generation);
+	if (!slot || slot->State.load(std::memory_order_acquire) != AssetState::Ready)
+		return nullptr;
+
+	// Same as GetState(): if it's been freed since, the data we read might be null, or someone else's.
+	void* data = slot->Data.load(std::memory_order_acquire);
+	return slot->Generation.load(std::memory_order_relaxed) == generation ? data : nullptr;
+}
+
+AssetState AssetManager::Wait(u32 index, u32 generation)
+{
+	AssetState state;
+	std::unique_lock lock(m_Mutex);
+	m_LoadDone.wait(lock, [&]()
+	{
+		state = GetState(index, generation);
+		return state != AssetState::Loading;
+	});
+	return state;
+}
+
+void AssetManager::WaitIdle()
+{
+	std::unique_lock lock(m_Mutex);
+	m_LoadDone.wait(lock, [this]() { return m_LoadingCount.load(std::memory_order_relaxed) == 0; });
+}
+
+AssetManager::Slot* AssetManager::GetSlot(u32 index, u32 generation) const
+{
+	if (generation == 0 || index >= m_MaxAssets)
+		return nullptr;
+	Slot& slot = m_Slots[index];
+	return slot.Generation.load(std::memory_order_acquire) == generation ? &slot : nullptr;
+}
+
+void AssetManager::ReadSlot(u32 index, ErasedLoader* loader)
+{
+	// Nobody else writes the path while it's loading, so there's no need to lock to read it.
+	std::optional<std::vector<u8>> bytes = m_FileSystem->ReadFile(m_Slots[index].Path);
+	if (!bytes)
+	{
+		FinishLoad(index, {});
+		return;
+	}
+
+	// The blocking part's over, so the rest is CPU work, and goes where the cores are rather than holding up reads.
+	m_JobSystem->Run([this, index, loader, bytes = std::move(*bytes)]() mutable
+	{
+		FinishLoad(index, (*loader)(m_Slots[index].Path, std::move(bytes)));
+	});
+}
+
+void AssetManager::FinishLoad(u32 index, LoadedAsset asset)
+{
+	Slot& slot = m_Slots[index];
+
+	std::lock_guard lock(m_Mutex);
+	m_LoadingCount.fetch_sub(1, std::memory_order_relaxed);
+
+	if (slot.RefCount.load(std::memory_order_relaxed) == 0)
+	{
+		// Everyone let go while we were loading.
+		if (asset.Data)
+			asset.Destroy(asset.Data);
+		FreeSlot(index);
+	}
+	else if (asset.Data)
+	{
+		slot.Destroy = asset.Destroy;
+		slot.Data.store(asset.Data, std::memory_order_release);
+		slot.State.store(AssetState::Ready, std::memory_order_release);
+		m_LoadedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		// It stays failed until it's released, so asking again doesn't keep retrying a missing file.
+		VULC_WARN("Failed to load asset {}", slot.Path);
+		slot.State.store(AssetState::Failed, std::memory_order_release);
+	}
+
+	// Under the lock, or the destructor could wake and be gone before we're done with the condition variable.
+	m_LoadDone.notify_all();
+}
+
+void AssetManager::FreeSlot(u32 index)
+{
+	Slot& slot = m_Slots[index];
+
+	// Bump the generation first, so stale handles stop seeing the slot before anything in it changes.
+	u32 generation = slot.Generation.load(std::memory_order_relaxed) + 1;
+	if (generation == 0)
+		generation = 1;
+	slot.Generation.store(generation, std::memory_order_release);
+
+	if (slot.State.load(std::memory_order_relaxed) == AssetState::Ready)
+	{
+		slot.Destroy(slot.Data.load(std::memory_order_relaxed));
+		m_LoadedCount.fetch_sub(1, std::memory_order_relaxed);
+	}
+	// Released, so a reader that sees either of these also sees the generation change above.
+	slot.State.store(AssetState::Unloaded, std::memory_order_release);
+	slot.Data.store(nullptr, std::memory_order_release);
+	slot.RefCount.store(0, std::memory_order_relaxed);
+	slot.Destroy = nullptr;
+	slot.Type    = typeid(void);
+	slot.Path.clear();
+
+	m_IDToSlot.erase(slot.ID.Value);
+	slot.ID = {};
+	m_FreeSlots.push_back(index);
+}
+
+void AssetManager::OnDrawIMGui()
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Assets");
+
+	std::lock_guard lock(m_Mutex);
+	ImGui::Text("%u loaded, %u loading, %u of %u slots used", GetLoadedCount(), GetLoadingCount(),
+	            m_UsedSlots - static_cast<u32>(m_FreeSlots.size()), m_MaxAssets);
+
+	if (ImGui::BeginTable("Assets", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+	{
+		ImGui::TableSetupColumn("Path");
+		ImGui::TableSetupColumn("State");
+		ImGui::TableSetupColumn("Refs");
+		ImGui::TableHeadersRow();
+
+		for (const auto& [id, index] : m_IDToSlot)
+		{
+			const Slot& slot = m_Slots[index];
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(slot.Path.c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(AssetStateToString(slot.State.load(std::memory_order_relaxed)));
+			ImGui::TableNextColumn();
+			ImGui::Text("%u", slot.RefCount.load(std::memory_order_relaxed));
+		}
+		ImGui::EndTable();
+	}
+
+	ImGui::End();
+#endif
+}
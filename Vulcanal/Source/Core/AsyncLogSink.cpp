@@ -0,0 +1,88 @@
+#include "vulcpch.h"
+#include "Core/AsyncLogSink.h"
+
+#include <spdlog/pattern_formatter.h>
+
+AsyncLogSink::AsyncLogSink(std::vector<spdlog::sink_ptr> sinks, u32 capacity)
+	: m_Sinks(std::move(sinks)), m_Queue(capacity)
+{
+	m_Thread = std::thread(&AsyncLogSink::ThreadLoop, this);
+}
+
+AsyncLogSink::~AsyncLogSink()
+{
+	m_Stopping.store(true, std::memory_order_release);
+	m_WorkReady.Set();
+	m_Thread.join();
+}
+
+void AsyncLogSink::log(const spdlog::details::log_msg& msg)
+{
+	// The message only borrows its text, so it has to be copied before it goes anywhere.
+	Push({.Message = CreateScope<spdlog::details::log_msg_buffer>(msg)});
+}
+
+void AsyncLogSink::flush()
+{
+	const auto flushed = CreateRef<std::atomic<u32>>(0u);
+	Push({.Flushed = flushed});
+
+	while (flushed->load(std::memory_order_acquire) == 0)
+		Futex::Wait(*flushed, 0);
+}
+
+void AsyncLogSink::set_pattern(const std::string& pattern)
+{
+	for (const spdlog::sink_ptr& sink : m_Sinks)
+		sink->set_pattern(pattern);
+}
+
+void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> sinkFormatter)
+{
+	for (const spdlog::sink_ptr& sink : m_Sinks)
+		sink->set_formatter(sinkFormatter->clone());
+}
+
+void AsyncLogSink::Push(Entry&& entry)
+{
+	while (!m_Queue.TryPush(std::move(entry)))
+	{
+		m_WorkReady.Set();
+		std::this_thread::yield();
+	}
+	m_WorkReady.Set();
+}
+
+void AsyncLogSink::ThreadLoop()
+{
+	while (true)
+	{
+		// Read before draining, so everything pushed before the destructor's written before we go.
+		const bool stopping = m_Stopping.load(std::memory_order_acquire);
+
+		while (std::optional<Entry> entry = m_Queue.TryPop())
+		{
+			if (entry->Message)
+			{
+				for (const spdlog::sink_ptr& sink : m_Sinks)
+				{
+					if (sink->should_log(entry->Message->level))
+						sink->log(*entry->Message);
+				}
+				continue;
+			}
+
+			for (const spdlog::sink_ptr& sink : m_Sinks)
+				sink->flush();
+			entry->Flushed->store(1, std::memory_order_release);
+			Futex::WakeAll(*entry->Flushed);
+		}
+
+		if (stopping)
+			break;
+		m_WorkReady.Wait();
+	}
+
+	for (const spdlog::sink_ptr& sink : m_Sinks)
+		sink->flush();
+}
@@ -0,0 +1,504 @@
+#include "vulcpch.h"
+#include "Core/BVH.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+namespace
+{
+	// Relative cost of visiting a node vs testing an object, for the SAH.
+	constexpr f32 TraversalCost    = 1.0f;
+	constexpr f32 IntersectionCost = 1.0f;
+
+	constexpr u32 TraversalStackSize = 64;
+	// Traversal holds at most one node per level below the root on its stack, plus the one it's about to visit, so
+	// capping the depth here is what keeps queries inside the stack. Skewed input just gets bigger leaves at the bottom.
+	constexpr u32 MaxTreeDepth = TraversalStackSize - 1;
+
+	// Batched queries are split into groups of this many for the job system.
+	constexpr u32 QueryBatchSize = 256;
+}
+
+void BVH::Build(std::span<const AABB> bounds)
+{
+	m_ObjectBounds.assign(bounds.begin(), bounds.end());
+	m_Pending.clear();
+	Rebuild();
+	m_Stats.Rebuilds = 0;
+}
+
+void BVH::Clear()
+{
+	m_Nodes.clear();
+	m_Parents.clear();
+	m_ObjectIndices.clear();
+	m_ObjectBounds.clear();
+	m_ObjectLeaf.clear();
+	m_Pending.clear();
+	m_DirtyLeaves.clear();
+	m_LeafDirty.clear();
+	m_InternalAreaSum = 0.0f;
+	m_LeafAreaSum     = 0.0f;
+	m_BuildCost       = 0.0f;
+	m_Stats           = {};
+}
+
+u32 BVH::AddObject(const AABB& bounds)
+{
+	const u32 objectID = static_cast<u32>(m_ObjectBounds.size());
+	m_ObjectBounds.push_back(bounds);
+	m_ObjectLeaf.push_back(InvalidIndex);
+	m_Pending.push_back(objectID);
+	return objectID;
+}
+
+void BVH::RemoveObject(u32 objectID)
+{
+	// IDs are never reused; the object just gets an empty box, which nothing can hit.
+	UpdateObject(objectID, AABB());
+
+	if (m_ObjectLeaf[objectID] == InvalidIndex)
+		std::erase(m_Pending, objectID);
+}
+
+void BVH::UpdateObject(u32 objectID, const AABB& bounds)
+{
+	VULC_ASSERT(objectID < m_ObjectBounds.size(), "BVH object {} doesn't exist", objectID);
+	m_ObjectBounds[objectID] = bounds;
+
+	const u32 leaf = m_ObjectLeaf[objectID];
+	if (leaf != InvalidIndex)
+	{
+		if (!m_LeafDirty[leaf])
+		{
+			m_LeafDirty[leaf] = true;
+			m_DirtyLeaves.push_back(leaf);
+		}
+	}
+	else if (bounds.IsValid() && std::ranges::find(m_Pending, objectID) == m_Pending.end())
+	{
+		// It had no box at the last build (removed, or added empty), so it's in neither the tree nor the pending list,
+		// and queries would never see it.
+		m_Pending.push_back(objectID);
+	}
+}
+
+void BVH::Update()
+{
+	u32 refitNodes = 0;
+	for (const u32 leaf : m_DirtyLeaves)
+	{
+		m_LeafDirty[leaf] = false;
+
+		// Walk up from the leaf, stopping as soon as a node's bounds come out the same as they were; everything above
+		// it was already fitted to those bounds.
+		for (u32 node = leaf; node != InvalidIndex; node = m_Parents[node])
+		{
+			const Node oldNode = m_Nodes[node];
+			UpdateNodeBounds(node);
+			refitNodes++;
+
+			const Node& newNode = m_Nodes[node];
+			const f32   areaDelta = SurfaceArea(newNode.Min, newNode.Max) - SurfaceArea(oldNode.Min, oldNode.Max);
+			if (newNode.IsLeaf())
+				m_LeafAreaSum += areaDelta * static_cast<f32>(newNode.Count);
+			else
+				m_InternalAreaSum += areaDelta;
+
+			if (oldNode.Min == newNode.Min && oldNode.Max == newNode.Max)
+				break;
+		}
+	}
+	m_DirtyLeaves.clear();
+
+	m_Stats.LastRefitNodes = refitNodes;
+	m_Stats.PendingObjects = static_cast<u32>(m_Pending.size());
+	m_Stats.CostRatio      = m_BuildCost > 0.0f ? CalculateCost() / m_BuildCost : 1.0f;
+
+	const bool tooManyPending = m_Pending.size() > std::max<size_t>(16, m_ObjectBounds.size() / 8);
+	if (tooManyPending || m_Stats.CostRatio > m_RebuildThreshold)
+	{
+		m_Pending.clear();
+		Rebuild();
+	}
+}
+
+RayHit BVH::Raycast(const Ray& ray) const
+{
+	RayHit          hit;
+	const glm::vec3 inverseDirection = 1.0f / ray.Direction;
+	f32             closest          = ray.MaxDistance;
+
+	auto testObject = [&](u32 objectID)
+	{
+		// Removed objects have an inverted box, which the slab test would treat as infinite.
+		const AABB& bounds = m_ObjectBounds[objectID];
+		if (!bounds.IsValid())
+			return;
+
+		const f32 distance = IntersectRay(ray.Origin, inverseDirection, bounds.Min, bounds.Max, closest);
+		if (distance < closest)
+		{
+			closest      = distance;
+			hit.ObjectID = objectID;
+			hit.Distance = distance;
+		}
+	};
+
+	if (!m_Nodes.empty())
+	{
+		u32 stack[TraversalStackSize];
+		u32 stackSize = 0;
+		u32 node      = 0;
+
+		if (IntersectRay(ray.Origin, inverseDirection, m_Nodes[0].Min, m_Nodes[0].Max, closest) >= closest)
+			node = InvalidIndex;
+
+		while (node != InvalidIndex)
+		{
+			const Node& current = m_Nodes[node];
+			if (current.IsLeaf())
+			{
+				for (u32 i = 0; i < current.Count; i++)
+					testObject(m_ObjectIndices[current.LeftOrFirst + i]);
+				node = stackSize > 0 ? stack[--stackSize] : InvalidIndex;
+				continue;
+			}
+
+			// Visit the nearer child first, and only push the further one if it's still in range.
+			u32 near = current.LeftOrFirst, far = current.LeftOrFirst + 1;
+			f32 nearDistance = IntersectRay(ray.Origin, inverseDirection, m_Nodes[near].Min, m_Nodes[near].Max, closest);
+			f32 farDistance  = IntersectRay(ray.Origin, inverseDirection, m_Nodes[far].Min, m_Nodes[far].Max, closest);
+			if (farDistance < nearDistance)
+			{
+				std::swap(near, far);
+				std::swap(nearDistance, farDistance);
+			}
+
+			if (nearDistance >= closest)
+			{
+				node = stackSize > 0 ? stack[--stackSize] : InvalidIndex;
+				continue;
+			}
+
+			node = near;
+			if (farDistance < closest)
+			{
+				VULC_ASSERT(stackSize < TraversalStackSize, "BVH traversal stack overflow");
+				stack[stackSize++] = far;
+			}
+		}
+	}
+
+	for (const u32 objectID : m_Pending)
+		testObject(objectID);
+
+	return hit;
+}
+
+void BVH::Raycast(std::span<const Ray> rays, std::span<RayHit> outHits, JobSystem* jobSystem) const
+{
+	VULC_ASSERT(outHits.size() >= rays.size(), "Not enough space for {} ray hits", rays.size());
+
+	auto castRange = [&](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; i++)
+			outHits[i] = Raycast(rays[i]);
+	};
+
+	if (jobSystem)
+		jobSystem->ParallelFor(static_cast<u32>(rays.size()), castRange, QueryBatchSize);
+	else
+		castRange(0, static_cast<u32>(rays.size()));
+}
+
+void BVH::QueryAABB(const AABB& bounds, std::vector<u32>& outObjects) const
+{
+	if (!m_Nodes.empty() && bounds.OverlapsWith(AABB(m_Nodes[0].Min, m_Nodes[0].Max)))
+	{
+		u32 stack[TraversalStackSize];
+		u32 stackSize      = 0;
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0)
+		{
+			const Node& current = m_Nodes[stack[--stackSize]];
+			if (current.IsLeaf())
+			{
+				for (u32 i = 0; i < current.Count; i++)
+				{
+					const u32 objectID = m_ObjectIndices[current.LeftOrFirst + i];
+					if (bounds.OverlapsWith(m_ObjectBounds[objectID]))
+						outObjects.push_back(objectID);
+				}
+				continue;
+			}
+
+			for (u32 child = current.LeftOrFirst; child < current.LeftOrFirst + 2; child++)
+			{
+				if (bounds.OverlapsWith(AABB(m_Nodes[child].Min, m_Nodes[child].Max)))
+				{
+					VULC_ASSERT(stackSize < TraversalStackSize, "BVH traversal stack overflow");
+					stack[stackSize++] = child;
+				}
+			}
+		}
+	}
+
+	for (const u32 objectID : m_Pending)
+	{
+		if (bounds.OverlapsWith(m_ObjectBounds[objectID]))
+			outObjects.push_back(objectID);
+	}
+}
+
+void BVH::QueryAABB(std::span<const AABB> bounds, std::vector<std::vector<u32>>& outObjects,
+                    JobSystem* jobSystem) const
+{
+	outObjects.resize(bounds.size());
+
+	auto queryRange = [&](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; i++)
+		{
+			outObjects[i].clear();
+			QueryAABB(bounds[i], outObjects[i]);
+		}
+	};
+
+	if (jobSystem)
+		jobSystem->ParallelFor(static_cast<u32>(bounds.size()), queryRange, QueryBatchSize);
+	else
+		queryRange(0, static_cast<u32>(bounds.size()));
+}
+
+void BVH::Rebuild()
+{
+	const u32 objectCount = static_cast<u32>(m_ObjectBounds.size());
+
+	m_ObjectLeaf.assign(objectCount, InvalidIndex);
+	m_ObjectIndices.clear();
+	m_ObjectIndices.reserve(objectCount);
+	for (u32 i = 0; i < objectCount; i++)
+	{
+		// Removed objects (empty boxes) don't need to be in the tree at all.
+		if (m_ObjectBounds[i].IsValid())
+			m_ObjectIndices.push_back(i);
+	}
+
+	m_Nodes.clear();
+	m_DirtyLeaves.clear();
+	if (m_ObjectIndices.empty())
+	{
+		m_Parents.clear();
+		m_LeafDirty.clear();
+		m_InternalAreaSum = 0.0f;
+		m_LeafAreaSum     = 0.0f;
+		m_BuildCost       = 0.0f;
+		UpdateBuildStats();
+		return;
+	}
+
+	// A binary tree with N leaves has 2N - 1 nodes. Node 1 is left unused so that sibling pairs start on even indices
+	// and share a cache line.
+	m_Nodes.reserve(m_ObjectIndices.size() * 2);
+	m_Nodes.push_back({.LeftOrFirst = 0, .Count = static_cast<u32>(m_ObjectIndices.size())});
+	m_Nodes.push_back({});
+	m_Parents.assign(2, InvalidIndex);
+	UpdateNodeBounds(0);
+	Subdivide(0);
+
+	m_LeafDirty.assign(m_Nodes.size(), false);
+	m_InternalAreaSum = 0.0f;
+	m_LeafAreaSum     = 0.0f;
+	for (u32 i = 0; i < m_Nodes.size(); i++)
+	{
+		const Node& node = m_Nodes[i];
+		if (i == 1)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			m_LeafAreaSum += SurfaceArea(node.Min, node.Max) * static_cast<f32>(node.Count);
+			for (u32 object = 0; object < node.Count; object++)
+				m_ObjectLeaf[m_ObjectIndices[node.LeftOrFirst + object]] = i;
+		}
+		else
+		{
+			m_InternalAreaSum += SurfaceArea(node.Min, node.Max);
+		}
+	}
+
+	m_BuildCost = CalculateCost();
+	UpdateBuildStats();
+}
+
+void BVH::UpdateBuildStats()
+{
+	m_Stats.ObjectCount    = static_cast<u32>(m_ObjectIndices.size());
+	m_Stats.NodeCount      = static_cast<u32>(m_Nodes.size());
+	m_Stats.PendingObjects = static_cast<u32>(m_Pending.size());
+	m_Stats.CostRatio      = 1.0f;
+	m_Stats.Rebuilds++;
+}
+
+void BVH::Subdivide(u32 rootIndex)
+{
+	// Explicit stack rather than recursion, so degenerate input can't blow the call stack.
+	std::vector<std::pair<u32, u32>> stack = {{rootIndex, 0}}; // Node, depth.
+	while (!stack.empty())
+	{
+		const auto [nodeIndex, depth] = stack.back();
+		stack.pop_back();
+
+		Node& node = m_Nodes[nodeIndex];
+		if (node.Count <= MaxLeafSize || depth >= MaxTreeDepth)
+			continue;
+
+		u32       axis      = 0;
+		f32       split     = 0.0f;
+		const f32 splitCost = FindBestSplit(node, axis, split);
+		const f32 leafCost  = IntersectionCost * static_cast<f32>(node.Count) * SurfaceArea(node.Min, node.Max);
+		if (splitCost >= leafCost)
+			continue;
+
+		// Partition the node's objects around the split plane.
+		const auto begin = m_ObjectIndices.begin() + node.LeftOrFirst;
+		const auto middle = std::partition(begin, begin + node.Count, [&](u32 objectID)
+		{
+			return m_ObjectBounds[objectID].GetCenter()[axis] < split;
+		});
+		const u32 i = static_cast<u32>(middle - m_ObjectIndices.begin());
+
+		const u32 leftCount = i - node.LeftOrFirst;
+		if (leftCount == 0 || leftCount == node.Count)
+			continue;
+
+		const u32 leftIndex = static_cast<u32>(m_Nodes.size());
+		const u32 first     = node.LeftOrFirst;
+		const u32 count     = node.Count;
+		node.LeftOrFirst    = leftIndex;
+		node.Count          = 0;
+
+		// Careful: this may reallocate, so `node` is dead from here.
+		m_Nodes.push_back({.LeftOrFirst = first, .Count = leftCount});
+		m_Nodes.push_back({.LeftOrFirst = i, .Count = count - leftCount});
+		m_Parents.push_back(nodeIndex);
+		m_Parents.push_back(nodeIndex);
+		UpdateNodeBounds(leftIndex);
+		UpdateNodeBounds(leftIndex + 1);
+
+		stack.emplace_back(leftIndex, depth + 1);
+		stack.emplace_back(leftIndex + 1, depth + 1);
+	}
+}
+
+f32 BVH::FindBestSplit(const Node& node, u32& outAxis, f32& outSplit) const
+{
+	f32 bestCost = std::numeric_limits<f32>::max();
+
+	// Bin by centroid, not by box, so the bins are a partition of the objects.
+	AABB centroidBounds;
+	for (u32 i = 0; i < node.Count; i++)
+		centroidBounds.Expand(m_ObjectBounds[m_ObjectIndices[node.LeftOrFirst + i]].GetCenter());
+
+	for (u32 axis = 0; axis < 3; axis++)
+	{
+		const f32 boundsMin = centroidBounds.Min[axis];
+		const f32 boundsMax = centroidBounds.Max[axis];
+		if (boundsMin == boundsMax)
+			continue;
+
+		struct Bin
+		{
+			AABB Bounds;
+			u32  Count = 0;
+		} bins[BinCount];
+
+		const f32 scale = static_cast<f32>(BinCount) / (boundsMax - boundsMin);
+		for (u32 i = 0; i < node.Count; i++)
+		{
+			const AABB& bounds = m_ObjectBounds[m_ObjectIndices[node.LeftOrFirst + i]];
+			const u32   bin    = std::min(BinCount - 1, static_cast<u32>((bounds.GetCenter()[axis] - boundsMin) * scale));
+			bins[bin].Count++;
+			bins[bin].Bounds.Expand(bounds);
+		}
+
+		// Sweep from both sides to get the area and count on each side of every bin boundary.
+		f32  leftArea[BinCount - 1], rightArea[BinCount - 1];
+		u32  leftCount[BinCount - 1], rightCount[BinCount - 1];
+		AABB leftBox, rightBox;
+		u32  leftSum = 0, rightSum = 0;
+		for (u32 i = 0; i < BinCount - 1; i++)
+		{
+			leftSum += bins[i].Count;
+			leftCount[i] = leftSum;
+			leftBox.Expand(bins[i].Bounds);
+			leftArea[i] = SurfaceArea(leftBox.Min, leftBox.Max);
+
+			rightSum += bins[BinCount - 1 - i].Count;
+			rightCount[BinCount - 2 - i] = rightSum;
+			rightBox.Expand(bins[BinCount - 1 - i].Bounds);
+			rightArea[BinCount - 2 - i] = SurfaceArea(rightBox.Min, rightBox.Max);
+		}
+
+		const f32 binWidth = (boundsMax - boundsMin) / static_cast<f32>(BinCount);
+		for (u32 i = 0; i < BinCount - 1; i++)
+		{
+			const f32 cost = static_cast<f32>(leftCount[i]) * leftArea[i] + static_cast<f32>(rightCount[i]) * rightArea[i];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				outAxis  = axis;
+				outSplit = boundsMin + binWidth * static_cast<f32>(i + 1);
+			}
+		}
+	}
+
+	// Both costs are scaled by the node's area, which saves dividing every candidate by it. Splitting means visiting
+	// this node as well as testing the objects on each side, which is what keeps small nodes as leaves.
+	if (bestCost == std::numeric_limits<f32>::max())
+		return bestCost;
+	return TraversalCost * SurfaceArea(node.Min, node.Max) + IntersectionCost * bestCost;
+}
+
+void BVH::UpdateNodeBounds(u32 nodeIndex)
+{
+	Node& node = m_Nodes[nodeIndex];
+	AABB  bounds;
+	if (node.IsLeaf())
+	{
+		for (u32 i = 0; i < node.Count; i++)
+			bounds.Expand(m_ObjectBounds[m_ObjectIndices[node.LeftOrFirst + i]]);
+	}
+	else
+	{
+		const Node& left  = m_Nodes[node.LeftOrFirst];
+		const Node& right = m_Nodes[node.LeftOrFirst + 1];
+		bounds            = AABB(glm::min(left.Min, right.Min), glm::max(left.Max, right.Max));
+	}
+
+	node.Min = bounds.Min;
+	node.Max = bounds.Max;
+}
+
+f32 BVH::CalculateCost() const
+{
+	const f32 rootArea = m_Nodes.empty() ? 0.0f : SurfaceArea(m_Nodes[0].Min, m_Nodes[0].Max);
+	if (rootArea <= 0.0f)
+		return 0.0f;
+
+	return (TraversalCost * m_InternalAreaSum + IntersectionCost * m_LeafAreaSum) / rootArea;
+}
+
+f32 BVH::IntersectRay(const glm::vec3& origin, const glm::vec3& inverseDirection, const glm::vec3& min,
+                      const glm::vec3& max, f32 maxDistance)
+{
+	const glm::vec3 t1   = (min - origin) * inverseDirection;
+	const glm::vec3 t2   = (max - origin) * inverseDirection;
+	const glm::vec3 tMin = glm::min(t1, t2);
+	const glm::vec3 tMax = glm::max(t1, t2);
+
+	const f32 entry = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+	const f32 exit  = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+	return entry <= exit ? entry : std::numeric_limits<f32>::max();
+}
@@ -0,0 +1,95 @@
+#include "vulcpch.h"
+#include "Core/Compression/LZ4.h"
+
+namespace
+{
+	constexpr size_t MinMatch = 4;
+
+	// Lengths of 15 carry on in the following bytes, each adding up to 255, until one's less than 255.
+	FORCEINLINE bool ReadLength(const u8*& in, const u8* inEnd, size_t& length)
+	{
+		if (length != 15)
+			return true;
+
+		u8 next;
+		do
+		{
+			if (in >= inEnd)
+				return false;
+			next = *in++;
+			length += next;
+		} while (next == 255);
+
+		return true;
+	}
+}
+
+bool LZ4::DecompressBlock(std::span<const u8> source, std::span<u8> destination)
+{
+	const u8* in     = source.data();
+	const u8* inEnd  = in + source.size();
+	u8*       out    = destination.data();
+	u8*       outEnd = out + destination.size();
+
+	// Each sequence is a run of literals, then a match copied from earlier in the output. The last sequence is
+	// literals only, and ends the block.
+	while (in < inEnd)
+	{
+		const u8 token = *in++;
+
+		size_t literalLength = token >> 4;
+		if (!ReadLength(in, inEnd, literalLength))
+			return false;
+		if (literalLength > static_cast<size_t>(inEnd - in) || literalLength > static_cast<size_t>(outEnd - out))
+			return false;
+		if (literalLength > 0)
+			std::memcpy(out, in, literalLength);
+		in  += literalLength;
+		out += literalLength;
+
+		if (in == inEnd)
+			break;
+
+		if (inEnd - in < 2)
+			return false;
+		const size_t offset = in[0] | (in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > static_cast<size_t>(out - destination.data()))
+			return false;
+
+		size_t matchLength = token & 0xF;
+		if (!ReadLength(in, inEnd, matchLength))
+			return false;
+		matchLength += MinMatch;
+		if (matchLength > static_cast<size_t>(outEnd - out))
+			return false;
+
+		// Matches can overlap what they're writing (an offset of 1 repeats the last byte), in which case they have
+		// to be copied in steps no longer than the offset, so each step reads what the last one wrote.
+		const u8* match = out - offset;
+		if (offset >= matchLength)
+		{
+			std::memcpy(out, match, matchLength);
+			out += matchLength;
+		}
+		else if (offset >= 8)
+		{
+			u8* const end = out + matchLength;
+			while (out < end)
+			{
+				const size_t step = std::min<size_t>(offset, end - out);
+				std::memcpy(out, match, step);
+				out   += step;
+				match += step;
+			}
+		}
+		else
+		{
+			for (size_t i = 0; i < matchLength; i++)
+				out[i] = match[i];
+			out += matchLength;
+		}
+	}
+
+	return out == outEnd;
+}
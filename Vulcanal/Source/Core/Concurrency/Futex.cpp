@@ -0,0 +1,93 @@
+#include "vulcpch.h"
+#include "Core/Concurrency/Futex.h"
+
+#include <chrono>
+#include <thread>
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(VULC_PLATFORM_LINUX)
+	#include <cerrno>
+	#include <climits>
+	#include <ctime>
+	#include <linux/futex.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+// The kernel only sees the word's address, so std::atomic<u32> has to be nothing but the u32 itself.
+static_assert(sizeof(std::atomic<u32>) == sizeof(u32) && std::atomic<u32>::is_always_lock_free);
+
+namespace
+{
+#if defined(VULC_PLATFORM_LINUX)
+	// The _PRIVATE ops skip the shared-mapping lookup, since none of our words are shared between processes.
+	long FutexCall(std::atomic<u32>& word, int op, u32 value, const timespec* timeout = nullptr)
+	{
+		return syscall(SYS_futex, reinterpret_cast<u32*>(&word), op, value, timeout, nullptr, 0);
+	}
+#endif
+}
+
+namespace Futex
+{
+	void Wait(std::atomic<u32>& word, u32 expected)
+	{
+#if defined(VULC_PLATFORM_LINUX)
+		// EAGAIN (it had already changed) and EINTR both just mean "re-check", which the caller does anyway.
+		FutexCall(word, FUTEX_WAIT_PRIVATE, expected);
+#elif defined(VULC_PLATFORM_WINDOWS)
+		WaitOnAddress(&word, &expected, sizeof(u32), INFINITE);
+#else
+		word.wait(expected, std::memory_order_relaxed);
+#endif
+	}
+
+	bool WaitFor(std::atomic<u32>& word, u32 expected, u64 timeoutNs)
+	{
+#if defined(VULC_PLATFORM_LINUX)
+		// FUTEX_WAIT's timeout is relative.
+		const timespec timeout = {
+			.tv_sec = static_cast<time_t>(timeoutNs / 1000000000), .tv_nsec = static_cast<long>(timeoutNs % 1000000000)
+		};
+		return FutexCall(word, FUTEX_WAIT_PRIVATE, expected, &timeout) == 0 || errno != ETIMEDOUT;
+#elif defined(VULC_PLATFORM_WINDOWS)
+		const DWORD timeoutMs = static_cast<DWORD>(std::min<u64>((timeoutNs + 999999) / 1000000, INFINITE - 1));
+		return WaitOnAddress(&word, &expected, sizeof(u32), timeoutMs) || GetLastError() != ERROR_TIMEOUT;
+#else
+		// No timed wait on std::atomic, so poll.
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::nanoseconds(timeoutNs);
+		while (word.load(std::memory_order_relaxed) == expected)
+		{
+			if (std::chrono::steady_clock::now() >= deadline)
+				return false;
+			std::this_thread::yield();
+		}
+		return true;
+#endif
+	}
+
+	void WakeOne(std::atomic<u32>& word)
+	{
+#if defined(VULC_PLATFORM_LINUX)
+		FutexCall(word, FUTEX_WAKE_PRIVATE, 1);
+#elif defined(VULC_PLATFORM_WINDOWS)
+		WakeByAddressSingle(&word);
+#else
+		word.notify_one();
+#endif
+	}
+
+	void WakeAll(std::atomic<u32>& word)
+	{
+#if defined(VULC_PLATFORM_LINUX)
+		FutexCall(word, FUTEX_WAKE_PRIVATE, INT_MAX);
+#elif defined(VULC_PLATFORM_WINDOWS)
+		WakeByAddressAll(&word);
+#else
+		word.notify_all();
+#endif
+	}
+}
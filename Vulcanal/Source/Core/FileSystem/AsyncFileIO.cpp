@@ -0,0 +1,643 @@
+#include "vulcpch.h"
+#include "Core/FileSystem/AsyncFileIO.h"
+
+#include "Core/ThreadPool.h"
+
+#ifndef VULC_NO_IMGUI
+#include <imgui.h>
+#endif
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <cerrno>
+	#include <cstring>
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#if defined(VULC_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+		#define VULC_HAS_IO_URING
+		#include <linux/io_uring.h>
+		#include <pthread.h>
+		#include <sys/mman.h>
+		#include <sys/syscall.h>
+		#include <sys/uio.h>
+	#endif
+#endif
+
+namespace
+{
+	// Reads are split into pieces no bigger than this, which every platform's read call can take in one go.
+	constexpr u64 MaxReadSize = 1ull << 30;
+
+	// Where a short read that's got `done` bytes so far picks up again, or nothing if it's finished: it's got
+	// everything, or reached the end of the file. A direct read can only start on an aligned offset, so it goes back to
+	// the last aligned one and reads the part of that block it already has again.
+	std::optional<u64> ResumeShortRead(const AsyncFile& file, u64 offset, u64 done, u64 size)
+	{
+		if (done >= size || offset + done >= file.GetSize())
+			return std::nullopt;
+		if (file.IsDirect())
+			done -= (offset + done) % AsyncFileIO::DirectAlignment;
+		return done;
+	}
+
+	// A plain blocking read, for the thread pool fallback. Loops over short reads until it's got everything, or hit the
+	// end of the file.
+	s64 ReadAt(const AsyncFile& file, u64 offset, std::span<u8> destination)
+	{
+		u64 done = 0;
+		while (true)
+		{
+			const u64 toRead = std::min<u64>(destination.size() - done, MaxReadSize);
+#if defined(VULC_PLATFORM_WINDOWS)
+			OVERLAPPED overlapped = {};
+			overlapped.Offset     = static_cast<DWORD>(offset + done);
+			overlapped.OffsetHigh = static_cast<DWORD>((offset + done) >> 32);
+
+			DWORD read = 0;
+			if (!ReadFile(reinterpret_cast<HANDLE>(file.GetNativeHandle()), destination.data() + done,
+			              static_cast<DWORD>(toRead), &read, &overlapped))
+			{
+				if (GetLastError() == ERROR_HANDLE_EOF)
+					return static_cast<s64>(done);
+				return -static_cast<s64>(GetLastError());
+			}
+#else
+			const ssize_t read = pread(static_cast<int>(file.GetNativeHandle()), destination.data() + done, toRead,
+			                           static_cast<off_t>(offset + done));
+			if (read < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				return -errno;
+			}
+#endif
+			if (read == 0)
+				return static_cast<s64>(done);
+
+			const std::optional<u64> resume = ResumeShortRead(file, offset, done + static_cast<u64>(read),
+			                                                  destination.size());
+			if (!resume)
+				return static_cast<s64>(done + static_cast<u64>(read));
+			done = *resume;
+		}
+	}
+
+#ifdef VULC_HAS_IO_URING
+	// glibc doesn't wrap these, and we'd rather not depend on liburing for three calls.
+	int IOURingSetup(u32 entries, io_uring_params* params)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	int IOURingEnter(int ring, u32 toSubmit, u32 minComplete, u32 flags)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, ring, toSubmit, minComplete, flags, nullptr, 0));
+	}
+
+	int IOURingRegister(int ring, u32 opcode, const void* arg, u32 count)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_register, ring, opcode, arg, count));
+	}
+#endif
+}
+
+AsyncFile::~AsyncFile()
+{
+	Close();
+}
+
+AsyncFile::AsyncFile(AsyncFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+AsyncFile& AsyncFile::operator=(AsyncFile&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	Close();
+	m_Handle = std::exchange(other.m_Handle, InvalidHandle);
+	m_Size   = std::exchange(other.m_Size, 0);
+	m_Direct = std::exchange(other.m_Direct, false);
+	return *this;
+}
+
+bool AsyncFile::Open(const std::filesystem::path& path, bool direct)
+{
+	Close();
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	constexpr DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN;
+
+	HANDLE file = INVALID_HANDLE_VALUE;
+	if (direct)
+		file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		                   flags | FILE_FLAG_NO_BUFFERING, nullptr);
+	m_Direct = file != INVALID_HANDLE_VALUE;
+	if (!m_Direct)
+		file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		m_Direct = false;
+		return false;
+	}
+
+	m_Handle = reinterpret_cast<intptr_t>(file);
+	m_Size   = static_cast<u64>(size.QuadPart);
+#else
+	int file = -1;
+	#ifdef O_DIRECT
+	// Some file systems (tmpfs, for one) refuse O_DIRECT, in which case we'll settle for the cache.
+	if (direct)
+		file = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_DIRECT);
+	#endif
+	m_Direct = file >= 0;
+	if (!m_Direct)
+		file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		return false;
+
+	struct stat info = {};
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		m_Direct = false;
+		return false;
+	}
+
+	m_Handle = file;
+	m_Size   = static_cast<u64>(info.st_size);
+#endif
+
+	return true;
+}
+
+void AsyncFile::Close()
+{
+	if (m_Handle != InvalidHandle)
+	{
+#if defined(VULC_PLATFORM_WINDOWS)
+		CloseHandle(reinterpret_cast<HANDLE>(m_Handle));
+#else
+		close(static_cast<int>(m_Handle));
+#endif
+	}
+
+	m_Handle = InvalidHandle;
+	m_Size   = 0;
+	m_Direct = false;
+}
+
+#ifdef VULC_HAS_IO_URING
+// The kernel's side of the ring, mapped into our address space. We write submissions at the submission queue's tail,
+// and the kernel moves its head; it writes completions at the completion queue's tail, and we move its head.
+struct AsyncFileIO::IOURing
+{
+	int           Fd         = -1;
+	void*         SQRing     = nullptr;
+	size_t        SQRingSize = 0;
+	void*         CQRing     = nullptr;
+	size_t        CQRingSize = 0;
+	io_uring_sqe* SQEs       = nullptr;
+	size_t        SQEsSize   = 0;
+
+	u32* SQHead    = nullptr;
+	u32* SQTail    = nullptr;
+	u32  SQMask    = 0;
+	u32* SQArray   = nullptr;
+	u32  SQEntries = 0;
+
+	u32*          CQHead = nullptr;
+	u32*          CQTail = nullptr;
+	u32           CQMask = 0;
+	io_uring_cqe* CQEs   = nullptr;
+};
+#else
+struct AsyncFileIO::IOURing
+{
+	u32 SQEntries = 0;
+};
+#endif
+
+AsyncFileIO::AsyncFileIO(ThreadPool& threadPool, AsyncFileIOSpecification spec)
+	: m_ThreadPool(&threadPool), m_Specification(spec)
+{
+	// Aligned so they can take direct reads.
+	for (u32 i = 0; i < m_Specification.RegisteredBufferCount; i++)
+	{
+		m_Buffers.push_back(static_cast<u8*>(
+			::operator new(m_Specification.RegisteredBufferSize, std::align_val_t(DirectAlignment))));
+	}
+
+	if (!m_Specification.ForceThreadPool && InitIOURing())
+	{
+		m_CompletionThread = std::thread(&AsyncFileIO::CompletionLoop, this);
+		VULC_INFO("Async file I/O is using io_uring, {} reads deep", m_Ring->SQEntries);
+	}
+	else
+		VULC_INFO("Async file I/O is using the thread pool");
+}
+
+AsyncFileIO::~AsyncFileIO()
+{
+	WaitIdle();
+	ShutdownIOURing();
+
+	for (u8* buffer : m_Buffers)
+		::operator delete(buffer, std::align_val_t(DirectAlignment));
+}
+
+void AsyncFileIO::Read(AsyncReadRequest&& request)
+{
+	Read({&request, 1});
+}
+
+void AsyncFileIO::Read(std::span<AsyncReadRequest> requests)
+{
+	if (requests.empty())
+		return;
+
+	for (const AsyncReadRequest& request : requests)
+	{
+		VULC_ASSERT(request.File && request.File->IsOpen(), "Reading from a file that isn't open");
+		VULC_ASSERT(!request.File->IsDirect() ||
+		            (request.Offset % DirectAlignment == 0 && request.Destination.size() % DirectAlignment == 0 &&
+		             reinterpret_cast<uintptr_t>(request.Destination.data()) % DirectAlignment == 0),
+		            "Direct reads have to be aligned to {} bytes", DirectAlignment);
+		VULC_ASSERT(request.BufferIndex < 0 ||
+		            (static_cast<u32>(request.BufferIndex) < GetRegisteredBufferCount() &&
+		             request.Destination.data() >= m_Buffers[request.BufferIndex] &&
+		             request.Destination.data() + request.Destination.size() <=
+		             m_Buffers[request.BufferIndex] + m_Specification.RegisteredBufferSize),
+		            "A read into a registered buffer has to fit in it");
+	}
+
+	m_InFlightCount.fetch_add(static_cast<u32>(requests.size()), std::memory_order_relaxed);
+
+	if (!m_Ring)
+	{
+		for (AsyncReadRequest& request : requests)
+			ReadOnThreadPool(new PendingRead{.Request = std::move(request)});
+		return;
+	}
+
+	std::vector<PendingRead*> unsubmitted;
+	{
+		std::lock_guard lock(m_Mutex);
+		for (AsyncReadRequest& request : requests)
+			m_Queued.push_back(new PendingRead{.Request = std::move(request)});
+		SubmitQueued(unsubmitted);
+	}
+	FinishUnsubmitted(unsubmitted);
+}
+
+void AsyncFileIO::WaitIdle()
+{
+	std::unique_lock lock(m_Mutex);
+	m_Idle.wait(lock, [this]() { return m_InFlightCount.load(std::memory_order_acquire) == 0; });
+}
+
+std::span<u8> AsyncFileIO::GetRegisteredBuffer(u32 index) const
+{
+	VULC_ASSERT(index < GetRegisteredBufferCount(), "No registered buffer {}", index);
+	return {m_Buffers[index], m_Specification.RegisteredBufferSize};
+}
+
+void AsyncFileIO::OnDrawIMGui()
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Async File I/O");
+
+	if (IsUsingIOUring())
+		ImGui::Text("Backend: io_uring (%u deep)", m_Ring->SQEntries);
+	else
+		ImGui::Text("Backend: Thread Pool");
+	ImGui::Text("Registered Buffers: %u x %u KiB%s", GetRegisteredBufferCount(),
+	            m_Specification.RegisteredBufferSize / 1024,
+	            m_BuffersRegistered || m_Buffers.empty() ? "" : " (not registered with the kernel)");
+
+	ImGui::Text("In Flight: %u", GetInFlightCount());
+	ImGui::Text("Reads: %llu", static_cast<unsigned long long>(m_ReadCount.load(std::memory_order_relaxed)));
+	ImGui::Text("Failed: %llu", static_cast<unsigned long long>(m_FailedCount.load(std::memory_order_relaxed)));
+	ImGui::Text("Read: %.1f MiB", m_BytesRead.load(std::memory_order_relaxed) / (1024.0 * 1024.0));
+
+	ImGui::End();
+#endif
+}
+
+bool AsyncFileIO::InitIOURing()
+{
+#ifdef VULC_HAS_IO_URING
+	io_uring_params params = {};
+	const int       fd     = IOURingSetup(m_Specification.QueueDepth, &params);
+	if (fd < 0)
+	{
+		VULC_WARN("io_uring isn't available ({}), so file reads will block thread pool workers", strerror(errno));
+		return false;
+	}
+
+	m_Ring     = CreateScope<IOURing>();
+	m_Ring->Fd = fd;
+
+	// Plain reads (rather than readv) arrived alongside this feature, in 5.6.
+	if (!(params.features & IORING_FEAT_RW_CUR_POS))
+	{
+		VULC_WARN("The kernel's io_uring is too old for plain reads, so file reads will block thread pool workers");
+		ShutdownIOURing();
+		return false;
+	}
+
+	const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+	m_Ring->SQRingSize   = params.sq_off.array + params.sq_entries * sizeof(u32);
+	m_Ring->CQRingSize   = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (singleMap)
+		m_Ring->SQRingSize = m_Ring->CQRingSize = std::max(m_Ring->SQRingSize, m_Ring->CQRingSize);
+	m_Ring->SQEsSize = params.sq_entries * sizeof(io_uring_sqe);
+
+	auto mapRing = [fd](size_t size, off_t offset) -> void*
+	{
+		void* ring = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+		return ring == MAP_FAILED ? nullptr : ring;
+	};
+	m_Ring->SQRing = mapRing(m_Ring->SQRingSize, IORING_OFF_SQ_RING);
+	m_Ring->CQRing = singleMap ? m_Ring->SQRing : mapRing(m_Ring->CQRingSize, IORING_OFF_CQ_RING);
+	m_Ring->SQEs   = static_cast<io_uring_sqe*>(mapRing(m_Ring->SQEsSize, IORING_OFF_SQES));
+	if (!m_Ring->SQRing || !m_Ring->CQRing || !m_Ring->SQEs)
+	{
+		VULC_WARN("Couldn't map the io_uring ({}), so file reads will block thread pool workers", strerror(errno));
+		ShutdownIOURing();
+		return false;
+	}
+
+	u8* sq            = static_cast<u8*>(m_Ring->SQRing);
+	m_Ring->SQHead    = reinterpret_cast<u32*>(sq + params.sq_off.head);
+	m_Ring->SQTail    = reinterpret_cast<u32*>(sq + params.sq_off.tail);
+	m_Ring->SQMask    = *reinterpret_cast<u32*>(sq + params.sq_off.ring_mask);
+	m_Ring->SQArray   = reinterpret_cast<u32*>(sq + params.sq_off.array);
+	m_Ring->SQEntries = params.sq_entries;
+
+	u8* cq         = static_cast<u8*>(m_Ring->CQRing);
+	m_Ring->CQHead = reinterpret_cast<u32*>(cq + params.cq_off.head);
+	m_Ring->CQTail = reinterpret_cast<u32*>(cq + params.cq_off.tail);
+	m_Ring->CQMask = *reinterpret_cast<u32*>(cq + params.cq_off.ring_mask);
+	m_Ring->CQEs   = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+	// Registered buffers are pinned once, rather than on every read. That counts against RLIMIT_MEMLOCK, which is
+	// small by default on some distros, so it's fine if it fails; reads into them are just ordinary reads.
+	if (!m_Buffers.empty())
+	{
+		std::vector<iovec> buffers;
+		for (u8* buffer : m_Buffers)
+			buffers.push_back({.iov_base = buffer, .iov_len = m_Specification.RegisteredBufferSize});
+
+		m_BuffersRegistered = IOURingRegister(fd, IORING_REGISTER_BUFFERS, buffers.data(),
+		                                      static_cast<u32>(buffers.size())) == 0;
+		if (!m_BuffersRegistered)
+			VULC_WARN("Couldn't register {} I/O buffers with io_uring ({})", buffers.size(), strerror(errno));
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AsyncFileIO::ShutdownIOURing()
+{
+#ifdef VULC_HAS_IO_URING
+	if (!m_Ring)
+		return;
+
+	// A no-op with no read attached tells the completion thread to stop. Everything's finished by now, so the ring has
+	// room for it.
+	if (m_CompletionThread.joinable())
+	{
+		bool stopped;
+		{
+			std::vector<PendingRead*> unsubmitted;
+			std::lock_guard           lock(m_Mutex);
+			const u32       tail  = std::atomic_ref(*m_Ring->SQTail).load(std::memory_order_relaxed);
+			const u32       index = tail & m_Ring->SQMask;
+			io_uring_sqe&   sqe   = m_Ring->SQEs[index];
+			std::memset(&sqe, 0, sizeof(sqe));
+			sqe.opcode             = IORING_OP_NOP;
+			sqe.user_data          = 0;
+			m_Ring->SQArray[index] = index;
+			std::atomic_ref(*m_Ring->SQTail).store(tail + 1, std::memory_order_release);
+			stopped = EnterRing(1, unsubmitted);
+		}
+
+		// If the no-op never got to the kernel, the completion thread's waiting on a ring that'll never complete
+		// anything again. Better to leave it (and the ring, which it's still using) than to hang on it.
+		if (!stopped)
+		{
+			VULC_ERROR("Couldn't stop the async file I/O completion thread, so it's been abandoned");
+			m_CompletionThread.detach();
+			m_Ring.release();
+			return;
+		}
+		m_CompletionThread.join();
+	}
+
+	if (m_Ring->SQEs)
+		munmap(m_Ring->SQEs, m_Ring->SQEsSize);
+	if (m_Ring->CQRing && m_Ring->CQRing != m_Ring->SQRing)
+		munmap(m_Ring->CQRing, m_Ring->CQRingSize);
+	if (m_Ring->SQRing)
+		munmap(m_Ring->SQRing, m_Ring->SQRingSize);
+	close(m_Ring->Fd);
+	m_Ring.reset();
+#endif
+}
+
+void AsyncFileIO::SubmitQueued(std::vector<PendingRead*>& unsubmitted)
+{
+#ifdef VULC_HAS_IO_URING
+	// Never more in the ring than it has submission entries. The completion queue's twice the size, so it can't
+	// overflow either.
+	u32 toSubmit = 0;
+	while (!m_Queued.empty() && m_InRing < m_Ring->SQEntries)
+	{
+		PendingRead*            read    = m_Queued.front();
+		const AsyncReadRequest& request = read->Request;
+		const bool              fixed   = m_BuffersRegistered && request.BufferIndex >= 0;
+		m_Queued.pop_front();
+
+		const u32     tail  = std::atomic_ref(*m_Ring->SQTail).load(std::memory_order_relaxed);
+		const u32     index = tail & m_Ring->SQMask;
+		io_uring_sqe& sqe   = m_Ring->SQEs[index];
+		std::memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode    = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+		sqe.fd        = static_cast<s32>(request.File->GetNativeHandle());
+		sqe.off       = request.Offset + read->Done;
+		sqe.addr      = reinterpret_cast<u64>(request.Destination.data() + read->Done);
+		sqe.len       = static_cast<u32>(std::min<u64>(request.Destination.size() - read->Done, MaxReadSize));
+		sqe.buf_index = fixed ? static_cast<u16>(request.BufferIndex) : 0;
+		sqe.user_data = reinterpret_cast<u64>(read);
+
+		m_Ring->SQArray[index] = index;
+		std::atomic_ref(*m_Ring->SQTail).store(tail + 1, std::memory_order_release);
+		m_InRing++;
+		toSubmit++;
+	}
+
+	if (toSubmit > 0)
+		EnterRing(toSubmit, unsubmitted);
+#endif
+}
+
+bool AsyncFileIO::EnterRing(u32 toSubmit, std::vector<PendingRead*>& unsubmitted)
+{
+#ifdef VULC_HAS_IO_URING
+	u32 submitted = 0;
+	while (submitted < toSubmit)
+	{
+		const int result = IOURingEnter(m_Ring->Fd, toSubmit - submitted, 0, 0);
+		if (result >= 0)
+			submitted += result;
+		else if (errno == EAGAIN)
+			std::this_thread::yield(); // Out of kernel memory for the moment.
+		else if (errno != EINTR)
+		{
+			const s64 error = -errno;
+			VULC_ERROR("Failed to submit {} file reads to io_uring: {}", toSubmit - submitted, strerror(errno));
+
+			// Whatever the kernel hasn't consumed is still ours, between its head and our tail, and without a
+			// submission thread it only consumes when we enter the ring, which we do under the lock. So take them back,
+			// or they'd never complete, and nor would anything waiting for them.
+			const u32 head = std::atomic_ref(*m_Ring->SQHead).load(std::memory_order_acquire);
+			const u32 tail = std::atomic_ref(*m_Ring->SQTail).load(std::memory_order_relaxed);
+			for (u32 i = head; i != tail; i++)
+			{
+				const io_uring_sqe& sqe  = m_Ring->SQEs[m_Ring->SQArray[i & m_Ring->SQMask]];
+				PendingRead*        read = reinterpret_cast<PendingRead*>(sqe.user_data);
+				if (!read)
+					continue;
+				read->SubmitError = error;
+				unsubmitted.push_back(read);
+				m_InRing--;
+			}
+			std::atomic_ref(*m_Ring->SQTail).store(head, std::memory_order_release);
+			return false;
+		}
+	}
+#endif
+	return true;
+}
+
+void AsyncFileIO::FinishUnsubmitted(std::span<PendingRead* const> unsubmitted)
+{
+	for (PendingRead* read : unsubmitted)
+		FinishRead(read, read->SubmitError);
+}
+
+void AsyncFileIO::CompletionLoop()
+{
+#ifdef VULC_HAS_IO_URING
+	pthread_setname_np(pthread_self(), "Async File I/O");
+
+	std::vector<std::pair<u64, s32>> completions;
+	bool                             stopping = false;
+	while (!stopping)
+	{
+		// Sleeps until there's at least one completion.
+		if (IOURingEnter(m_Ring->Fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR)
+		{
+			VULC_ERROR("Failed to wait for io_uring completions: {}", strerror(errno));
+			break;
+		}
+
+		// Copied out and handed back to the kernel before running any callbacks, so it can reuse the entries sooner.
+		completions.clear();
+		u32       head = std::atomic_ref(*m_Ring->CQHead).load(std::memory_order_relaxed);
+		const u32 tail = std::atomic_ref(*m_Ring->CQTail).load(std::memory_order_acquire);
+		for (; head != tail; head++)
+		{
+			const io_uring_cqe& cqe = m_Ring->CQEs[head & m_Ring->CQMask];
+			completions.emplace_back(cqe.user_data, cqe.res);
+		}
+		std::atomic_ref(*m_Ring->CQHead).store(head, std::memory_order_release);
+
+		for (const auto& [userData, result] : completions)
+		{
+			if (userData == 0)
+				stopping = true;
+			else
+				OnReadCompleted(reinterpret_cast<PendingRead*>(userData), result);
+		}
+	}
+#endif
+}
+
+void AsyncFileIO::OnReadCompleted(PendingRead* read, s64 result)
+{
+#ifdef VULC_HAS_IO_URING
+	const bool                retry = result == -EAGAIN || result == -EINTR;
+	bool                      more  = false;
+	std::vector<PendingRead*> unsubmitted;
+
+	{
+		// Only touched under the lock, the one it was submitted under: the kernel passing it between threads is
+		// invisible to anything checking for races.
+		std::lock_guard lock(m_Mutex);
+
+		// A short read that isn't at the end of the file (the kernel's allowed to stop early) goes back for the rest.
+		if (result > 0)
+		{
+			const AsyncReadRequest&  request = read->Request;
+			const std::optional<u64> resume  = ResumeShortRead(*request.File, request.Offset, read->Done + result,
+			                                                   request.Destination.size());
+			more = resume.has_value();
+			if (more)
+				read->Done = *resume;
+		}
+
+		m_InRing--;
+		if (retry || more)
+			m_Queued.push_front(read);
+		SubmitQueued(unsubmitted);
+	}
+
+	if (!retry && !more)
+		FinishRead(read, result < 0 ? result : static_cast<s64>(read->Done + result));
+	FinishUnsubmitted(unsubmitted);
+#endif
+}
+
+void AsyncFileIO::FinishRead(PendingRead* read, s64 result)
+{
+	m_ReadCount.fetch_add(1, std::memory_order_relaxed);
+	if (result >= 0)
+		m_BytesRead.fetch_add(result, std::memory_order_relaxed);
+	else
+		m_FailedCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (read->Request.OnComplete)
+		read->Request.OnComplete(result);
+	delete read;
+
+	if (m_InFlightCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Idle.notify_all();
+	}
+}
+
+void AsyncFileIO::ReadOnThreadPool(PendingRead* read)
+{
+	m_ThreadPool->Submit([this, read]()
+	{
+		const AsyncReadRequest& request = read->Request;
+		FinishRead(read, ReadAt(*request.File, request.Offset, request.Destination));
+	});
+}
@@ -0,0 +1,126 @@
+#include "vulcpch.h"
+#include "Core/FileSystem/MappedFile.h"
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	Close();
+	m_Data = std::exchange(other.m_Data, nullptr);
+	m_Size = std::exchange(other.m_Size, 0);
+	m_Open = std::exchange(other.m_Open, false);
+#ifdef VULC_PLATFORM_WINDOWS
+	m_FileHandle    = std::exchange(other.m_FileHandle, nullptr);
+	m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+	return *this;
+}
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	// Windows won't map an empty file, so there's nothing to map.
+	m_FileHandle = file;
+	m_Size       = static_cast<size_t>(size.QuadPart);
+	m_Open       = true;
+	if (m_Size == 0)
+		return true;
+
+	m_MappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_MappingHandle)
+		m_Data = static_cast<const u8*>(MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!m_Data)
+	{
+		Close();
+		return false;
+	}
+#else
+	const int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (file < 0)
+		return false;
+
+	struct stat info = {};
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		return false;
+	}
+
+	m_Size = static_cast<size_t>(info.st_size);
+	m_Open = true;
+	if (m_Size > 0)
+	{
+		void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (data == MAP_FAILED)
+		{
+			close(file);
+			m_Size = 0;
+			m_Open = false;
+			return false;
+		}
+		m_Data = static_cast<const u8*>(data);
+	}
+
+	// The mapping keeps the file alive on its own.
+	close(file);
+#endif
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(VULC_PLATFORM_WINDOWS)
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_MappingHandle)
+		CloseHandle(m_MappingHandle);
+	if (m_FileHandle)
+		CloseHandle(m_FileHandle);
+	m_MappingHandle = nullptr;
+	m_FileHandle    = nullptr;
+#else
+	if (m_Data)
+		munmap(const_cast<u8*>(m_Data), m_Size);
+#endif
+
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Open = false;
+}
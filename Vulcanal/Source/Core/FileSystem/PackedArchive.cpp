@@ -0,0 +1,196 @@
+#include "vulcpch.h"
+#include "Core/FileSystem/PackedArchive.h"
+
+#include <atomic>
+
+#include "Core/Compression/LZ4.h"
+#include "Core/Jobs/JobSystem.h"
+
+bool PackedArchive::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	if (!m_File.Open(path))
+		return false;
+
+	// Everything's checked once here, so lookups can trust the tables without bounds checks.
+	const std::span<const u8> data = m_File.GetData();
+	auto fail = [&](std::string_view reason)
+	{
+		VULC_ERROR("Content archive {} is invalid: {}", path.string(), reason);
+		Close();
+		return false;
+	};
+
+	if (data.size() < sizeof(Header))
+		return fail("too small for a header");
+
+	Header header;
+	std::memcpy(&header, data.data(), sizeof(Header));
+	if (header.Magic != Magic)
+		return fail("bad magic");
+	if (header.Version != Version)
+		return fail(fmt::format("version {}, expected {}", header.Version, Version));
+	if (header.ChunkSize == 0)
+		return fail("no chunk size");
+	m_ChunkSize = header.ChunkSize;
+
+	const u64 entriesSize = static_cast<u64>(header.EntryCount) * sizeof(Entry);
+	if (header.EntriesOffset % alignof(Entry) != 0 || header.EntriesOffset > data.size() ||
+	    entriesSize > data.size() - header.EntriesOffset || header.PathsOffset > data.size())
+		return fail("tables out of bounds");
+
+	m_Entries = {reinterpret_cast<const Entry*>(data.data() + header.EntriesOffset), header.EntryCount};
+	m_Paths   = reinterpret_cast<const char*>(data.data() + header.PathsOffset);
+
+	const u64 pathsSize = data.size() - header.PathsOffset;
+	for (size_t i = 0; i < m_Entries.size(); i++)
+	{
+		const Entry& entry = m_Entries[i];
+		if (static_cast<u64>(entry.PathOffset) + entry.PathLength > pathsSize)
+			return fail("path out of bounds");
+		if (entry.Offset > data.size())
+			return fail(fmt::format("data for {} out of bounds", GetPath(entry)));
+		if (entry.Flags & ~CompressedFlag)
+			return fail(fmt::format("{} has flags {:#x}, which this version can't read", GetPath(entry), entry.Flags));
+		if (IsCompressed(entry))
+		{
+			// The chunk table's checked here; the chunks themselves are checked as they're decoded.
+			if (entry.Size / m_ChunkSize >= std::numeric_limits<u32>::max())
+				return fail(fmt::format("{} has too many chunks", GetPath(entry)));
+			const u64 tableSize = static_cast<u64>(GetChunkCount(entry)) * sizeof(u32);
+			if (entry.Offset % alignof(u32) != 0 || tableSize > data.size() - entry.Offset)
+				return fail(fmt::format("chunk table for {} out of bounds", GetPath(entry)));
+		}
+		else if (entry.Size > data.size() - entry.Offset)
+			return fail(fmt::format("data for {} out of bounds", GetPath(entry)));
+		if (i > 0 && m_Entries[i - 1].Hash > entry.Hash)
+			return fail("entries aren't sorted");
+	}
+
+	m_Path = path;
+	return true;
+}
+
+void PackedArchive::Close()
+{
+	m_File.Close();
+	m_Path.clear();
+	m_Entries   = {};
+	m_Paths     = nullptr;
+	m_ChunkSize = 0;
+}
+
+const PackedArchive::Entry* PackedArchive::FindEntry(std::string_view path) const
+{
+	const u32 hash = crc32(path);
+	auto      it   = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash,
+	                                  [](const Entry& entry, u32 value) { return entry.Hash < value; });
+
+	// Collisions are rare, but possible, so the path has the final say.
+	for (; it != m_Entries.end() && it->Hash == hash; ++it)
+	{
+		if (GetPath(*it) == path)
+			return &*it;
+	}
+
+	return nullptr;
+}
+
+std::string_view PackedArchive::GetPath(const Entry& entry) const
+{
+	return {m_Paths + entry.PathOffset, entry.PathLength};
+}
+
+std::span<const u8> PackedArchive::GetData(const Entry& entry) const
+{
+	VULC_ASSERT(!IsCompressed(entry), "Compressed entries have to be Read()");
+	return m_File.GetData().subspan(entry.Offset, entry.Size);
+}
+
+bool PackedArchive::Read(const Entry& entry, u64 offset, std::span<u8> destination, JobSystem* jobSystem) const
+{
+	if (offset > entry.Size || destination.size() > entry.Size - offset)
+		return false;
+
+	if (!IsCompressed(entry))
+	{
+		std::memcpy(destination.data(), GetData(entry).data() + offset, destination.size());
+		return true;
+	}
+
+	if (destination.empty())
+		return true;
+
+	const u64 readEnd    = offset + destination.size();
+	const u32 firstChunk = static_cast<u32>(offset / m_ChunkSize);
+	const u32 lastChunk  = static_cast<u32>((readEnd - 1) / m_ChunkSize);
+
+	std::atomic<bool> failed = false;
+	auto readChunks = [&](u32 begin, u32 end)
+	{
+		for (u32 chunk = begin; chunk < end && !failed.load(std::memory_order_relaxed); chunk++)
+		{
+			const u64 chunkBegin = static_cast<u64>(chunk) * m_ChunkSize;
+			const u64 chunkEnd   = std::min(chunkBegin + m_ChunkSize, entry.Size);
+			const u64 copyBegin  = std::max(chunkBegin, offset);
+			const u64 copyEnd    = std::min(chunkEnd, readEnd);
+
+			bool success;
+			if (copyBegin == chunkBegin && copyEnd == chunkEnd)
+			{
+				// The whole chunk's wanted, so it's decoded straight into place.
+				success = ReadChunk(entry, chunk, destination.subspan(chunkBegin - offset, chunkEnd - chunkBegin));
+			}
+			else
+			{
+				// Only the chunks at either end of the range can be partial.
+				thread_local std::vector<u8> scratch;
+				scratch.resize(chunkEnd - chunkBegin);
+				success = ReadChunk(entry, chunk, scratch);
+				if (success)
+					std::memcpy(destination.data() + (copyBegin - offset), scratch.data() + (copyBegin - chunkBegin),
+					            copyEnd - copyBegin);
+			}
+
+			if (!success)
+				failed.store(true, std::memory_order_relaxed);
+		}
+	};
+
+	const u32 chunkCount = lastChunk - firstChunk + 1;
+	if (jobSystem && chunkCount > 1)
+		jobSystem->ParallelFor(chunkCount, [&](u32 begin, u32 end) { readChunks(firstChunk + begin, firstChunk + end); });
+	else
+		readChunks(firstChunk, lastChunk + 1);
+
+	return !failed.load(std::memory_order_relaxed);
+}
+
+u32 PackedArchive::GetChunkCount(const Entry& entry) const
+{
+	return static_cast<u32>((entry.Size + m_ChunkSize - 1) / m_ChunkSize);
+}
+
+bool PackedArchive::ReadChunk(const Entry& entry, u32 chunk, std::span<u8> destination) const
+{
+	const std::span<const u8> data       = m_File.GetData();
+	const u32                 chunkCount = GetChunkCount(entry);
+	const auto*               chunkEnds  = reinterpret_cast<const u32*>(data.data() + entry.Offset);
+	const u64                 dataBegin  = entry.Offset + static_cast<u64>(chunkCount) * sizeof(u32);
+
+	const u64 begin = chunk > 0 ? chunkEnds[chunk - 1] : 0;
+	const u64 end   = chunkEnds[chunk];
+	if (begin > end || end > data.size() - dataBegin)
+		return false;
+
+	const std::span<const u8> source = data.subspan(dataBegin + begin, end - begin);
+	if (source.size() == destination.size())
+	{
+		// Stored, since compressing it didn't help.
+		std::memcpy(destination.data(), source.data(), source.size());
+		return true;
+	}
+
+	return LZ4::DecompressBlock(source, destination);
+}
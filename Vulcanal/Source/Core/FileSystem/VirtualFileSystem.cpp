@@ -0,0 +1,202 @@
+#include "vulcpch.h"
+#include "Core/FileSystem/VirtualFileSystem.h"
+
+#include <fstream>
+
+#ifndef VULC_NO_IMGUI
+#include <imgui.h>
+#endif
+
+VirtualFileSystem* VirtualFileSystem::s_Instance = nullptr;
+
+VirtualFileSystem::VirtualFileSystem(VirtualFileSystemSpecification spec, JobSystem* jobSystem)
+	: m_Specification(spec), m_JobSystem(jobSystem)
+{
+	VULC_ASSERT(!s_Instance, "Only one virtual file system at a time");
+	s_Instance = this;
+}
+
+VirtualFileSystem::~VirtualFileSystem()
+{
+	s_Instance = nullptr;
+}
+
+bool VirtualFileSystem::Mount(const std::filesystem::path& archivePath, std::string_view mountPoint)
+{
+	PackedArchive archive;
+	if (!archive.Open(archivePath))
+		return false;
+
+	std::string prefix = Normalise(mountPoint);
+	if (!prefix.empty() && prefix.back() != '/')
+		prefix += '/';
+
+	VULC_INFO("Mounted {} ({} files, {:.1f} MiB) at \"{}\"", archivePath.string(), archive.GetEntries().size(),
+	          archive.GetSize() / (1024.0 * 1024.0), prefix);
+	m_Mounts.insert(m_Mounts.begin(), {.Prefix = std::move(prefix), .Archive = std::move(archive)});
+	return true;
+}
+
+std::optional<std::span<const u8>> VirtualFileSystem::Map(std::string_view path) const
+{
+	const std::optional<ArchiveFile> file = FindInArchives(Normalise(path));
+	if (!file || PackedArchive::IsCompressed(*file->Entry))
+		return std::nullopt;
+
+	m_ArchiveReads.fetch_add(1, std::memory_order_relaxed);
+	return file->Archive->GetData(*file->Entry);
+}
+
+std::optional<std::vector<u8>> VirtualFileSystem::ReadFile(std::string_view path) const
+{
+	const std::string normalised = Normalise(path);
+
+	if (const std::optional<ArchiveFile> file = FindInArchives(normalised))
+	{
+		std::vector<u8> bytes(file->Entry->Size);
+		if (!ReadFromArchive(*file, 0, bytes))
+		{
+			VULC_ERROR("Failed to read {} from {}, it's corrupt", normalised, file->Archive->GetArchivePath().string());
+			return std::nullopt;
+		}
+		return bytes;
+	}
+
+	if (std::optional<std::vector<u8>> bytes = ReadLooseFile(normalised))
+	{
+		m_LooseReads.fetch_add(1, std::memory_order_relaxed);
+		return bytes;
+	}
+
+	m_Misses.fetch_add(1, std::memory_order_relaxed);
+	return std::nullopt;
+}
+
+bool VirtualFileSystem::ReadRange(std::string_view path, u64 offset, std::span<u8> destination) const
+{
+	const std::string normalised = Normalise(path);
+
+	if (const std::optional<ArchiveFile> file = FindInArchives(normalised))
+		return ReadFromArchive(*file, offset, destination);
+
+	std::ifstream file(normalised, std::ios::binary);
+	if (!file.is_open())
+	{
+		m_Misses.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	m_LooseReads.fetch_add(1, std::memory_order_relaxed);
+	file.seekg(static_cast<std::streamoff>(offset));
+	return static_cast<bool>(
+		file.read(reinterpret_cast<char*>(destination.data()), static_cast<std::streamsize>(destination.size())));
+}
+
+std::optional<u64> VirtualFileSystem::GetFileSize(std::string_view path) const
+{
+	const std::string normalised = Normalise(path);
+	if (const std::optional<ArchiveFile> file = FindInArchives(normalised))
+		return file->Entry->Size;
+
+	std::error_code error;
+	const u64       size = std::filesystem::file_size(normalised, error);
+	if (error)
+		return std::nullopt;
+	return size;
+}
+
+bool VirtualFileSystem::Exists(std::string_view path) const
+{
+	const std::string normalised = Normalise(path);
+	return FindInArchives(normalised) || IsLooseFile(normalised);
+}
+
+bool VirtualFileSystem::IsPacked(std::string_view path) const
+{
+	return FindInArchives(Normalise(path)).has_value();
+}
+
+void VirtualFileSystem::OnDrawIMGui()
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("File System");
+
+	ImGui::Text("Prefer Loose Files: %s", m_Specification.PreferLooseFiles ? "Yes" : "No");
+	ImGui::Text("Archive Reads: %llu", static_cast<unsigned long long>(m_ArchiveReads.load(std::memory_order_relaxed)));
+	ImGui::Text("Loose Reads: %llu", static_cast<unsigned long long>(m_LooseReads.load(std::memory_order_relaxed)));
+	ImGui::Text("Misses: %llu", static_cast<unsigned long long>(m_Misses.load(std::memory_order_relaxed)));
+	ImGui::Text("Decompressed: %.1f MiB", m_DecompressedBytes.load(std::memory_order_relaxed) / (1024.0 * 1024.0));
+
+	ImGui::SeparatorText("Mounts");
+	if (m_Mounts.empty())
+		ImGui::TextDisabled("None, everything's read from disk");
+	for (const MountedArchive& mount : m_Mounts)
+	{
+		const std::span<const PackedArchive::Entry> entries = mount.Archive.GetEntries();
+		const auto compressed = static_cast<size_t>(std::ranges::count_if(entries, &PackedArchive::IsCompressed));
+
+		ImGui::Text("\"%s\": %s", mount.Prefix.c_str(), mount.Archive.GetArchivePath().string().c_str());
+		ImGui::Text("    %zu files (%zu compressed), %.1f MiB", entries.size(), compressed,
+		            mount.Archive.GetSize() / (1024.0 * 1024.0));
+	}
+
+	ImGui::End();
+#endif
+}
+
+std::string VirtualFileSystem::Normalise(std::string_view path)
+{
+	std::string result(path);
+	std::ranges::replace(result, '\\', '/');
+	while (result.starts_with("./"))
+		result.erase(0, 2);
+	return result;
+}
+
+std::optional<VirtualFileSystem::ArchiveFile> VirtualFileSystem::FindInArchives(const std::string& normalisedPath) const
+{
+	if (m_Specification.PreferLooseFiles && IsLooseFile(normalisedPath))
+		return std::nullopt;
+
+	const std::string_view path = normalisedPath;
+	for (const MountedArchive& mount : m_Mounts)
+	{
+		if (!path.starts_with(mount.Prefix))
+			continue;
+
+		if (const PackedArchive::Entry* entry = mount.Archive.FindEntry(path.substr(mount.Prefix.size())))
+			return ArchiveFile{.Archive = &mount.Archive, .Entry = entry};
+	}
+
+	return std::nullopt;
+}
+
+bool VirtualFileSystem::ReadFromArchive(const ArchiveFile& file, u64 offset, std::span<u8> destination) const
+{
+	m_ArchiveReads.fetch_add(1, std::memory_order_relaxed);
+	if (PackedArchive::IsCompressed(*file.Entry))
+		m_DecompressedBytes.fetch_add(destination.size(), std::memory_order_relaxed);
+
+	return file.Archive->Read(*file.Entry, offset, destination, m_JobSystem);
+}
+
+bool VirtualFileSystem::IsLooseFile(const std::string& path)
+{
+	std::error_code error;
+	return std::filesystem::is_regular_file(path, error);
+}
+
+std::optional<std::vector<u8>> VirtualFileSystem::ReadLooseFile(const std::string& path)
+{
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open())
+		return std::nullopt;
+
+	std::vector<u8> bytes(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!file)
+		return std::nullopt;
+
+	return bytes;
+}
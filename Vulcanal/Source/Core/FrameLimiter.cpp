@@ -0,0 +1,66 @@
+#include "vulcpch.h"
+#include "Core/FrameLimiter.h"
+
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	constexpr std::chrono::microseconds SleepStep = std::chrono::microseconds(1000);
+
+	// Enough samples to be confident in, while still adapting if the system's timer behaviour changes.
+	constexpr u64 MaxSleepSamples = 1000;
+}
+
+void FrameLimiter::SetTargetFrameRate(f64 frameRate)
+{
+	m_TargetFrameRate = std::max(frameRate, 0.0);
+	m_NextFrame       = {};
+}
+
+void FrameLimiter::Wait()
+{
+	if (m_TargetFrameRate <= 0.0)
+		return;
+
+	const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<f64>(1.0 / m_TargetFrameRate));
+	const auto now    = Clock::now();
+
+	// On the first frame, or if we've fallen more than a frame behind, start again from now rather than rushing out a
+	// burst of frames to catch up.
+	if (m_NextFrame == Clock::time_point() || now - m_NextFrame > period)
+		m_NextFrame = now;
+	else
+		SleepUntil(m_NextFrame);
+
+	m_NextFrame += period;
+}
+
+void FrameLimiter::SleepUntil(Clock::time_point time)
+{
+	while (true)
+	{
+		// Mean plus one standard deviation, so only the odd unlucky sleep overshoots.
+		const f64 estimate  = m_SleepMean + std::sqrt(m_SleepM2 / static_cast<f64>(m_SleepCount));
+		const f64 remaining = std::chrono::duration<f64>(time - Clock::now()).count();
+		if (remaining <= estimate)
+			break;
+
+		const auto start = Clock::now();
+		std::this_thread::sleep_for(SleepStep);
+		const f64 observed = std::chrono::duration<f64>(Clock::now() - start).count();
+
+		if (m_SleepCount >= MaxSleepSamples)
+		{
+			m_SleepCount = 1;
+			m_SleepM2    = 0.0;
+		}
+		m_SleepCount++;
+		const f64 delta = observed - m_SleepMean;
+		m_SleepMean += delta / static_cast<f64>(m_SleepCount);
+		m_SleepM2 += delta * (observed - m_SleepMean);
+	}
+
+	while (Clock::now() < time)
+		std::this_thread::yield();
+}
@@ -0,0 +1,342 @@
+#include "vulcpch.h"
+#include "Core/Jobs/JobSystem.h"
+
+#if defined(VULC_PLATFORM_WINDOWS)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(VULC_PLATFORM_LINUX)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+struct Job
+{
+	JobFunction Function;
+	JobCounter* Counter = nullptr;
+};
+
+namespace
+{
+	// Enough for stealing to even out uneven batches, without so many that scheduling them costs more than running them.
+	constexpr u32 BatchesPerThread = 4;
+	// How many times an idle worker looks for work before going to sleep. Waking a sleeping thread takes a syscall
+	// and tens of microseconds, which is a lot next to most jobs, so it's worth hanging on for a moment first.
+	constexpr u32 SpinsBeforeSleeping = 64;
+
+	struct ThreadInfo
+	{
+		const JobSystem* System = nullptr;
+		s32              Index  = -1;
+		u32              Random = 0; // For picking who to steal from.
+	};
+	thread_local ThreadInfo s_CurrentThread;
+
+	u32 NextRandom()
+	{
+		// Xorshift. Only has to spread the thieves out, not be any good.
+		u32& x = s_CurrentThread.Random;
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		return x;
+	}
+
+	void NameCurrentThread(const std::string& name)
+	{
+#if defined(VULC_PLATFORM_WINDOWS)
+		const std::wstring wideName(name.begin(), name.end());
+		SetThreadDescription(GetCurrentThread(), wideName.c_str());
+#elif defined(VULC_PLATFORM_LINUX)
+		// Linux caps names at 15 characters, and fails outright rather than truncating.
+		pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#endif
+	}
+
+	void PinCurrentThread(u32 core)
+	{
+		bool pinned = false;
+#if defined(VULC_PLATFORM_WINDOWS)
+		if (core < sizeof(DWORD_PTR) * 8)
+			pinned = SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << core) != 0;
+#elif defined(VULC_PLATFORM_LINUX)
+		if (core < CPU_SETSIZE)
+		{
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+			CPU_SET(core, &cpus);
+			pinned = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+		}
+#endif
+		if (!pinned)
+			VULC_WARN("Failed to pin job worker to core {}", core);
+	}
+}
+
+JobSystem::JobSystem(JobSystemSpecification spec)
+	: m_Specification(std::move(spec))
+{
+	u32 workerCount = m_Specification.WorkerCount;
+	if (workerCount == 0)
+		workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+	// The creating thread is thread 0, and the workers follow it.
+	m_Queues.reserve(workerCount + 1);
+	for (u32 i = 0; i < workerCount + 1; i++)
+		m_Queues.push_back(CreateScope<WorkStealingDeque<Job*>>());
+
+	VULC_ASSERT(s_CurrentThread.System == nullptr, "This thread already belongs to a job system");
+	s_CurrentThread = {.System = this, .Index = 0, .Random = 0x9E3779B9u};
+
+	m_Workers.reserve(workerCount);
+	for (u32 i = 1; i <= workerCount; i++)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+	// The workers drain whatever's left before they go.
+	m_Stopping.store(true);
+	Wake(true);
+
+	for (auto& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+
+	// Anything still in our own deque would've been stolen, but jobs held back by a dependency that never finished
+	// are stuck.
+	for (Job* job = FindJob(0); job; job = FindJob(0))
+		Execute(job);
+
+	if (s_CurrentThread.System == this)
+		s_CurrentThread = {};
+}
+
+void JobSystem::Run(JobFunction&& function, JobCounter* counter, JobCounter* dependency)
+{
+	auto* job = new Job{.Function = std::move(function), .Counter = counter};
+	if (counter)
+		counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency)
+	{
+		// Under the lock, so this can't slip in between the dependency reaching zero and it releasing its jobs.
+		std::lock_guard lock(dependency->m_Mutex);
+		if (dependency->m_Value.load(std::memory_order_acquire) != 0)
+		{
+			dependency->m_Waiting.push_back(job);
+			return;
+		}
+	}
+
+	Schedule(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	const s32 index = GetCurrentThreadIndex();
+	if (index < 0)
+	{
+		// Not one of ours, so there's no deque to work from; just block.
+		for (u32 value = counter.m_Value.load(std::memory_order_acquire); value != 0;
+		     value = counter.m_Value.load(std::memory_order_acquire))
+			counter.m_Value.wait(value, std::memory_order_acquire);
+	}
+	else
+	{
+		// Help out until it's done. If there's nothing to do, sleep until there is, or the counter finishes, which
+		// wakes us too as long as we've said we're waiting.
+		counter.m_Helpers.fetch_add(1);
+		while (true)
+		{
+			const u32 epoch = m_WakeEpoch.load();
+			if (counter.m_Value.load(std::memory_order_acquire) == 0)
+				break;
+
+			if (Job* job = FindJob(static_cast<u32>(index)))
+			{
+				Execute(job);
+				continue;
+			}
+
+			m_Sleeping.fetch_add(1);
+			if (m_WakeEpoch.load() == epoch && counter.m_Value.load() != 0)
+				m_WakeEpoch.wait(epoch);
+			m_Sleeping.fetch_sub(1);
+		}
+		counter.m_Helpers.fetch_sub(1);
+	}
+
+	// The last job may still be inside Signal, touching the counter, which the caller's about to destroy. It's done
+	// with it once it's let go of the lock.
+	std::lock_guard lock(counter.m_Mutex);
+}
+
+void JobSystem::ParallelFor(u32 count, const std::function<void(u32 begin, u32 end)>& func, u32 minBatchSize)
+{
+	if (count == 0)
+		return;
+
+	minBatchSize         = std::max(1u, minBatchSize);
+	const u32 batchCount = std::clamp(count / minBatchSize, 1u, GetThreadCount() * BatchesPerThread);
+	const u32 batchSize  = (count + batchCount - 1) / batchCount;
+
+	// Not worth waking anyone up for.
+	if (batchCount == 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	JobCounter counter;
+	for (u32 begin = batchSize; begin < count; begin += batchSize)
+	{
+		const u32 end = std::min(begin + batchSize, count);
+		Run([&func, begin, end]() { func(begin, end); }, &counter);
+	}
+
+	// Do the first batch ourselves, rather than pushing it only to pop it straight back off.
+	func(0, batchSize);
+	Wait(counter);
+}
+
+s32 JobSystem::GetCurrentThreadIndex() const
+{
+	return s_CurrentThread.System == this ? s_CurrentThread.Index : -1;
+}
+
+void JobSystem::WorkerLoop(u32 index)
+{
+	s_CurrentThread = {.System = this, .Index = static_cast<s32>(index), .Random = 0x9E3779B9u * (index + 1)};
+
+	NameCurrentThread(fmt::format("{} {}", m_Specification.Name, index));
+	if (m_Specification.PinThreads)
+		PinCurrentThread(index);
+
+	u32 idleSpins = 0;
+	while (true)
+	{
+		const u32 epoch = m_WakeEpoch.load();
+		if (Job* job = FindJob(index))
+		{
+			Execute(job);
+			idleSpins = 0;
+			continue;
+		}
+
+		if (m_Stopping.load())
+			break;
+
+		if (++idleSpins < SpinsBeforeSleeping)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Anyone who queues work after we last looked has bumped the epoch by now, or will notify us, since we're
+		// counted as sleeping before we check.
+		m_Sleeping.fetch_add(1);
+		if (m_WakeEpoch.load() == epoch && !m_Stopping.load())
+			m_WakeEpoch.wait(epoch);
+		m_Sleeping.fetch_sub(1);
+		idleSpins = 0;
+	}
+
+	s_CurrentThread = {};
+}
+
+void JobSystem::Schedule(Job* job)
+{
+	const s32 index = GetCurrentThreadIndex();
+	if (index >= 0)
+	{
+		m_Queues[index]->Push(job);
+	}
+	else
+	{
+		// Full means the workers are well behind; get them going and give them a moment to catch up.
+		while (!m_Injected.TryPush(job))
+		{
+			Wake(false);
+			std::this_thread::yield();
+		}
+	}
+
+	Wake(false);
+}
+
+void JobSystem::Execute(Job* job)
+{
+	job->Function();
+
+	JobCounter* counter = job->Counter;
+	delete job;
+	if (counter)
+		Signal(*counter);
+}
+
+void JobSystem::Signal(JobCounter& counter)
+{
+	// Only the decrement that reaches zero has to take the lock; the rest can't release anything.
+	u32 value = counter.m_Value.load(std::memory_order_relaxed);
+	while (value > 1)
+	{
+		if (counter.m_Value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+			return;
+	}
+
+	std::vector<Job*> released;
+	bool              wakeHelpers;
+	{
+		std::lock_guard lock(counter.m_Mutex);
+		if (counter.m_Value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			return; // Someone added a job in the meantime.
+
+		released.swap(counter.m_Waiting);
+		wakeHelpers = counter.m_Helpers.load() > 0;
+		counter.m_Value.notify_all();
+	}
+	// Past here, the counter may already be gone.
+
+	for (Job* job : released)
+		Schedule(job);
+
+	if (wakeHelpers)
+		Wake(true);
+}
+
+Job* JobSystem::FindJob(u32 index)
+{
+	if (std::optional<Job*> job = m_Queues[index]->Pop())
+		return *job;
+
+	if (std::optional<Job*> job = m_Injected.TryPop())
+		return *job;
+
+	// Go round everyone else once, starting somewhere random so the thieves don't all pile onto the same victim.
+	const u32 threadCount = GetThreadCount();
+	const u32 start       = NextRandom() % threadCount;
+	for (u32 i = 0; i < threadCount; i++)
+	{
+		const u32 victim = (start + i) % threadCount;
+		if (victim == index)
+			continue;
+
+		if (std::optional<Job*> job = m_Queues[victim]->Steal())
+			return *job;
+	}
+
+	return nullptr;
+}
+
+void JobSystem::Wake(bool all)
+{
+	m_WakeEpoch.fetch_add(1);
+	if (m_Sleeping.load() == 0)
+		return;
+
+	if (all)
+		m_WakeEpoch.notify_all();
+	else
+		m_WakeEpoch.notify_one();
+}
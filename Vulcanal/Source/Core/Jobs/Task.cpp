@@ -0,0 +1,37 @@
+#include "vulcpch.h"
+#include "Core/Jobs/Task.h"
+
+bool FileReadAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	if (!m_File.Open(m_Path))
+	{
+		VULC_WARN("Failed to open {}", m_Path.string());
+		return false;
+	}
+
+	// Nothing to wait for.
+	if (m_File.GetSize() == 0)
+	{
+		m_Data.emplace();
+		return false;
+	}
+
+	// We live in the suspended coroutine's frame, so the file and the buffer are safe to use until it's resumed, which
+	// isn't until the read's done with them.
+	m_Buffer.resize(static_cast<size_t>(m_File.GetSize()));
+	m_AsyncIO->Read({
+		.File        = &m_File,
+		.Destination = m_Buffer,
+		.OnComplete  = [this, handle](s64 result)
+		{
+			if (result == static_cast<s64>(m_Buffer.size()))
+				m_Data = std::move(m_Buffer);
+			else
+				VULC_WARN("Failed to read {} ({})", m_Path.string(), result);
+
+			// Off the I/O completion thread, which mustn't be held up running the rest of the task.
+			m_JobSystem->Run([handle]() { handle.resume(); });
+		},
+	});
+	return true;
+}
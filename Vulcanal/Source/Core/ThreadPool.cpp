@@ -0,0 +1,67 @@
+#include "vulcpch.h"
+#include "Core/ThreadPool.h"
+
+ThreadPool::ThreadPool(u32 threadCount)
+{
+	if (threadCount == 0)
+		threadCount = std::clamp(std::thread::hardware_concurrency() / 4, 2u, 4u);
+
+	m_Workers.reserve(threadCount);
+	for (u32 i = 0; i < threadCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_TaskAdded.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+	m_Workers.clear();
+}
+
+void ThreadPool::Submit(std::function<void()>&& task)
+{
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Tasks.push_back(std::move(task));
+	}
+	m_TaskAdded.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+	std::unique_lock lock(m_Mutex);
+	m_Idle.wait(lock, [this]() { return m_Tasks.empty() && m_ActiveTasks == 0; });
+}
+
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock lock(m_Mutex);
+			m_TaskAdded.wait(lock, [this]() { return m_Stopping || !m_Tasks.empty(); });
+			if (m_Stopping && m_Tasks.empty())
+				return;
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+			m_ActiveTasks++;
+		}
+
+		task();
+
+		{
+			std::lock_guard lock(m_Mutex);
+			m_ActiveTasks--;
+			if (m_Tasks.empty() && m_ActiveTasks == 0)
+				m_Idle.notify_all();
+		}
+	}
+}
@@ -4,6 +4,8 @@
 #include <iomanip>
 #include <spdlog/sinks/basic_file_sink.h>
 
+#include "Core/AsyncLogSink.h"
+
 std::shared_ptr<spdlog::logger> g_VulcanalLogger;
 
 void InitLog(const char* prefPath)
@@ -38,8 +40,11 @@ void InitLog(const char* prefPath)
 	sinks.push_back(std::make_shared<spdlog::sinks::basic_file_sink_mt>(path));
 	sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
 
-	g_VulcanalLogger = std::make_shared<spdlog::logger>("Vulcanal", std::begin(sinks), std::end(sinks));
+	// The file and console are written from a thread of their own, so logging doesn't stall whoever's doing it.
+	// Errors wait until they're written, so an assertion's message is out before it breaks or aborts.
+	g_VulcanalLogger = std::make_shared<spdlog::logger>("Vulcanal", std::make_shared<AsyncLogSink>(std::move(sinks)));
 	g_VulcanalLogger->set_level(spdlog::level::trace);
+	g_VulcanalLogger->flush_on(spdlog::level::err);
 }
 
 void ShutdownLog()
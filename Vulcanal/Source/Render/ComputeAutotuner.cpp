@@ -0,0 +1,215 @@
+#include "vulcpch.h"
+#include "Render/ComputeAutotuner.h"
+
+#include <fstream>
+
+#include "Render/Renderer.h"
+
+void ComputeAutotuner::Init(Renderer* renderer, std::filesystem::path cachePath)
+{
+	m_Renderer  = renderer;
+	m_CachePath = std::move(cachePath);
+
+	// The best shape can change with a driver update as easily as with a new GPU, so both go in the key.
+	VkPhysicalDeviceVulkan11Properties properties11 = {};
+	properties11.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext                       = &properties11;
+	vkGetPhysicalDeviceProperties2(m_Renderer->GetGPU(), &properties);
+
+	m_DeviceKey.clear();
+	for (u8 byte : properties11.deviceUUID)
+		m_DeviceKey += fmt::format("{:02x}", byte);
+	m_DeviceKey += fmt::format("-{:x}", properties.properties.driverVersion);
+
+	if (m_Renderer->GetTimestampPeriod() > 0.0f)
+	{
+		VkQueryPoolCreateInfo queryPoolInfo = {};
+		queryPoolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		queryPoolInfo.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+		queryPoolInfo.queryCount            = 2;
+		VK_CHECK(vkCreateQueryPool(m_Renderer->GetDevice(), &queryPoolInfo, nullptr, &m_QueryPool));
+	}
+
+	LoadCache();
+}
+
+void ComputeAutotuner::Shutdown()
+{
+	if (m_QueryPool)
+		vkDestroyQueryPool(m_Renderer->GetDevice(), m_QueryPool, nullptr);
+	m_QueryPool = nullptr;
+	m_Cache.clear();
+	m_Results.clear();
+}
+
+std::optional<WorkgroupSize> ComputeAutotuner::Find(const std::string& name)
+{
+	auto it = m_Cache.find(GetCacheKey(name));
+	if (it == m_Cache.end())
+		return std::nullopt;
+
+	m_Results[name] = {.Size = it->second, .FromCache = true};
+	return it->second;
+}
+
+WorkgroupSize ComputeAutotuner::Tune(const TunableKernel& kernel)
+{
+	VULC_ASSERT(kernel.Name.find(' ') == std::string::npos, "Tunable kernel names can't have spaces: {}", kernel.Name);
+
+	if (!CanTune())
+		return kernel.Fallback;
+
+	VkDevice      device   = m_Renderer->GetDevice();
+	WorkgroupSize best     = kernel.Fallback;
+	f64           bestTime = std::numeric_limits<f64>::max();
+
+	for (const WorkgroupSize& size : GetCandidates(kernel))
+	{
+		VkPipeline pipeline = kernel.CreatePipeline(size);
+		const f64  time     = TimeVariant(kernel, pipeline, size);
+		vkDestroyPipeline(device, pipeline, nullptr); // Fine, since ImmediateSubmit waits.
+
+		VULC_INFO("Autotuning {}: {}x{}x{} takes {:.4f} ms", kernel.Name, size.X, size.Y, size.Z, time);
+		if (time < bestTime)
+		{
+			bestTime = time;
+			best     = size;
+		}
+	}
+
+	VULC_INFO("Autotuning {}: picked {}x{}x{}", kernel.Name, best.X, best.Y, best.Z);
+
+	m_Cache[GetCacheKey(kernel.Name)] = best;
+	m_Results[kernel.Name]            = {.Size = best, .Time = static_cast<f32>(bestTime), .FromCache = false};
+	SaveCache();
+
+	return best;
+}
+
+void ComputeAutotuner::ClearCache()
+{
+	const std::string prefix = m_DeviceKey + ' ';
+	std::erase_if(m_Cache, [&prefix](const auto& entry) { return entry.first.starts_with(prefix); });
+	SaveCache();
+}
+
+void ComputeAutotuner::OnDrawIMGui()
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Compute Tuning");
+
+	ImGui::Checkbox("Tune Uncached Kernels", &m_Enabled);
+	if (!m_QueryPool)
+		ImGui::TextUnformatted("No timestamp support; using default workgroup sizes.");
+
+	for (const auto& [name, result] : m_Results)
+	{
+		if (result.FromCache)
+			ImGui::Text("%s: %ux%ux%u (cached)", name.c_str(), result.Size.X, result.Size.Y, result.Size.Z);
+		else
+			ImGui::Text("%s: %ux%ux%u (%.4f ms)", name.c_str(), result.Size.X, result.Size.Y, result.Size.Z,
+			            result.Time);
+	}
+
+	if (ImGui::Button("Retune Next Run"))
+		ClearCache();
+
+	ImGui::End();
+#endif
+}
+
+std::vector<WorkgroupSize> ComputeAutotuner::GetCandidates(const TunableKernel& kernel) const
+{
+	std::vector<WorkgroupSize> candidates;
+	if (kernel.Extent.height <= 1 && kernel.Extent.depth <= 1)
+		candidates = {{32, 1, 1}, {64, 1, 1}, {128, 1, 1}, {256, 1, 1}};
+	else
+		candidates = {{8, 8, 1}, {16, 8, 1}, {16, 16, 1}, {32, 8, 1}, {64, 1, 1}};
+	candidates.push_back(kernel.Fallback);
+
+	const SubgroupInfo& limits = m_Renderer->GetSubgroupInfo();
+	std::erase_if(candidates, [&limits](const WorkgroupSize& size)
+	{
+		return size.X > limits.MaxWorkgroupSize[0] || size.Y > limits.MaxWorkgroupSize[1] ||
+			size.Z > limits.MaxWorkgroupSize[2] || size.GetInvocations() > limits.MaxWorkgroupInvocations;
+	});
+
+	// The fallback might already be in there.
+	std::vector<WorkgroupSize> unique;
+	for (const WorkgroupSize& size : candidates)
+	{
+		if (std::ranges::find(unique, size) == unique.end())
+			unique.push_back(size);
+	}
+	return unique;
+}
+
+f64 ComputeAutotuner::TimeVariant(const TunableKernel& kernel, VkPipeline pipeline, const WorkgroupSize& size) const
+{
+	u64 bestTicks = std::numeric_limits<u64>::max();
+	for (u32 repetition = 0; repetition < Repetitions; repetition++)
+	{
+		m_Renderer->ImmediateSubmit([&](VkCommandBuffer cmd)
+		{
+			vkCmdResetQueryPool(cmd, m_QueryPool, 0, 2);
+			if (kernel.Prepare)
+				kernel.Prepare(cmd);
+
+			// Warm caches and clocks up first, so we're not timing the first dispatch's overhead.
+			for (u32 i = 0; i < WarmupIterations; i++)
+				kernel.Record(cmd, pipeline, size);
+
+			vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_QueryPool, 0);
+			for (u32 i = 0; i < Iterations; i++)
+				kernel.Record(cmd, pipeline, size);
+			vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_QueryPool, 1);
+		});
+
+		std::array<u64, 2> timestamps;
+		VK_CHECK(vkGetQueryPoolResults(m_Renderer->GetDevice(), m_QueryPool, 0, 2, sizeof(timestamps),
+		                               timestamps.data(), sizeof(u64), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+		bestTicks = std::min(bestTicks, (timestamps[1] - timestamps[0]) & m_Renderer->GetTimestampMask());
+	}
+
+	return static_cast<f64>(bestTicks) * m_Renderer->GetTimestampPeriod() / 1000000.0 / Iterations;
+}
+
+void ComputeAutotuner::LoadCache()
+{
+	m_Cache.clear();
+
+	std::ifstream file(m_CachePath);
+	if (!file.is_open())
+		return; // Nothing tuned yet.
+
+	// One result per line: device key, kernel name, then the workgroup size.
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream stream(line);
+		std::string        deviceKey, name;
+		WorkgroupSize      size;
+		if (!(stream >> deviceKey >> name >> size.X >> size.Y >> size.Z) || size.GetInvocations() == 0)
+		{
+			VULC_WARN("Skipping malformed line in {}: {}", m_CachePath.string(), line);
+			continue;
+		}
+		m_Cache[deviceKey + ' ' + name] = size;
+	}
+}
+
+void ComputeAutotuner::SaveCache() const
+{
+	std::ofstream file(m_CachePath, std::ios::trunc);
+	if (!file.is_open())
+	{
+		VULC_WARN("Failed to save compute tuning results to {}", m_CachePath.string());
+		return;
+	}
+
+	for (const auto& [key, size] : m_Cache)
+		file << key << ' ' << size.X << ' ' << size.Y << ' ' << size.Z << '\n';
+}
@@ -0,0 +1,87 @@
+#include "vulcpch.h"
+#include "Render/ComputeDispatch.h"
+
+#include <bit>
+
+namespace
+{
+	WorkgroupSize ClampToLimits(WorkgroupSize size, const SubgroupInfo& subgroups)
+	{
+		size.X = std::min(size.X, subgroups.MaxWorkgroupSize[0]);
+		size.Y = std::min(size.Y, subgroups.MaxWorkgroupSize[1]);
+		size.Z = std::min(size.Z, subgroups.MaxWorkgroupSize[2]);
+		return size;
+	}
+
+	u32 PickInvocationCount(const SubgroupInfo& subgroups)
+	{
+		// Four subgroups tends to be the sweet spot: 128 on NVIDIA and RDNA in wave32, 256 on GCN, and never less than
+		// 64, so tiny-subgroup devices (and CPU implementations) still get a reasonable tile.
+		const u32 invocations = std::clamp(subgroups.Size * 4, 64u, 256u);
+		return std::bit_floor(std::min(invocations, subgroups.MaxWorkgroupInvocations));
+	}
+}
+
+SubgroupInfo QuerySubgroupInfo(VkPhysicalDevice gpu)
+{
+	VkPhysicalDeviceVulkan13Properties properties13 = {};
+	properties13.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES;
+
+	VkPhysicalDeviceVulkan11Properties properties11 = {};
+	properties11.sType                              = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+	properties11.pNext                              = &properties13;
+
+	VkPhysicalDeviceProperties2 properties = {};
+	properties.sType                       = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+	properties.pNext                       = &properties11;
+	vkGetPhysicalDeviceProperties2(gpu, &properties);
+
+	const VkPhysicalDeviceLimits& limits = properties.properties.limits;
+
+	SubgroupInfo info;
+	info.Size                    = properties11.subgroupSize;
+	info.MinSize                 = properties13.minSubgroupSize ? properties13.minSubgroupSize : info.Size;
+	info.MaxSize                 = properties13.maxSubgroupSize ? properties13.maxSubgroupSize : info.Size;
+	info.SupportedStages         = properties11.subgroupSupportedStages;
+	info.SupportedOperations     = properties11.subgroupSupportedOperations;
+	info.MaxWorkgroupInvocations = limits.maxComputeWorkGroupInvocations;
+	for (u32 i = 0; i < 3; i++)
+	{
+		info.MaxWorkgroupSize[i]  = limits.maxComputeWorkGroupSize[i];
+		info.MaxWorkgroupCount[i] = limits.maxComputeWorkGroupCount[i];
+	}
+	return info;
+}
+
+WorkgroupSize PickWorkgroupSize2D(const SubgroupInfo& subgroups)
+{
+	// Square, or twice as wide as tall; wider rows are friendlier to row-major image layouts.
+	const u32 invocations = PickInvocationCount(subgroups);
+	const u32 log2        = std::bit_width(invocations) - 1;
+	const u32 width       = 1u << ((log2 + 1) / 2);
+	return ClampToLimits({width, invocations / width, 1}, subgroups);
+}
+
+WorkgroupSize PickWorkgroupSize1D(const SubgroupInfo& subgroups)
+{
+	return ClampToLimits({PickInvocationCount(subgroups), 1, 1}, subgroups);
+}
+
+void Dispatch(VkCommandBuffer cmd, VkExtent3D extent, const WorkgroupSize& size)
+{
+	const VkExtent3D groups = GetGroupCount(extent, size);
+	if (groups.width == 0 || groups.height == 0 || groups.depth == 0)
+		return;
+
+	vkCmdDispatch(cmd, groups.width, groups.height, groups.depth);
+}
+
+void Dispatch(VkCommandBuffer cmd, VkExtent2D extent, const WorkgroupSize& size)
+{
+	Dispatch(cmd, VkExtent3D{extent.width, extent.height, 1}, size);
+}
+
+void Dispatch(VkCommandBuffer cmd, u32 count, const WorkgroupSize& size)
+{
+	Dispatch(cmd, VkExtent3D{count, 1, 1}, size);
+}
@@ -0,0 +1,335 @@
+#include "vulcpch.h"
+#include "Render/Culling.h"
+
+#include <bit>
+#include <chrono>
+#include <SDL3/SDL_cpuinfo.h>
+
+#include "Core/Jobs/JobSystem.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+	#define VULC_CULLING_X64
+	#include <immintrin.h>
+
+	// MSVC lets us use any intrinsic anywhere; GCC and Clang need the function to be compiled for the target ISA.
+	// We only ever call these after checking the CPU supports them.
+	#if defined(__GNUC__) || defined(__clang__)
+		#define VULC_TARGET_AVX2 __attribute__((target("avx2,fma")))
+	#else
+		#define VULC_TARGET_AVX2
+	#endif
+#endif
+
+namespace
+{
+	// Widest SIMD path processes 8 objects at once; keep the streams padded to that.
+	constexpr u32 StreamPadding = 8;
+
+	// Planes split into components, with the absolute normal precomputed for the box test.
+	struct PreparedPlanes
+	{
+		f32 NX[Frustum::Count], NY[Frustum::Count], NZ[Frustum::Count], W[Frustum::Count];
+		f32 AX[Frustum::Count], AY[Frustum::Count], AZ[Frustum::Count];
+	};
+
+	struct CullingStreams
+	{
+		const f32 *CX, *CY, *CZ;
+		const f32 *EX, *EY, *EZ;
+		const f32 *R;
+	};
+
+	PreparedPlanes PreparePlanes(const Frustum& frustum)
+	{
+		PreparedPlanes planes = {};
+		for (u32 i = 0; i < Frustum::Count; i++)
+		{
+			const glm::vec4& plane = frustum.Planes[i];
+			planes.NX[i] = plane.x;
+			planes.NY[i] = plane.y;
+			planes.NZ[i] = plane.z;
+			planes.W[i]  = plane.w;
+			planes.AX[i] = glm::abs(plane.x);
+			planes.AY[i] = glm::abs(plane.y);
+			planes.AZ[i] = glm::abs(plane.z);
+		}
+		return planes;
+	}
+
+	// An object is outside a plane if its centre is further behind it than the smaller of its two "radii" - the sphere
+	// radius and the box's projected extent. Both are conservative, so we can take whichever is tighter.
+	u32 CullRangeScalar(const PreparedPlanes& planes, const CullingStreams& streams, u32 begin, u32 end, u32* out)
+	{
+		u32 written = 0;
+		for (u32 i = begin; i < end; i++)
+		{
+			bool culled = false;
+			for (u32 p = 0; p < Frustum::Count && !culled; p++)
+			{
+				const f32 distance = planes.NX[p] * streams.CX[i] + planes.NY[p] * streams.CY[i] + planes.NZ[p] * streams.CZ[i]
+					+ planes.W[p];
+				const f32 boxRadius = planes.AX[p] * streams.EX[i] + planes.AY[p] * streams.EY[i] + planes.AZ[p] * streams.EZ[i];
+				culled = distance < -std::min(streams.R[i], boxRadius);
+			}
+
+			if (!culled)
+				out[written++] = i;
+		}
+		return written;
+	}
+
+#ifdef VULC_CULLING_X64
+	FORCEINLINE u32 WriteVisibleIndices(u32 visibleMask, u32 base, u32* out)
+	{
+		u32 written = 0;
+		while (visibleMask)
+		{
+			out[written++] = base + static_cast<u32>(std::countr_zero(visibleMask));
+			visibleMask &= visibleMask - 1;
+		}
+		return written;
+	}
+
+	u32 CullRangeSSE(const PreparedPlanes& planes, const CullingStreams& streams, u32 begin, u32 end, u32* out)
+	{
+		const __m128 zero    = _mm_setzero_ps();
+		u32          written = 0;
+		for (u32 i = begin; i < end; i += 4)
+		{
+			const __m128 cx = _mm_loadu_ps(streams.CX + i);
+			const __m128 cy = _mm_loadu_ps(streams.CY + i);
+			const __m128 cz = _mm_loadu_ps(streams.CZ + i);
+			const __m128 ex = _mm_loadu_ps(streams.EX + i);
+			const __m128 ey = _mm_loadu_ps(streams.EY + i);
+			const __m128 ez = _mm_loadu_ps(streams.EZ + i);
+			const __m128 r  = _mm_loadu_ps(streams.R + i);
+
+			__m128 culled = zero;
+			for (u32 p = 0; p < Frustum::Count; p++)
+			{
+				__m128 distance = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.NX[p]), cx), _mm_set1_ps(planes.W[p]));
+				distance        = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.NY[p]), cy), distance);
+				distance        = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.NZ[p]), cz), distance);
+
+				__m128 boxRadius = _mm_mul_ps(_mm_set1_ps(planes.AX[p]), ex);
+				boxRadius        = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.AY[p]), ey), boxRadius);
+				boxRadius        = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.AZ[p]), ez), boxRadius);
+
+				const __m128 threshold = _mm_sub_ps(zero, _mm_min_ps(r, boxRadius));
+				culled                 = _mm_or_ps(culled, _mm_cmplt_ps(distance, threshold));
+			}
+
+			const u32 visibleMask = ~static_cast<u32>(_mm_movemask_ps(culled)) & 0xf;
+			written += WriteVisibleIndices(visibleMask, i, out + written);
+		}
+		return written;
+	}
+
+	VULC_TARGET_AVX2 u32 CullRangeAVX2(const PreparedPlanes& planes, const CullingStreams& streams, u32 begin, u32 end,
+	                                   u32* out)
+	{
+		const __m256 zero    = _mm256_setzero_ps();
+		u32          written = 0;
+		for (u32 i = begin; i < end; i += 8)
+		{
+			const __m256 cx = _mm256_loadu_ps(streams.CX + i);
+			const __m256 cy = _mm256_loadu_ps(streams.CY + i);
+			const __m256 cz = _mm256_loadu_ps(streams.CZ + i);
+			const __m256 ex = _mm256_loadu_ps(streams.EX + i);
+			const __m256 ey = _mm256_loadu_ps(streams.EY + i);
+			const __m256 ez = _mm256_loadu_ps(streams.EZ + i);
+			const __m256 r  = _mm256_loadu_ps(streams.R + i);
+
+			__m256 culled = zero;
+			for (u32 p = 0; p < Frustum::Count; p++)
+			{
+				__m256 distance = _mm256_fmadd_ps(_mm256_set1_ps(planes.NX[p]), cx, _mm256_set1_ps(planes.W[p]));
+				distance        = _mm256_fmadd_ps(_mm256_set1_ps(planes.NY[p]), cy, distance);
+				distance        = _mm256_fmadd_ps(_mm256_set1_ps(planes.NZ[p]), cz, distance);
+
+				__m256 boxRadius = _mm256_mul_ps(_mm256_set1_ps(planes.AX[p]), ex);
+				boxRadius        = _mm256_fmadd_ps(_mm256_set1_ps(planes.AY[p]), ey, boxRadius);
+				boxRadius        = _mm256_fmadd_ps(_mm256_set1_ps(planes.AZ[p]), ez, boxRadius);
+
+				const __m256 threshold = _mm256_sub_ps(zero, _mm256_min_ps(r, boxRadius));
+				culled                 = _mm256_or_ps(culled, _mm256_cmp_ps(distance, threshold, _CMP_LT_OQ));
+			}
+
+			const u32 visibleMask = ~static_cast<u32>(_mm256_movemask_ps(culled)) & 0xff;
+			written += WriteVisibleIndices(visibleMask, i, out + written);
+		}
+		return written;
+	}
+#endif
+
+	using CullRangeFunction = u32(*)(const PreparedPlanes&, const CullingStreams&, u32, u32, u32*);
+
+	CullRangeFunction GetCullFunction(CullingPath path)
+	{
+		switch (path)
+		{
+#ifdef VULC_CULLING_X64
+		case CullingPath::SSE:
+			return &CullRangeSSE;
+		case CullingPath::AVX2:
+			return &CullRangeAVX2;
+#endif
+		default:
+			return &CullRangeScalar;
+		}
+	}
+}
+
+u32 FrustumCuller::Add(const AABB& bounds)
+{
+	return Add(bounds, BoundingSphere::FromAABB(bounds));
+}
+
+u32 FrustumCuller::Add(const AABB& bounds, const BoundingSphere& sphere)
+{
+	const u32 index = m_Count;
+	Resize(m_Count + 1);
+	Set(index, bounds, sphere);
+	return index;
+}
+
+void FrustumCuller::Set(u32 index, const AABB& bounds)
+{
+	Set(index, bounds, BoundingSphere::FromAABB(bounds));
+}
+
+void FrustumCuller::Set(u32 index, const AABB& bounds, const BoundingSphere& sphere)
+{
+	VULC_ASSERT(index < m_Count, "Culling index {} out of range ({} objects)", index, m_Count);
+
+	// We test the sphere against the plane from the box centre, so grow the radius if the sphere isn't centred on it.
+	const glm::vec3 center = bounds.GetCenter();
+	const float     radius = sphere.Radius + glm::length(sphere.Center - center);
+	Write(index, center, bounds.GetExtents(), radius);
+}
+
+u32 FrustumCuller::RemoveSwap(u32 index)
+{
+	VULC_ASSERT(index < m_Count, "Culling index {} out of range ({} objects)", index, m_Count);
+
+	const u32 last = m_Count - 1;
+	if (index != last)
+	{
+		Write(index, {m_CenterX[last], m_CenterY[last], m_CenterZ[last]},
+		      {m_ExtentX[last], m_ExtentY[last], m_ExtentZ[last]}, m_Radius[last]);
+	}
+	Resize(last);
+	return last;
+}
+
+void FrustumCuller::Reserve(u32 count)
+{
+	const u32 padded = (count + StreamPadding - 1) / StreamPadding * StreamPadding;
+	for (auto* stream : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ, &m_Radius})
+		stream->reserve(padded);
+}
+
+void FrustumCuller::Clear()
+{
+	Resize(0);
+}
+
+CullingStats FrustumCuller::Cull(const Frustum& frustum, std::vector<u32>& outVisible, JobSystem* jobSystem) const
+{
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	CullingStats stats;
+	stats.Tested   = m_Count;
+	stats.PathUsed = m_Path == CullingPath::Auto ? GetBestSupportedPath() : m_Path;
+
+	if (m_Count == 0)
+	{
+		outVisible.clear();
+		return stats;
+	}
+
+	const PreparedPlanes    planes   = PreparePlanes(frustum);
+	const CullingStreams    streams  = {
+		m_CenterX.data(), m_CenterY.data(), m_CenterZ.data(),
+		m_ExtentX.data(), m_ExtentY.data(), m_ExtentZ.data(),
+		m_Radius.data()
+	};
+	const CullRangeFunction cullRange = GetCullFunction(stats.PathUsed);
+
+	// The SIMD paths walk the padded stream; the padding is never visible, so it's safe to write past m_Count while
+	// we're in a chunk, as long as the chunk's output region is big enough. So we give each chunk a padded region.
+	const u32 paddedCount = static_cast<u32>(m_Radius.size());
+	const u32 chunkCount  = (paddedCount + ChunkSize - 1) / ChunkSize;
+	outVisible.resize(paddedCount);
+
+	if (!jobSystem || chunkCount == 1)
+	{
+		stats.Visible = cullRange(planes, streams, 0, paddedCount, outVisible.data());
+	}
+	else
+	{
+		// Each chunk writes its visible indices to the start of its own region of the output, then we squash them
+		// together in chunk order so the result is the same as the single-threaded path.
+		std::vector<u32> chunkVisible(chunkCount);
+		jobSystem->ParallelFor(chunkCount, [&](u32 beginChunk, u32 endChunk)
+		{
+			for (u32 chunk = beginChunk; chunk < endChunk; chunk++)
+			{
+				const u32 begin     = chunk * ChunkSize;
+				const u32 end       = std::min(begin + ChunkSize, paddedCount);
+				chunkVisible[chunk] = cullRange(planes, streams, begin, end, outVisible.data() + begin);
+			}
+		});
+
+		u32 written = chunkVisible[0];
+		for (u32 chunk = 1; chunk < chunkCount; chunk++)
+		{
+			const u32* chunkStart = outVisible.data() + chunk * ChunkSize;
+			std::memmove(outVisible.data() + written, chunkStart, chunkVisible[chunk] * sizeof(u32));
+			written += chunkVisible[chunk];
+		}
+		stats.Visible = written;
+	}
+
+	outVisible.resize(stats.Visible);
+
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	stats.Milliseconds = std::chrono::duration<f64, std::milli>(endTime - startTime).count();
+	return stats;
+}
+
+CullingPath FrustumCuller::GetBestSupportedPath()
+{
+#ifdef VULC_CULLING_X64
+	// SSE2 is part of x86-64, so we only need to check for AVX2 (and FMA, which every AVX2 CPU we care about has).
+	static const CullingPath s_BestPath = SDL_HasAVX2() ? CullingPath::AVX2 : CullingPath::SSE;
+	return s_BestPath;
+#else
+	return CullingPath::Scalar;
+#endif
+}
+
+void FrustumCuller::Resize(u32 count)
+{
+	// Keep the padding lanes set to something that can never pass: a sphere with a hugely negative radius.
+	const u32 padded = (count + StreamPadding - 1) / StreamPadding * StreamPadding;
+	for (auto* stream : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_ExtentX, &m_ExtentY, &m_ExtentZ})
+		stream->resize(padded, 0.0f);
+	m_Radius.resize(padded, std::numeric_limits<f32>::lowest());
+
+	for (u32 i = count; i < std::min(m_Count, padded); i++)
+		Write(i, glm::vec3(0.0f), glm::vec3(0.0f), std::numeric_limits<f32>::lowest());
+
+	m_Count = count;
+}
+
+void FrustumCuller::Write(u32 index, const glm::vec3& center, const glm::vec3& extents, float radius)
+{
+	m_CenterX[index] = center.x;
+	m_CenterY[index] = center.y;
+	m_CenterZ[index] = center.z;
+	m_ExtentX[index] = extents.x;
+	m_ExtentY[index] = extents.y;
+	m_ExtentZ[index] = extents.z;
+	m_Radius[index]  = radius;
+}
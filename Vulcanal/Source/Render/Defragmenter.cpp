@@ -0,0 +1,368 @@
+#include "vulcpch.h"
+#include "Render/Defragmenter.h"
+
+#ifndef VULC_NO_IMGUI
+#include <imgui.h>
+#endif
+
+#include "Render/Renderer.h"
+
+namespace
+{
+	constexpr f64 BytesPerMB = 1024.0 * 1024.0;
+}
+
+void Defragmenter::Init(Renderer* renderer)
+{
+	m_Renderer      = renderer;
+	m_NextAutoCheck = DefaultAutoCheckFrames;
+}
+
+void Defragmenter::Shutdown()
+{
+	// The device is idle by now, so whatever stage we're at, it's safe to wrap up.
+	if (m_PassStage != PassStage::None)
+		EndPass();
+	if (m_Context)
+		FinishDefragmentation();
+
+	m_Movables.clear();
+}
+
+void Defragmenter::Register(const MovableImage& image)
+{
+	VULC_ASSERT(image.Image && image.Image->Allocation, "Can only register allocated images");
+	m_Movables[image.Image->Allocation] = image;
+}
+
+bool Defragmenter::Unregister(const AllocatedImage& image)
+{
+	if (!image.Allocation || !m_Movables.erase(image.Allocation))
+		return false;
+
+	for (Move& move : m_Moves)
+	{
+		if (move.Allocation != image.Allocation || !move.NewImage.Image)
+			continue;
+
+		// The owner's done with it from this frame on, but frames already in flight might not be.
+		move.Orphaned = true;
+		m_StageFrame  = std::max(m_StageFrame, m_Renderer->GetFrameIndex() + FramesInFlight);
+		return true;
+	}
+
+	return false;
+}
+
+void Defragmenter::Begin()
+{
+	if (m_Context)
+		return;
+
+	VmaDefragmentationInfo info = {};
+	info.flags                  = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+	info.maxBytesPerPass        = m_BytesPerPass;
+	info.maxAllocationsPerPass  = m_MovesPerPass;
+	VK_CHECK(vmaBeginDefragmentation(m_Renderer->GetAllocator(), &info, &m_Context));
+
+	m_CurrentRun            = {};
+	m_CurrentRun.Before     = CalculateStats();
+	m_CurrentRun.StartFrame = m_Renderer->GetFrameIndex();
+}
+
+void Defragmenter::Update(VkCommandBuffer cmd)
+{
+	const u64 frameIndex = m_Renderer->GetFrameIndex();
+
+	if (!m_Context && m_Auto && frameIndex >= m_NextAutoCheck)
+	{
+		m_NextAutoCheck                = frameIndex + DefaultAutoCheckFrames;
+		const FragmentationStats stats = CalculateStats();
+
+		// Don't bother for the odd few MB of holes; the point is to give back whole blocks.
+		if (stats.GetFragmentation() > m_AutoThreshold && stats.BlockBytes - stats.AllocationBytes > m_BytesPerPass)
+			Begin();
+	}
+
+	if (!m_Context)
+		return;
+
+	switch (m_PassStage)
+	{
+	case PassStage::Copying:
+		if (frameIndex >= m_StageFrame)
+			SwapPass();
+		break;
+	case PassStage::Retiring:
+		if (frameIndex >= m_StageFrame)
+		{
+			EndPass();
+			if (m_Context)
+				BeginPass(cmd);
+		}
+		break;
+	case PassStage::None:
+		BeginPass(cmd);
+		break;
+	}
+}
+
+bool Defragmenter::IsMoving(const AllocatedImage& image) const
+{
+	return std::ranges::any_of(m_Moves, [&image](const Move& move)
+	{
+		return move.Allocation == image.Allocation && move.NewImage.Image;
+	});
+}
+
+FragmentationStats Defragmenter::CalculateStats() const
+{
+	const VkPhysicalDeviceMemoryProperties* memoryProperties;
+	vmaGetMemoryProperties(m_Renderer->GetAllocator(), &memoryProperties);
+
+	VmaTotalStatistics totalStats;
+	vmaCalculateStatistics(m_Renderer->GetAllocator(), &totalStats);
+
+	FragmentationStats stats;
+	for (u32 heap = 0; heap < memoryProperties->memoryHeapCount; heap++)
+	{
+		if (!(memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+			continue;
+
+		const VmaDetailedStatistics& heapStats = totalStats.memoryHeap[heap];
+		stats.BlockBytes += heapStats.statistics.blockBytes;
+		stats.AllocationBytes += heapStats.statistics.allocationBytes;
+		stats.BlockCount += heapStats.statistics.blockCount;
+		if (heapStats.unusedRangeCount > 0)
+			stats.LargestFreeRange = std::max(stats.LargestFreeRange, heapStats.unusedRangeSizeMax);
+	}
+	return stats;
+}
+
+void Defragmenter::ApplySettings(const DefragmenterSettings& settings)
+{
+	m_Auto          = settings.Auto;
+	m_AutoThreshold = settings.AutoThreshold;
+	m_BytesPerPass  = settings.BytesPerPass;
+	if (settings.DefragmentNow)
+		Begin();
+}
+
+DefragmenterSettings Defragmenter::GetSettings() const
+{
+	return {.Auto = m_Auto, .AutoThreshold = m_AutoThreshold, .BytesPerPass = m_BytesPerPass};
+}
+
+DefragmenterStats Defragmenter::GetStats() const
+{
+	return {
+		.Now = CalculateStats(), .Running = IsRunning(), .RunStartFrame = m_CurrentRun.StartFrame, .HasRun = m_HasRun,
+		.LastRun = m_LastRun
+	};
+}
+
+void Defragmenter::OnDrawIMGui(DefragmenterSettings& settings, const DefragmenterStats& stats,
+                               const ResidencyStats& residency)
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("GPU Memory");
+
+	ImGui::Text("Budget: %.1f / %.1f MB (target %.1f MB)", residency.Usage / BytesPerMB, residency.Budget / BytesPerMB,
+	            residency.Target / BytesPerMB);
+
+	auto drawStats = [](const char* label, const FragmentationStats& fragmentation)
+	{
+		ImGui::Text("%s: %.1f MB live in %.1f MB (%u blocks), %.0f%% fragmented", label,
+		            fragmentation.AllocationBytes / BytesPerMB, fragmentation.BlockBytes / BytesPerMB,
+		            fragmentation.BlockCount, fragmentation.GetFragmentation() * 100.0f);
+	};
+	drawStats("Now", stats.Now);
+
+	ImGui::Separator();
+	ImGui::TextUnformatted("Defragmentation");
+	ImGui::Checkbox("Automatic", &settings.Auto);
+	ImGui::SliderFloat("Threshold", &settings.AutoThreshold, 0.05f, 0.95f, "%.2f");
+
+	s32 megabytesPerPass = static_cast<s32>(settings.BytesPerPass / (1024 * 1024));
+	if (ImGui::SliderInt("MB Per Pass", &megabytesPerPass, 1, 256))
+		settings.BytesPerPass = static_cast<u64>(megabytesPerPass) * 1024 * 1024;
+
+	if (stats.Running)
+		ImGui::Text("Running since frame %llu...", static_cast<unsigned long long>(stats.RunStartFrame));
+	else if (ImGui::Button("Defragment Now"))
+		settings.DefragmentNow = true;
+
+	if (stats.HasRun)
+	{
+		const DefragmentationRun& run = stats.LastRun;
+		ImGui::Separator();
+		ImGui::TextUnformatted("Last Run");
+		drawStats("Before", run.Before);
+		drawStats("After", run.After);
+		ImGui::Text("Moved %u allocations (%.1f MB), freed %u blocks (%.1f MB) over %llu frames",
+		            run.AllocationsMoved, run.BytesMoved / BytesPerMB, run.BlocksFreed, run.BytesFreed / BytesPerMB,
+		            static_cast<unsigned long long>(run.EndFrame - run.StartFrame));
+	}
+
+	ImGui::End();
+#endif
+}
+
+void Defragmenter::BeginPass(VkCommandBuffer cmd)
+{
+	VmaAllocator allocator = m_Renderer->GetAllocator();
+	VkDevice     device    = m_Renderer->GetDevice();
+
+	const VkResult result = vmaBeginDefragmentationPass(allocator, m_Context, &m_PassInfo);
+	if (result == VK_SUCCESS)
+	{
+		// Nothing left to move.
+		FinishDefragmentation();
+		return;
+	}
+	VULC_CHECK(result == VK_INCOMPLETE, "vmaBeginDefragmentationPass failed: {}", string_VkResult(result));
+
+	m_Moves.assign(m_PassInfo.moveCount, {});
+	for (u32 i = 0; i < m_PassInfo.moveCount; i++)
+	{
+		VmaDefragmentationMove& vmaMove = m_PassInfo.pMoves[i];
+
+		// Anything we don't know how to move, or that's busy, stays put.
+		auto it = m_Movables.find(vmaMove.srcAllocation);
+		if (it == m_Movables.end() || (it->second.CanMove && !it->second.CanMove()))
+		{
+			vmaMove.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+			continue;
+		}
+
+		const AllocatedImage& oldImage = *it->second.Image;
+		AllocatedImage        newImage = oldImage;
+
+		VkImageCreateInfo imageInfo = CreateImageCreateInfo(oldImage.Format, it->second.Usage, oldImage.Extent,
+		                                                    oldImage.MipLevels);
+		VK_CHECK(vkCreateImage(device, &imageInfo, nullptr, &newImage.Image));
+		VK_CHECK(vmaBindImageMemory(allocator, vmaMove.dstTmpAllocation, newImage.Image));
+
+		VkImageViewCreateInfo viewInfo = CreateImageViewCreateInfo(oldImage.Format, newImage.Image,
+		                                                           VK_IMAGE_ASPECT_COLOR_BIT, VK_IMAGE_VIEW_TYPE_2D, 0,
+		                                                           oldImage.MipLevels);
+		VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &newImage.ImageView));
+
+		std::vector<VkImageCopy2> regions(oldImage.MipLevels);
+		for (u32 mip = 0; mip < oldImage.MipLevels; mip++)
+		{
+			regions[mip]                = {};
+			regions[mip].sType          = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
+			regions[mip].srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 1};
+			regions[mip].dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip, 0, 1};
+			regions[mip].extent         = {
+				std::max(oldImage.Extent.width >> mip, 1u), std::max(oldImage.Extent.height >> mip, 1u), 1
+			};
+		}
+
+		VkCopyImageInfo2 copyInfo = {};
+		copyInfo.sType            = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2;
+		copyInfo.srcImage         = oldImage.Image;
+		copyInfo.srcImageLayout   = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		copyInfo.dstImage         = newImage.Image;
+		copyInfo.dstImageLayout   = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		copyInfo.regionCount      = static_cast<u32>(regions.size());
+		copyInfo.pRegions         = regions.data();
+
+		TransitionImage(cmd, oldImage.Image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		TransitionImage(cmd, newImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		vkCmdCopyImage2(cmd, &copyInfo);
+		TransitionImage(cmd, oldImage.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		TransitionImage(cmd, newImage.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+		m_Moves[i] = {.Allocation = vmaMove.srcAllocation, .OldImage = oldImage, .NewImage = newImage};
+	}
+
+	// The copies are in this frame's command buffer, so they're done once this frame retires.
+	m_PassStage  = PassStage::Copying;
+	m_StageFrame = m_Renderer->GetFrameIndex() + FramesInFlight;
+}
+
+void Defragmenter::SwapPass()
+{
+	for (Move& move : m_Moves)
+	{
+		if (!move.NewImage.Image || move.Orphaned)
+			continue;
+
+		// After the pass ends, the original allocation handle refers to the new memory, so that's what owners keep.
+		const MovableImage& movable = m_Movables.at(move.Allocation);
+		*movable.Image              = move.NewImage;
+		if (movable.OnMoved)
+			movable.OnMoved();
+	}
+
+	// Frames recorded before this one might still be sampling the old images.
+	m_PassStage  = PassStage::Retiring;
+	m_StageFrame = m_Renderer->GetFrameIndex() + FramesInFlight;
+}
+
+void Defragmenter::EndPass()
+{
+	const bool swapped = m_PassStage == PassStage::Retiring;
+	for (u32 i = 0; i < m_PassInfo.moveCount; i++)
+	{
+		Move&                   move    = m_Moves[i];
+		VmaDefragmentationMove& vmaMove = m_PassInfo.pMoves[i];
+		if (!move.NewImage.Image)
+			continue;
+
+		if (move.Orphaned)
+		{
+			// Nobody wants either copy, so let VMA free the allocation for us.
+			DestroyImageObjects(move.OldImage);
+			DestroyImageObjects(move.NewImage);
+			vmaMove.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+		}
+		else if (swapped)
+			DestroyImageObjects(move.OldImage);
+		else
+		{
+			// Only happens if we're shutting down mid-copy; the owner never switched over, so leave it where it was.
+			DestroyImageObjects(move.NewImage);
+			vmaMove.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+		}
+	}
+
+	const VkResult result = vmaEndDefragmentationPass(m_Renderer->GetAllocator(), m_Context, &m_PassInfo);
+	m_Moves.clear();
+	m_PassStage = PassStage::None;
+
+	if (result == VK_SUCCESS)
+		FinishDefragmentation();
+}
+
+void Defragmenter::FinishDefragmentation()
+{
+	VmaDefragmentationStats stats;
+	vmaEndDefragmentation(m_Renderer->GetAllocator(), m_Context, &stats);
+	m_Context = nullptr;
+
+	m_CurrentRun.After            = CalculateStats();
+	m_CurrentRun.EndFrame         = m_Renderer->GetFrameIndex();
+	m_CurrentRun.BytesMoved       = stats.bytesMoved;
+	m_CurrentRun.BytesFreed       = stats.bytesFreed;
+	m_CurrentRun.AllocationsMoved = stats.allocationsMoved;
+	m_CurrentRun.BlocksFreed      = stats.deviceMemoryBlocksFreed;
+	m_LastRun                     = m_CurrentRun;
+	m_HasRun                      = true;
+
+	VULC_INFO("Defragmentation moved {} allocations ({:.1f} MB) and freed {} blocks ({:.1f} MB) over {} frames",
+	          stats.allocationsMoved, stats.bytesMoved / BytesPerMB, stats.deviceMemoryBlocksFreed,
+	          stats.bytesFreed / BytesPerMB, m_CurrentRun.EndFrame - m_CurrentRun.StartFrame);
+}
+
+void Defragmenter::DestroyImageObjects(AllocatedImage& image) const
+{
+	vkDestroyImageView(m_Renderer->GetDevice(), image.ImageView, nullptr);
+	vkDestroyImage(m_Renderer->GetDevice(), image.Image, nullptr);
+	image.Reset();
+}
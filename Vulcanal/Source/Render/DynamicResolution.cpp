@@ -0,0 +1,101 @@
+#include "vulcpch.h"
+#include "Render/DynamicResolution.h"
+
+#include <cmath>
+
+namespace
+{
+	u32 ScaleDimension(u32 dimension, f32 scale)
+	{
+		return std::max(static_cast<u32>(static_cast<f32>(dimension) * scale + 0.5f), 1u);
+	}
+}
+
+void DynamicResolution::Update(f32 gpuTime)
+{
+	if (gpuTime <= 0.0f)
+		return;
+
+	m_LastGPUTime     = gpuTime;
+	m_SmoothedGPUTime = m_HasSample ? std::lerp(m_SmoothedGPUTime, gpuTime, Smoothing) : gpuTime;
+	m_HasSample       = true;
+
+	if (!m_Settings.Enabled)
+	{
+		m_Scale = m_Settings.MaxScale;
+		return;
+	}
+
+	// Going down, react to the latest frame too, so a spike is dealt with straight away rather than once it's bled
+	// into the average. Going up, only trust the average.
+	const f32 target   = m_Settings.TargetFrameTime * TargetHeadroom;
+	const f32 downTime = std::max(m_SmoothedGPUTime, m_LastGPUTime);
+
+	f32 scale = m_Scale;
+	if (downTime > target)
+		scale = std::max(m_Scale * std::sqrt(target / downTime), m_Scale - MaxStepDown);
+	else
+		scale = std::min(m_Scale * std::sqrt(target / m_SmoothedGPUTime), m_Scale + MaxStepUp);
+
+	scale = std::clamp(scale, m_Settings.MinScale, m_Settings.MaxScale);
+	if (std::abs(scale - m_Scale) >= Deadband || scale == m_Settings.MinScale || scale == m_Settings.MaxScale)
+		m_Scale = scale;
+}
+
+VkExtent2D DynamicResolution::GetDrawExtent(VkExtent2D maxExtent) const
+{
+	// The draw image is already at the max scale, so we only need the fraction of that.
+	const f32 scale = GetScale() / m_Settings.MaxScale;
+	return {
+		std::min(ScaleDimension(maxExtent.width, scale), maxExtent.width),
+		std::min(ScaleDimension(maxExtent.height, scale), maxExtent.height)
+	};
+}
+
+VkExtent2D DynamicResolution::GetMaxExtent(VkExtent2D outputExtent) const
+{
+	const f32 scale = m_Settings.MaxScale;
+	return {ScaleDimension(outputExtent.width, scale), ScaleDimension(outputExtent.height, scale)};
+}
+
+void DynamicResolution::ApplySettings(const DynamicResolutionSettings& settings)
+{
+	m_Settings.Enabled         = settings.Enabled;
+	m_Settings.TargetFrameTime = std::max(settings.TargetFrameTime, 0.1f);
+	m_Settings.MaxScale        = std::clamp(settings.MaxScale, 0.1f, 1.0f);
+	m_Settings.MinScale        = std::clamp(settings.MinScale, 0.1f, m_Settings.MaxScale);
+	m_Scale                    = std::clamp(m_Scale, m_Settings.MinScale, m_Settings.MaxScale);
+}
+
+DynamicResolutionStats DynamicResolution::GetStats(VkExtent2D drawExtent) const
+{
+	return {.LastGPUTime = m_LastGPUTime, .SmoothedGPUTime = m_SmoothedGPUTime, .Scale = GetScale(),
+	        .DrawExtent = drawExtent};
+}
+
+void DynamicResolution::OnDrawIMGui(DynamicResolutionSettings& settings, const DynamicResolutionStats& stats)
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Dynamic Resolution");
+
+	ImGui::Checkbox("Enabled", &settings.Enabled);
+
+	f32 targetFrameRate = 1000.0f / settings.TargetFrameTime;
+	if (ImGui::SliderFloat("Target FPS", &targetFrameRate, 30.0f, 240.0f, "%.0f"))
+		settings.TargetFrameTime = 1000.0f / std::max(targetFrameRate, 1.0f);
+
+	// The max scale decides the draw image's size, so changing it reallocates; the min scale's free. The min's kept
+	// under the max here too, so the sliders don't fight ApplySettings() over it.
+	ImGui::SliderFloat("Min Scale", &settings.MinScale, 0.1f, 1.0f, "%.2f");
+	if (ImGui::SliderFloat("Max Scale", &settings.MaxScale, 0.1f, 1.0f, "%.2f"))
+		settings.MinScale = std::min(settings.MinScale, settings.MaxScale);
+	settings.MaxScale = std::max(settings.MaxScale, settings.MinScale);
+
+	ImGui::Separator();
+	ImGui::Text("GPU: %.2f ms (smoothed %.2f ms, target %.2f ms)", stats.LastGPUTime, stats.SmoothedGPUTime,
+	            settings.TargetFrameTime);
+	ImGui::Text("Scale: %.2f (%ux%u)", stats.Scale, stats.DrawExtent.width, stats.DrawExtent.height);
+
+	ImGui::End();
+#endif
+}
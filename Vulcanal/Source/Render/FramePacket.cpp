@@ -0,0 +1,44 @@
+#include "vulcpch.h"
+#include "Render/FramePacket.h"
+
+FramePacket::~FramePacket()
+{
+	Release();
+}
+
+void FramePacket::Capture()
+{
+	Release();
+
+#ifndef VULC_NO_IMGUI
+	const ImDrawData* drawData = ImGui::GetDrawData();
+	if (drawData && drawData->Valid)
+	{
+		// ImGui reuses its lists every frame, so each one's cloned; the rest is plain values.
+		m_DrawData.Valid            = true;
+		m_DrawData.TotalIdxCount    = drawData->TotalIdxCount;
+		m_DrawData.TotalVtxCount    = drawData->TotalVtxCount;
+		m_DrawData.DisplayPos       = drawData->DisplayPos;
+		m_DrawData.DisplaySize      = drawData->DisplaySize;
+		m_DrawData.FramebufferScale = drawData->FramebufferScale;
+		m_DrawData.OwnerViewport    = drawData->OwnerViewport;
+		for (s32 i = 0; i < drawData->CmdListsCount; i++)
+			m_DrawData.CmdLists.push_back(drawData->CmdLists[i]->CloneOutput());
+		m_DrawData.CmdListsCount = m_DrawData.CmdLists.Size;
+	}
+
+	const ImGuiIO& io = ImGui::GetIO();
+	MousePos          = io.MousePos;
+	std::copy(std::begin(io.MouseDown), std::end(io.MouseDown), std::begin(MouseDown));
+	MouseWheel = io.MouseWheel;
+#endif
+}
+
+void FramePacket::Release()
+{
+#ifndef VULC_NO_IMGUI
+	for (ImDrawList* list : m_DrawData.CmdLists)
+		IM_DELETE(list);
+	m_DrawData.Clear();
+#endif
+}
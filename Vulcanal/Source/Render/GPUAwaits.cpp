@@ -0,0 +1,93 @@
+#include "vulcpch.h"
+#include "Render/GPUAwaits.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+bool GPUAwaiter::await_ready() const
+{
+	return m_Poller->IsRetired(m_Fence, m_Timeline, m_Value);
+}
+
+void GPUAwaiter::await_suspend(std::coroutine_handle<> handle) const
+{
+	// If it retires between await_ready() and here, the next poll picks it up.
+	m_Poller->Add({.Handle = handle, .Fence = m_Fence, .Timeline = m_Timeline, .Value = m_Value});
+}
+
+void GPUAwaitPoller::Init(VkDevice device, JobSystem* jobSystem)
+{
+	m_Device    = device;
+	m_JobSystem = jobSystem;
+}
+
+void GPUAwaitPoller::Shutdown()
+{
+	std::lock_guard lock(m_Mutex);
+	if (!m_Waiters.empty())
+		VULC_WARN("Abandoning {} coroutines still waiting on the GPU", m_Waiters.size());
+	m_Waiters.clear();
+}
+
+void GPUAwaitPoller::Poll()
+{
+	std::vector<std::coroutine_handle<>> retired;
+	{
+		std::lock_guard lock(m_Mutex);
+
+		// Timeline values are shared by lots of waiters (every upload in a batch, say), so only ask once per poll.
+		std::vector<std::pair<VkSemaphore, u64>> timelineValues;
+		auto getTimelineValue = [&](VkSemaphore timeline)
+		{
+			for (const auto& [semaphore, value] : timelineValues)
+			{
+				if (semaphore == timeline)
+					return value;
+			}
+			u64 value = 0;
+			VK_CHECK(vkGetSemaphoreCounterValue(m_Device, timeline, &value));
+			timelineValues.emplace_back(timeline, value);
+			return value;
+		};
+
+		std::erase_if(m_Waiters, [&](const Waiter& waiter)
+		{
+			const bool done = waiter.Fence
+				                  ? vkGetFenceStatus(m_Device, waiter.Fence) == VK_SUCCESS
+				                  : getTimelineValue(waiter.Timeline) >= waiter.Value;
+			if (done)
+				retired.push_back(waiter.Handle);
+			return done;
+		});
+	}
+
+	// Outside the lock, since a resumed coroutine might well wait on the GPU again.
+	for (std::coroutine_handle<> handle : retired)
+	{
+		if (m_JobSystem)
+			m_JobSystem->Run([handle]() { handle.resume(); });
+		else
+			handle.resume();
+	}
+}
+
+u32 GPUAwaitPoller::GetWaiterCount() const
+{
+	std::lock_guard lock(m_Mutex);
+	return static_cast<u32>(m_Waiters.size());
+}
+
+bool GPUAwaitPoller::IsRetired(VkFence fence, VkSemaphore timeline, u64 value) const
+{
+	if (fence)
+		return vkGetFenceStatus(m_Device, fence) == VK_SUCCESS;
+
+	u64 currentValue = 0;
+	VK_CHECK(vkGetSemaphoreCounterValue(m_Device, timeline, &currentValue));
+	return currentValue >= value;
+}
+
+void GPUAwaitPoller::Add(const Waiter& waiter)
+{
+	std::lock_guard lock(m_Mutex);
+	m_Waiters.push_back(waiter);
+}
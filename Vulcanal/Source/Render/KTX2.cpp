@@ -0,0 +1,255 @@
+#include "vulcpch.h"
+#include "Render/KTX2.h"
+
+#include "Core/FileSystem/VirtualFileSystem.h"
+
+namespace
+{
+	constexpr u8 KTX2Identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+	// Laid out exactly as in the file (which is always little endian).
+	struct KTX2Header
+	{
+		u8  Identifier[12];
+		u32 VkFormat;
+		u32 TypeSize;
+		u32 PixelWidth;
+		u32 PixelHeight;
+		u32 PixelDepth;
+		u32 LayerCount;
+		u32 FaceCount;
+		u32 LevelCount;
+		u32 SupercompressionScheme;
+
+		u32 DFDByteOffset;
+		u32 DFDByteLength;
+		u32 KVDByteOffset;
+		u32 KVDByteLength;
+		u64 SGDByteOffset;
+		u64 SGDByteLength;
+	};
+	static_assert(sizeof(KTX2Header) == 80);
+
+	struct KTX2LevelIndex
+	{
+		u64 ByteOffset;
+		u64 ByteLength;
+		u64 UncompressedByteLength;
+	};
+	static_assert(sizeof(KTX2LevelIndex) == 24);
+
+	// The size of a format's smallest addressable unit: one texel for plain formats, one compressed block otherwise.
+	struct FormatBlock
+	{
+		u32 Width  = 1;
+		u32 Height = 1;
+		u32 Bytes  = 0;
+	};
+
+	// Only formats we know the layout of can be checked against the level sizes, so anything else is turned away.
+	std::optional<FormatBlock> GetFormatBlock(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8_SNORM:
+		case VK_FORMAT_R8_SRGB:
+			return FormatBlock{.Bytes = 1};
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R8G8_SRGB:
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16_SFLOAT:
+			return FormatBlock{.Bytes = 2};
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+		case VK_FORMAT_B8G8R8A8_UNORM:
+		case VK_FORMAT_B8G8R8A8_SRGB:
+		case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R32_SFLOAT:
+			return FormatBlock{.Bytes = 4};
+		case VK_FORMAT_R16G16B16A16_UNORM:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+			return FormatBlock{.Bytes = 8};
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			return FormatBlock{.Bytes = 16};
+
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+			return FormatBlock{.Width = 4, .Height = 4, .Bytes = 8};
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+		case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+		case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+		case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+			return FormatBlock{.Width = 4, .Height = 4, .Bytes = 16};
+		default:
+			break;
+		}
+
+		// ASTC blocks are always 16 bytes, and come in UNORM/SRGB pairs, one pair per footprint.
+		if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+		{
+			constexpr u32 Footprints[][2] = {{4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5},
+			                                 {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+			const u32 footprint = (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2;
+			return FormatBlock{.Width = Footprints[footprint][0], .Height = Footprints[footprint][1], .Bytes = 16};
+		}
+
+		return std::nullopt;
+	}
+}
+
+bool LoadKTX2Header(const std::filesystem::path& path, KTX2File& outFile, std::string& outError)
+{
+	// Through the file system, so the header comes out of the content archive, if that's where the texture is.
+	VirtualFileSystem* fileSystem = VirtualFileSystem::Get();
+	VULC_ASSERT(fileSystem, "Textures are read through the file system, so it has to exist by now");
+	const std::string        filePath = path.generic_string();
+	const std::optional<u64> fileSize = fileSystem->GetFileSize(filePath);
+	if (!fileSize)
+	{
+		outError = "couldn't open file";
+		return false;
+	}
+
+	KTX2Header header;
+	if (*fileSize < sizeof(header) ||
+	    !fileSystem->ReadRange(filePath, 0, {reinterpret_cast<u8*>(&header), sizeof(header)}) ||
+		memcmp(header.Identifier, KTX2Identifier, sizeof(KTX2Identifier)) != 0)
+	{
+		outError = "not a KTX2 file";
+		return false;
+	}
+
+	if (header.SupercompressionScheme != 0)
+	{
+		outError = fmt::format("supercompression scheme {} isn't supported", header.SupercompressionScheme);
+		return false;
+	}
+	if (header.VkFormat == VK_FORMAT_UNDEFINED)
+	{
+		outError = "no Vulkan format (Basis Universal textures aren't supported)";
+		return false;
+	}
+	if (header.PixelHeight == 0 || header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1)
+	{
+		outError = "only 2D textures are supported (no 1D, 3D, array or cubemap textures)";
+		return false;
+	}
+	if (header.PixelWidth == 0)
+	{
+		outError = "zero width";
+		return false;
+	}
+
+	const std::optional<FormatBlock> block = GetFormatBlock(static_cast<VkFormat>(header.VkFormat));
+	if (!block)
+	{
+		outError = fmt::format("format {} isn't supported", string_VkFormat(static_cast<VkFormat>(header.VkFormat)));
+		return false;
+	}
+
+	// A level count of 0 means "generate mips at load time", which we can't do for block-compressed data. More levels
+	// than it takes to get down to 1x1 would just be more 1x1 levels.
+	const u32 levelCount    = std::max(header.LevelCount, 1u);
+	const u32 maxLevelCount = static_cast<u32>(std::bit_width(std::max(header.PixelWidth, header.PixelHeight)));
+	if (levelCount > maxLevelCount)
+	{
+		outError = fmt::format("{} levels, but a {}x{} texture can only have {}", levelCount, header.PixelWidth,
+		                       header.PixelHeight, maxLevelCount);
+		return false;
+	}
+
+	std::vector<KTX2LevelIndex> levelIndex(levelCount);
+	const u64                   levelIndexSize = levelCount * sizeof(KTX2LevelIndex);
+	if (*fileSize < sizeof(header) + levelIndexSize ||
+	    !fileSystem->ReadRange(filePath, sizeof(header), {reinterpret_cast<u8*>(levelIndex.data()), levelIndexSize}))
+	{
+		outError = "truncated level index";
+		return false;
+	}
+
+	outFile.Path   = path;
+	outFile.Format = static_cast<VkFormat>(header.VkFormat);
+	outFile.Width  = header.PixelWidth;
+	outFile.Height = header.PixelHeight;
+	outFile.Levels.resize(levelCount);
+	for (u32 i = 0; i < levelCount; i++)
+	{
+		// Written so neither side can overflow, whatever the file says.
+		const KTX2LevelIndex& level = levelIndex[i];
+		if (level.ByteOffset > *fileSize || level.ByteLength > *fileSize - level.ByteOffset)
+		{
+			outError = fmt::format("level {} is outside the file", i);
+			return false;
+		}
+
+		// Uploads copy the whole mip extent out of staging, and staging's sized from this, so a level that's any
+		// shorter would have the copy read past the end of it. Anything beyond what the extent needs is never used.
+		const VkExtent3D extent   = outFile.GetMipExtent(i);
+		const u64        required = static_cast<u64>((extent.width + block->Width - 1) / block->Width) *
+		                            ((extent.height + block->Height - 1) / block->Height) * block->Bytes;
+		if (level.ByteLength < required)
+		{
+			outError = fmt::format("level {} is {} bytes, but a {}x{} level needs {}", i, level.ByteLength,
+			                       extent.width, extent.height, required);
+			return false;
+		}
+		outFile.Levels[i] = {.Offset = level.ByteOffset, .Size = required};
+	}
+
+	return true;
+}
+
+TextureCompressionFamily GetTextureCompressionFamily(VkFormat format)
+{
+	if (format >= VK_FORMAT_BC1_RGB_UNORM_BLOCK && format <= VK_FORMAT_BC7_SRGB_BLOCK)
+		return TextureCompressionFamily::BC;
+	if (format >= VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK && format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+		return TextureCompressionFamily::ETC2;
+	if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+		return TextureCompressionFamily::ASTC;
+	return TextureCompressionFamily::None;
+}
+
+const char* TextureCompressionFamilyToString(TextureCompressionFamily family)
+{
+	switch (family)
+	{
+	case TextureCompressionFamily::None:
+		return "Uncompressed";
+	case TextureCompressionFamily::BC:
+		return "BC";
+	case TextureCompressionFamily::ETC2:
+		return "ETC2";
+	case TextureCompressionFamily::ASTC:
+		return "ASTC";
+	}
+	return "Unknown";
+}
@@ -0,0 +1,90 @@
+#include "vulcpch.h"
+#include "Render/PassCache.h"
+
+PassInputHash& PassInputHash::AddBytes(const void* data, size_t size)
+{
+	// FNV-1a, but a word at a time, since some inputs (vertex buffers, say) are big enough for bytes to be slow.
+	const auto* bytes = static_cast<const u8*>(data);
+	size_t      i     = 0;
+	for (; i + sizeof(u64) <= size; i += sizeof(u64))
+	{
+		u64 word;
+		memcpy(&word, bytes + i, sizeof(u64));
+		m_Hash ^= word;
+		m_Hash *= 1099511628211ull;
+		m_Hash ^= m_Hash >> 32;
+	}
+	for (; i < size; i++)
+	{
+		m_Hash ^= bytes[i];
+		m_Hash *= 1099511628211ull;
+	}
+	return *this;
+}
+
+CachedPassID PassCache::Register(std::string name)
+{
+	m_Passes.push_back({.Name = std::move(name)});
+	return static_cast<CachedPassID>(m_Passes.size() - 1);
+}
+
+bool PassCache::ShouldExecute(CachedPassID pass, u64 inputHash, bool outputRetained)
+{
+	CachedPass& cached = m_Passes[pass];
+	if (m_Enabled && outputRetained && cached.Valid && cached.InputHash == inputHash)
+	{
+		cached.Skipped++;
+		return false;
+	}
+
+	cached.InputHash = inputHash;
+	cached.Valid     = true;
+	cached.Executed++;
+	return true;
+}
+
+void PassCache::Invalidate(CachedPassID pass)
+{
+	m_Passes[pass].Valid = false;
+}
+
+void PassCache::InvalidateAll()
+{
+	for (CachedPass& pass : m_Passes)
+		pass.Valid = false;
+}
+
+void PassCache::ApplySettings(const PassCacheSettings& settings)
+{
+	if (m_Enabled && !settings.Enabled)
+		InvalidateAll();
+	m_Enabled = settings.Enabled;
+}
+
+std::vector<PassCacheStats> PassCache::GetStats() const
+{
+	std::vector<PassCacheStats> stats;
+	stats.reserve(m_Passes.size());
+	for (const CachedPass& pass : m_Passes)
+		stats.push_back({.Name = pass.Name, .Executed = pass.Executed, .Skipped = pass.Skipped});
+	return stats;
+}
+
+void PassCache::OnDrawIMGui(PassCacheSettings& settings, std::span<const PassCacheStats> stats)
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Pass Cache");
+
+	ImGui::Checkbox("Enabled", &settings.Enabled);
+
+	for (const PassCacheStats& pass : stats)
+	{
+		const u64 total = pass.Executed + pass.Skipped;
+		ImGui::Text("%s: ran %llu, skipped %llu (%.0f%%)", pass.Name.c_str(),
+		            static_cast<unsigned long long>(pass.Executed), static_cast<unsigned long long>(pass.Skipped),
+		            total > 0 ? 100.0 * static_cast<f64>(pass.Skipped) / static_cast<f64>(total) : 0.0);
+	}
+
+	ImGui::End();
+#endif
+}
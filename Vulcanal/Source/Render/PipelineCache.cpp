@@ -0,0 +1,99 @@
+#include "vulcpch.h"
+#include "Render/PipelineCache.h"
+
+#include <fstream>
+
+namespace
+{
+	// VkPipelineCacheHeaderVersionOne, as laid out in the file.
+	struct CacheHeader
+	{
+		u32 HeaderSize;
+		u32 HeaderVersion;
+		u32 VendorID;
+		u32 DeviceID;
+		u8  PipelineCacheUUID[VK_UUID_SIZE];
+	};
+}
+
+void PipelineCache::Init(VkDevice device, VkPhysicalDevice gpu, std::filesystem::path path)
+{
+	m_Device = device;
+	m_GPU    = gpu;
+	m_Path   = std::move(path);
+
+	std::vector<u8> data;
+	if (std::ifstream file(m_Path, std::ios::ate | std::ios::binary); file.is_open())
+	{
+		data.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	if (!data.empty() && !IsCompatible(data))
+	{
+		VULC_INFO("Pipeline cache at {} is for a different device or driver, starting afresh", m_Path.string());
+		data.clear();
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo = {};
+	cacheInfo.sType                     = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize           = data.size();
+	cacheInfo.pInitialData              = data.empty() ? nullptr : data.data();
+	VK_CHECK(vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_Cache));
+
+	if (!data.empty())
+		VULC_INFO("Loaded {:.1f} KB pipeline cache", data.size() / 1024.0);
+}
+
+void PipelineCache::Shutdown()
+{
+	if (!m_Cache)
+		return;
+
+	Save();
+	vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+	m_Cache = nullptr;
+}
+
+void PipelineCache::Save() const
+{
+	size_t size = 0;
+	VK_CHECK(vkGetPipelineCacheData(m_Device, m_Cache, &size, nullptr));
+	std::vector<u8> data(size);
+	VK_CHECK(vkGetPipelineCacheData(m_Device, m_Cache, &size, data.data()));
+
+	// Write next to it and swap it in, so a crash mid-write can't leave a truncated cache behind.
+	std::filesystem::path tempPath = m_Path;
+	tempPath += ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			VULC_WARN("Failed to save pipeline cache to {}", m_Path.string());
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(size));
+	}
+
+	std::error_code error;
+	std::filesystem::rename(tempPath, m_Path, error);
+	if (error)
+		VULC_WARN("Failed to save pipeline cache to {}: {}", m_Path.string(), error.message());
+}
+
+bool PipelineCache::IsCompatible(const std::vector<u8>& data) const
+{
+	if (data.size() < sizeof(CacheHeader))
+		return false;
+
+	CacheHeader header;
+	std::memcpy(&header, data.data(), sizeof(header));
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_GPU, &properties);
+
+	return header.HeaderSize >= sizeof(CacheHeader) && header.HeaderVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+		header.VendorID == properties.vendorID && header.DeviceID == properties.deviceID &&
+		std::memcmp(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
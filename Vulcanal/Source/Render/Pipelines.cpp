@@ -1,33 +1,103 @@
 #include "vulcpch.h"
 #include "Render/Pipelines.h"
 
+#include "Core/FileSystem/VirtualFileSystem.h"
+
 bool LoadShaderModule(std::string_view path, VkDevice device, VkShaderModule* outShaderModule)
 {
-	std::ifstream file(path.data(), std::ios::ate | std::ios::binary);
-	if (!file.is_open())
+	// Shaders stored uncompressed in the content archive are used straight out of the mapping (entries are 16-byte
+	// aligned, so it's fine as SPIR-V words). Anything else is read into a buffer of words, so it's aligned too.
+	VirtualFileSystem*                 fileSystem = VirtualFileSystem::Get();
+	std::optional<std::span<const u8>> mapped     = fileSystem ? fileSystem->Map(path) : std::nullopt;
+	std::span<const u8>                code;
+	std::vector<u32>                   words;
+
+	if (mapped)
 	{
-		VULC_ERROR("Failed to open shader file: {}", path.data());
-		return false;
+		code = *mapped;
+	}
+	else if (fileSystem)
+	{
+		const std::optional<u64> fileSize = fileSystem->GetFileSize(path);
+		if (fileSize)
+		{
+			words.resize((*fileSize + sizeof(u32) - 1) / sizeof(u32));
+			code = {reinterpret_cast<const u8*>(words.data()), *fileSize};
+		}
+		if (!fileSize || !fileSystem->ReadRange(path, 0, {reinterpret_cast<u8*>(words.data()), code.size()}))
+		{
+			VULC_ERROR("Failed to read shader file: {}", path);
+			return false;
+		}
 	}
+	else
+	{
+		std::ifstream file(std::string(path), std::ios::ate | std::ios::binary);
+		if (!file.is_open())
+		{
+			VULC_ERROR("Failed to open shader file: {}", path);
+			return false;
+		}
 
-	size_t fileSize = file.tellg();
-	u8*    data     = new u8[fileSize];
-	file.seekg(0);
-	file.read(reinterpret_cast<char*>(data), fileSize);
-	file.close();
+		const size_t fileSize = file.tellg();
+		words.resize((fileSize + sizeof(u32) - 1) / sizeof(u32));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(words.data()), static_cast<std::streamsize>(fileSize));
+		code = {reinterpret_cast<const u8*>(words.data()), fileSize};
+	}
 
 	VkShaderModuleCreateInfo createInfo = {};
 	createInfo.sType                    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
 	createInfo.pNext                    = nullptr;
-	createInfo.codeSize                 = fileSize;
-	createInfo.pCode                    = reinterpret_cast<u32*>(data);
+	createInfo.codeSize                 = code.size();
+	createInfo.pCode                    = reinterpret_cast<const u32*>(code.data());
 
 	VkShaderModule shaderModule;
 	if (vkCreateShaderModule(device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS)
 		return false;
 	*outShaderModule = shaderModule;
 
-	delete[] data;
-	
 	return true;
 }
+
+VkPipeline CreateComputePipeline(VkDevice device, VkPipelineLayout layout, VkShaderModule shader,
+                                 const WorkgroupSize& workgroupSize, std::span<const SpecializationValue> constants,
+                                 VkPipelineCache cache)
+{
+	std::vector<u32>                      data    = {workgroupSize.X, workgroupSize.Y, workgroupSize.Z};
+	std::vector<VkSpecializationMapEntry> entries = {
+		{WorkgroupSizeXConstantID, 0, sizeof(u32)},
+		{WorkgroupSizeYConstantID, sizeof(u32), sizeof(u32)},
+		{WorkgroupSizeZConstantID, sizeof(u32) * 2, sizeof(u32)},
+	};
+	for (const SpecializationValue& constant : constants)
+	{
+		VULC_ASSERT(constant.ID > WorkgroupSizeZConstantID, "Specialisation constants 0-2 are the workgroup size");
+		entries.push_back({constant.ID, static_cast<u32>(data.size() * sizeof(u32)), sizeof(u32)});
+		data.push_back(constant.Value);
+	}
+
+	VkSpecializationInfo specialisation = {};
+	specialisation.mapEntryCount        = static_cast<u32>(entries.size());
+	specialisation.pMapEntries          = entries.data();
+	specialisation.dataSize             = data.size() * sizeof(u32);
+	specialisation.pData                = data.data();
+
+	VkPipelineShaderStageCreateInfo stageInfo = {};
+	stageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stageInfo.pNext                           = nullptr;
+	stageInfo.stage                           = VK_SHADER_STAGE_COMPUTE_BIT;
+	stageInfo.module                          = shader;
+	stageInfo.pName                           = "main"; // Entry point.
+	stageInfo.pSpecializationInfo             = &specialisation;
+
+	VkComputePipelineCreateInfo computePipelineInfo = {};
+	computePipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineInfo.pNext                       = nullptr;
+	computePipelineInfo.layout                      = layout;
+	computePipelineInfo.stage                       = stageInfo;
+
+	VkPipeline pipeline = nullptr;
+	VK_CHECK(vkCreateComputePipelines(device, cache, 1, &computePipelineInfo, nullptr, &pipeline));
+	return pipeline;
+}
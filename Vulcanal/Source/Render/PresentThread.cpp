@@ -0,0 +1,215 @@
+#include "vulcpch.h"
+#include "Render/PresentThread.h"
+
+namespace
+{
+	// Acquires time out quickly, so a present queued in the meantime isn't stuck behind one for a whole vsync.
+	constexpr u64 AcquireTimeout = 2000000; // 2ms.
+}
+
+PresentThread::~PresentThread()
+{
+	Stop();
+}
+
+void PresentThread::Start(VkDevice device, VkQueue queue, std::mutex* queueMutex, VkSwapchainKHR swapchain,
+                          u32 maxAcquired, u32 framesInFlight)
+{
+	VULC_ASSERT(!IsRunning(), "Present thread already running");
+
+	m_Device      = device;
+	m_Queue       = queue;
+	m_QueueMutex  = queueMutex;
+	m_Swapchain   = swapchain;
+	m_MaxAcquired = std::max(1u, maxAcquired);
+	m_Held        = 0;
+	m_Ahead       = 0;
+	m_OutOfDate   = false;
+	m_Stopping    = false;
+
+	// Enough for every image we could be holding, plus one for each frame that's still waiting to hand its back.
+	VkSemaphoreCreateInfo semaphoreInfo = CreateSemaphoreCreateInfo();
+	m_AllSemaphores.resize(m_MaxAcquired + framesInFlight);
+	for (VkSemaphore& semaphore : m_AllSemaphores)
+		VK_CHECK(vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &semaphore));
+	m_FreeSemaphores = m_AllSemaphores;
+
+	// Every present is of an image we acquired, and every semaphore comes back at most once.
+	m_Presents = CreateScope<SPSCQueue<QueuedPresent>>(m_MaxAcquired);
+	m_Recycled = CreateScope<SPSCQueue<VkSemaphore>>(static_cast<u32>(m_AllSemaphores.size()));
+	m_WorkReady.Reset();
+	m_ImageReady.Reset();
+
+	m_Thread = std::thread(&PresentThread::ThreadLoop, this);
+}
+
+void PresentThread::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	m_Stopping.store(true, std::memory_order_release);
+	m_WorkReady.Set();
+	m_Thread.join();
+
+	// Some semaphores may still be waited on by a submission, or signalled by an acquire nobody used, and neither can
+	// be destroyed until the device is done with them.
+	{
+		std::lock_guard queueLock(*m_QueueMutex);
+		vkDeviceWaitIdle(m_Device);
+	}
+	for (VkSemaphore semaphore : m_AllSemaphores)
+		vkDestroySemaphore(m_Device, semaphore, nullptr);
+
+	m_AllSemaphores.clear();
+	m_FreeSemaphores.clear();
+	while (m_Acquired.TryPop())
+	{
+	}
+	m_Presents.reset();
+	m_Recycled.reset();
+	m_Held           = 0;
+	m_Ahead          = 0;
+	m_PresentsQueued = 0;
+	m_PresentsIssued = 0;
+}
+
+std::optional<PresentThread::AcquiredImage> PresentThread::Acquire()
+{
+	while (true)
+	{
+		// Read before looking for an image, so one that arrives along with the news that the swapchain's suboptimal
+		// still gets handed out.
+		const bool giveUp = m_OutOfDate.load(std::memory_order_acquire) || m_Stopping.load(std::memory_order_acquire);
+		if (std::optional<AcquiredImage> image = m_Acquired.TryPop())
+		{
+			// There's room to get another one ahead.
+			m_Ahead.fetch_sub(1, std::memory_order_release);
+			m_WorkReady.Set();
+			return image;
+		}
+
+		if (giveUp)
+			return std::nullopt;
+		m_ImageReady.Wait();
+	}
+}
+
+u64 PresentThread::Present(u32 imageIndex, VkSemaphore waitSemaphore, u64 presentID)
+{
+	const bool queued = m_Presents->TryPush({.ImageIndex = imageIndex, .WaitSemaphore = waitSemaphore,
+	                                         .PresentID = presentID});
+	VULC_ASSERT(queued, "Presenting more images than were acquired");
+	m_WorkReady.Set();
+	return ++m_PresentsQueued;
+}
+
+void PresentThread::WaitForPresent(u64 ticket)
+{
+	while (m_PresentsIssued.load(std::memory_order_acquire) < ticket && !m_Stopping.load(std::memory_order_acquire))
+		m_ImageReady.Wait();
+}
+
+void PresentThread::Recycle(VkSemaphore semaphore)
+{
+	const bool recycled = m_Recycled->TryPush(semaphore);
+	VULC_ASSERT(recycled, "Recycled more semaphores than were handed out");
+	m_WorkReady.Set();
+}
+
+bool PresentThread::IsOutOfDate() const
+{
+	return m_OutOfDate.load(std::memory_order_acquire);
+}
+
+void PresentThread::ThreadLoop()
+{
+	while (true)
+	{
+		// Read before looking for presents, so every present queued before Stop() is issued before we go.
+		const bool stopping = m_Stopping.load(std::memory_order_acquire);
+
+		while (std::optional<VkSemaphore> semaphore = m_Recycled->TryPop())
+			m_FreeSemaphores.push_back(*semaphore);
+
+		// Presents go first, as they're what frees images up to acquire.
+		if (std::optional<QueuedPresent> present = m_Presents->TryPop())
+		{
+			VkPresentIdKHR presentIDInfo = {};
+			presentIDInfo.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+			presentIDInfo.swapchainCount = 1;
+			presentIDInfo.pPresentIds    = &present->PresentID;
+
+			VkPresentInfoKHR presentInfo   = {};
+			presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+			presentInfo.pNext              = present->PresentID != 0 ? &presentIDInfo : nullptr;
+			presentInfo.pSwapchains        = &m_Swapchain;
+			presentInfo.swapchainCount     = 1;
+			presentInfo.pWaitSemaphores    = &present->WaitSemaphore;
+			presentInfo.waitSemaphoreCount = 1;
+			presentInfo.pImageIndices      = &present->ImageIndex;
+
+			VkResult result;
+			{
+				std::lock_guard queueLock(*m_QueueMutex);
+				result = vkQueuePresentKHR(m_Queue, &presentInfo);
+			}
+
+			m_Held--;
+			if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
+				m_OutOfDate.store(true, std::memory_order_release);
+			else if (result != VK_SUCCESS)
+				VULC_WARN("vkQueuePresentKHR failed: {}", string_VkResult(result));
+			m_PresentsIssued.fetch_add(1, std::memory_order_release);
+			m_ImageReady.Set();
+			continue;
+		}
+
+		if (stopping)
+			break;
+
+		// Whatever could change this (a present, a semaphore coming back, the renderer taking an image) sets the event
+		// afterwards, so a change between the check and the wait just means the wait returns straight away.
+		if (!CanAcquire())
+		{
+			m_WorkReady.Wait();
+			continue;
+		}
+
+		const VkSemaphore semaphore = m_FreeSemaphores.back();
+		m_FreeSemaphores.pop_back();
+		m_Held++;
+
+		u32            imageIndex = 0;
+		const VkResult result     = vkAcquireNextImageKHR(m_Device, m_Swapchain, AcquireTimeout, semaphore, nullptr,
+		                                                  &imageIndex);
+
+		if (result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR)
+		{
+			// CanAcquire() made sure there's room.
+			m_Ahead.fetch_add(1, std::memory_order_relaxed);
+			m_Acquired.TryPush({.ImageIndex = imageIndex, .Semaphore = semaphore});
+			if (result == VK_SUBOPTIMAL_KHR)
+				m_OutOfDate.store(true, std::memory_order_release);
+		}
+		else
+		{
+			// Nothing was acquired, so the semaphore's untouched.
+			m_Held--;
+			m_FreeSemaphores.push_back(semaphore);
+			if (result != VK_TIMEOUT && result != VK_NOT_READY)
+			{
+				if (result != VK_ERROR_OUT_OF_DATE_KHR)
+					VULC_WARN("vkAcquireNextImageKHR failed: {}", string_VkResult(result));
+				m_OutOfDate.store(true, std::memory_order_release);
+			}
+		}
+		m_ImageReady.Set();
+	}
+}
+
+bool PresentThread::CanAcquire() const
+{
+	return !m_OutOfDate.load(std::memory_order_relaxed) && m_Ahead.load(std::memory_order_acquire) < MaxAhead &&
+	       m_Held < m_MaxAcquired && !m_FreeSemaphores.empty();
+}
@@ -11,6 +11,17 @@
 #include "Core/Application.h"
 #include "Render/Pipelines.h"
 
+namespace
+{
+	constexpr VkFormat          DrawImageFormat = VK_FORMAT_R16G16B16A16_SFLOAT;
+	constexpr VkImageUsageFlags DrawImageUsage  = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+		VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+	// Matches GradientTest.comp.
+	constexpr u32 GradientSmoothConstantID      = 3;
+	constexpr u32 GradientColourCountConstantID = 4;
+}
+
 Renderer::~Renderer()
 {
 	Shutdown();
@@ -51,45 +62,178 @@ bool Renderer::Init(RendererSpecification spec)
 		return false;
 	if (!InitDescriptors())
 		return false;
+
+	// Set before the pipelines, since autotuning runs the gradient.
+	const GradientSettings gradient = {};
+	m_PushConstants.Colour1         = gradient.Colour1;
+	m_PushConstants.Colour2         = gradient.Colour2;
+	m_PushConstants.Colour3         = gradient.Colour3;
+	m_PushConstants.ColourPoints    = gradient.ColourPoints;
+
 	if (!InitPipelines())
 		return false;
 
 	if (!InitImGUI())
 		return false;
-	
-	m_PushConstants.Colour1 = glm::vec4(1, 0, 0, 1);
-	m_PushConstants.Colour2 = glm::vec4(0, 1, 0, 1);
-	m_PushConstants.Colour3 = glm::vec4(0, 0, 1, 1);
-	m_PushConstants.ColourPoints = glm::vec3(0.1f, 0.5f, 0.8f);
 
+	m_TextureStreamer.Init(this, &m_Spec.App->GetThreadPool(), &m_Spec.App->GetAsyncIO());
+	m_GPUAwaits.Init(m_Device, &m_Spec.App->GetJobSystem());
+	m_ResidencyManager.Init(this, &m_TextureStreamer);
+	m_Defragmenter.Init(this);
+	m_TransientImages.Init(this);
+	m_GradientPass = m_PassCache.Register("Gradient");
+	m_ImGuiPass    = m_PassCache.Register("ImGui Overlay");
+
+	// The UI starts from whatever we actually ended up with (dynamic resolution's off without timestamps, say).
+	m_UISettings = {
+		.WindowSize = m_WindowSize, .PresentMode = m_Spec.PresentMode, .LowLatency = m_Spec.LowLatency,
+		.CacheImGui = m_Spec.CacheImGui, .ParallelRecording = m_Spec.ParallelRecording,
+		.UsePresentThread = m_Spec.UsePresentThread,
+		.Gradient = {
+			.Colour1 = m_PushConstants.Colour1, .Colour2 = m_PushConstants.Colour2, .Colour3 = m_PushConstants.Colour3,
+			.ColourPoints = m_PushConstants.ColourPoints, .Key = m_GradientKey
+		},
+		.Defragmenter = m_Defragmenter.GetSettings(), .DynamicResolution = m_DynamicResolution.GetSettings(),
+		.Resolve = m_ResolvePass.GetSettings(), .PassCache = m_PassCache.GetSettings()
+	};
 	m_Spec.App->OnDrawIMGui.BindMethod(this, &Renderer::OnDrawIMGui);
 
+	// Last, since everything before here may still want the queue to itself.
+	if (m_Spec.UsePresentThread)
+		StartPresentThread();
+
 	return true;
 }
 
-void Renderer::Render()
+void Renderer::Render(FramePacket* packet)
 {
+	m_FramePacket = packet;
+
+	// First, since some of them need the swapchain recreated.
+	ApplySettings(packet ? packet->Settings : TakeSettings());
+
+	if (m_PresentThread.IsRunning() && m_PresentThread.IsOutOfDate())
+		m_SwapchainDirty = true;
 	if (m_SwapchainDirty)
 		RecreateSwapchain();
 	
 	FrameData& frame = GetCurrentFrame();
 
 	// Let's wait for our render fence.
+	// It's only reset just before we submit, so a frame we give up on leaves it signalled.
 	VK_CHECK(vkWaitForFences(m_Device, 1, &frame.RenderFence, true, 1000000000));
-	VK_CHECK(vkResetFences(m_Device, 1, &frame.RenderFence));
+
+	// The submission that waited on this frame's acquire semaphore has finished, so the present thread can have it
+	// back. Its present also has to be on the queue before we signal the render semaphore again; it almost always is.
+	if (frame.AcquireSemaphore)
+	{
+		m_PresentThread.Recycle(frame.AcquireSemaphore);
+		frame.AcquireSemaphore = nullptr;
+	}
+	if (frame.PresentTicket)
+	{
+		m_PresentThread.WaitForPresent(frame.PresentTicket);
+		frame.PresentTicket = 0;
+	}
 
 	// Perform any pending deletions from our frame.
 	frame.FrameDeletionQueue.Flush();
 
+	// And the frame's retired, so all its secondary command buffers can go back in one go.
+	for (WorkerCommandPool& workerPool : frame.WorkerPools)
+	{
+		if (workerPool.UsedBuffers == 0)
+			continue;
+		VK_CHECK(vkResetCommandPool(m_Device, workerPool.Pool, 0));
+		workerPool.UsedBuffers = 0;
+	}
+
+	// The frame we just waited on tells us how long the GPU's taking, so pick this frame's resolution from that.
+	ReadFrameTimestamps(frame);
+
+	// Anything deferred FramesInFlight frames ago is now definitely finished with, since we've just waited on the
+	// oldest frame that could have used it.
+	while (!m_DeferredDestruction.empty() && m_DeferredDestruction.front().first <= m_FrameIndex)
+	{
+		m_DeferredDestruction.front().second();
+		m_DeferredDestruction.pop_front();
+	}
+
+	m_ResidencyManager.Update();
+	m_TextureStreamer.Update();
+
+	// Async work goes in ahead of the frame, and anything waiting on earlier work that's since finished can carry on.
+	FlushAsyncSubmits();
+	m_GPUAwaits.Poll();
+
 	// Time to get the swapchain image that we'll blit to when we present.
 	// Let's quickly talk about semaphores. The swapchain semaphore we pass in here is used to signal that the swapchain
 	// image is available. So, you'll see later when we submit our command buffer that we wait on this semaphore before
 	// we actually start executing the commands. When we submit, we also provide a  semaphore (frame.RenderSemaphore),
 	// to be signalled when the command buffer is done executing. We use this to know when we can present the swapchain
 	// image to the screen - the call to vkQueuePresent takes the render semaphore as a wait semaphore parameter.
-	VK_CHECK(
-		vkAcquireNextImageKHR(m_Device, m_Swapchain, 1000000000, frame.SwapchainSemaphore, nullptr, &m_SwapchainImageIndex
-		));
+	// With the present thread, it's already acquired one ahead of us, with a semaphore of its own. If it hasn't, every
+	// image is in use, and we'd have blocked here anyway.
+	VkSemaphore acquireSemaphore = frame.SwapchainSemaphore;
+	if (m_PresentThread.IsRunning())
+	{
+		const std::optional<PresentThread::AcquiredImage> image = m_PresentThread.Acquire();
+		if (!image)
+		{
+			// The swapchain's out of date, so give up on this frame, and recreate it at the start of the next one.
+			m_SwapchainDirty = true;
+			m_FrameSkipped   = true;
+			m_FramePacket    = nullptr;
+			return;
+		}
+		m_SwapchainImageIndex  = image->ImageIndex;
+		frame.AcquireSemaphore = image->Semaphore;
+		acquireSemaphore       = image->Semaphore;
+	}
+	else
+	{
+		VK_CHECK(
+			vkAcquireNextImageKHR(m_Device, m_Swapchain, 1000000000, frame.SwapchainSemaphore, nullptr,
+				&m_SwapchainImageIndex));
+	}
+
+	// Work out this frame's intermediate images. The draw image is drawn into (pass 0) and then read by the resolve
+	// (pass 1); if the resolve can't write the swapchain directly, it writes its own image, which is blitted across
+	// (pass 2). Passes that need their own targets should declare them here too, so they can share memory.
+	// The draw image is always at the largest size dynamic resolution can ask for, so changing scale never rebuilds it.
+	// It's persistent, so the gradient can be left in it between frames rather than redrawn.
+	const bool resolve            = m_ResolvePass.IsReady();
+	const bool resolveToSwapchain = resolve && m_SwapchainSupportsStorage && !m_ResolvePass.IsForcingBlit();
+#ifndef VULC_NO_IMGUI
+	const bool cacheImGui = resolve && m_Spec.CacheImGui;
+#else
+	const bool cacheImGui = false;
+#endif
+
+	m_TransientImages.BeginFrame();
+	const TransientImageHandle drawImageHandle = m_TransientImages.Declare({
+		.Format = DrawImageFormat, .Extent = m_DynamicResolution.GetMaxExtent(m_SwapchainExtent), .Usage = DrawImageUsage
+	}, 0, 1, true);
+	TransientImageHandle resolveImageHandle = 0;
+	if (resolve && !resolveToSwapchain)
+	{
+		resolveImageHandle = m_TransientImages.Declare({
+			.Format = ResolvePass::IntermediateFormat, .Extent = m_SwapchainExtent,
+			.Usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT
+		}, 1, 2);
+	}
+	// Same format as the swapchain, so ImGui's pipeline can draw into it too.
+	TransientImageHandle imguiOverlayHandle = 0;
+	if (cacheImGui)
+	{
+		imguiOverlayHandle = m_TransientImages.Declare({
+			.Format = m_SwapchainImageFormat, .Extent = m_SwapchainExtent,
+			.Usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT
+		}, 1, 1, true);
+	}
+	m_TransientImages.Compile();
+	m_DrawImage = m_TransientImages.Get(drawImageHandle);
+	UpdateDrawImageDescriptor(frame);
 
 	// Reset our command buffer.
 	VkCommandBuffer commandBuffer = frame.MainCommandBuffer;
@@ -99,67 +243,197 @@ void Renderer::Render()
 	VkCommandBufferBeginInfo beginInfo = CreateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
 	VK_CHECK(vkBeginCommandBuffer(commandBuffer, &beginInfo));
 
-	// Update our draw extent.
-	m_DrawExtent.width  = m_DrawImage.Extent.width;
-	m_DrawExtent.height = m_DrawImage.Extent.height;
+	if (frame.TimestampQueryPool)
+	{
+		vkCmdResetQueryPool(commandBuffer, frame.TimestampQueryPool, 0, 2);
+		vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, frame.TimestampQueryPool, 0);
+	}
+
+	// Update our draw extent. We only render into the top left of the draw image, and the resolve scales it up.
+	m_DrawExtent = m_DynamicResolution.GetDrawExtent({m_DrawImage.Extent.width, m_DrawImage.Extent.height});
+	m_PushConstants.DrawExtent = {static_cast<s32>(m_DrawExtent.width), static_cast<s32>(m_DrawExtent.height)};
 
-	// Transition our draw image.
-	TransitionImage(commandBuffer, m_DrawImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	// Move a little memory around, if we're defragmenting. This goes first, so anything switched over to a moved
+	// image this frame is only ever sampled after the copy.
+	m_Defragmenter.Update(commandBuffer);
+
+	// Only transition the draw image when its layout actually changes, since a skipped pass leaves it as it was.
+	auto transitionDrawImage = [&](VkImageLayout layout)
+	{
+		if (m_DrawImageLayout != layout)
+			TransitionImage(commandBuffer, m_DrawImage.Image, m_DrawImageLayout, layout);
+		m_DrawImageLayout = layout;
+	};
 
 	// This is where we're actually able to draw things!
-	// Clear our screen.
-	Clear(commandBuffer);
+	// The passes up to the resolve don't touch each other's images, so they're recorded in parallel (see
+	// RecordPasses()). What runs, and with which pipelines, is all decided here first; the recorders only record.
+	std::vector<PassRecorder> passes;
+
+	// The gradient only depends on its pipeline, push constants and target, so unless one of those has changed, last
+	// frame's is still sitting in the draw image, and we can skip it. Nothing else draws into the draw image yet; once
+	// something does, it'll need to invalidate the gradient too.
+	const VkPipeline gradientPipeline  = m_GradientPermutations.Get(m_GradientKey);
+	const bool       drawImageRetained = m_DrawImageGeneration == m_TransientImages.GetGeneration();
+	m_DrawImageGeneration              = m_TransientImages.GetGeneration();
+	if (m_PassCache.ShouldExecute(m_GradientPass, GetGradientInputHash(gradientPipeline), drawImageRetained))
+	{
+		m_DrawImageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		passes.emplace_back([this, gradientPipeline](VkCommandBuffer cmd)
+		{
+			// Whatever was in there before can go.
+			TransitionImage(cmd, m_DrawImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+
+			// Clear our screen.
+			Clear(cmd, gradientPipeline);
+		});
+	}
 
-	// Okay, we're done drawing - lets prepare our draw and swapchain images for the blit.
-	TransitionImage(commandBuffer, m_DrawImage.Image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-	TransitionImage(commandBuffer, m_SwapchainImages[m_SwapchainImageIndex], VK_IMAGE_LAYOUT_UNDEFINED,
-	                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	// With a cached UI, ImGui only gets drawn when something in it has changed; otherwise last frame's overlay is
+	// composited again as it is. Idle tool layouts then cost one texel fetch a pixel, rather than a raster of the lot.
+	VkImageView imguiOverlay = nullptr;
+#ifndef VULC_NO_IMGUI
+	if (cacheImGui)
+	{
+		const AllocatedImage& overlay         = m_TransientImages.Get(imguiOverlayHandle);
+		const bool            overlayRetained = m_ImGuiOverlayGeneration == m_TransientImages.GetGeneration();
+		m_ImGuiOverlayGeneration              = m_TransientImages.GetGeneration();
+		if (m_PassCache.ShouldExecute(m_ImGuiPass, GetImGuiInputHash(), overlayRetained))
+		{
+			passes.emplace_back([this, overlay](VkCommandBuffer cmd)
+			{
+				constexpr VkClearValue transparent = {};
+				TransitionImage(cmd, overlay.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+				DrawImGUI(cmd, overlay.ImageView, &transparent);
+				TransitionImage(cmd, overlay.Image, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+			});
+		}
+		imguiOverlay = overlay.ImageView;
+	}
+#endif
 
-	// Do the actual blit.
-	BlitImageToImage(commandBuffer, m_DrawImage.Image, m_SwapchainImages[m_SwapchainImageIndex], m_DrawExtent,
-	                 m_SwapchainExtent);
+	RecordPasses(commandBuffer, frame, passes);
+
+	// Okay, we're done drawing - now to get it onto the swapchain image. The resolve does the upscale, tonemapping and
+	// grading in one go, reading the draw image once.
+	VkImage       swapchainImage  = m_SwapchainImages[m_SwapchainImageIndex];
+	VkImageLayout swapchainLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	const u32     frameSlot       = static_cast<u32>(m_FrameIndex % FramesInFlight);
+	if (resolveToSwapchain)
+	{
+		// Straight into the swapchain, so no copy at all.
+		transitionDrawImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		TransitionImage(commandBuffer, swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+		m_ResolvePass.Record(commandBuffer, frameSlot, m_DrawImage, m_DrawExtent,
+		                     m_SwapchainImageViews[m_SwapchainImageIndex], m_SwapchainExtent, imguiOverlay);
+		swapchainLayout = VK_IMAGE_LAYOUT_GENERAL;
+	}
+	else if (resolve)
+	{
+		// The surface won't take storage writes, so resolve into our own image and blit that across 1:1.
+		const AllocatedImage& resolveImage = m_TransientImages.Get(resolveImageHandle);
+		transitionDrawImage(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		TransitionImage(commandBuffer, resolveImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+		m_ResolvePass.Record(commandBuffer, frameSlot, m_DrawImage, m_DrawExtent, resolveImage.ImageView,
+		                     m_SwapchainExtent, imguiOverlay);
+
+		TransitionImage(commandBuffer, resolveImage.Image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		TransitionImage(commandBuffer, swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		BlitImageToImage(commandBuffer, resolveImage.Image, swapchainImage, m_SwapchainExtent, m_SwapchainExtent,
+		                 VK_FILTER_NEAREST);
+	}
+	else
+	{
+		// No resolve pass at all, so just scale the draw image across as it is.
+		transitionDrawImage(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		TransitionImage(commandBuffer, swapchainImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+		BlitImageToImage(commandBuffer, m_DrawImage.Image, swapchainImage, m_DrawExtent, m_SwapchainExtent);
+	}
 
 #ifndef VULC_NO_IMGUI
-	TransitionImage(commandBuffer, m_SwapchainImages[m_SwapchainImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-	                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-	DrawImGUI(commandBuffer, m_SwapchainImageViews[m_SwapchainImageIndex]);
-	TransitionImage(commandBuffer, m_SwapchainImages[m_SwapchainImageIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-	                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
-#else
-	// Transition our swapchain image to the required format for presenting.
-	TransitionImage(commandBuffer, m_SwapchainImages[swapchainImageIndex], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-					VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+	if (!cacheImGui)
+	{
+		TransitionImage(commandBuffer, swapchainImage, swapchainLayout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		DrawImGUI(commandBuffer, m_SwapchainImageViews[m_SwapchainImageIndex]);
+		swapchainLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	}
 #endif
 
+	// Transition our swapchain image to the required format for presenting.
+	TransitionImage(commandBuffer, swapchainImage, swapchainLayout, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+
+	if (frame.TimestampQueryPool)
+	{
+		vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, frame.TimestampQueryPool, 1);
+		frame.TimestampsWritten = true;
+	}
+
 	// End our command buffer.
 	VK_CHECK(vkEndCommandBuffer(commandBuffer));
 
 	// Submit our command buffer.
 	VkCommandBufferSubmitInfo cmdInfo  = CreateCommandBufferSubmitInfo(commandBuffer);
 	VkSemaphoreSubmitInfo     waitInfo = CreateSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
-	                                                           frame.SwapchainSemaphore);
+	                                                           acquireSemaphore);
 	VkSemaphoreSubmitInfo signalInfo = CreateSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT,
 	                                                             frame.RenderSemaphore);
 
 	VkSubmitInfo2 submit = CreateSubmitInfo(&cmdInfo, &signalInfo, &waitInfo);
 
 	// This is the big moment: submit our command buffer to the GPU.
-	VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submit, frame.RenderFence));
+	VK_CHECK(vkResetFences(m_Device, 1, &frame.RenderFence));
+	{
+		std::lock_guard queueLock(m_QueueMutex);
+		VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submit, frame.RenderFence));
+	}
+
+	PublishStats();
+	m_FramePacket = nullptr;
 }
 
 void Renderer::Present()
 {
+	if (m_FrameSkipped)
+	{
+		m_FrameSkipped = false;
+		return;
+	}
+
+	// Tag the present, so low latency mode can wait for it to be displayed.
+	const u64      presentID     = m_NextPresentID;
+	VkPresentIdKHR presentIDInfo = {};
+	presentIDInfo.sType          = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	presentIDInfo.swapchainCount = 1;
+	presentIDInfo.pPresentIds    = &presentID;
+
 	// Present our swapchain.
 	VkPresentInfoKHR presentInfo   = {};
 	presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.pNext              = nullptr;
+	presentInfo.pNext              = m_SupportsPresentWait ? &presentIDInfo : nullptr;
 	presentInfo.pSwapchains        = &m_Swapchain;
 	presentInfo.swapchainCount     = 1;
 	presentInfo.pWaitSemaphores    = &GetCurrentFrame().RenderSemaphore;
 	presentInfo.waitSemaphoreCount = 1;
 	presentInfo.pImageIndices      = &m_SwapchainImageIndex;
 
-	VK_CHECK(vkQueuePresentKHR(m_GraphicsQueue, &presentInfo));
+	if (m_PresentThread.IsRunning())
+	{
+		// It'll go out as soon as the present thread gets to it, and we can get on with the next frame.
+		GetCurrentFrame().PresentTicket = m_PresentThread.Present(m_SwapchainImageIndex, GetCurrentFrame().RenderSemaphore,
+		                                                          m_SupportsPresentWait ? presentID : 0);
+	}
+	else
+	{
+		std::lock_guard queueLock(m_QueueMutex);
+		VK_CHECK(vkQueuePresentKHR(m_GraphicsQueue, &presentInfo));
+	}
+
+	if (m_SupportsPresentWait)
+	{
+		m_LastPresentID = presentID;
+		m_NextPresentID++;
+	}
 
 	// We're done with this frame. Let's iterate.
 	m_FrameIndex++;
@@ -180,17 +454,130 @@ void Renderer::ImmediateSubmit(std::function<void(VkCommandBuffer cmd)>&& functi
 	VkCommandBufferSubmitInfo submitInfo = CreateCommandBufferSubmitInfo(m_ImmediateCommandBuffer);
 	VkSubmitInfo2             submit     = CreateSubmitInfo(&submitInfo, nullptr, nullptr);
 
-	VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submit, m_ImmediateFence));
+	{
+		std::lock_guard queueLock(m_QueueMutex);
+		VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, 1, &submit, m_ImmediateFence));
+	}
 	VK_CHECK(vkWaitForFences(m_Device, 1, &m_ImmediateFence, true, 9999999999));
 }
 
+GPUAwaiter Renderer::SubmitAsync(std::function<void(VkCommandBuffer cmd)>&& function)
+{
+	std::lock_guard lock(m_AsyncMutex);
+	const u64 value = m_NextAsyncValue++;
+	m_PendingAsyncSubmits.emplace_back(value, std::move(function));
+	return m_GPUAwaits.WaitForTimeline(m_AsyncTimeline, value);
+}
+
+void Renderer::DeferDestruction(std::function<void()>&& function)
+{
+	// If we're mid-recording, this frame's submission is still to come, so count it as in flight too.
+	m_DeferredDestruction.emplace_back(m_FrameIndex + FramesInFlight, std::move(function));
+}
+
+bool Renderer::SupportsTextureCompression(TextureCompressionFamily family) const
+{
+	switch (family)
+	{
+	case TextureCompressionFamily::None:
+		return true;
+	case TextureCompressionFamily::BC:
+		return m_SupportsBC;
+	case TextureCompressionFamily::ETC2:
+		return m_SupportsETC2;
+	case TextureCompressionFamily::ASTC:
+		return m_SupportsASTC;
+	}
+	return false;
+}
+
+AllocatedBuffer Renderer::CreateBuffer(size_t size, VkBufferUsageFlags usage, VmaMemoryUsage memoryUsage,
+                                       VmaAllocationCreateFlags flags) const
+{
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType              = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.pNext              = nullptr;
+	bufferInfo.size               = size;
+	bufferInfo.usage              = usage;
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage                   = memoryUsage;
+	allocInfo.flags                   = flags;
+
+	AllocatedBuffer buffer;
+	VK_CHECK(vmaCreateBuffer(m_Allocator, &bufferInfo, &allocInfo, &buffer.Buffer, &buffer.Allocation, &buffer.Info));
+	return buffer;
+}
+
+void Renderer::DestroyBuffer(AllocatedBuffer& buffer) const
+{
+	if (buffer.Buffer)
+		vmaDestroyBuffer(m_Allocator, buffer.Buffer, buffer.Allocation);
+	buffer.Reset();
+}
+
+AllocatedImage Renderer::CreateImage(VkExtent3D extent, VkFormat format, VkImageUsageFlags usage, u32 mipLevels,
+                                     VmaAllocationCreateFlags allocationFlags) const
+{
+	AllocatedImage image = {};
+	image.Extent         = extent;
+	image.Format         = format;
+	image.MipLevels      = mipLevels;
+
+	VkImageCreateInfo imageInfo = CreateImageCreateInfo(format, usage, extent, mipLevels);
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+	allocInfo.requiredFlags           = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	allocInfo.flags                   = allocationFlags;
+
+	VkResult result = vmaCreateImage(m_Allocator, &imageInfo, &allocInfo, &image.Image, &image.Allocation, nullptr);
+	if (result == VK_ERROR_OUT_OF_DEVICE_MEMORY && (allocationFlags & VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT))
+	{
+		image.Reset();
+		return image;
+	}
+	VK_CHECK(result);
+
+	// The view covers the whole mip chain.
+	VkImageAspectFlags aspect = format == VK_FORMAT_D32_SFLOAT ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+	VkImageViewCreateInfo viewInfo = CreateImageViewCreateInfo(format, image.Image, aspect, VK_IMAGE_VIEW_TYPE_2D, 0,
+	                                                           mipLevels);
+	VK_CHECK(vkCreateImageView(m_Device, &viewInfo, nullptr, &image.ImageView));
+
+	return image;
+}
+
+void Renderer::DestroyImage(AllocatedImage& image) const
+{
+	if (image.Image)
+	{
+		vkDestroyImageView(m_Device, image.ImageView, nullptr);
+		vmaDestroyImage(m_Allocator, image.Image, image.Allocation);
+	}
+	image.Reset();
+}
+
 void Renderer::Shutdown()
 {
+	StopPresentThread();
 	if (m_Device)
 		vkDeviceWaitIdle(m_Device);
 	else
 		return; // If we have no device, we really shouldn't be here!
 
+	m_GPUAwaits.Shutdown();
+	m_Defragmenter.Shutdown();
+	m_ComputeAutotuner.Shutdown();
+	m_TextureStreamer.Shutdown();
+	m_TransientImages.Shutdown();
+	m_DrawImage.Reset();
+
+	// We've waited for the device, so everything deferred is safe to go.
+	for (auto& [frameIndex, function] : m_DeferredDestruction)
+		function();
+	m_DeferredDestruction.clear();
+
 	// Shutdown ImGUI
 	if (m_ImGUIInitialised)
 	{
@@ -218,6 +605,22 @@ void Renderer::Shutdown()
 		m_ImmediateFence = nullptr;
 	}
 
+	// And the async ones. Anything still pending never got recorded, so there's nothing to wait for.
+	m_PendingAsyncSubmits.clear();
+	m_AsyncInFlight.clear();
+	m_FreeAsyncCommandBuffers.clear();
+	if (m_AsyncCommandPool)
+	{
+		vkDestroyCommandPool(m_Device, m_AsyncCommandPool, nullptr);
+		m_AsyncCommandPool = nullptr;
+	}
+
+	if (m_AsyncTimeline)
+	{
+		vkDestroySemaphore(m_Device, m_AsyncTimeline, nullptr);
+		m_AsyncTimeline = nullptr;
+	}
+
 	for (s32 i = 0; i < FramesInFlight; i++)
 		ShutdownFrameData(m_Frames[i]);
 
@@ -295,6 +698,7 @@ bool Renderer::InitDevice()
 	deviceFeatures12.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
 	deviceFeatures12.bufferDeviceAddress              = true;
 	deviceFeatures12.descriptorIndexing               = true;
+	deviceFeatures12.timelineSemaphore                = true; // For async submission. Always there in 1.3.
 
 	VkPhysicalDeviceVulkan13Features deviceFeatures13 = {};
 	deviceFeatures13.sType                            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
@@ -353,6 +757,37 @@ bool Renderer::InitDevice()
 	}
 	m_GPUIndex = static_cast<s32>(gpuIndex);
 
+	// Desktop GPUs tend to do BC, mobile ones ETC2 and ASTC, and some do all three. None of them are required - we
+	// just refuse to load textures the GPU can't sample.
+	auto enableIfPresent = [&device = devices[gpuIndex]](VkBool32 VkPhysicalDeviceFeatures::* feature)
+	{
+		VkPhysicalDeviceFeatures features = {};
+		features.*feature                 = true;
+		return device.enable_features_if_present(features);
+	};
+	m_SupportsBC   = enableIfPresent(&VkPhysicalDeviceFeatures::textureCompressionBC);
+	m_SupportsETC2 = enableIfPresent(&VkPhysicalDeviceFeatures::textureCompressionETC2);
+	m_SupportsASTC = enableIfPresent(&VkPhysicalDeviceFeatures::textureCompressionASTC_LDR);
+	m_SupportsStorageWriteWithoutFormat = enableIfPresent(&VkPhysicalDeviceFeatures::shaderStorageImageWriteWithoutFormat);
+
+	// Lets VMA ask the driver for real heap budgets, rather than guessing from heap sizes.
+	m_SupportsMemoryBudget = devices[gpuIndex].enable_extension_if_present(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+	// For low latency mode: tagging presents with IDs, and waiting for a given one to hit the screen.
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures = {};
+	presentIdFeatures.sType                                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	presentIdFeatures.presentId                            = true;
+
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures = {};
+	presentWaitFeatures.sType                                  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	presentWaitFeatures.presentWait                            = true;
+
+	m_SupportsPresentWait = devices[gpuIndex].enable_extensions_if_present({
+		                        VK_KHR_PRESENT_ID_EXTENSION_NAME, VK_KHR_PRESENT_WAIT_EXTENSION_NAME
+	                        }) &&
+		devices[gpuIndex].enable_extension_features_if_present(presentIdFeatures) &&
+		devices[gpuIndex].enable_extension_features_if_present(presentWaitFeatures);
+
 	vkb::DeviceBuilder deviceBuilder(devices[gpuIndex]);
 	auto               logicalDeviceResult = deviceBuilder.build();
 	if (!logicalDeviceResult.has_value())
@@ -378,12 +813,23 @@ bool Renderer::InitDevice()
 	m_GraphicsQueue       = queueResult.value();
 	m_GraphicsQueueFamily = logicalDevice.get_queue_index(vkb::QueueType::graphics).value();
 
+	// Extension functions aren't exported by the loader, so we have to look this one up ourselves.
+	if (m_SupportsPresentWait)
+	{
+		m_WaitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+			vkGetDeviceProcAddr(m_Device, "vkWaitForPresentKHR"));
+		m_SupportsPresentWait = m_WaitForPresent != nullptr;
+	}
+
+	m_SubgroupInfo = QuerySubgroupInfo(m_GPU);
+
 	return true;
 }
 
 bool Renderer::InitSwapchain()
 {
-	if (!CreateSwapchain(m_Window->GetWidth(), m_Window->GetHeight()))
+	m_WindowSize = m_Window->GetSize();
+	if (!CreateSwapchain(m_WindowSize.x, m_WindowSize.y))
 		return false;
 
 	return true;
@@ -404,6 +850,14 @@ bool Renderer::InitCommands()
 		// Finally, create our command buffers.
 		VkCommandBufferAllocateInfo bufferInfo = CreateCommandBufferAllocateInfo(m_Frames[i].CommandPool, 1, true);
 		VK_CHECK(vkAllocateCommandBuffers(m_Device, &bufferInfo, &m_Frames[i].MainCommandBuffer));
+
+		// Plus a pool for each thread that can record in parallel. These are only ever reset as a whole, once the
+		// frame's retired, so they don't need the per-buffer reset flag.
+		m_Frames[i].WorkerPools.resize(m_Spec.App->GetJobSystem().GetThreadCount() + 1);
+		VkCommandPoolCreateInfo workerPoolInfo = CreateCommandPoolCreateInfo(m_GraphicsQueueFamily,
+		                                                                     VK_COMMAND_POOL_CREATE_TRANSIENT_BIT);
+		for (WorkerCommandPool& workerPool : m_Frames[i].WorkerPools)
+			VK_CHECK(vkCreateCommandPool(m_Device, &workerPoolInfo, nullptr, &workerPool.Pool));
 	}
 
 	// And our immediate command buffer.
@@ -412,6 +866,10 @@ bool Renderer::InitCommands()
 		m_ImmediateCommandPool, 1, true);
 	VK_CHECK(vkAllocateCommandBuffers(m_Device, &immediateCommandBufferInfo, &m_ImmediateCommandBuffer));
 
+	// Async submissions get their own pool, as they're recorded alongside the immediate ones. Buffers are allocated
+	// as needed.
+	VK_CHECK(vkCreateCommandPool(m_Device, &commandPoolInfo, nullptr, &m_AsyncCommandPool));
+
 	return true;
 }
 
@@ -431,6 +889,44 @@ bool Renderer::InitSyncStructures()
 	// And init our immediate fence.
 	VK_CHECK(vkCreateFence(m_Device, &fenceInfo, nullptr, &m_ImmediateFence));
 
+	// Plus the async submission timeline, which counts up from 0 as submissions finish.
+	VkSemaphoreTypeCreateInfo timelineInfo = {};
+	timelineInfo.sType                     = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineInfo.semaphoreType             = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineInfo.initialValue              = 0;
+
+	VkSemaphoreCreateInfo timelineSemaphoreInfo = CreateSemaphoreCreateInfo();
+	timelineSemaphoreInfo.pNext                 = &timelineInfo;
+	VK_CHECK(vkCreateSemaphore(m_Device, &timelineSemaphoreInfo, nullptr, &m_AsyncTimeline));
+
+	// Timestamps for measuring GPU frame time, if the graphics queue can write them. Without them, dynamic resolution
+	// just sits at its max scale.
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_GPU, &properties);
+
+	u32 queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(m_GPU, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_GPU, &queueFamilyCount, queueFamilies.data());
+
+	if (queueFamilies[m_GraphicsQueueFamily].timestampValidBits == 0 || properties.limits.timestampPeriod <= 0.0f)
+	{
+		VULC_WARN("Graphics queue doesn't support timestamps, dynamic resolution is disabled");
+		m_DynamicResolution.SetEnabled(false);
+		return true;
+	}
+
+	const u32 validBits = queueFamilies[m_GraphicsQueueFamily].timestampValidBits;
+	m_TimestampPeriod   = properties.limits.timestampPeriod;
+	m_TimestampMask     = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+	VkQueryPoolCreateInfo queryPoolInfo = {};
+	queryPoolInfo.sType                 = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType             = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount            = 2;
+	for (s32 i = 0; i < FramesInFlight; i++)
+		VK_CHECK(vkCreateQueryPool(m_Device, &queryPoolInfo, nullptr, &m_Frames[i].TimestampQueryPool));
+
 	return true;
 }
 
@@ -442,6 +938,8 @@ bool Renderer::InitAllocator()
 	allocatorInfo.instance               = m_Instance;
 	allocatorInfo.vulkanApiVersion       = VK_API_VERSION_1_3;
 	allocatorInfo.flags                  = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+	if (m_SupportsMemoryBudget)
+		allocatorInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
 	if (auto result = vmaCreateAllocator(&allocatorInfo, &m_Allocator); result != VK_SUCCESS)
 	{
 		m_Spec.App->ShowError(fmt::format("Failed to create Vulkan queue: {}", string_VkResult(result)),
@@ -465,21 +963,9 @@ bool Renderer::InitDescriptors()
 	builder.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
 	m_DrawImageDescriptorLayout = builder.Build(m_Device, VK_SHADER_STAGE_COMPUTE_BIT);
 
-	m_DescriptorSet                 = m_DescriptorAllocator.Allocate(m_Device, m_DrawImageDescriptorLayout);
-	VkDescriptorImageInfo imageInfo = {};
-	imageInfo.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
-	imageInfo.imageView             = m_DrawImage.ImageView;
-
-	VkWriteDescriptorSet drawImageWrite = {};
-	drawImageWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	drawImageWrite.pNext                = nullptr;
-	drawImageWrite.dstBinding           = 0;
-	drawImageWrite.dstSet               = m_DescriptorSet;
-	drawImageWrite.descriptorCount      = 1;
-	drawImageWrite.descriptorType       = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-	drawImageWrite.pImageInfo           = &imageInfo;
-
-	vkUpdateDescriptorSets(m_Device, 1, &drawImageWrite, 0, nullptr);
+	// These get written in Render(), once we know which image we're drawing to.
+	for (FrameData& frame : m_Frames)
+		frame.DrawImageDescriptor = m_DescriptorAllocator.Allocate(m_Device, m_DrawImageDescriptorLayout);
 
 	m_DeletionQueue.Defer([this]()
 	{
@@ -508,6 +994,8 @@ bool Renderer::InitPipelines()
 
 	VK_CHECK(vkCreatePipelineLayout(m_Device, &computeLayout, nullptr, &m_GradientPipelineLayout));
 
+	m_PipelineCache.Init(m_Device, m_GPU, m_Spec.App->GetPrefPath() / "PipelineCache.bin");
+
 	VkShaderModule shader;
 	if (!LoadShaderModule("Content/Shaders/GradientTest.spv", m_Device, &shader))
 	{
@@ -515,27 +1003,41 @@ bool Renderer::InitPipelines()
 		return false;
 	}
 
-	VkPipelineShaderStageCreateInfo stageInfo = {};
-	stageInfo.sType                           = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	stageInfo.pNext                           = nullptr;
-	stageInfo.stage                           = VK_SHADER_STAGE_COMPUTE_BIT;
-	stageInfo.module                          = shader;
-	stageInfo.pName                           = "main"; // Entry point.
+	// Use whichever workgroup shape won last time on this device, or find out now.
+	m_ComputeAutotuner.Init(this, m_Spec.App->GetPrefPath() / "ComputeTuning.txt");
+	const WorkgroupSize fallback = PickWorkgroupSize2D(m_SubgroupInfo);
+	if (auto cached = m_ComputeAutotuner.Find("GradientTest"))
+		m_GradientWorkgroupSize = *cached;
+	else
+		m_GradientWorkgroupSize = TuneGradientPipeline(shader, fallback);
 
-	VkComputePipelineCreateInfo computePipelineInfo = {};
-	computePipelineInfo.sType                       = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
-	computePipelineInfo.pNext                       = nullptr;
-	computePipelineInfo.layout                      = m_GradientPipelineLayout;
-	computePipelineInfo.stage                       = stageInfo;
+	vkDestroyShaderModule(m_Device, shader, nullptr);
 
-	VK_CHECK(vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &computePipelineInfo, nullptr, &m_GradientPipeline));
+	// The gradient's toggles are specialisation constants, so each combination gets its own branch-free variant.
+	// There are only a few, so start compiling them all now rather than hitching the first time one's picked.
+	std::vector<SpecializationConstant> gradientConstants = {
+		{.Name = "Smooth", .ID = GradientSmoothConstantID, .IsBool = true, .Default = 1},
+		{.Name = "Colour Count", .ID = GradientColourCountConstantID, .Default = 3, .Min = 2, .Max = 3},
+	};
+	if (!m_GradientPermutations.Init(m_Device, "Content/Shaders/GradientTest.spv", m_GradientPipelineLayout,
+	                                 m_GradientWorkgroupSize, std::move(gradientConstants), m_PipelineCache.Get(),
+	                                 &m_Spec.App->GetJobSystem()))
+		return false;
+	m_GradientPermutations.Prewarm(m_GradientPermutations.GetAllPermutations());
 
-	vkDestroyShaderModule(m_Device, shader, nullptr);
+	// Not fatal: without it, we just blit the draw image across untouched.
+	if (!m_SupportsStorageWriteWithoutFormat)
+		VULC_WARN("Device can't write storage images without a format; skipping the resolve pass");
+	else if (!m_ResolvePass.Init(this, m_PipelineCache.Get(), &m_Spec.App->GetJobSystem()))
+		VULC_WARN("Failed to initialise the resolve pass; blitting the draw image instead");
 
 	m_DeletionQueue.Defer([this]()
 	{
+		m_ResolvePass.Shutdown();
+		m_GradientPermutations.Shutdown();
 		vkDestroyPipelineLayout(m_Device, m_GradientPipelineLayout, nullptr);
-		vkDestroyPipeline(m_Device, m_GradientPipeline, nullptr);
+		// Last, so it has everything that was compiled this run.
+		m_PipelineCache.Shutdown();
 	});
 
 	return true;
@@ -591,7 +1093,122 @@ bool Renderer::InitImGUI()
 	return true;
 }
 
-void Renderer::Clear(VkCommandBuffer cmd) const
+void Renderer::RecordPasses(VkCommandBuffer cmd, FrameData& frameData, std::span<const PassRecorder> passes)
+{
+	// Not worth the secondary buffers for just the one.
+	if (!m_Spec.ParallelRecording || passes.size() < 2 || frameData.WorkerPools.empty())
+	{
+		for (const PassRecorder& pass : passes)
+			pass(cmd);
+		return;
+	}
+
+	// Each pass records into a secondary from the pool of whichever job thread picked it up, so no pool's ever shared.
+	// The buffers are then executed in pass order, so the result's the same as recording them one after another,
+	// whichever threads did the work.
+	JobSystem& jobSystem = m_Spec.App->GetJobSystem();
+	const u32  passCount = static_cast<u32>(passes.size());
+
+	VkCommandBufferInheritanceInfo inheritanceInfo = {};
+	inheritanceInfo.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+	VkCommandBufferBeginInfo beginInfo = CreateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	beginInfo.pInheritanceInfo         = &inheritanceInfo;
+
+	std::vector<VkCommandBuffer> secondaryBuffers(passCount);
+	jobSystem.ParallelFor(passCount, [&](u32 begin, u32 end)
+	{
+		// Only the recording thread itself can be outside the job system, and only one thread ever renders at a time
+		// (the main thread or the render thread, which is joined before the main thread takes over again), so the spare
+		// pool on the end is never shared either.
+		const s32          threadIndex = jobSystem.GetCurrentThreadIndex();
+		WorkerCommandPool& workerPool  = threadIndex >= 0 ? frameData.WorkerPools[threadIndex]
+		                                                  : frameData.WorkerPools.back();
+		for (u32 i = begin; i < end; i++)
+		{
+			if (workerPool.UsedBuffers == workerPool.SecondaryBuffers.size())
+			{
+				VkCommandBufferAllocateInfo allocInfo = CreateCommandBufferAllocateInfo(workerPool.Pool, 1, false);
+				VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocInfo, &workerPool.SecondaryBuffers.emplace_back()));
+			}
+
+			VkCommandBuffer secondary = workerPool.SecondaryBuffers[workerPool.UsedBuffers++];
+			VK_CHECK(vkBeginCommandBuffer(secondary, &beginInfo));
+			passes[i](secondary);
+			VK_CHECK(vkEndCommandBuffer(secondary));
+			secondaryBuffers[i] = secondary;
+		}
+	});
+
+	vkCmdExecuteCommands(cmd, passCount, secondaryBuffers.data());
+}
+
+void Renderer::FlushAsyncSubmits()
+{
+	// Recycle the command buffers of anything that's finished.
+	u64 retiredValue = 0;
+	VK_CHECK(vkGetSemaphoreCounterValue(m_Device, m_AsyncTimeline, &retiredValue));
+	std::erase_if(m_AsyncInFlight, [&](const std::pair<VkCommandBuffer, u64>& inFlight)
+	{
+		if (inFlight.second > retiredValue)
+			return false;
+		m_FreeAsyncCommandBuffers.push_back(inFlight.first);
+		return true;
+	});
+
+	std::vector<std::pair<u64, std::function<void(VkCommandBuffer)>>> pending;
+	{
+		std::lock_guard lock(m_AsyncMutex);
+		pending.swap(m_PendingAsyncSubmits);
+	}
+	if (pending.empty())
+		return;
+
+	// They're queued in value order, and submitted in the same order, so the timeline only ever goes up.
+	std::vector<VkCommandBufferSubmitInfo> commandBufferInfos;
+	std::vector<VkSemaphoreSubmitInfo>     signalInfos;
+	commandBufferInfos.reserve(pending.size());
+	signalInfos.reserve(pending.size());
+
+	VkCommandBufferBeginInfo beginInfo = CreateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	for (auto& [value, function] : pending)
+	{
+		VkCommandBuffer cmd = nullptr;
+		if (m_FreeAsyncCommandBuffers.empty())
+		{
+			VkCommandBufferAllocateInfo allocInfo = CreateCommandBufferAllocateInfo(m_AsyncCommandPool, 1, true);
+			VK_CHECK(vkAllocateCommandBuffers(m_Device, &allocInfo, &cmd));
+		}
+		else
+		{
+			cmd = m_FreeAsyncCommandBuffers.back();
+			m_FreeAsyncCommandBuffers.pop_back();
+		}
+
+		// Beginning implicitly resets it, since the pool allows it.
+		VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+		function(cmd);
+		VK_CHECK(vkEndCommandBuffer(cmd));
+
+		VkSemaphoreSubmitInfo signalInfo = CreateSemaphoreSubmitInfo(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+		                                                             m_AsyncTimeline);
+		signalInfo.value                 = value;
+
+		commandBufferInfos.push_back(CreateCommandBufferSubmitInfo(cmd));
+		signalInfos.push_back(signalInfo);
+		m_AsyncInFlight.emplace_back(cmd, value);
+	}
+
+	std::vector<VkSubmitInfo2> submits;
+	submits.reserve(pending.size());
+	for (size_t i = 0; i < pending.size(); i++)
+		submits.push_back(CreateSubmitInfo(&commandBufferInfos[i], &signalInfos[i], nullptr));
+
+	std::lock_guard queueLock(m_QueueMutex);
+	VK_CHECK(vkQueueSubmit2(m_GraphicsQueue, static_cast<u32>(submits.size()), submits.data(), nullptr));
+}
+
+void Renderer::Clear(VkCommandBuffer cmd, VkPipeline pipeline) const
 {
 	// // Let's get our clear colour.
 	// VkClearColorValue clearValue;
@@ -602,37 +1219,58 @@ void Renderer::Clear(VkCommandBuffer cmd) const
 	//
 	// vkCmdClearColorImage(cmd, m_DrawImage.Image, VK_IMAGE_LAYOUT_GENERAL, &clearValue, 1, &clearRange);
 
-	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_GradientPipeline);
-	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_GradientPipelineLayout, 0, 1, &m_DescriptorSet, 0,
-	                        nullptr);
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_GradientPipelineLayout, 0, 1,
+	                        &m_Frames[m_FrameIndex % FramesInFlight].DrawImageDescriptor, 0, nullptr);
 
 	vkCmdPushConstants(cmd, m_GradientPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &m_PushConstants);
 	
-	vkCmdDispatch(cmd, static_cast<u32>(std::ceil(m_DrawExtent.width / 16)),
-	              static_cast<u32>(std::ceil(m_DrawExtent.height / 16)), 1);
+	Dispatch(cmd, m_DrawExtent, m_GradientWorkgroupSize);
 }
 
-void Renderer::DrawImGUI(VkCommandBuffer cmd, VkImageView targetImage)
+void Renderer::DrawImGUI(VkCommandBuffer cmd, VkImageView targetImage, const VkClearValue* clear)
 {
-	VkRenderingAttachmentInfo colorAttachment = CreateRenderingColorAttachmentInfo(targetImage, nullptr,
+	VkRenderingAttachmentInfo colorAttachment = CreateRenderingColorAttachmentInfo(targetImage, clear,
 		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 	VkRenderingInfo renderInfo = CreateRenderingInfo(m_SwapchainExtent, &colorAttachment, nullptr);
 
 	vkCmdBeginRendering(cmd, &renderInfo);
 
-	ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+	if (ImDrawData* drawData = GetImGuiDrawData())
+		ImGui_ImplVulkan_RenderDrawData(drawData, cmd);
 	
 	vkCmdEndRendering(cmd);
 }
 
 void Renderer::OnDrawIMGui()
 {
+	// Runs on the main thread, which may be a frame ahead of the render thread, so everything's drawn from our copy of
+	// the settings and the last frame's stats rather than the live state.
+	const RendererStats stats    = GetStats();
+	GradientSettings&   gradient = m_UISettings.Gradient;
+
 	ImGui::Begin("Gradient");
-	ImGui::DragFloat4("Colour 1", &m_PushConstants.Colour1.r, 0.01f, 0, 1);
-	ImGui::DragFloat4("Colour 2", &m_PushConstants.Colour2.r, 0.01f, 0, 1);
-	ImGui::DragFloat4("Colour 3", &m_PushConstants.Colour3.r, 0.01f, 0, 1);
-	ImGui::DragFloat3("Colour Points", &m_PushConstants.ColourPoints.r, 0.01f, 0, 1);
+	ImGui::DragFloat4("Colour 1", &gradient.Colour1.r, 0.01f, 0, 1);
+	ImGui::DragFloat4("Colour 2", &gradient.Colour2.r, 0.01f, 0, 1);
+	ImGui::DragFloat4("Colour 3", &gradient.Colour3.r, 0.01f, 0, 1);
+	ImGui::DragFloat3("Colour Points", &gradient.ColourPoints.r, 0.01f, 0, 1);
+
+	// Each combination's its own pipeline variant.
+	bool smooth = gradient.Key.Get(GradientSmoothConstantID).value_or(1) != 0;
+	if (ImGui::Checkbox("Smooth", &smooth))
+		gradient.Key.Set(GradientSmoothConstantID, smooth);
+	s32 colourCount = gradient.Key.Get(GradientColourCountConstantID).value_or(3);
+	if (ImGui::SliderInt("Colour Count", &colourCount, 2, 3))
+		gradient.Key.Set(GradientColourCountConstantID, colourCount);
+	ImGui::Text("%zu variants compiled", stats.GradientVariantCount);
 	ImGui::End();
+
+	Defragmenter::OnDrawIMGui(m_UISettings.Defragmenter, stats.Defragmenter, stats.Residency);
+	// The autotuner only runs during Init(), so its state's the main thread's from then on.
+	m_ComputeAutotuner.OnDrawIMGui();
+	DynamicResolution::OnDrawIMGui(m_UISettings.DynamicResolution, stats.DynamicResolution);
+	ResolvePass::OnDrawIMGui(m_UISettings.Resolve, stats.Resolve);
+	PassCache::OnDrawIMGui(m_UISettings.PassCache, stats.PassCache);
 }
 
 void Renderer::PrintDeviceInfo()
@@ -649,18 +1287,95 @@ void Renderer::PrintDeviceInfo()
 	          VK_VERSION_MAJOR(properties.properties.apiVersion),
 	          VK_VERSION_MINOR(properties.properties.apiVersion),
 	          VK_VERSION_PATCH(properties.properties.apiVersion));
+	VULC_INFO("Subgroups: {} invocations ({} to {}), max workgroup size {} invocations", m_SubgroupInfo.Size,
+	          m_SubgroupInfo.MinSize, m_SubgroupInfo.MaxSize, m_SubgroupInfo.MaxWorkgroupInvocations);
 }
 
 bool Renderer::OnWindowResize(const glm::ivec2& newSize)
 {
-	m_SwapchainDirty = true;
+	// Picked up, and the swapchain recreated, when the settings are next applied.
+	m_UISettings.WindowSize = newSize;
 	return false;
 }
 
-void Renderer::SetVSync(bool vsync)
+void Renderer::WaitForFrameStart()
 {
-	m_Spec.VSync = vsync;
-	m_SwapchainDirty = true;
+	// Waiting for a present needs the swapchain to ourselves, which it isn't while the present thread has it.
+	if (!m_Spec.LowLatency || !m_SupportsPresentWait || m_LastPresentID == 0 || m_SwapchainDirty ||
+		m_PresentThread.IsRunning())
+		return;
+
+	// Wait for the last frame to actually be on screen. Without this, we'd only block on the swapchain or a frame
+	// fence, with up to FramesInFlight frames queued ahead of the display, each showing input that's that much older.
+	// Time out rather than hang if the display stops presenting (minimised, or a compositor that's holding frames).
+	constexpr u64 timeout = 100000000; // 100ms.
+	const VkResult result = m_WaitForPresent(m_Device, m_Swapchain, m_LastPresentID, timeout);
+	if (result == VK_ERROR_OUT_OF_DATE_KHR)
+		m_SwapchainDirty = true;
+	else if (result != VK_SUCCESS && result != VK_TIMEOUT && result != VK_SUBOPTIMAL_KHR)
+		VULC_WARN("vkWaitForPresentKHR failed: {}", string_VkResult(result));
+}
+
+void Renderer::WaitForFrameFence()
+{
+	// No reset; Render() waits again (which returns straight away) and resets it.
+	VK_CHECK(vkWaitForFences(m_Device, 1, &GetCurrentFrame().RenderFence, true, 1000000000));
+}
+
+RendererSettings Renderer::TakeSettings()
+{
+	RendererSettings settings               = m_UISettings;
+	m_UISettings.Defragmenter.DefragmentNow = false;
+	return settings;
+}
+
+RendererStats Renderer::GetStats() const
+{
+	std::lock_guard lock(m_StatsMutex);
+	return m_Stats;
+}
+
+void Renderer::ApplySettings(const RendererSettings& settings)
+{
+	// Starting or stopping the present thread is done along with recreating the swapchain, which is the only other
+	// time it changes hands.
+	if (settings.WindowSize != m_WindowSize || settings.PresentMode != m_Spec.PresentMode ||
+		settings.UsePresentThread != m_Spec.UsePresentThread)
+		m_SwapchainDirty = true;
+
+	m_WindowSize             = settings.WindowSize;
+	m_Spec.PresentMode       = settings.PresentMode;
+	m_Spec.LowLatency        = settings.LowLatency;
+	m_Spec.CacheImGui        = settings.CacheImGui;
+	m_Spec.ParallelRecording = settings.ParallelRecording;
+	m_Spec.UsePresentThread  = settings.UsePresentThread;
+
+	m_PushConstants.Colour1      = settings.Gradient.Colour1;
+	m_PushConstants.Colour2      = settings.Gradient.Colour2;
+	m_PushConstants.Colour3      = settings.Gradient.Colour3;
+	m_PushConstants.ColourPoints = settings.Gradient.ColourPoints;
+	m_GradientKey                = settings.Gradient.Key;
+
+	m_Defragmenter.ApplySettings(settings.Defragmenter);
+	m_DynamicResolution.ApplySettings(settings.DynamicResolution);
+	m_ResolvePass.ApplySettings(settings.Resolve);
+	m_PassCache.ApplySettings(settings.PassCache);
+}
+
+void Renderer::PublishStats()
+{
+	// Built before taking the lock, which is then only held for the swap.
+	RendererStats stats         = {};
+	stats.SupportedPresentModes = m_SupportedPresentModes;
+	stats.GradientVariantCount  = m_GradientPermutations.GetVariantCount();
+	stats.Residency             = m_ResidencyManager.GetStats();
+	stats.Defragmenter          = m_Defragmenter.GetStats();
+	stats.DynamicResolution     = m_DynamicResolution.GetStats(m_DrawExtent);
+	stats.Resolve               = m_ResolvePass.GetStats(m_SwapchainSupportsStorage && !m_ResolvePass.IsForcingBlit());
+	stats.PassCache             = m_PassCache.GetStats();
+
+	std::lock_guard lock(m_StatsMutex);
+	std::swap(m_Stats, stats);
 }
 
 bool Renderer::CreateSwapchain(u32 width, u32 height)
@@ -669,17 +1384,33 @@ bool Renderer::CreateSwapchain(u32 width, u32 height)
 	vkb::SwapchainBuilder swapchainBuilder(m_GPU, m_Device, m_Surface);
 	m_SwapchainImageFormat = VK_FORMAT_B8G8R8A8_UNORM; // Hardcoded format for now.
 
+	// FIFO is the only mode that's guaranteed, so the others are only offered if the surface has them.
+	u32 presentModeCount = 0;
+	vkGetPhysicalDeviceSurfacePresentModesKHR(m_GPU, m_Surface, &presentModeCount, nullptr);
+	m_SupportedPresentModes.resize(presentModeCount);
+	vkGetPhysicalDeviceSurfacePresentModesKHR(m_GPU, m_Surface, &presentModeCount, m_SupportedPresentModes.data());
+
+	// The resolve pass can write straight into the swapchain if the surface allows storage usage and the format
+	// supports it. Plenty of surfaces don't, so otherwise it's a blit.
+	VkSurfaceCapabilitiesKHR surfaceCapabilities = {};
+	vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_GPU, m_Surface, &surfaceCapabilities);
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(m_GPU, m_SwapchainImageFormat, &formatProperties);
+	m_SwapchainSupportsStorage = m_SupportsStorageWriteWithoutFormat &&
+		(surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) &&
+		(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+	const VkImageUsageFlags swapchainUsage = VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+		(m_SwapchainSupportsStorage ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+
 	// Let's build it!
 	auto swapchainResult = swapchainBuilder
 	                       .set_desired_format(VkSurfaceFormatKHR{
 		                       .format = m_SwapchainImageFormat, .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR
 	                       })
-	                       .set_desired_present_mode(
-	                       		m_Spec.VSync
-	                       		? VK_PRESENT_MODE_FIFO_RELAXED_KHR
-	                       		: VK_PRESENT_MODE_IMMEDIATE_KHR)
+	                       .set_desired_present_mode(m_Spec.PresentMode)
+	                       .add_fallback_present_mode(VK_PRESENT_MODE_FIFO_KHR)
 	                       .set_desired_extent(width, height)
-	                       .add_image_usage_flags(VK_IMAGE_USAGE_TRANSFER_DST_BIT)
+	                       .add_image_usage_flags(swapchainUsage)
 	                       .build();
 
 	// Basic error checking.
@@ -706,50 +1437,21 @@ bool Renderer::CreateSwapchain(u32 width, u32 height)
 	m_SwapchainExtent      = swapchain.extent;
 	m_SwapchainImages      = swapchain.get_images().value();
 	m_SwapchainImageViews  = swapchain.get_image_views().value();
+	m_PresentMode          = swapchain.present_mode;
+	m_LastPresentID        = 0;
+	m_MaxAcquiredImages    = static_cast<u32>(m_SwapchainImages.size()) - surfaceCapabilities.minImageCount + 1;
 
-	// Okay, now that the swapchain itself is created, let's create the separate image we'll actually draw to.
-	VkExtent3D drawImageExtent = {width, height, 1};
-	m_DrawImage.Extent         = drawImageExtent;
-
-	// We'll hardcode the image format for now.
-	m_DrawImage.Format = VK_FORMAT_R16G16B16A16_SFLOAT;
-
-	// Our usage flags.
-	VkImageUsageFlags uses = {};
-	uses |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-	uses |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
-	uses |= VK_IMAGE_USAGE_STORAGE_BIT;
-	uses |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
-
-	VkImageCreateInfo imageCreateInfo = CreateImageCreateInfo(m_DrawImage.Format, uses, drawImageExtent);
-
-	// We'll allocate it on local GPU memory.
-	VmaAllocationCreateInfo imageAllocInfo = {};
-	imageAllocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
-	imageAllocInfo.requiredFlags           = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-
-	// Actually allocate the memory, using VMA.
-	vmaCreateImage(m_Allocator, &imageCreateInfo, &imageAllocInfo, &m_DrawImage.Image, &m_DrawImage.Allocation,
-	               nullptr);
+	if (m_PresentMode != m_Spec.PresentMode)
+		VULC_WARN("{} isn't supported, falling back to {}", PresentModeToString(m_Spec.PresentMode),
+		          PresentModeToString(m_PresentMode));
 
-	// Create the image view.
-	VkImageViewCreateInfo imageViewInfo = CreateImageViewCreateInfo(m_DrawImage.Format, m_DrawImage.Image,
-	                                                                VK_IMAGE_ASPECT_COLOR_BIT);
-	VK_CHECK(vkCreateImageView(m_Device, &imageViewInfo, nullptr, &m_DrawImage.ImageView));
+	// The draw image itself comes from the transient pool, which picks up the new extent next frame.
 
 	return true;
 }
 
 bool Renderer::DestroySwapchain()
 {
-	if (m_DrawImage.Image)
-	{
-		vkDestroyImageView(m_Device, m_DrawImage.ImageView, nullptr);
-		vmaDestroyImage(m_Allocator, m_DrawImage.Image, m_DrawImage.Allocation);
-
-		m_DrawImage.Reset();
-	}
-
 	if (!m_Swapchain)
 		return true;
 
@@ -766,11 +1468,46 @@ bool Renderer::DestroySwapchain()
 void Renderer::RecreateSwapchain()
 {
 	VULC_ASSERT(m_Device);
-	vkDeviceWaitIdle(m_Device);
+
+	// The present thread's using the old swapchain, so it goes first, and comes back on the new one.
+	StopPresentThread();
+	{
+		std::lock_guard queueLock(m_QueueMutex);
+		vkDeviceWaitIdle(m_Device);
+	}
 	DestroySwapchain();
-	CreateSwapchain(m_Spec.App->GetWindow().GetWidth(), m_Spec.App->GetWindow().GetHeight());
+	const bool created = CreateSwapchain(m_WindowSize.x, m_WindowSize.y);
+	if (created && m_Spec.UsePresentThread)
+		StartPresentThread();
+
+	m_SwapchainDirty = false;
+}
+
+void Renderer::StartPresentThread()
+{
+	m_PresentThread.Start(m_Device, m_GraphicsQueue, &m_QueueMutex, m_Swapchain, m_MaxAcquiredImages, FramesInFlight);
+}
+
+void Renderer::StopPresentThread()
+{
+	if (!m_PresentThread.IsRunning())
+		return;
+
+	// Its semaphores go with it, so nothing can be holding on to one.
+	m_PresentThread.Stop();
+	for (FrameData& frame : m_Frames)
+	{
+		frame.AcquireSemaphore = nullptr;
+		frame.PresentTicket    = 0;
+	}
+}
+
+void Renderer::UpdateDrawImageDescriptor(FrameData& frameData) const
+{
+	// Comparing views isn't enough; a new view can reuse a destroyed one's handle.
+	if (frameData.DrawImageDescriptorGeneration == m_TransientImages.GetGeneration())
+		return;
 
-	// BODGE FIX FOR RESIZING
 	VkDescriptorImageInfo imageInfo = {};
 	imageInfo.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
 	imageInfo.imageView             = m_DrawImage.ImageView;
@@ -779,14 +1516,151 @@ void Renderer::RecreateSwapchain()
 	drawImageWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	drawImageWrite.pNext                = nullptr;
 	drawImageWrite.dstBinding           = 0;
-	drawImageWrite.dstSet               = m_DescriptorSet;
+	drawImageWrite.dstSet               = frameData.DrawImageDescriptor;
 	drawImageWrite.descriptorCount      = 1;
 	drawImageWrite.descriptorType       = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
 	drawImageWrite.pImageInfo           = &imageInfo;
 
 	vkUpdateDescriptorSets(m_Device, 1, &drawImageWrite, 0, nullptr);
+	frameData.DrawImageDescriptorGeneration = m_TransientImages.GetGeneration();
+}
 
-	m_SwapchainDirty = false;
+WorkgroupSize Renderer::TuneGradientPipeline(VkShaderModule shader, const WorkgroupSize& fallback)
+{
+	if (!m_ComputeAutotuner.CanTune())
+		return fallback;
+
+	// The draw image doesn't exist until the first frame, so draw into a stand-in the same size. Its descriptor set
+	// stays allocated until the pool goes, which is one set we can spare.
+	const VkExtent2D extent = m_SwapchainExtent;
+	AllocatedImage   target = CreateImage({extent.width, extent.height, 1}, DrawImageFormat, VK_IMAGE_USAGE_STORAGE_BIT);
+	VkDescriptorSet  set    = m_DescriptorAllocator.Allocate(m_Device, m_DrawImageDescriptorLayout);
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
+	imageInfo.imageView             = target.ImageView;
+
+	VkWriteDescriptorSet imageWrite = {};
+	imageWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	imageWrite.dstBinding           = 0;
+	imageWrite.dstSet               = set;
+	imageWrite.descriptorCount      = 1;
+	imageWrite.descriptorType       = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	imageWrite.pImageInfo           = &imageInfo;
+	vkUpdateDescriptorSets(m_Device, 1, &imageWrite, 0, nullptr);
+
+	PushConstants pushConstants = m_PushConstants;
+	pushConstants.DrawExtent    = {static_cast<s32>(extent.width), static_cast<s32>(extent.height)};
+
+	TunableKernel kernel = {};
+	kernel.Name          = "GradientTest";
+	kernel.Extent        = {extent.width, extent.height, 1};
+	kernel.Fallback      = fallback;
+
+	kernel.CreatePipeline = [&](const WorkgroupSize& size)
+	{
+		return CreateComputePipeline(m_Device, m_GradientPipelineLayout, shader, size);
+	};
+	kernel.Prepare = [&](VkCommandBuffer cmd)
+	{
+		TransitionImage(cmd, target.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL);
+	};
+	kernel.Record = [&](VkCommandBuffer cmd, VkPipeline pipeline, const WorkgroupSize& size)
+	{
+		vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+		vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_GradientPipelineLayout, 0, 1, &set, 0, nullptr);
+		vkCmdPushConstants(cmd, m_GradientPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants),
+		                   &pushConstants);
+		Dispatch(cmd, extent, size);
+
+		// In a real frame, something always reads the gradient straight after, so don't let dispatches overlap.
+		TransitionImage(cmd, target.Image, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_GENERAL);
+	};
+
+	const WorkgroupSize best = m_ComputeAutotuner.Tune(kernel);
+	DestroyImage(target);
+	return best;
+}
+
+u64 Renderer::GetGradientInputHash(VkPipeline pipeline) const
+{
+	// The pipeline covers the toggles and workgroup size; the view covers which image it's writing.
+	return PassInputHash()
+	       .Add(pipeline)
+	       .Add(m_PushConstants.Colour1)
+	       .Add(m_PushConstants.Colour2)
+	       .Add(m_PushConstants.Colour3)
+	       .Add(m_PushConstants.ColourPoints)
+	       .Add(m_PushConstants.DrawExtent)
+	       .Add(m_DrawImage.ImageView)
+	       .Add(m_DrawExtent)
+	       .Get();
+}
+
+u64 Renderer::GetImGuiInputHash() const
+{
+#ifndef VULC_NO_IMGUI
+	// Everything that ends up in the draw lists: geometry, and how it's split into draws. Input goes in too, so a
+	// widget that reacts to the mouse without its geometry changing yet still gets a fresh frame.
+	const ImDrawData* drawData = GetImGuiDrawData();
+	if (!drawData)
+		return 0;
+
+	PassInputHash hash;
+	hash.Add(drawData->DisplayPos).Add(drawData->DisplaySize).Add(drawData->FramebufferScale);
+	for (s32 listIndex = 0; listIndex < drawData->CmdListsCount; listIndex++)
+	{
+		const ImDrawList* list = drawData->CmdLists[listIndex];
+		hash.AddBytes(list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+		hash.AddBytes(list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+		for (const ImDrawCmd& drawCmd : list->CmdBuffer)
+		{
+			hash.Add(drawCmd.ClipRect).Add(drawCmd.TextureId).Add(drawCmd.VtxOffset).Add(drawCmd.IdxOffset)
+			    .Add(drawCmd.ElemCount).Add(drawCmd.UserCallback);
+		}
+	}
+
+	if (m_FramePacket)
+	{
+		hash.Add(m_FramePacket->MousePos).Add(m_FramePacket->MouseDown).Add(m_FramePacket->MouseWheel);
+	}
+	else
+	{
+		const ImGuiIO& io = ImGui::GetIO();
+		hash.Add(io.MousePos).Add(io.MouseDown).Add(io.MouseWheel);
+	}
+
+	return hash.Get();
+#else
+	return 0;
+#endif
+}
+
+ImDrawData* Renderer::GetImGuiDrawData() const
+{
+#ifndef VULC_NO_IMGUI
+	return m_FramePacket ? m_FramePacket->GetDrawData() : ImGui::GetDrawData();
+#else
+	return nullptr;
+#endif
+}
+
+void Renderer::ReadFrameTimestamps(FrameData& frameData)
+{
+	if (!frameData.TimestampsWritten)
+		return;
+	frameData.TimestampsWritten = false;
+
+	// We've already waited on this frame's fence, so these should always be ready; if the driver disagrees, we just
+	// skip a sample.
+	std::array<u64, 2> timestamps;
+	if (vkGetQueryPoolResults(m_Device, frameData.TimestampQueryPool, 0, 2, sizeof(timestamps), timestamps.data(),
+	                          sizeof(u64), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+		return;
+
+	// Only the low timestampValidBits bits are meaningful, and they can wrap.
+	const u64 ticks = (timestamps[1] - timestamps[0]) & m_TimestampMask;
+	m_DynamicResolution.Update(static_cast<f32>(static_cast<f64>(ticks) * m_TimestampPeriod / 1000000.0));
 }
 
 void Renderer::ShutdownFrameData(FrameData& frameData) const
@@ -801,11 +1675,20 @@ void Renderer::ShutdownFrameData(FrameData& frameData) const
 	if (frameData.RenderSemaphore)
 		vkDestroySemaphore(m_Device, frameData.RenderSemaphore, nullptr);
 
+	if (frameData.TimestampQueryPool)
+		vkDestroyQueryPool(m_Device, frameData.TimestampQueryPool, nullptr);
+
+	// Destroying the pools frees their buffers too.
+	for (WorkerCommandPool& workerPool : frameData.WorkerPools)
+		vkDestroyCommandPool(m_Device, workerPool.Pool, nullptr);
+	frameData.WorkerPools.clear();
+
 	frameData.CommandPool        = nullptr;
 	frameData.RenderFence        = nullptr;
 	frameData.SwapchainSemaphore = nullptr;
 	frameData.RenderSemaphore    = nullptr;
 	frameData.MainCommandBuffer  = nullptr;
+	frameData.TimestampQueryPool = nullptr;
 
 	frameData.FrameDeletionQueue.Flush();
 }
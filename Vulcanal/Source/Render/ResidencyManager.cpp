@@ -0,0 +1,138 @@
+#include "vulcpch.h"
+#include "Render/ResidencyManager.h"
+
+#include "Render/Renderer.h"
+
+void ResidencyManager::Init(Renderer* renderer, TextureStreamer* streamer)
+{
+	m_Renderer = renderer;
+	m_Streamer = streamer;
+}
+
+void ResidencyManager::Touch(StreamedTexture& texture, u32 desiredMip) const
+{
+	texture.LastUsedFrame = m_Renderer->GetFrameIndex();
+	texture.DesiredMip    = std::min(desiredMip, texture.TailMip);
+}
+
+void ResidencyManager::Update()
+{
+	u64 budget, usage;
+	QueryBudget(budget, usage);
+
+	const u64 frameIndex = m_Renderer->GetFrameIndex();
+	const s64 target     = static_cast<s64>(static_cast<f64>(budget) * m_TargetFraction);
+	auto      isStale    = [&](const StreamedTexture& texture)
+	{
+		return frameIndex - std::min(texture.LastUsedFrame, frameIndex) >= m_EvictAfterFrames;
+	};
+
+	// Usage lags behind what we've asked for: downgrades and evictions haven't freed anything until the streamer gets
+	// to them and the old image retires, and upgrades haven't allocated anything yet. Count all of that now, or we'd
+	// keep asking for more of the same every frame until it caught up. Textures mid-transfer are already counted (or
+	// about to be) in usage.
+	s64 projected = static_cast<s64>(usage) - static_cast<s64>(m_Streamer->GetRetiringBytes());
+
+	m_SortedTextures.clear();
+	for (const auto& texture : m_Streamer->GetTextures())
+	{
+		if (texture->Failed)
+			continue;
+		m_SortedTextures.push_back(texture.get());
+		if (texture->Pending)
+			continue;
+
+		// The app asking for less detail is always fine.
+		if (texture->RequestedMip < texture->DesiredMip)
+			texture->RequestedMip = texture->DesiredMip;
+
+		const u32 requested = std::min(texture->RequestedMip, texture->GetMipLevels());
+		projected += static_cast<s64>(texture->GetSizeFromMip(requested)) - static_cast<s64>(texture->GetResidentSize());
+	}
+
+	if (projected > target)
+	{
+		// Least recently used first. We only take one level off each texture per frame, so the hit's spread across
+		// everything that's not in use rather than wiping out a few textures completely.
+		std::ranges::sort(m_SortedTextures, std::less(), &StreamedTexture::LastUsedFrame);
+		for (StreamedTexture* texture : m_SortedTextures)
+		{
+			if (projected <= target)
+				break;
+
+			const u32 requested = std::min(texture->RequestedMip, texture->GetMipLevels());
+			if (texture->Pending || requested >= texture->GetMipLevels())
+				continue;
+
+			if (isStale(*texture))
+			{
+				texture->RequestedMip = texture->GetMipLevels();
+				projected -= static_cast<s64>(texture->GetSizeFromMip(requested));
+				m_Stats.Evictions++;
+			}
+			else if (requested < texture->TailMip)
+			{
+				texture->RequestedMip = requested + 1;
+				projected -= static_cast<s64>(texture->File.Levels[requested].Size);
+				m_Stats.Downgrades++;
+			}
+		}
+	}
+	else
+	{
+		// Keep a little slack below the target, so we don't flip-flop a level every frame.
+		s64 headroom = target - target / 20 - projected;
+
+		std::ranges::sort(m_SortedTextures, std::greater(), &StreamedTexture::LastUsedFrame);
+		for (StreamedTexture* texture : m_SortedTextures)
+		{
+			if (texture->Pending || isStale(*texture))
+				continue;
+
+			// A missing texture is much worse than a blurry one, and tails are tiny, so those always go through.
+			const u32 requested = std::min(texture->RequestedMip, texture->GetMipLevels());
+			if (requested >= texture->GetMipLevels())
+			{
+				texture->RequestedMip = texture->TailMip;
+				headroom -= static_cast<s64>(texture->GetSizeFromMip(texture->TailMip));
+				continue;
+			}
+			if (requested <= texture->DesiredMip)
+				continue;
+
+			// While the copy's in flight, both the old and new images are alive, so the whole new image has to fit.
+			const u32 next = requested - 1;
+			if (static_cast<s64>(texture->GetSizeFromMip(next)) > headroom)
+				continue;
+
+			texture->RequestedMip = next;
+			headroom -= static_cast<s64>(texture->File.Levels[next].Size);
+		}
+	}
+
+	m_Stats.Budget    = budget;
+	m_Stats.Usage     = usage;
+	m_Stats.Target    = static_cast<u64>(target);
+	m_Stats.Projected = static_cast<u64>(std::max<s64>(projected, 0));
+}
+
+void ResidencyManager::QueryBudget(u64& outBudget, u64& outUsage) const
+{
+	// Without VK_EXT_memory_budget, VMA estimates these from its own allocations and the heap sizes instead.
+	const VkPhysicalDeviceMemoryProperties* memoryProperties;
+	vmaGetMemoryProperties(m_Renderer->GetAllocator(), &memoryProperties);
+
+	std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets;
+	vmaGetHeapBudgets(m_Renderer->GetAllocator(), budgets.data());
+
+	outBudget = 0;
+	outUsage  = 0;
+	for (u32 heap = 0; heap < memoryProperties->memoryHeapCount; heap++)
+	{
+		if (!(memoryProperties->memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT))
+			continue;
+
+		outBudget += budgets[heap].budget;
+		outUsage += budgets[heap].usage;
+	}
+}
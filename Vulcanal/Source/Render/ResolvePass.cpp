@@ -0,0 +1,318 @@
+#include "vulcpch.h"
+#include "Render/ResolvePass.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include "Render/Renderer.h"
+
+namespace
+{
+	// Matches Resolve.comp.
+	constexpr u32 TonemapperConstantID = 3;
+	constexpr u32 GradeConstantID      = 4;
+	constexpr u32 OverlayConstantID    = 5;
+
+	constexpr const char* TonemapperNames[] = {"None", "Reinhard", "ACES"};
+
+	glm::vec3 ApplyGrade(const ColourGrade& grade, glm::vec3 colour)
+	{
+		colour = colour * grade.Gain + grade.Lift * (1.0f - colour);
+		colour = (colour - 0.5f) * grade.Contrast + 0.5f;
+
+		const f32 luma = glm::dot(colour, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+		colour         = glm::mix(glm::vec3(luma), colour, grade.Saturation);
+
+		return glm::clamp(colour, 0.0f, 1.0f);
+	}
+}
+
+bool ResolvePass::Init(Renderer* renderer, VkPipelineCache cache, JobSystem* jobSystem)
+{
+	m_Renderer            = renderer;
+	const VkDevice device = m_Renderer->GetDevice();
+
+	// Each frame in flight gets its own set, since the target (and the draw image) can change from frame to frame.
+	std::vector<PoolSizeRatio> sizes =
+	{
+		{.Type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .Ratio = 3},
+		{.Type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .Ratio = 1}
+	};
+	m_DescriptorAllocator.InitPool(device, FramesInFlight, sizes);
+
+	DescriptorLayoutBuilder builder;
+	builder.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	builder.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE);
+	builder.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	builder.AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+	m_DescriptorLayout = builder.Build(device, VK_SHADER_STAGE_COMPUTE_BIT);
+
+	m_DescriptorSets.resize(FramesInFlight);
+	for (VkDescriptorSet& set : m_DescriptorSets)
+		set = m_DescriptorAllocator.Allocate(device, m_DescriptorLayout);
+
+	VkPushConstantRange pushConstant = {};
+	pushConstant.offset              = 0;
+	pushConstant.size                = sizeof(ResolvePushConstants);
+	pushConstant.stageFlags          = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	VkPipelineLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	layoutInfo.pSetLayouts                = &m_DescriptorLayout;
+	layoutInfo.setLayoutCount             = 1;
+	layoutInfo.pPushConstantRanges        = &pushConstant;
+	layoutInfo.pushConstantRangeCount     = 1;
+	VK_CHECK(vkCreatePipelineLayout(device, &layoutInfo, nullptr, &m_PipelineLayout));
+
+	// Bilinear for the upscale, and between LUT entries. Clamped, so the edges don't pull in the unused part of the
+	// draw image.
+	VkSamplerCreateInfo samplerInfo = {};
+	samplerInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter           = VK_FILTER_LINEAR;
+	samplerInfo.minFilter           = VK_FILTER_LINEAR;
+	samplerInfo.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.maxLod              = 0.0f;
+	VK_CHECK(vkCreateSampler(device, &samplerInfo, nullptr, &m_Sampler));
+
+	CreateLUT();
+
+	std::vector<SpecializationConstant> constants = {
+		{.Name = "Tonemapper", .ID = TonemapperConstantID, .Default = 2, .Min = 0, .Max = 2},
+		{.Name = "Grade", .ID = GradeConstantID, .IsBool = true, .Default = 1},
+		{.Name = "Overlay", .ID = OverlayConstantID, .IsBool = true, .Default = 0},
+	};
+	if (!m_Permutations.Init(device, "Content/Shaders/Resolve.spv", m_PipelineLayout,
+	                         PickWorkgroupSize2D(m_Renderer->GetSubgroupInfo()), std::move(constants), cache,
+	                         jobSystem))
+	{
+		Shutdown();
+		return false;
+	}
+	m_Permutations.Prewarm(m_Permutations.GetAllPermutations());
+
+	m_Ready = true;
+	return true;
+}
+
+void ResolvePass::Shutdown()
+{
+	if (!m_Renderer)
+		return;
+
+	const VkDevice device = m_Renderer->GetDevice();
+	m_Permutations.Shutdown();
+	m_Renderer->DestroyImage(m_LUT);
+
+	if (m_Sampler)
+		vkDestroySampler(device, m_Sampler, nullptr);
+	if (m_PipelineLayout)
+		vkDestroyPipelineLayout(device, m_PipelineLayout, nullptr);
+	if (m_DescriptorLayout)
+		vkDestroyDescriptorSetLayout(device, m_DescriptorLayout, nullptr);
+	m_DescriptorAllocator.DestroyPool(device);
+
+	m_Sampler          = nullptr;
+	m_PipelineLayout   = nullptr;
+	m_DescriptorLayout = nullptr;
+	m_DescriptorSets.clear();
+	m_Ready    = false;
+	m_Renderer = nullptr;
+}
+
+void ResolvePass::Record(VkCommandBuffer cmd, u32 frameSlot, const AllocatedImage& source, VkExtent2D drawExtent,
+                         VkImageView target, VkExtent2D targetExtent, VkImageView overlay)
+{
+	VULC_ASSERT(m_Ready, "Resolve pass isn't initialised");
+	VkDescriptorSet set = m_DescriptorSets[frameSlot];
+
+	// Cheaper to just rewrite them all than to track which changed. This frame slot's last submission is done, so
+	// nothing's still reading the set.
+	VkDescriptorImageInfo sourceInfo = {};
+	sourceInfo.sampler               = m_Sampler;
+	sourceInfo.imageView             = source.ImageView;
+	sourceInfo.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkDescriptorImageInfo targetInfo = {};
+	targetInfo.imageView             = target;
+	targetInfo.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
+
+	VkDescriptorImageInfo lutInfo = {};
+	lutInfo.sampler               = m_Sampler;
+	lutInfo.imageView             = m_LUT.ImageView;
+	lutInfo.imageLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	// The binding's statically used either way, so without an overlay it gets the source, which is at least a valid
+	// 2D image in the right layout.
+	VkDescriptorImageInfo overlayInfo = sourceInfo;
+	if (overlay)
+		overlayInfo.imageView = overlay;
+
+	std::array<VkWriteDescriptorSet, 4> writes  = {};
+	const VkDescriptorImageInfo*        infos[] = {&sourceInfo, &targetInfo, &lutInfo, &overlayInfo};
+	for (u32 i = 0; i < writes.size(); i++)
+	{
+		writes[i].sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet          = set;
+		writes[i].dstBinding      = i;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType  = i == 1 ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		writes[i].pImageInfo      = infos[i];
+	}
+	vkUpdateDescriptorSets(m_Renderer->GetDevice(), static_cast<u32>(writes.size()), writes.data(), 0, nullptr);
+
+	ResolvePushConstants pushConstants = {};
+	pushConstants.SourceScale          = {
+		static_cast<f32>(drawExtent.width) / static_cast<f32>(source.Extent.width),
+		static_cast<f32>(drawExtent.height) / static_cast<f32>(source.Extent.height)
+	};
+	pushConstants.TargetExtent = {static_cast<s32>(targetExtent.width), static_cast<s32>(targetExtent.height)};
+	pushConstants.Exposure     = m_Exposure;
+
+	PermutationKey key = m_Key;
+	key.Set(OverlayConstantID, overlay != nullptr);
+
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_Permutations.Get(key));
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &set, 0, nullptr);
+	vkCmdPushConstants(cmd, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(ResolvePushConstants),
+	                   &pushConstants);
+
+	Dispatch(cmd, targetExtent, m_Permutations.GetWorkgroupSize());
+}
+
+void ResolvePass::SetGrade(const ColourGrade& grade)
+{
+	if (grade == m_Grade)
+		return;
+
+	m_Grade = grade;
+	if (m_Ready)
+		CreateLUT();
+}
+
+void ResolvePass::ApplySettings(const ResolveSettings& settings)
+{
+	m_Key       = settings.Key;
+	m_Exposure  = settings.Exposure;
+	m_ForceBlit = settings.ForceBlit;
+	SetGrade(settings.Grade);
+}
+
+ResolveSettings ResolvePass::GetSettings() const
+{
+	return {.Key = m_Key, .Grade = m_Grade, .Exposure = m_Exposure, .ForceBlit = m_ForceBlit};
+}
+
+ResolveStats ResolvePass::GetStats(bool writingSwapchain) const
+{
+	return {.Ready = m_Ready, .WritingSwapchain = writingSwapchain, .VariantCount = m_Permutations.GetVariantCount()};
+}
+
+void ResolvePass::CreateLUT()
+{
+	// Frames in flight may still be sampling the old one, so build a new one and let the old one go once they're
+	// done, rather than uploading over it.
+	if (m_LUT.Image)
+	{
+		m_Renderer->DeferDestruction([renderer = m_Renderer, lut = m_LUT]() mutable
+		{
+			renderer->DestroyImage(lut);
+		});
+		m_LUT.Reset();
+	}
+
+	const VkExtent3D extent = {LUTSize, LUTSize, LUTSize};
+
+	VkImageCreateInfo imageInfo = CreateImageCreateInfo(LUTFormat,
+	                                                    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+	                                                    extent, 1, 1, VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_TYPE_3D);
+
+	VmaAllocationCreateInfo allocInfo = {};
+	allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+	allocInfo.requiredFlags           = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	VK_CHECK(vmaCreateImage(m_Renderer->GetAllocator(), &imageInfo, &allocInfo, &m_LUT.Image, &m_LUT.Allocation,
+	                        nullptr));
+	m_LUT.Extent    = extent;
+	m_LUT.Format    = LUTFormat;
+	m_LUT.MipLevels = 1;
+
+	VkImageViewCreateInfo viewInfo = CreateImageViewCreateInfo(LUTFormat, m_LUT.Image, VK_IMAGE_ASPECT_COLOR_BIT,
+	                                                           VK_IMAGE_VIEW_TYPE_3D);
+	VK_CHECK(vkCreateImageView(m_Renderer->GetDevice(), &viewInfo, nullptr, &m_LUT.ImageView));
+
+	// Half floats, so dark gradients don't band between entries.
+	const size_t    texelCount = static_cast<size_t>(LUTSize) * LUTSize * LUTSize;
+	AllocatedBuffer staging    = m_Renderer->CreateBuffer(texelCount * sizeof(u64), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+	                                                      VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+	auto*     texels = static_cast<u64*>(staging.Info.pMappedData);
+	const f32 step   = 1.0f / static_cast<f32>(LUTSize - 1);
+	for (u32 b = 0; b < LUTSize; b++)
+	{
+		for (u32 g = 0; g < LUTSize; g++)
+		{
+			for (u32 r = 0; r < LUTSize; r++)
+			{
+				const glm::vec3 colour = ApplyGrade(m_Grade, glm::vec3(r, g, b) * step);
+				*texels++              = glm::packHalf4x16(glm::vec4(colour, 1.0f));
+			}
+		}
+	}
+
+	m_Renderer->ImmediateSubmit([&](VkCommandBuffer cmd)
+	{
+		TransitionImage(cmd, m_LUT.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+		VkBufferImageCopy copyRegion           = {};
+		copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		copyRegion.imageSubresource.layerCount = 1;
+		copyRegion.imageExtent                 = extent;
+		vkCmdCopyBufferToImage(cmd, staging.Buffer, m_LUT.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+		TransitionImage(cmd, m_LUT.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	});
+
+	m_Renderer->DestroyBuffer(staging);
+}
+
+void ResolvePass::OnDrawIMGui(ResolveSettings& settings, const ResolveStats& stats)
+{
+#ifndef VULC_NO_IMGUI
+	ImGui::Begin("Resolve");
+
+	if (!stats.Ready)
+		ImGui::TextWrapped("Unavailable; blitting the draw image straight to the swapchain.");
+	else if (stats.WritingSwapchain)
+		ImGui::TextWrapped("Writing the swapchain directly.");
+	else
+		ImGui::TextWrapped("Resolving into an intermediate image and blitting it to the swapchain.");
+
+	ImGui::BeginDisabled(!stats.Ready);
+	ImGui::Checkbox("Force Blit Fallback", &settings.ForceBlit);
+	ImGui::SliderFloat("Exposure", &settings.Exposure, 0.1f, 8.0f, "%.2f");
+
+	// Both of these pick a pipeline variant.
+	s32 tonemapper = settings.Key.Get(TonemapperConstantID).value_or(2);
+	if (ImGui::Combo("Tonemapper", &tonemapper, TonemapperNames, static_cast<s32>(std::size(TonemapperNames))))
+		settings.Key.Set(TonemapperConstantID, tonemapper);
+	bool grade = settings.Key.Get(GradeConstantID).value_or(1) != 0;
+	if (ImGui::Checkbox("Colour Grade", &grade))
+		settings.Key.Set(GradeConstantID, grade);
+
+	// Changing these rebuilds the LUT, which is cheap enough to do every frame while dragging.
+	ImGui::BeginDisabled(!grade);
+	ImGui::SliderFloat("Contrast", &settings.Grade.Contrast, 0.5f, 1.5f, "%.2f");
+	ImGui::SliderFloat("Saturation", &settings.Grade.Saturation, 0.0f, 2.0f, "%.2f");
+	ImGui::DragFloat3("Lift", &settings.Grade.Lift.r, 0.005f, -0.25f, 0.25f);
+	ImGui::DragFloat3("Gain", &settings.Grade.Gain.r, 0.005f, 0.5f, 1.5f);
+	if (ImGui::Button("Reset Grade"))
+		settings.Grade = {};
+	ImGui::EndDisabled();
+
+	ImGui::Text("%zu variants compiled", stats.VariantCount);
+	ImGui::EndDisabled();
+
+	ImGui::End();
+#endif
+}
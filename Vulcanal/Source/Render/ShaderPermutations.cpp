@@ -0,0 +1,213 @@
+#include "vulcpch.h"
+#include "Render/ShaderPermutations.h"
+
+#include "Core/Jobs/JobSystem.h"
+
+PermutationKey& PermutationKey::Set(u32 id, s32 value)
+{
+	auto it = std::ranges::lower_bound(m_Values, id, std::less(), &std::pair<u32, s32>::first);
+	if (it != m_Values.end() && it->first == id)
+		it->second = value;
+	else
+		m_Values.insert(it, {id, value});
+	return *this;
+}
+
+std::optional<s32> PermutationKey::Get(u32 id) const
+{
+	auto it = std::ranges::lower_bound(m_Values, id, std::less(), &std::pair<u32, s32>::first);
+	if (it != m_Values.end() && it->first == id)
+		return it->second;
+	return std::nullopt;
+}
+
+ShaderPermutations::~ShaderPermutations()
+{
+	Shutdown();
+}
+
+bool ShaderPermutations::Init(VkDevice device, std::string_view shaderPath, VkPipelineLayout layout,
+                              const WorkgroupSize& workgroupSize, std::vector<SpecializationConstant> constants,
+                              VkPipelineCache cache, JobSystem* jobSystem)
+{
+	m_Device        = device;
+	m_Layout        = layout;
+	m_WorkgroupSize = workgroupSize;
+	m_Constants     = std::move(constants);
+	m_Cache         = cache;
+	m_JobSystem     = jobSystem;
+
+	for (SpecializationConstant& constant : m_Constants)
+	{
+		VULC_ASSERT(constant.ID > WorkgroupSizeZConstantID, "Specialisation constants 0-2 are the workgroup size");
+		if (constant.IsBool)
+		{
+			constant.Min = 0;
+			constant.Max = 1;
+		}
+	}
+
+	// We hang on to the module, since variants can be compiled at any point.
+	if (!LoadShaderModule(shaderPath, m_Device, &m_Shader))
+	{
+		VULC_ERROR("Failed to load shader: {}", shaderPath);
+		return false;
+	}
+
+	return true;
+}
+
+void ShaderPermutations::Shutdown()
+{
+	if (!m_Device)
+		return;
+
+	for (auto& [hash, variant] : m_Variants)
+	{
+		if (VkPipeline pipeline = variant.Pipeline.get())
+			vkDestroyPipeline(m_Device, pipeline, nullptr);
+	}
+	m_Variants.clear();
+	m_LastKey      = {};
+	m_LastPipeline = nullptr;
+
+	if (m_Shader)
+		vkDestroyShaderModule(m_Device, m_Shader, nullptr);
+	m_Shader = nullptr;
+	m_Device = nullptr;
+}
+
+VkPipeline ShaderPermutations::Get(const PermutationKey& key)
+{
+	if (m_LastPipeline && key == m_LastKey)
+		return m_LastPipeline;
+
+	std::vector<SpecializationValue> values = Resolve(key);
+	const u64                        hash   = Hash(values);
+
+	std::shared_future<VkPipeline> pipeline;
+	{
+		std::lock_guard lock(m_Mutex);
+		if (const Variant* variant = FindVariant(hash, values))
+			pipeline = variant->Pipeline;
+	}
+
+	if (!pipeline.valid())
+	{
+		// Compile outside the lock, so prewarming carries on meanwhile. Nothing else can add this variant in the
+		// meantime, since variants are only ever added from the render thread.
+		std::promise<VkPipeline> promise;
+		pipeline = promise.get_future().share();
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Variants.insert({hash, {.Values = values, .Pipeline = pipeline}});
+		}
+		promise.set_value(Compile(values));
+	}
+
+	m_LastKey      = key;
+	m_LastPipeline = pipeline.get();
+	return m_LastPipeline;
+}
+
+void ShaderPermutations::Prewarm(std::span<const PermutationKey> keys)
+{
+	for (const PermutationKey& key : keys)
+	{
+		std::vector<SpecializationValue> values = Resolve(key);
+		const u64                        hash   = Hash(values);
+
+		auto promise = std::make_shared<std::promise<VkPipeline>>();
+		{
+			std::lock_guard lock(m_Mutex);
+			if (FindVariant(hash, values))
+				continue;
+
+			m_Variants.insert({hash, {.Values = values, .Pipeline = promise->get_future().share()}});
+		}
+
+		// The pipeline cache is internally synchronised, so compiling variants side by side is fine.
+		m_JobSystem->Run([this, promise, values = std::move(values)]()
+		{
+			promise->set_value(Compile(values));
+		});
+	}
+}
+
+std::vector<PermutationKey> ShaderPermutations::GetAllPermutations() const
+{
+	std::vector<PermutationKey> keys = {PermutationKey()};
+	for (const SpecializationConstant& constant : m_Constants)
+	{
+		std::vector<PermutationKey> expanded;
+		for (const PermutationKey& key : keys)
+		{
+			for (s32 value = constant.Min; value <= constant.Max; value++)
+				expanded.push_back(PermutationKey(key).Set(constant.ID, value));
+		}
+		keys = std::move(expanded);
+	}
+	return keys;
+}
+
+size_t ShaderPermutations::GetVariantCount() const
+{
+	std::lock_guard lock(m_Mutex);
+	return m_Variants.size();
+}
+
+std::vector<SpecializationValue> ShaderPermutations::Resolve(const PermutationKey& key) const
+{
+	std::vector<SpecializationValue> values;
+	values.reserve(m_Constants.size());
+	for (const SpecializationConstant& constant : m_Constants)
+	{
+		const s32 value = key.Get(constant.ID).value_or(constant.Default);
+		VULC_ASSERT(value >= constant.Min && value <= constant.Max, "{} is out of range: {}", constant.Name, value);
+		values.push_back({constant.ID, static_cast<u32>(value)});
+	}
+
+	// Keys with constants the shader doesn't declare are almost certainly a typo.
+	VULC_ASSERT(std::ranges::all_of(key.GetValues(), [this](const auto& entry)
+	{
+		return std::ranges::find(m_Constants, entry.first, &SpecializationConstant::ID) != m_Constants.end();
+	}), "Permutation key sets a constant the shader doesn't declare");
+
+	return values;
+}
+
+const ShaderPermutations::Variant* ShaderPermutations::FindVariant(u64 hash,
+                                                                   std::span<const SpecializationValue> values) const
+{
+	auto [begin, end] = m_Variants.equal_range(hash);
+	auto it           = std::find_if(begin, end, [&values](const auto& entry)
+	{
+		return std::ranges::equal(entry.second.Values, values);
+	});
+	return it != end ? &it->second : nullptr;
+}
+
+u64 ShaderPermutations::Hash(std::span<const SpecializationValue> values)
+{
+	// FNV-1a over the IDs and values.
+	u64 hash = 14695981039346656037ull;
+	auto mix = [&hash](u32 word)
+	{
+		for (u32 byte = 0; byte < 4; byte++)
+		{
+			hash ^= (word >> (byte * 8)) & 0xFF;
+			hash *= 1099511628211ull;
+		}
+	};
+	for (const SpecializationValue& value : values)
+	{
+		mix(value.ID);
+		mix(value.Value);
+	}
+	return hash;
+}
+
+VkPipeline ShaderPermutations::Compile(const std::vector<SpecializationValue>& values) const
+{
+	return CreateComputePipeline(m_Device, m_Layout, m_Shader, m_WorkgroupSize, values, m_Cache);
+}
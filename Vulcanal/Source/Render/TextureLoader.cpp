@@ -0,0 +1,293 @@
+#include "vulcpch.h"
+#include "Render/TextureLoader.h"
+
+#include <chrono>
+#include <fstream>
+#include <stb_image.h>
+
+#include "Core/Jobs/JobSystem.h"
+#include "Render/Renderer.h"
+
+namespace
+{
+	// Keep each copy in the staging buffer aligned to a texel of the largest format we produce (RGBA32F).
+	constexpr size_t StagingAlignment = 16;
+
+	std::string ToLower(std::string string)
+	{
+		std::ranges::transform(string, string.begin(), [](char c) { return static_cast<char>(std::tolower(c)); });
+		return string;
+	}
+}
+
+struct TextureLoader::DecodedImage
+{
+	std::string Name;
+	void*       Pixels = nullptr; // Owned by stb until it's been copied to the staging buffer.
+	size_t      Size   = 0;
+	u32         Width  = 0, Height = 0;
+	VkFormat    Format = VK_FORMAT_UNDEFINED;
+};
+
+TextureLoader::TextureLoader(Renderer& renderer, JobSystem* jobSystem)
+	: m_Renderer(renderer), m_JobSystem(jobSystem)
+{
+}
+
+AllocatedImage TextureLoader::Load(const std::filesystem::path& path, const TextureLoadOptions& options) const
+{
+	return Load(std::span(&path, 1), options)[0];
+}
+
+std::vector<AllocatedImage> TextureLoader::Load(std::span<const std::filesystem::path> paths,
+                                                const TextureLoadOptions&              options) const
+{
+	std::vector<AllocatedImage> images(paths.size(), AllocatedImage{});
+	if (paths.empty())
+		return images;
+
+	const auto startTime = std::chrono::high_resolution_clock::now();
+
+	// We decode a few files per thread at a time, so the decoded pixels for a whole directory never have to be in
+	// memory at once.
+	const size_t threadCount = m_JobSystem ? m_JobSystem->GetThreadCount() : 1;
+	const size_t groupSize   = threadCount * 4;
+
+	std::vector<DecodedImage> decoded;
+	for (size_t first = 0; first < paths.size(); first += groupSize)
+	{
+		const size_t count = std::min(groupSize, paths.size() - first);
+		decoded.assign(count, {});
+		DecodeBatch(paths.subspan(first, count), decoded, options);
+		UploadBatch(decoded, std::span(images).subspan(first, count), options);
+	}
+
+	const auto endTime = std::chrono::high_resolution_clock::now();
+	if (paths.size() > 1)
+	{
+		VULC_INFO("Loaded {} textures in {:.2f}ms", paths.size(),
+		          std::chrono::duration<f64, std::milli>(endTime - startTime).count());
+	}
+
+	return images;
+}
+
+std::unordered_map<std::string, AllocatedImage> TextureLoader::LoadDirectory(
+	const std::filesystem::path& directory, const TextureLoadOptions& options, bool recursive) const
+{
+	std::unordered_map<std::string, AllocatedImage> textures;
+
+	std::error_code errorCode;
+	if (!std::filesystem::is_directory(directory, errorCode))
+	{
+		VULC_ERROR("Can't load textures from {}: not a directory", directory.string());
+		return textures;
+	}
+
+	// Walked by hand, with error codes throughout: range-for uses the throwing operator++, so one unreadable entry
+	// partway through would throw. Whatever was found before an error still gets loaded.
+	std::vector<std::filesystem::path> paths;
+	auto collectFiles = [&](auto it)
+	{
+		for (; !errorCode && it != std::filesystem::end(it); it.increment(errorCode))
+		{
+			std::error_code fileError;
+			if (it->is_regular_file(fileError) && IsSupportedExtension(it->path()))
+				paths.push_back(it->path());
+		}
+
+		if (errorCode)
+			VULC_WARN("Stopped looking for textures in {}: {}", directory.string(), errorCode.message());
+	};
+
+	constexpr auto iteratorOptions = std::filesystem::directory_options::skip_permission_denied;
+	if (recursive)
+		collectFiles(std::filesystem::recursive_directory_iterator(directory, iteratorOptions, errorCode));
+	else
+		collectFiles(std::filesystem::directory_iterator(directory, iteratorOptions, errorCode));
+
+	std::vector<AllocatedImage> images = Load(paths, options);
+	for (size_t i = 0; i < paths.size(); i++)
+	{
+		if (images[i].Image)
+			textures.emplace(std::filesystem::relative(paths[i], directory).generic_string(), images[i]);
+	}
+
+	return textures;
+}
+
+bool TextureLoader::IsSupportedExtension(const std::filesystem::path& path)
+{
+	static const std::unordered_set<std::string> extensions = {
+		".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif", ".hdr", ".pic", ".pnm", ".ppm", ".pgm"
+	};
+	return extensions.contains(ToLower(path.extension().string()));
+}
+
+void TextureLoader::DecodeBatch(std::span<const std::filesystem::path> paths, std::span<DecodedImage> outImages,
+                                const TextureLoadOptions&              options) const
+{
+	auto decodeRange = [&](u32 begin, u32 end)
+	{
+		std::vector<u8> fileData;
+		for (u32 i = begin; i < end; i++)
+		{
+			DecodedImage& image = outImages[i];
+			image.Name          = paths[i].string();
+
+			// Read the whole file ourselves, rather than letting stb open it, so non-ASCII paths work on Windows too.
+			std::ifstream file(paths[i], std::ios::ate | std::ios::binary);
+			if (!file.is_open())
+			{
+				VULC_ERROR("Failed to open texture file: {}", image.Name);
+				continue;
+			}
+			fileData.resize(static_cast<size_t>(file.tellg()));
+			file.seekg(0);
+			file.read(reinterpret_cast<char*>(fileData.data()), static_cast<std::streamsize>(fileData.size()));
+			file.close();
+
+			// Everything is expanded to 4 channels, as 3 channel formats are barely supported for sampling.
+			const auto* data = fileData.data();
+			const s32   size = static_cast<s32>(fileData.size());
+			s32         width, height, channels;
+			size_t      texelSize;
+			if (stbi_is_hdr_from_memory(data, size))
+			{
+				image.Pixels = stbi_loadf_from_memory(data, size, &width, &height, &channels, STBI_rgb_alpha);
+				image.Format = VK_FORMAT_R32G32B32A32_SFLOAT;
+				texelSize    = 4 * sizeof(f32);
+			}
+			else if (stbi_is_16_bit_from_memory(data, size))
+			{
+				image.Pixels = stbi_load_16_from_memory(data, size, &width, &height, &channels, STBI_rgb_alpha);
+				image.Format = VK_FORMAT_R16G16B16A16_UNORM;
+				texelSize    = 4 * sizeof(u16);
+			}
+			else
+			{
+				image.Pixels = stbi_load_from_memory(data, size, &width, &height, &channels, STBI_rgb_alpha);
+				image.Format = options.SRGB ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+				texelSize    = 4 * sizeof(u8);
+			}
+
+			if (!image.Pixels)
+			{
+				VULC_ERROR("Failed to decode texture {}: {}", image.Name, stbi_failure_reason());
+				continue;
+			}
+
+			image.Width  = static_cast<u32>(width);
+			image.Height = static_cast<u32>(height);
+			image.Size   = static_cast<size_t>(image.Width) * image.Height * texelSize;
+		}
+	};
+
+	if (m_JobSystem)
+		m_JobSystem->ParallelFor(static_cast<u32>(paths.size()), decodeRange);
+	else
+		decodeRange(0, static_cast<u32>(paths.size()));
+}
+
+void TextureLoader::UploadBatch(std::span<DecodedImage> images, std::span<AllocatedImage> outImages,
+                                const TextureLoadOptions& options) const
+{
+	VkPhysicalDevice gpu = m_Renderer.GetGPU();
+
+	size_t first = 0;
+	while (first < images.size())
+	{
+		// Fill up one staging buffer's worth of images (always at least one, so huge images still get through).
+		std::vector<size_t> offsets;
+		size_t              stagingSize = 0;
+		size_t              end         = first;
+		for (; end < images.size(); end++)
+		{
+			const size_t offset = (stagingSize + StagingAlignment - 1) & ~(StagingAlignment - 1);
+			if (end > first && offset + images[end].Size > m_StagingBudget)
+				break;
+
+			offsets.push_back(offset);
+			stagingSize = offset + images[end].Size;
+		}
+
+		const auto batch    = images.subspan(first, end - first);
+		auto       outBatch = outImages.subspan(first, end - first);
+		first               = end;
+
+		if (stagingSize == 0)
+			continue; // Nothing in this batch decoded.
+
+		AllocatedBuffer staging = m_Renderer.CreateBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		                                                  VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+
+		// Copying into (likely write-combined) mapped memory isn't free either, so spread that out too.
+		auto copyRange = [&](u32 begin, u32 rangeEnd)
+		{
+			for (u32 i = begin; i < rangeEnd; i++)
+			{
+				if (!batch[i].Pixels)
+					continue;
+
+				memcpy(static_cast<u8*>(staging.Info.pMappedData) + offsets[i], batch[i].Pixels, batch[i].Size);
+				stbi_image_free(batch[i].Pixels);
+				batch[i].Pixels = nullptr;
+			}
+		};
+		if (m_JobSystem)
+			m_JobSystem->ParallelFor(static_cast<u32>(batch.size()), copyRange);
+		else
+			copyRange(0, static_cast<u32>(batch.size()));
+
+		for (size_t i = 0; i < batch.size(); i++)
+		{
+			if (batch[i].Size == 0)
+				continue;
+
+			const VkExtent3D extent    = {batch[i].Width, batch[i].Height, 1};
+			u32              mipLevels = 1;
+			if (options.GenerateMipmaps)
+			{
+				if (SupportsLinearBlit(gpu, batch[i].Format))
+					mipLevels = CalculateMipLevels({extent.width, extent.height});
+				else
+					VULC_WARN("Can't generate mipmaps for {}: {} doesn't support linear blits", batch[i].Name,
+					          string_VkFormat(batch[i].Format));
+			}
+
+			outBatch[i] = m_Renderer.CreateImage(extent, batch[i].Format,
+			                                     VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+			                                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT, mipLevels);
+		}
+
+		// One submission for the whole batch: copy in mip 0, then blit it down the chain. The GPU does all the
+		// filtering; we just wait for it to finish so we can free the staging buffer.
+		m_Renderer.ImmediateSubmit([&](VkCommandBuffer cmd)
+		{
+			for (size_t i = 0; i < batch.size(); i++)
+			{
+				const AllocatedImage& image = outBatch[i];
+				if (!image.Image)
+					continue;
+
+				TransitionImage(cmd, image.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+				VkBufferImageCopy copyRegion               = {};
+				copyRegion.bufferOffset                    = offsets[i];
+				copyRegion.bufferRowLength                 = 0;
+				copyRegion.bufferImageHeight               = 0;
+				copyRegion.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+				copyRegion.imageSubresource.mipLevel       = 0;
+				copyRegion.imageSubresource.baseArrayLayer = 0;
+				copyRegion.imageSubresource.layerCount     = 1;
+				copyRegion.imageExtent                     = image.Extent;
+				vkCmdCopyBufferToImage(cmd, staging.Buffer, image.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
+				                       &copyRegion);
+
+				GenerateMipmaps(cmd, image.Image, {image.Extent.width, image.Extent.height}, image.MipLevels);
+			}
+		});
+
+		m_Renderer.DestroyBuffer(staging);
+	}
+}
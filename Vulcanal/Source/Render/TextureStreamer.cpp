@@ -0,0 +1,523 @@
+#include "vulcpch.h"
+#include "Render/TextureStreamer.h"
+
+#include "Core/ThreadPool.h"
+#include "Core/FileSystem/VirtualFileSystem.h"
+#include "Render/Renderer.h"
+
+namespace
+{
+	// Block-compressed copies need offsets aligned to the block size (8 or 16 bytes).
+	constexpr u64 StagingAlignment = 16;
+
+	constexpr VkImageUsageFlags StreamedImageUsage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+		VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+}
+
+u64 StreamedTexture::GetSizeFromMip(u32 mip) const
+{
+	u64 size = 0;
+	for (u32 level = mip; level < GetMipLevels(); level++)
+		size += File.Levels[level].Size;
+	return size;
+}
+
+void TextureStreamer::Init(Renderer* renderer, ThreadPool* threadPool, AsyncFileIO* asyncIO)
+{
+	m_Renderer   = renderer;
+	m_ThreadPool = threadPool;
+	m_AsyncIO    = asyncIO;
+
+	VkCommandPoolCreateInfo poolInfo = CreateCommandPoolCreateInfo(m_Renderer->GetGraphicsQueueFamily(),
+	                                                               VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	VK_CHECK(vkCreateCommandPool(m_Renderer->GetDevice(), &poolInfo, nullptr, &m_CommandPool));
+}
+
+void TextureStreamer::Shutdown()
+{
+	if (!m_CommandPool)
+		return;
+
+	VkDevice device = m_Renderer->GetDevice();
+
+	// Workers (or the kernel) may still be writing into staging memory, so let them finish before we free anything.
+	{
+		std::unique_lock lock(m_ReadMutex);
+		m_ReadsDone.wait(lock, [this]() { return m_ReadsInFlight == 0; });
+	}
+
+	for (auto& transfer : m_Transfers)
+	{
+		if (transfer->State == TransferState::Submitted)
+			VK_CHECK(vkWaitForFences(device, 1, &transfer->Fence, true, UINT64_MAX));
+		m_Renderer->DestroyImage(transfer->NewImage);
+		ReleaseTransfer(*transfer);
+	}
+	m_Transfers.clear();
+
+	for (auto& texture : m_Textures)
+		m_Renderer->DestroyImage(texture->Image);
+	m_Textures.clear();
+
+	for (auto& [cmd, fence] : m_FreeCommandBuffers)
+		vkDestroyFence(device, fence, nullptr);
+	m_FreeCommandBuffers.clear();
+
+	vkDestroyCommandPool(device, m_CommandPool, nullptr);
+	m_CommandPool = nullptr;
+}
+
+Ref<StreamedTexture> TextureStreamer::Load(const std::filesystem::path& path)
+{
+	auto        texture = CreateRef<StreamedTexture>();
+	std::string error;
+	if (!LoadKTX2Header(path, texture->File, error))
+	{
+		VULC_ERROR("Failed to load texture {}: {}", path.string(), error);
+		return nullptr;
+	}
+
+	if (!CanSample(texture->File))
+		return nullptr;
+
+	// The tail is everything from the first level that fits in TailSize x TailSize down.
+	const u32 mipLevels = texture->GetMipLevels();
+	texture->TailMip    = mipLevels - 1;
+	for (u32 mip = 0; mip < mipLevels; mip++)
+	{
+		const VkExtent3D extent = texture->File.GetMipExtent(mip);
+		if (std::max(extent.width, extent.height) <= m_TailSize)
+		{
+			texture->TailMip = mip;
+			break;
+		}
+	}
+	texture->ResidentMip   = mipLevels;
+	texture->RequestedMip  = texture->TailMip;
+	texture->LastUsedFrame = m_Renderer->GetFrameIndex();
+
+	m_Textures.push_back(texture);
+	return texture;
+}
+
+void TextureStreamer::Unload(const Ref<StreamedTexture>& texture)
+{
+	if (!texture)
+		return;
+
+	std::erase(m_Textures, texture);
+
+	// If there's a transfer in flight, it holds its own reference, and Update() will see the texture's gone.
+	if (!texture->Pending)
+		RetireImage(texture->Image);
+}
+
+void TextureStreamer::Update()
+{
+	VkDevice device = m_Renderer->GetDevice();
+
+	// First, retire anything the GPU has finished with, and submit anything whose data has arrived.
+	for (auto it = m_Transfers.begin(); it != m_Transfers.end();)
+	{
+		Transfer& transfer = **it;
+		switch (transfer.State.load())
+		{
+		case TransferState::Ready:
+			if (SubmitTransfer(transfer))
+			{
+				++it;
+				continue;
+			}
+			// Out of budget. Settle where we are, and let the residency manager decide what to do about it.
+			transfer.Texture->RequestedMip = transfer.Texture->ResidentMip;
+			transfer.Texture->Pending      = false;
+			break;
+		case TransferState::Submitted:
+			if (vkGetFenceStatus(device, transfer.Fence) != VK_SUCCESS)
+			{
+				++it;
+				continue;
+			}
+			FinishTransfer(transfer);
+			break;
+		case TransferState::Failed:
+			VULC_ERROR("Failed to read mip {} of {}", transfer.NewResidentMip, transfer.Texture->File.Path.string());
+			transfer.Texture->Failed  = true;
+			transfer.Texture->Pending = false;
+			break;
+		case TransferState::Reading:
+			++it;
+			continue;
+		}
+
+		// If it was unloaded while we were busy, nothing else references the image now.
+		if (!transfer.Texture->Pending && std::ranges::find(m_Textures, transfer.Texture) == m_Textures.end())
+			Unload(transfer.Texture);
+
+		ReleaseTransfer(transfer);
+		it = m_Transfers.erase(it);
+	}
+
+	// Then start new ones. Textures with nothing resident come first, so everything in view has something to show as
+	// soon as possible; after that, we step each texture up one level at a time, which naturally favours the cheap
+	// (small) levels across all textures before the expensive ones.
+	u64 bytesThisFrame = 0;
+	for (bool tailsOnly : {true, false})
+	{
+		for (const auto& texture : m_Textures)
+		{
+			if (m_Transfers.size() >= m_MaxTransfers)
+				return;
+			if (texture->Pending || texture->Failed || texture->RequestedMip == texture->ResidentMip)
+				continue;
+			// Our copies would race the defragmenter's.
+			if (m_Renderer->GetDefragmenter().IsMoving(texture->Image))
+				continue;
+
+			// Evictions just drop the image; there's nothing to transfer.
+			if (texture->RequestedMip >= texture->GetMipLevels())
+			{
+				RetireImage(texture->Image);
+				texture->ResidentMip = texture->GetMipLevels();
+				texture->Version++;
+				continue;
+			}
+
+			const bool resident = texture->IsUsable();
+			if (tailsOnly == resident)
+				continue;
+
+			// Downgrades don't read anything, so they're free as far as the budget goes. They stop at the tail; going
+			// any further is an eviction, handled above.
+			u32 newResidentMip = std::min(texture->RequestedMip, texture->TailMip);
+			u64 readSize       = 0;
+			if (!resident)
+			{
+				newResidentMip = texture->TailMip;
+				readSize       = texture->GetSizeFromMip(newResidentMip);
+			}
+			else if (texture->RequestedMip < texture->ResidentMip)
+			{
+				newResidentMip = texture->ResidentMip - 1;
+				readSize       = texture->File.Levels[newResidentMip].Size;
+			}
+
+			// Always let one read through, so a level bigger than the budget can't stall forever.
+			if (readSize > 0 && bytesThisFrame > 0 && bytesThisFrame + readSize > m_UploadBudget)
+				continue;
+
+			if (BeginTransfer(texture, newResidentMip))
+				bytesThisFrame += readSize;
+		}
+	}
+}
+
+TextureStreamerStats TextureStreamer::GetStats() const
+{
+	TextureStreamerStats stats;
+	stats.TextureCount    = static_cast<u32>(m_Textures.size());
+	stats.ActiveTransfers = static_cast<u32>(m_Transfers.size());
+	stats.UploadedBytes   = m_UploadedBytes;
+	for (const auto& texture : m_Textures)
+		stats.ResidentBytes += texture->GetResidentSize();
+	return stats;
+}
+
+bool TextureStreamer::BeginTransfer(const Ref<StreamedTexture>& texture, u32 newResidentMip)
+{
+	auto transfer            = CreateScope<Transfer>();
+	transfer->Texture        = texture;
+	transfer->NewResidentMip = newResidentMip;
+
+	// Only upgrades need to read anything; downgrades are a GPU-side copy of the levels we're keeping.
+	const u32 readEnd = std::min(texture->ResidentMip, texture->GetMipLevels());
+	if (newResidentMip < readEnd)
+	{
+		u64 stagingSize = 0;
+		for (u32 mip = newResidentMip; mip < readEnd; mip++)
+		{
+			stagingSize = (stagingSize + StagingAlignment - 1) & ~(StagingAlignment - 1);
+			transfer->StagingOffsets.push_back(stagingSize);
+			stagingSize += texture->File.Levels[mip].Size;
+		}
+
+		transfer->Staging = m_Renderer->CreateBuffer(stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		                                             VMA_MEMORY_USAGE_CPU_ONLY, VMA_ALLOCATION_CREATE_MAPPED_BIT);
+		if (!transfer->Staging.Buffer)
+			return false;
+
+		transfer->State = TransferState::Reading;
+
+		// Loose files go to the kernel as a batch, one read per level, so a cold texture's levels are all in the
+		// drive's queue at once instead of read one after another.
+		const std::string filePath = texture->File.Path.generic_string();
+		if (m_AsyncIO && !VirtualFileSystem::Get()->IsPacked(filePath) && BeginAsyncRead(*transfer, readEnd))
+		{
+			texture->Pending = true;
+			m_Transfers.push_back(std::move(transfer));
+			return true;
+		}
+
+		{
+			std::lock_guard lock(m_ReadMutex);
+			m_ReadsInFlight++;
+		}
+		m_ThreadPool->Submit([this, transfer = transfer.get(), readEnd]()
+		{
+			const KTX2File&   file     = transfer->Texture->File;
+			const std::string filePath = file.Path.generic_string();
+			auto*             mapped   = static_cast<u8*>(transfer->Staging.Info.pMappedData);
+
+			// Each level goes straight into the staging buffer. Packed textures are decoded into it, chunks in
+			// parallel, with no copy in between.
+			bool success = true;
+			for (u32 mip = transfer->NewResidentMip; success && mip < readEnd; mip++)
+			{
+				const KTX2Level& level = file.Levels[mip];
+				u8*              dest  = mapped + transfer->StagingOffsets[mip - transfer->NewResidentMip];
+				success = VirtualFileSystem::Get()->ReadRange(filePath, level.Offset, {dest, level.Size});
+			}
+
+			CompleteRead(*transfer, success);
+		});
+	}
+
+	texture->Pending = true;
+	m_Transfers.push_back(std::move(transfer));
+	return true;
+}
+
+void TextureStreamer::CompleteRead(Transfer& transfer, bool success)
+{
+	transfer.State = success ? TransferState::Ready : TransferState::Failed;
+
+	// Under the lock, so Shutdown() can't see the count hit zero and carry on before we're done notifying.
+	std::lock_guard lock(m_ReadMutex);
+	if (--m_ReadsInFlight == 0)
+		m_ReadsDone.notify_all();
+}
+
+bool TextureStreamer::BeginAsyncRead(Transfer& transfer, u32 readEnd)
+{
+	// Levels don't start on sector boundaries, so no direct I/O; the reads land in staging memory as they are.
+	if (!transfer.File.Open(transfer.Texture->File.Path))
+		return false;
+
+	const KTX2File& file   = transfer.Texture->File;
+	auto*           mapped = static_cast<u8*>(transfer.Staging.Info.pMappedData);
+
+	std::vector<AsyncReadRequest> requests;
+	for (u32 mip = transfer.NewResidentMip; mip < readEnd; mip++)
+	{
+		const KTX2Level& level = file.Levels[mip];
+		u8*              dest  = mapped + transfer.StagingOffsets[mip - transfer.NewResidentMip];
+		requests.push_back({
+			.File        = &transfer.File,
+			.Offset      = level.Offset,
+			.Destination = {dest, level.Size},
+			.OnComplete  = [this, transfer = &transfer, size = level.Size](s64 result)
+			{
+				if (result != static_cast<s64>(size))
+					transfer->ReadFailed = true;
+
+				// The last one in hands the transfer back to Update().
+				if (transfer->ReadsLeft.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					CompleteRead(*transfer, !transfer->ReadFailed);
+			},
+		});
+	}
+
+	transfer.ReadsLeft = static_cast<u32>(requests.size());
+	{
+		std::lock_guard lock(m_ReadMutex);
+		m_ReadsInFlight++;
+	}
+	m_AsyncIO->Read(requests);
+	return true;
+}
+
+bool TextureStreamer::SubmitTransfer(Transfer& transfer)
+{
+	VkDevice         device    = m_Renderer->GetDevice();
+	StreamedTexture& texture   = *transfer.Texture;
+	const u32        mipLevels = texture.GetMipLevels();
+	const u32        newMip    = transfer.NewResidentMip;
+	const u32        oldMip    = texture.ResidentMip;
+
+	// Streamed images stay within the heap budget; if we can't fit, we'd rather keep the levels we have than have the
+	// driver start paging.
+	transfer.NewImage = m_Renderer->CreateImage(texture.File.GetMipExtent(newMip), texture.File.Format,
+	                                            StreamedImageUsage, mipLevels - newMip,
+	                                            VMA_ALLOCATION_CREATE_WITHIN_BUDGET_BIT);
+	if (!transfer.NewImage.Image)
+	{
+		VULC_WARN("Not enough VRAM budget to stream mip {} of {}", newMip, texture.File.Path.string());
+		return false;
+	}
+
+	if (m_FreeCommandBuffers.empty())
+	{
+		VkCommandBufferAllocateInfo allocInfo = CreateCommandBufferAllocateInfo(m_CommandPool);
+		VkFenceCreateInfo           fenceInfo = CreateFenceCreateInfo();
+		auto&                       entry     = m_FreeCommandBuffers.emplace_back();
+		VK_CHECK(vkAllocateCommandBuffers(device, &allocInfo, &entry.first));
+		VK_CHECK(vkCreateFence(device, &fenceInfo, nullptr, &entry.second));
+	}
+	std::tie(transfer.Cmd, transfer.Fence) = m_FreeCommandBuffers.back();
+	m_FreeCommandBuffers.pop_back();
+
+	VkCommandBuffer          cmd       = transfer.Cmd;
+	VkCommandBufferBeginInfo beginInfo = CreateCommandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+	VK_CHECK(vkResetCommandBuffer(cmd, 0));
+	VK_CHECK(vkBeginCommandBuffer(cmd, &beginInfo));
+
+	TransitionImage(cmd, transfer.NewImage.Image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+	// Copy over the levels both images share. Frames that are already queued still sample the old image, so it goes
+	// back to SHADER_READ_ONLY straight after.
+	if (texture.IsUsable())
+	{
+		const u32                 firstShared = std::max(newMip, oldMip);
+		std::vector<VkImageCopy2> regions;
+		for (u32 mip = firstShared; mip < mipLevels; mip++)
+		{
+			VkImageCopy2 region   = {};
+			region.sType          = VK_STRUCTURE_TYPE_IMAGE_COPY_2;
+			region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - oldMip, 0, 1};
+			region.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mip - newMip, 0, 1};
+			region.extent         = texture.File.GetMipExtent(mip);
+			regions.push_back(region);
+		}
+
+		VkCopyImageInfo2 copyInfo = {};
+		copyInfo.sType            = VK_STRUCTURE_TYPE_COPY_IMAGE_INFO_2;
+		copyInfo.srcImage         = texture.Image.Image;
+		copyInfo.srcImageLayout   = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		copyInfo.dstImage         = transfer.NewImage.Image;
+		copyInfo.dstImageLayout   = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		copyInfo.regionCount      = static_cast<u32>(regions.size());
+		copyInfo.pRegions         = regions.data();
+
+		TransitionImage(cmd, texture.Image.Image, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		                VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+		vkCmdCopyImage2(cmd, &copyInfo);
+		TransitionImage(cmd, texture.Image.Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	}
+
+	// And the new levels from staging.
+	for (u32 i = 0; i < transfer.StagingOffsets.size(); i++)
+	{
+		const u32         mip    = newMip + i;
+		VkBufferImageCopy region = {};
+		region.bufferOffset      = transfer.StagingOffsets[i];
+		region.imageSubresource  = {VK_IMAGE_ASPECT_COLOR_BIT, mip - newMip, 0, 1};
+		region.imageExtent       = texture.File.GetMipExtent(mip);
+		vkCmdCopyBufferToImage(cmd, transfer.Staging.Buffer, transfer.NewImage.Image,
+		                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	}
+
+	TransitionImage(cmd, transfer.NewImage.Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	VK_CHECK(vkEndCommandBuffer(cmd));
+
+	VkCommandBufferSubmitInfo cmdInfo = CreateCommandBufferSubmitInfo(cmd);
+	VkSubmitInfo2             submit  = CreateSubmitInfo(&cmdInfo, nullptr, nullptr);
+	{
+		auto queueLock = m_Renderer->LockQueue();
+		VK_CHECK(vkQueueSubmit2(m_Renderer->GetGraphicsQueue(), 1, &submit, transfer.Fence));
+	}
+
+	transfer.State = TransferState::Submitted;
+	return true;
+}
+
+void TextureStreamer::FinishTransfer(Transfer& transfer)
+{
+	StreamedTexture& texture = *transfer.Texture;
+
+	// Frames in flight may still be sampling the old image.
+	RetireImage(texture.Image);
+
+	for (u32 mip = transfer.NewResidentMip; mip < std::min(texture.ResidentMip, texture.GetMipLevels()); mip++)
+		m_UploadedBytes += texture.File.Levels[mip].Size;
+
+	texture.Image       = transfer.NewImage;
+	texture.ResidentMip = transfer.NewResidentMip;
+	texture.Pending     = false;
+	texture.Version++;
+	transfer.NewImage.Reset();
+
+	// Streamed textures come and go constantly, so they're exactly what leaves holes in the heap. Let the
+	// defragmenter move them, as long as we're not in the middle of a transfer of our own.
+	StreamedTexture* texturePtr = transfer.Texture.get();
+	m_Renderer->GetDefragmenter().Register({
+		.Image = &texture.Image,
+		.Usage = StreamedImageUsage,
+		.CanMove = [texturePtr]() { return !texturePtr->Pending; },
+		.OnMoved = [texturePtr]() { texturePtr->Version++; },
+	});
+}
+
+void TextureStreamer::ReleaseTransfer(Transfer& transfer)
+{
+	m_Renderer->DestroyBuffer(transfer.Staging);
+
+	if (transfer.Cmd)
+	{
+		VK_CHECK(vkResetFences(m_Renderer->GetDevice(), 1, &transfer.Fence));
+		m_FreeCommandBuffers.emplace_back(transfer.Cmd, transfer.Fence);
+		transfer.Cmd   = nullptr;
+		transfer.Fence = nullptr;
+	}
+}
+
+void TextureStreamer::RetireImage(AllocatedImage& image)
+{
+	if (!image.Image)
+		return;
+
+	// If it's mid-move, the defragmenter frees it along with its copy.
+	if (m_Renderer->GetDefragmenter().Unregister(image))
+	{
+		image.Reset();
+		return;
+	}
+
+	VmaAllocationInfo allocationInfo;
+	vmaGetAllocationInfo(m_Renderer->GetAllocator(), image.Allocation, &allocationInfo);
+	m_RetiringBytes += allocationInfo.size;
+
+	m_Renderer->DeferDestruction([this, image, size = allocationInfo.size]() mutable
+	{
+		m_Renderer->DestroyImage(image);
+		m_RetiringBytes -= size;
+	});
+	image.Reset();
+}
+
+bool TextureStreamer::CanSample(const KTX2File& file) const
+{
+	const TextureCompressionFamily family = GetTextureCompressionFamily(file.Format);
+	if (!m_Renderer->SupportsTextureCompression(family))
+	{
+		VULC_ERROR("Can't load {}: this GPU doesn't support {} compressed textures", file.Path.string(),
+		           TextureCompressionFamilyToString(family));
+		return false;
+	}
+
+	// Even within a supported family, individual formats can be missing (e.g. HDR ASTC, or ETC2 via emulation).
+	constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT |
+		VK_FORMAT_FEATURE_TRANSFER_SRC_BIT;
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(m_Renderer->GetGPU(), file.Format, &properties);
+	if ((properties.optimalTilingFeatures & required) != required)
+	{
+		VULC_ERROR("Can't load {}: {} isn't supported for sampled images on this GPU", file.Path.string(),
+		           string_VkFormat(file.Format));
+		return false;
+	}
+
+	return true;
+}
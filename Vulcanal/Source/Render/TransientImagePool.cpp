@@ -0,0 +1,263 @@
+#include "vulcpch.h"
+#include "Render/TransientImagePool.h"
+
+#include <limits>
+#include <numeric>
+
+#include "Render/Renderer.h"
+
+namespace
+{
+	VkImageAspectFlags GetAspectFlags(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_D32_SFLOAT:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	VkImageCreateInfo CreateTransientImageInfo(const TransientImageDesc& desc)
+	{
+		return CreateImageCreateInfo(desc.Format, desc.Usage, {desc.Extent.width, desc.Extent.height, 1}, 1, 1,
+		                             desc.Samples);
+	}
+
+	VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+void TransientImagePool::Init(Renderer* renderer)
+{
+	m_Renderer = renderer;
+}
+
+void TransientImagePool::Shutdown()
+{
+	Release();
+	m_Declarations.clear();
+	m_CompiledDeclarations.clear();
+}
+
+void TransientImagePool::BeginFrame()
+{
+	m_Declarations.clear();
+}
+
+TransientImageHandle TransientImagePool::Declare(const TransientImageDesc& desc, u32 firstPass, u32 lastPass,
+                                                 bool persistent)
+{
+	VULC_ASSERT(firstPass <= lastPass, "Transient image lifetimes must end after they start");
+	m_Declarations.push_back({.Desc = desc, .FirstPass = firstPass, .LastPass = lastPass, .Persistent = persistent});
+	return static_cast<TransientImageHandle>(m_Declarations.size() - 1);
+}
+
+void TransientImagePool::Compile()
+{
+	m_Stats.DeclaredImages = static_cast<u32>(m_Declarations.size());
+
+	// The common case: the same passes as last frame, so the same images.
+	if (std::ranges::equal(m_Declarations, m_CompiledDeclarations, &Declaration::Matches))
+	{
+		for (size_t i = 0; i < m_Declarations.size(); i++)
+			m_Declarations[i].PhysicalIndex = m_CompiledDeclarations[i].PhysicalIndex;
+		return;
+	}
+
+	Rebuild();
+}
+
+void TransientImagePool::Rebuild()
+{
+	Release();
+
+	// First, work out how many images we actually need. Going in order of first use, each declaration takes over an
+	// image with the same description that's done with by the time it starts, if there is one. Persistent images get
+	// a lifetime covering every pass, so nothing can share them or their memory.
+	std::vector<u32> order(m_Declarations.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::stable_sort(order, std::less(), [this](u32 index) { return m_Declarations[index].FirstPass; });
+
+	for (u32 index : order)
+	{
+		Declaration& declaration = m_Declarations[index];
+		if (declaration.Persistent)
+		{
+			declaration.PhysicalIndex = static_cast<u32>(m_PhysicalImages.size());
+			m_PhysicalImages.push_back({
+				.Desc = declaration.Desc, .FirstPass = 0, .LastPass = std::numeric_limits<u32>::max()
+			});
+			continue;
+		}
+
+		auto reusable = std::ranges::find_if(m_PhysicalImages, [&declaration](const PhysicalImage& image)
+		{
+			return image.Desc == declaration.Desc && image.LastPass < declaration.FirstPass;
+		});
+
+		if (reusable != m_PhysicalImages.end())
+		{
+			reusable->LastPass        = declaration.LastPass;
+			declaration.PhysicalIndex = static_cast<u32>(reusable - m_PhysicalImages.begin());
+			continue;
+		}
+
+		declaration.PhysicalIndex = static_cast<u32>(m_PhysicalImages.size());
+		m_PhysicalImages.push_back({
+			.Desc = declaration.Desc, .FirstPass = declaration.FirstPass, .LastPass = declaration.LastPass
+		});
+	}
+
+	// We can ask for memory requirements without creating the images, so we can lay the memory out first.
+	VkDevice device = m_Renderer->GetDevice();
+	for (PhysicalImage& image : m_PhysicalImages)
+	{
+		VkImageCreateInfo               imageInfo        = CreateTransientImageInfo(image.Desc);
+		VkDeviceImageMemoryRequirements requirementsInfo = {};
+		requirementsInfo.sType                           = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS;
+		requirementsInfo.pCreateInfo                     = &imageInfo;
+
+		VkMemoryRequirements2 requirements = {};
+		requirements.sType                 = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2;
+		vkGetDeviceImageMemoryRequirements(device, &requirementsInfo, &requirements);
+		image.Requirements = requirements.memoryRequirements;
+	}
+
+	PlaceImages();
+
+	// Then allocate each group's memory once, and bind everything into it.
+	VmaAllocator allocator = m_Renderer->GetAllocator();
+	for (MemoryGroup& group : m_MemoryGroups)
+	{
+		VkMemoryRequirements requirements = {};
+		requirements.size                 = group.Size;
+		requirements.alignment            = group.Alignment;
+		requirements.memoryTypeBits       = group.MemoryTypeBits;
+
+		VmaAllocationCreateInfo allocInfo = {};
+		allocInfo.usage                   = VMA_MEMORY_USAGE_GPU_ONLY;
+		allocInfo.requiredFlags           = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		VK_CHECK(vmaAllocateMemory(allocator, &requirements, &allocInfo, &group.Allocation, nullptr));
+	}
+
+	m_Stats.PhysicalImages = static_cast<u32>(m_PhysicalImages.size());
+	m_Stats.AllocatedBytes = 0;
+	m_Stats.UnaliasedBytes = 0;
+	for (const MemoryGroup& group : m_MemoryGroups)
+		m_Stats.AllocatedBytes += group.Size;
+
+	for (PhysicalImage& image : m_PhysicalImages)
+	{
+		VkImageCreateInfo imageInfo = CreateTransientImageInfo(image.Desc);
+		VK_CHECK(vkCreateImage(device, &imageInfo, nullptr, &image.Image.Image));
+
+		const MemoryGroup& group = m_MemoryGroups[image.MemoryGroup];
+		VK_CHECK(vmaBindImageMemory2(allocator, group.Allocation, image.Offset, image.Image.Image, nullptr));
+
+		VkImageViewCreateInfo viewInfo = CreateImageViewCreateInfo(image.Desc.Format, image.Image.Image,
+		                                                           GetAspectFlags(image.Desc.Format));
+		VK_CHECK(vkCreateImageView(device, &viewInfo, nullptr, &image.Image.ImageView));
+
+		image.Image.Allocation = group.Allocation;
+		image.Image.Extent     = {image.Desc.Extent.width, image.Desc.Extent.height, 1};
+		image.Image.Format     = image.Desc.Format;
+		image.Image.MipLevels  = 1;
+
+		m_Stats.UnaliasedBytes += image.Requirements.size;
+	}
+
+	m_CompiledDeclarations = m_Declarations;
+	m_Stats.Rebuilds++;
+
+	VULC_INFO("Built {} transient images ({} declared) in {:.1f} MB ({:.1f} MB without aliasing)",
+	          m_Stats.PhysicalImages, m_Stats.DeclaredImages, m_Stats.AllocatedBytes / (1024.0 * 1024.0),
+	          m_Stats.UnaliasedBytes / (1024.0 * 1024.0));
+}
+
+void TransientImagePool::PlaceImages()
+{
+	// Biggest first, which tends to pack best. Each image goes at the lowest offset in its group where it doesn't
+	// overlap anything it's alive at the same time as; the only offsets worth trying are 0 and the ends of those.
+	std::vector<u32> order(m_PhysicalImages.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::ranges::stable_sort(order, std::greater(), [this](u32 index)
+	{
+		return m_PhysicalImages[index].Requirements.size;
+	});
+
+	std::vector<u32> placed;
+	for (u32 index : order)
+	{
+		PhysicalImage& image = m_PhysicalImages[index];
+
+		auto group = std::ranges::find(m_MemoryGroups, image.Requirements.memoryTypeBits, &MemoryGroup::MemoryTypeBits);
+		if (group == m_MemoryGroups.end())
+			group = m_MemoryGroups.insert(group, {.MemoryTypeBits = image.Requirements.memoryTypeBits});
+		image.MemoryGroup = static_cast<u32>(group - m_MemoryGroups.begin());
+
+		std::vector<const PhysicalImage*> neighbours;
+		for (u32 other : placed)
+		{
+			const PhysicalImage& otherImage = m_PhysicalImages[other];
+			if (otherImage.MemoryGroup == image.MemoryGroup && otherImage.FirstPass <= image.LastPass &&
+				image.FirstPass <= otherImage.LastPass)
+				neighbours.push_back(&otherImage);
+		}
+
+		std::vector<VkDeviceSize> candidates = {0};
+		for (const PhysicalImage* neighbour : neighbours)
+			candidates.push_back(AlignUp(neighbour->Offset + neighbour->Requirements.size, image.Requirements.alignment));
+		std::ranges::sort(candidates);
+
+		for (VkDeviceSize offset : candidates)
+		{
+			const bool fits = std::ranges::none_of(neighbours, [&](const PhysicalImage* neighbour)
+			{
+				return offset < neighbour->Offset + neighbour->Requirements.size &&
+					neighbour->Offset < offset + image.Requirements.size;
+			});
+			if (fits)
+			{
+				image.Offset = offset;
+				break;
+			}
+		}
+
+		group->Size      = std::max(group->Size, image.Offset + image.Requirements.size);
+		group->Alignment = std::max(group->Alignment, image.Requirements.alignment);
+		placed.push_back(index);
+	}
+}
+
+void TransientImagePool::Release()
+{
+	// Frames in flight may still be using these, so let them go once they're done.
+	if (!m_PhysicalImages.empty() || !m_MemoryGroups.empty())
+	{
+		m_Renderer->DeferDestruction([renderer = m_Renderer, images = std::move(m_PhysicalImages),
+			                             groups = std::move(m_MemoryGroups)]()
+			{
+				for (const PhysicalImage& image : images)
+				{
+					vkDestroyImageView(renderer->GetDevice(), image.Image.ImageView, nullptr);
+					vkDestroyImage(renderer->GetDevice(), image.Image.Image, nullptr);
+				}
+				for (const MemoryGroup& group : groups)
+					vmaFreeMemory(renderer->GetAllocator(), group.Allocation);
+			});
+	}
+
+	m_PhysicalImages.clear();
+	m_MemoryGroups.clear();
+	m_CompiledDeclarations.clear();
+}
@@ -1,19 +1,29 @@
 ﻿#include <vulcpch.h>
 
-VkImageSubresourceRange ImageSubresourceRange(VkImageAspectFlags flags)
+VkImageSubresourceRange ImageSubresourceRange(VkImageAspectFlags flags, u32 baseMip, u32 levelCount, u32 baseLayer,
+                                              u32                layerCount)
 {
 	VkImageSubresourceRange range;
 	range.aspectMask     = flags;
-	range.baseMipLevel   = 0;
-	range.levelCount     = VK_REMAINING_MIP_LEVELS;
-	range.baseArrayLayer = 0;
-	range.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+	range.baseMipLevel   = baseMip;
+	range.levelCount     = levelCount;
+	range.baseArrayLayer = baseLayer;
+	range.layerCount     = layerCount;
 
 	return range;
 }
 
 void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout currentLayout,
                      VkImageLayout   newLayout)
+{
+	VkImageAspectFlags aspectFlags = (newLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
+		                                 ? VK_IMAGE_ASPECT_DEPTH_BIT
+		                                 : VK_IMAGE_ASPECT_COLOR_BIT;
+	TransitionImage(commandBuffer, image, currentLayout, newLayout, ImageSubresourceRange(aspectFlags));
+}
+
+void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout currentLayout, VkImageLayout newLayout,
+                     const VkImageSubresourceRange& range)
 {
 	VkImageMemoryBarrier2 imageBarrier = {};
 	imageBarrier.sType                 = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
@@ -27,10 +37,7 @@ void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout
 	imageBarrier.oldLayout = currentLayout;
 	imageBarrier.newLayout = newLayout;
 
-	VkImageAspectFlags aspectFlags = (newLayout == VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL)
-		                                 ? VK_IMAGE_ASPECT_DEPTH_BIT
-		                                 : VK_IMAGE_ASPECT_COLOR_BIT;
-	imageBarrier.subresourceRange = ImageSubresourceRange(aspectFlags);
+	imageBarrier.subresourceRange = range;
 	imageBarrier.image            = image;
 
 	VkDependencyInfo dependencyInfo = {};
@@ -44,7 +51,8 @@ void TransitionImage(VkCommandBuffer commandBuffer, VkImage image, VkImageLayout
 }
 
 void BlitImageToImage(VkCommandBuffer commandBuffer, VkImage   source, VkImage destination, VkExtent2D sourceExt,
-                      VkExtent2D      destinationExt, VkFilter filter)
+                      VkExtent2D      destinationExt, VkFilter filter, u32 sourceMip, u32 destinationMip,
+                      u32             baseLayer, u32 layerCount)
 {
 	VkImageBlit2 blitRegion = {};
 	blitRegion.sType        = VK_STRUCTURE_TYPE_IMAGE_BLIT_2;
@@ -59,14 +67,14 @@ void BlitImageToImage(VkCommandBuffer commandBuffer, VkImage   source, VkImage d
 	blitRegion.dstOffsets[1].z = 1;
 
 	blitRegion.srcSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-	blitRegion.srcSubresource.mipLevel       = 0;
-	blitRegion.srcSubresource.baseArrayLayer = 0;
-	blitRegion.srcSubresource.layerCount     = 1;
+	blitRegion.srcSubresource.mipLevel       = sourceMip;
+	blitRegion.srcSubresource.baseArrayLayer = baseLayer;
+	blitRegion.srcSubresource.layerCount     = layerCount;
 
 	blitRegion.dstSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-	blitRegion.dstSubresource.mipLevel       = 0;
-	blitRegion.dstSubresource.baseArrayLayer = 0;
-	blitRegion.dstSubresource.layerCount     = 1;
+	blitRegion.dstSubresource.mipLevel       = destinationMip;
+	blitRegion.dstSubresource.baseArrayLayer = baseLayer;
+	blitRegion.dstSubresource.layerCount     = layerCount;
 
 	VkBlitImageInfo2 blitInfo;
 	blitInfo.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2;
@@ -82,3 +90,37 @@ void BlitImageToImage(VkCommandBuffer commandBuffer, VkImage   source, VkImage d
 
 	vkCmdBlitImage2(commandBuffer, &blitInfo);
 }
+
+void GenerateMipmaps(VkCommandBuffer commandBuffer, VkImage image, VkExtent2D extent, u32 mipLevels, u32 layerCount,
+                     VkImageLayout   finalLayout)
+{
+	for (u32 mip = 1; mip < mipLevels; mip++)
+	{
+		// The previous level is done being written (either by the upload, or the last blit), so we can read from it.
+		TransitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		                ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, mip - 1, 1, 0, layerCount));
+
+		const VkExtent2D mipExtent = {std::max(extent.width / 2, 1u), std::max(extent.height / 2, 1u)};
+		BlitImageToImage(commandBuffer, image, image, extent, mipExtent, VK_FILTER_LINEAR, mip - 1, mip, 0, layerCount);
+		extent = mipExtent;
+	}
+
+	// Everything but the last level is in TRANSFER_SRC now.
+	if (mipLevels > 1)
+	{
+		TransitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, finalLayout,
+		                ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels - 1, 0, layerCount));
+	}
+	TransitionImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout,
+	                ImageSubresourceRange(VK_IMAGE_ASPECT_COLOR_BIT, mipLevels - 1, 1, 0, layerCount));
+}
+
+bool SupportsLinearBlit(VkPhysicalDevice gpu, VkFormat format)
+{
+	constexpr VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+		VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(gpu, format, &properties);
+	return (properties.optimalTilingFeatures & required) == required;
+}
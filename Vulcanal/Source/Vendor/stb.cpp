@@ -0,0 +1,6 @@
+#include "vulcpch.h"
+
+// stb gets its own translation unit, so it can be built with optimisations on regardless of configuration (see
+// premake5.lua).
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
@@ -0,0 +1,246 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <fstream>
+#include <random>
+#include <thread>
+
+#include "Core/Assets/AssetManager.h"
+#include "Core/Concurrency/Event.h"
+#include "Core/FileSystem/VirtualFileSystem.h"
+#include "Core/Jobs/JobSystem.h"
+#include "Core/ThreadPool.h"
+
+namespace
+{
+	// What every test file holds, and what the loader checks it got.
+	struct TestAsset
+	{
+		u32 Key = 0;
+
+		// Never actually freed, so a test that reads one through a stale handle reads dead memory rather than memory
+		// someone else owns. That's what the generation checks are meant to stop, and it's how we see it if they don't.
+		static void* operator new(size_t size);
+		static void  operator delete(void*) {}
+	};
+
+	constexpr u32    ArenaSize = 1 << 16;
+	TestAsset        s_Arena[ArenaSize];
+	std::atomic<u32> s_ArenaUsed = 0;
+
+	void* TestAsset::operator new(size_t size)
+	{
+		VULC_ASSERT(size == sizeof(TestAsset), "Only for TestAssets");
+		const u32 index = s_ArenaUsed.fetch_add(1, std::memory_order_relaxed);
+		VULC_ASSERT(index < ArenaSize, "The test asset arena's full");
+		return &s_Arena[index];
+	}
+
+	// A directory of small files, one per key, which holds the key, so a loaded asset can say which file it came from.
+	class TestFiles
+	{
+	public:
+		explicit TestFiles(u32 count)
+			: m_Directory(std::filesystem::temp_directory_path() / "VulcanalAssetManagerTests")
+		{
+			std::filesystem::create_directories(m_Directory);
+			for (u32 key = 0; key < count; key++)
+			{
+				std::ofstream file(GetPath(key), std::ios::binary);
+				file.write(reinterpret_cast<const char*>(&key), sizeof(key));
+			}
+		}
+
+		~TestFiles()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(m_Directory, error);
+		}
+
+		NODISCARD std::string GetPath(u32 key) const { return (m_Directory / fmt::format("{}.asset", key)).string(); }
+
+	private:
+		std::filesystem::path m_Directory;
+	};
+
+	Scope<TestAsset> LoadTestAsset(std::string_view, std::vector<u8>&& bytes)
+	{
+		if (bytes.size() != sizeof(u32))
+			return nullptr;
+		Scope<TestAsset> asset = CreateScope<TestAsset>();
+		std::memcpy(&asset->Key, bytes.data(), sizeof(u32));
+		return asset;
+	}
+}
+
+VULC_TEST(AssetManager_SharesAssetsByPath)
+{
+	TestFiles         files(1);
+	ThreadPool        threadPool(2);
+	JobSystem         jobs({.WorkerCount = 2});
+	VirtualFileSystem fileSystem;
+	AssetManager      assets(threadPool, jobs, fileSystem);
+	assets.RegisterLoader<TestAsset>(&LoadTestAsset);
+
+	const AssetHandle<TestAsset> first  = assets.Load<TestAsset>(files.GetPath(0));
+	const AssetHandle<TestAsset> second = assets.Load<TestAsset>(files.GetPath(0));
+	VULC_EXPECT(first.IsValid());
+	VULC_EXPECT(first.Index == second.Index && first.Generation == second.Generation);
+	VULC_EXPECT(assets.Wait(first) == AssetState::Ready);
+	VULC_EXPECT(assets.GetLoadedCount() == 1);
+
+	// It's only gone once both have let go.
+	assets.Release(first);
+	VULC_EXPECT(assets.IsReady(second));
+	VULC_EXPECT(assets.Get(second) && assets.Get(second)->Key == 0);
+	assets.Release(second);
+	VULC_EXPECT(assets.GetState(second) == AssetState::Unloaded);
+	VULC_EXPECT(assets.GetLoadedCount() == 0);
+}
+
+VULC_TEST(AssetManager_StaleHandlesDontSeeReusedSlots)
+{
+	TestFiles         files(2);
+	ThreadPool        threadPool(2);
+	JobSystem         jobs({.WorkerCount = 2});
+	VirtualFileSystem fileSystem;
+	AssetManager      assets(threadPool, jobs, fileSystem);
+	assets.RegisterLoader<TestAsset>(&LoadTestAsset);
+
+	const AssetHandle<TestAsset> stale = assets.Load<TestAsset>(files.GetPath(0));
+	VULC_EXPECT(assets.Wait(stale) == AssetState::Ready);
+	assets.Release(stale);
+
+	// The freed slot's the first one handed out again, so this one lands where the stale handle points.
+	const AssetHandle<TestAsset> reused = assets.Load<TestAsset>(files.GetPath(1));
+	VULC_EXPECT(reused.Index == stale.Index);
+	VULC_EXPECT(reused.Generation != stale.Generation);
+	VULC_EXPECT(assets.Wait(reused) == AssetState::Ready);
+
+	VULC_EXPECT(assets.GetState(stale) == AssetState::Unloaded);
+	VULC_EXPECT(assets.Get(stale) == nullptr);
+	VULC_EXPECT(assets.Wait(stale) == AssetState::Unloaded);
+	VULC_EXPECT(assets.Get(reused) && assets.Get(reused)->Key == 1);
+
+	// Nor can a stale handle take a reference to, or release, the new asset.
+	assets.AddRef(stale);
+	assets.Release(stale);
+	VULC_EXPECT(assets.IsReady(reused));
+	assets.Release(reused);
+}
+
+VULC_TEST(AssetManager_ReleasingWhileLoadingFreesItOnceLoaded)
+{
+	TestFiles         files(1);
+	ThreadPool        threadPool(1);
+	JobSystem         jobs({.WorkerCount = 1});
+	VirtualFileSystem fileSystem;
+	AssetManager      assets(threadPool, jobs, fileSystem);
+
+	// Holds the load up until we've let go of it.
+	Event            released(true, false);
+	std::atomic<u32> loads = 0;
+	assets.RegisterLoader<TestAsset>([&](std::string_view path, std::vector<u8>&& bytes)
+	{
+		released.Wait();
+		loads.fetch_add(1);
+		return LoadTestAsset(path, std::move(bytes));
+	});
+
+	const AssetHandle<TestAsset> handle = assets.Load<TestAsset>(files.GetPath(0));
+	VULC_EXPECT(assets.GetState(handle) == AssetState::Loading);
+
+	// The load still has the slot, so it's the load that frees it.
+	assets.Release(handle);
+	VULC_EXPECT(assets.GetState(handle) == AssetState::Loading);
+	released.Set();
+
+	assets.WaitIdle();
+	VULC_EXPECT(loads.load() == 1);
+	VULC_EXPECT(assets.GetLoadedCount() == 0);
+	VULC_EXPECT(assets.GetLoadingCount() == 0);
+	VULC_EXPECT(assets.GetState(handle) == AssetState::Unloaded);
+	VULC_EXPECT(assets.Get(handle) == nullptr);
+}
+
+VULC_TEST(AssetManager_ConcurrentLoadsAndReleases)
+{
+	// Few enough keys that the threads keep landing on each other's assets, and slots keep being freed and reused.
+	constexpr u32 KeyCount       = 8;
+	constexpr u32 LoaderThreads  = 4;
+	constexpr u32 LoadsPerThread = 2000;
+	constexpr u32 ReaderThreads  = 2;
+
+	TestFiles         files(KeyCount);
+	ThreadPool        threadPool(2);
+	JobSystem         jobs({.WorkerCount = 3});
+	VirtualFileSystem fileSystem;
+	AssetManager      assets(threadPool, jobs, fileSystem, {.MaxAssets = KeyCount});
+	assets.RegisterLoader<TestAsset>(&LoadTestAsset);
+
+	// The last handle anyone got for each key, packed as index and generation, for the readers to look through long
+	// after it's been released.
+	std::atomic<u64>  lastHandles[KeyCount] = {};
+	std::atomic<bool> loading               = true;
+
+	std::vector<std::thread> readers;
+	for (u32 t = 0; t < ReaderThreads; t++)
+	{
+		readers.emplace_back([&]()
+		{
+			while (loading.load(std::memory_order_relaxed))
+			{
+				for (u32 key = 0; key < KeyCount; key++)
+				{
+					const u64              packed = lastHandles[key].load(std::memory_order_relaxed);
+					AssetHandle<TestAsset> handle;
+					handle.Index      = static_cast<u32>(packed >> 32);
+					handle.Generation = static_cast<u32>(packed);
+
+					// No reference held, so it might be anything by now, except someone else's.
+					if (const TestAsset* asset = assets.Get(handle))
+						VULC_EXPECT(asset->Key == key);
+				}
+			}
+		});
+	}
+
+	std::vector<std::thread> loaders;
+	for (u32 t = 0; t < LoaderThreads; t++)
+	{
+		loaders.emplace_back([&, t]()
+		{
+			std::mt19937 random(t);
+			for (u32 i = 0; i < LoadsPerThread; i++)
+			{
+				const u32                    key    = random() % KeyCount;
+				const AssetHandle<TestAsset> handle = assets.Load<TestAsset>(files.GetPath(key));
+				VULC_EXPECT(handle.IsValid());
+				if (!handle.IsValid())
+					continue;
+				const u64 packed = static_cast<u64>(handle.Index) << 32 | handle.Generation;
+				lastHandles[key].store(packed, std::memory_order_relaxed);
+
+				// Only wait on some, so others are released while they're still loading.
+				if (random() % 2 == 0)
+				{
+					VULC_EXPECT(assets.Wait(handle) == AssetState::Ready);
+					const TestAsset* asset = assets.Get(handle);
+					VULC_EXPECT(asset && asset->Key == key);
+				}
+				assets.Release(handle);
+			}
+		});
+	}
+
+	for (std::thread& loader : loaders)
+		loader.join();
+	loading.store(false, std::memory_order_relaxed);
+	for (std::thread& reader : readers)
+		reader.join();
+
+	// Everything's been released, so once the stragglers finish loading, nothing's left.
+	assets.WaitIdle();
+	VULC_EXPECT(assets.GetLoadingCount() == 0);
+	VULC_EXPECT(assets.GetLoadedCount() == 0);
+}
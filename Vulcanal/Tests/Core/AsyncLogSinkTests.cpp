@@ -0,0 +1,112 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <thread>
+#include <mutex>
+
+#include <spdlog/sinks/base_sink.h>
+
+#include "Core/AsyncLogSink.h"
+
+namespace
+{
+	// Keeps every message it's given, and counts its flushes.
+	class RecordingSink : public spdlog::sinks::base_sink<std::mutex>
+	{
+	public:
+		std::vector<std::string> GetMessages()
+		{
+			std::lock_guard lock(mutex_);
+			return m_Messages;
+		}
+
+		u32 GetFlushes()
+		{
+			std::lock_guard lock(mutex_);
+			return m_Flushes;
+		}
+
+	protected:
+		void sink_it_(const spdlog::details::log_msg& msg) override
+		{
+			m_Messages.emplace_back(msg.payload.data(), msg.payload.size());
+		}
+
+		void flush_() override { m_Flushes++; }
+
+		std::vector<std::string> m_Messages = {};
+		u32                      m_Flushes  = 0;
+	};
+}
+
+VULC_TEST(AsyncLogSink_WritesEveryMessageInEachThreadsOrder)
+{
+	constexpr u32 ThreadCount       = 4;
+	constexpr u32 MessagesPerThread = 5000;
+
+	const auto recorder = CreateRef<RecordingSink>();
+	{
+		// Small, so loggers keep finding it full.
+		const auto sink   = CreateRef<AsyncLogSink>(std::vector<spdlog::sink_ptr>{recorder}, 64);
+		const auto logger = CreateRef<spdlog::logger>("AsyncLogSinkTest", sink);
+
+		std::vector<std::thread> threads;
+		for (u32 t = 0; t < ThreadCount; t++)
+		{
+			threads.emplace_back([&logger, t]()
+			{
+				for (u32 i = 0; i < MessagesPerThread; i++)
+					logger->info("{} {}", t, i);
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+
+		// Everything before the flush is written by the time it returns.
+		logger->flush();
+		VULC_EXPECT(recorder->GetMessages().size() == ThreadCount * MessagesPerThread);
+		VULC_EXPECT(recorder->GetFlushes() == 1);
+	}
+
+	std::vector<u32> next(ThreadCount, 0);
+	bool             inOrder = true;
+	for (const std::string& message : recorder->GetMessages())
+	{
+		u32 thread = 0;
+		u32 index  = 0;
+		std::istringstream(message) >> thread >> index;
+		inOrder &= thread < ThreadCount && next[thread] == index;
+		if (thread < ThreadCount)
+			next[thread] = index + 1;
+	}
+	VULC_EXPECT(inOrder);
+}
+
+VULC_TEST(AsyncLogSink_WritesWhatsLeftWhenDestroyed)
+{
+	const auto recorder = CreateRef<RecordingSink>();
+	{
+		const auto logger = CreateRef<spdlog::logger>("AsyncLogSinkTest",
+		                                              CreateRef<AsyncLogSink>(std::vector<spdlog::sink_ptr>{recorder}));
+		for (u32 i = 0; i < 1000; i++)
+			logger->info("{}", i);
+	}
+
+	VULC_EXPECT(recorder->GetMessages().size() == 1000);
+	VULC_EXPECT(recorder->GetFlushes() >= 1);
+}
+
+VULC_TEST(AsyncLogSink_FlushesOnErrors)
+{
+	const auto recorder = CreateRef<RecordingSink>();
+	const auto logger   = CreateRef<spdlog::logger>("AsyncLogSinkTest",
+	                                                CreateRef<AsyncLogSink>(std::vector<spdlog::sink_ptr>{recorder}));
+	logger->flush_on(spdlog::level::err);
+
+	logger->info("Not yet");
+	logger->error("Now");
+
+	// The error waited for its flush, so both are out already.
+	VULC_EXPECT(recorder->GetMessages().size() == 2);
+	VULC_EXPECT(recorder->GetFlushes() == 1);
+}
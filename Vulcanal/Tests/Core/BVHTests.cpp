@@ -0,0 +1,225 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Core/BVH.h"
+#include "Core/Jobs/JobSystem.h"
+
+namespace
+{
+	constexpr u32 ObjectCount = 2000;
+	constexpr u32 RayCount    = 2000;
+
+	// The same slab test the BVH uses, so the two agree on what a hit is.
+	f32 HitDistance(const Ray& ray, const AABB& bounds)
+	{
+		if (!bounds.IsValid())
+			return std::numeric_limits<f32>::max();
+
+		const glm::vec3 inverseDirection = 1.0f / ray.Direction;
+		const glm::vec3 t1               = (bounds.Min - ray.Origin) * inverseDirection;
+		const glm::vec3 t2               = (bounds.Max - ray.Origin) * inverseDirection;
+		const glm::vec3 tMin             = glm::min(t1, t2);
+		const glm::vec3 tMax             = glm::max(t1, t2);
+
+		const f32 entry = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		const f32 exit  = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, ray.MaxDistance));
+		return entry <= exit ? entry : std::numeric_limits<f32>::max();
+	}
+
+	// Tests every object, so whatever it says is the right answer.
+	RayHit BruteForceRaycast(const Ray& ray, std::span<const AABB> objects)
+	{
+		RayHit hit;
+		hit.Distance = ray.MaxDistance;
+		for (u32 i = 0; i < objects.size(); i++)
+		{
+			const f32 distance = HitDistance(ray, objects[i]);
+			if (distance < hit.Distance)
+			{
+				hit.ObjectID = i;
+				hit.Distance = distance;
+			}
+		}
+		return hit;
+	}
+
+	std::vector<AABB> RandomObjects(std::mt19937& random, u32 count)
+	{
+		std::uniform_real_distribution<f32> position(-100.0f, 100.0f);
+		std::uniform_real_distribution<f32> extent(0.1f, 3.0f);
+
+		std::vector<AABB> objects;
+		objects.reserve(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			const glm::vec3 center(position(random), position(random), position(random));
+			objects.push_back(AABB::FromCenterExtents(center, glm::vec3(extent(random), extent(random), extent(random))));
+		}
+		return objects;
+	}
+
+	Ray RandomRay(std::mt19937& random)
+	{
+		std::uniform_real_distribution<f32> position(-120.0f, 120.0f);
+		std::uniform_real_distribution<f32> direction(-1.0f, 1.0f);
+
+		Ray ray;
+		ray.Origin    = glm::vec3(position(random), position(random), position(random));
+		ray.Direction = glm::vec3(direction(random), direction(random), direction(random));
+		if (glm::dot(ray.Direction, ray.Direction) < 0.01f)
+			ray.Direction = glm::vec3(0.0f, 0.0f, 1.0f);
+		ray.Direction = glm::normalize(ray.Direction);
+		// Aimed at the middle half the time, so plenty of them actually hit something.
+		if (random() % 2 == 0)
+			ray.Direction = glm::normalize(-ray.Origin);
+		return ray;
+	}
+
+	// Two objects can be hit at exactly the same distance, so only the distance has to match, and whichever object the
+	// BVH picked has to really be hit there.
+	bool Matches(const RayHit& hit, const RayHit& expected, const Ray& ray, std::span<const AABB> objects)
+	{
+		if (hit.IsHit() != expected.IsHit())
+			return false;
+		if (!hit.IsHit())
+			return true;
+		return hit.Distance == expected.Distance && HitDistance(ray, objects[hit.ObjectID]) == expected.Distance;
+	}
+
+	u32 CountMismatches(const BVH& bvh, std::span<const AABB> objects, std::mt19937& random)
+	{
+		u32 mismatches = 0;
+		for (u32 i = 0; i < RayCount; i++)
+		{
+			const Ray ray = RandomRay(random);
+			if (!Matches(bvh.Raycast(ray), BruteForceRaycast(ray, objects), ray, objects))
+				mismatches++;
+		}
+		return mismatches;
+	}
+}
+
+VULC_TEST(BVH_RaycastMatchesBruteForce)
+{
+	std::mt19937            random(1234);
+	const std::vector<AABB> objects = RandomObjects(random, ObjectCount);
+
+	BVH bvh;
+	bvh.Build(objects);
+	VULC_EXPECT(bvh.GetStats().ObjectCount == ObjectCount);
+	VULC_EXPECT(CountMismatches(bvh, objects, random) == 0);
+
+	// The batched version has to agree with the single one, spread over the job system or not.
+	std::vector<Ray> rays;
+	for (u32 i = 0; i < RayCount; i++)
+		rays.push_back(RandomRay(random));
+	std::vector<RayHit> hits(rays.size());
+	std::vector<RayHit> jobHits(rays.size());
+	JobSystem           jobs({.WorkerCount = 3});
+	bvh.Raycast(rays, hits);
+	bvh.Raycast(rays, jobHits, &jobs);
+
+	u32 mismatches = 0;
+	for (u32 i = 0; i < rays.size(); i++)
+	{
+		const RayHit expected = BruteForceRaycast(rays[i], objects);
+		mismatches += Matches(hits[i], expected, rays[i], objects) ? 0 : 1;
+		mismatches += Matches(jobHits[i], expected, rays[i], objects) ? 0 : 1;
+	}
+	VULC_EXPECT(mismatches == 0);
+}
+
+VULC_TEST(BVH_RaycastMatchesBruteForceAfterChanges)
+{
+	std::mt19937      random(5678);
+	std::vector<AABB> objects = RandomObjects(random, ObjectCount);
+
+	BVH bvh;
+	bvh.Build(objects);
+
+	// Move some, remove some, add some, and bring some removed ones back. Moved objects are only found where they are
+	// once Update() has refitted (or rebuilt) the tree, so that's when to check.
+	const std::vector<AABB> moved = RandomObjects(random, ObjectCount / 4);
+	for (u32 i = 0; i < moved.size(); i++)
+	{
+		objects[i * 4] = moved[i];
+		bvh.UpdateObject(i * 4, moved[i]);
+	}
+	for (u32 i = 1; i < ObjectCount; i += 8)
+	{
+		objects[i] = AABB();
+		bvh.RemoveObject(i);
+	}
+	for (const AABB& added : RandomObjects(random, 100))
+	{
+		objects.push_back(added);
+		VULC_EXPECT(bvh.AddObject(added) == objects.size() - 1);
+	}
+	bvh.Update();
+	VULC_EXPECT(CountMismatches(bvh, objects, random) == 0);
+
+	const std::vector<AABB> restored = RandomObjects(random, ObjectCount / 8);
+	for (u32 i = 0; i < restored.size(); i++)
+	{
+		objects[1 + i * 8] = restored[i];
+		bvh.UpdateObject(1 + i * 8, restored[i]);
+	}
+	bvh.Update();
+	VULC_EXPECT(CountMismatches(bvh, objects, random) == 0);
+}
+
+VULC_TEST(BVH_QueryAABBMatchesBruteForce)
+{
+	std::mt19937            random(91011);
+	const std::vector<AABB> objects = RandomObjects(random, ObjectCount);
+
+	BVH bvh;
+	bvh.Build(objects);
+
+	u32 mismatches = 0;
+	for (const AABB& query : RandomObjects(random, 200))
+	{
+		const AABB bigger = AABB::FromCenterExtents(query.GetCenter(), query.GetExtents() * 5.0f);
+
+		std::vector<u32> found;
+		bvh.QueryAABB(bigger, found);
+		std::ranges::sort(found);
+
+		std::vector<u32> expected;
+		for (u32 i = 0; i < objects.size(); i++)
+		{
+			if (bigger.OverlapsWith(objects[i]))
+				expected.push_back(i);
+		}
+		mismatches += found == expected ? 0 : 1;
+	}
+	VULC_EXPECT(mismatches == 0);
+}
+
+VULC_TEST(BVH_StatsFollowRebuilds)
+{
+	std::mt19937      random(1213);
+	std::vector<AABB> objects = RandomObjects(random, 100);
+
+	BVH bvh;
+	bvh.Build(objects);
+	VULC_EXPECT(bvh.GetStats().ObjectCount == 100);
+	VULC_EXPECT(bvh.GetStats().Rebuilds == 0);
+
+	// Enough new objects to force a rebuild, which has to show up in the stats.
+	for (const AABB& added : RandomObjects(random, 50))
+		bvh.AddObject(added);
+	VULC_EXPECT(bvh.GetStats().ObjectCount == 100);
+	bvh.Update();
+	VULC_EXPECT(bvh.GetStats().Rebuilds == 1);
+	VULC_EXPECT(bvh.GetStats().ObjectCount == 150);
+	VULC_EXPECT(bvh.GetStats().PendingObjects == 0);
+	VULC_EXPECT(bvh.GetStats().NodeCount > 1);
+
+	// An empty tree has to say so too.
+	bvh.Build({});
+	VULC_EXPECT(bvh.GetStats().ObjectCount == 0);
+	VULC_EXPECT(bvh.GetStats().NodeCount == 0);
+}
@@ -0,0 +1,195 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <random>
+
+#include "Core/Compression/LZ4.h"
+
+namespace
+{
+	constexpr size_t MinMatch = 4;
+
+	// Just enough of an LZ4 block encoder to give the decoder something to decode: greedy, with one candidate per
+	// hash, but keeping to the format's end-of-block rules (the last five bytes are literals, and the last match starts
+	// at least twelve from the end), so its blocks are ones the reference decoder would take too.
+	std::vector<u8> CompressBlock(std::span<const u8> source)
+	{
+		constexpr u32    HashBits   = 12;
+		constexpr size_t NoPosition = std::numeric_limits<size_t>::max();
+
+		std::vector<u8>     out;
+		std::vector<size_t> table(1 << HashBits, NoPosition);
+
+		auto load32 = [&](size_t position)
+		{
+			u32 value;
+			std::memcpy(&value, source.data() + position, sizeof(value));
+			return value;
+		};
+
+		// Lengths of 15 or more carry on in bytes of up to 255.
+		auto writeLength = [&](size_t length)
+		{
+			for (length -= 15; length >= 255; length -= 255)
+				out.push_back(255);
+			out.push_back(static_cast<u8>(length));
+		};
+
+		auto writeLiterals = [&](size_t begin, size_t end, u8 matchCode)
+		{
+			const size_t literalLength = end - begin;
+			out.push_back(static_cast<u8>(std::min<size_t>(literalLength, 15) << 4 | matchCode));
+			if (literalLength >= 15)
+				writeLength(literalLength);
+			out.insert(out.end(), source.begin() + begin, source.begin() + end);
+		};
+
+		const size_t matchStartLimit = source.size() > 12 ? source.size() - 12 : 0;
+		const size_t matchEndLimit   = source.size() > 5 ? source.size() - 5 : 0;
+
+		size_t anchor   = 0;
+		size_t position = 0;
+		while (position < matchStartLimit)
+		{
+			const u32    sequence  = load32(position);
+			const u32    hash      = (sequence * 2654435761u) >> (32 - HashBits);
+			const size_t candidate = std::exchange(table[hash], position);
+			if (candidate == NoPosition || position - candidate > 65535 || load32(candidate) != sequence)
+			{
+				position++;
+				continue;
+			}
+
+			size_t matchLength = MinMatch;
+			while (position + matchLength < matchEndLimit &&
+			       source[candidate + matchLength] == source[position + matchLength])
+			{
+				matchLength++;
+			}
+
+			const size_t matchCode = matchLength - MinMatch;
+			const size_t offset    = position - candidate;
+			writeLiterals(anchor, position, static_cast<u8>(std::min<size_t>(matchCode, 15)));
+			out.push_back(static_cast<u8>(offset));
+			out.push_back(static_cast<u8>(offset >> 8));
+			if (matchCode >= 15)
+				writeLength(matchCode);
+
+			position += matchLength;
+			anchor    = position;
+		}
+
+		writeLiterals(anchor, source.size(), 0);
+		return out;
+	}
+
+	bool RoundTrips(std::span<const u8> source)
+	{
+		const std::vector<u8> compressed = CompressBlock(source);
+		std::vector<u8>       decompressed(source.size());
+		return LZ4::DecompressBlock(compressed, decompressed) && std::ranges::equal(decompressed, source);
+	}
+
+	bool Decompresses(std::initializer_list<u8> block, size_t decompressedSize)
+	{
+		std::vector<u8> destination(decompressedSize);
+		return LZ4::DecompressBlock({block.begin(), block.size()}, destination);
+	}
+}
+
+VULC_TEST(LZ4_RoundTrips)
+{
+	std::mt19937 random(1);
+
+	// Empty, and too short for any matches.
+	VULC_EXPECT(RoundTrips({}));
+	const std::vector<u8> tiny = {1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3};
+	VULC_EXPECT(RoundTrips(tiny));
+
+	// Incompressible, so one long run of literals, with a length that takes several extra bytes.
+	std::vector<u8> noise(5000);
+	for (u8& byte : noise)
+		byte = static_cast<u8>(random());
+	VULC_EXPECT(RoundTrips(noise));
+
+	// One byte over and over: a match at an offset of 1, far longer than its own offset.
+	const std::vector<u8> run(70000, 0xAB);
+	VULC_EXPECT(RoundTrips(run));
+
+	// Every short period, so every overlapping match copy gets a go, and a couple that don't overlap.
+	for (const size_t period : {2, 3, 5, 7, 8, 9, 16, 100})
+	{
+		std::vector<u8> pattern(4096 + period);
+		for (size_t i = 0; i < pattern.size(); i++)
+			pattern[i] = static_cast<u8>(i % period * 37);
+		VULC_EXPECT(RoundTrips(pattern));
+	}
+
+	// Something more like real data: words from a small vocabulary, so matches and literals interleave.
+	const std::array<std::string_view, 8> words = {"vertex ", "index ", "buffer ", "texture ", "mip ", "0", "1", "\n"};
+	std::vector<u8>                       text;
+	while (text.size() < 64 * 1024)
+	{
+		const std::string_view word = words[random() % words.size()];
+		text.insert(text.end(), word.begin(), word.end());
+	}
+	VULC_EXPECT(RoundTrips(text));
+	VULC_EXPECT(CompressBlock(text).size() < text.size() / 2);
+}
+
+VULC_TEST(LZ4_RejectsMalformedBlocks)
+{
+	// Fine as they are, to show it's the malformation that's rejected below.
+	VULC_EXPECT(Decompresses({0x40, 'a', 'b', 'c', 'd'}, 4));
+	VULC_EXPECT(Decompresses({0x40, 'a', 'b', 'c', 'd', 0x01, 0x00, 0x00}, 8));
+
+	// A literal run that says it's longer than what's left of the block.
+	VULC_EXPECT(!Decompresses({0x50, 'a', 'b', 'c', 'd'}, 5));
+	// A run of 15 or more whose extra length bytes are cut off.
+	VULC_EXPECT(!Decompresses({0xF0}, 15));
+	VULC_EXPECT(!Decompresses({0xF0, 0xFF}, 270));
+	// Literals that'd run past the end of the output.
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd'}, 3));
+
+	// Offsets of zero, and from before the start of the output.
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd', 0x00, 0x00, 0x00}, 8));
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd', 0x05, 0x00, 0x00}, 8));
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd', 0xFF, 0xFF, 0x00}, 8));
+	// An offset that's cut off.
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd', 0x01}, 8));
+
+	// Matches that'd run past the end of the output, short and with extra length bytes.
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd', 0x01, 0x00, 0x00}, 7));
+	VULC_EXPECT(!Decompresses({0x4F, 'a', 'b', 'c', 'd', 0x01, 0x00, 0x10}, 20));
+	// A match length whose extra bytes are cut off.
+	VULC_EXPECT(!Decompresses({0x4F, 'a', 'b', 'c', 'd', 0x01, 0x00}, 23));
+
+	// A block that's fine, but decodes to less than we're told it should.
+	VULC_EXPECT(!Decompresses({0x40, 'a', 'b', 'c', 'd'}, 5));
+}
+
+VULC_TEST(LZ4_SurvivesCorruption)
+{
+	// Whatever the damage, it either decodes or says it can't; it never reads or writes outside its spans, which
+	// the sanitizers are there to catch.
+	std::mt19937    random(2);
+	std::vector<u8> source(16 * 1024);
+	for (size_t i = 0; i < source.size(); i++)
+		source[i] = static_cast<u8>(random() % 4 == 0 ? random() : i % 13);
+	const std::vector<u8> compressed = CompressBlock(source);
+
+	u32 rejected = 0;
+	for (u32 attempt = 0; attempt < 2000; attempt++)
+	{
+		// Built at exactly their sizes, so a read or write past either end is past the allocation.
+		std::vector<u8> damaged(compressed.begin(), compressed.end() - random() % 8);
+		for (u32 i = 0, count = 1 + random() % 4; i < count; i++)
+			damaged[random() % damaged.size()] = static_cast<u8>(random());
+		std::vector<u8> destination(source.size() - random() % 2);
+		rejected += !LZ4::DecompressBlock(damaged, destination);
+	}
+	VULC_EXPECT(rejected > 0);
+
+	std::vector<u8> decompressed(source.size());
+	VULC_EXPECT(LZ4::DecompressBlock(compressed, decompressed) && decompressed == source);
+}
@@ -0,0 +1,112 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <thread>
+#include <mutex>
+
+#include "Core/Concurrency/SpinMutex.h"
+#include "Core/Concurrency/FutexMutex.h"
+
+namespace
+{
+	constexpr u32 ThreadCount         = 8;
+	constexpr u32 IncrementsPerThread = 100000;
+
+	// Plain, non-atomic increments, so any two threads in the critical section at once lose some.
+	template <typename Mutex>
+	void CheckMutualExclusion()
+	{
+		Mutex mutex;
+		u64   counter = 0;
+		u32   inside  = 0;
+		bool  overlap = false;
+
+		std::vector<std::thread> threads;
+		for (u32 t = 0; t < ThreadCount; t++)
+		{
+			threads.emplace_back([&]()
+			{
+				for (u32 i = 0; i < IncrementsPerThread; i++)
+				{
+					std::lock_guard lock(mutex);
+					overlap |= ++inside != 1;
+					counter++;
+					inside--;
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+
+		VULC_EXPECT(!overlap);
+		VULC_EXPECT(counter == static_cast<u64>(ThreadCount) * IncrementsPerThread);
+	}
+
+	template <typename Mutex>
+	void CheckTryLock()
+	{
+		Mutex mutex;
+		VULC_EXPECT(mutex.try_lock());
+
+		// Held, so nobody else can have it, even if they ask nicely.
+		bool otherGotIt = true;
+		std::thread other([&]() { otherGotIt = mutex.try_lock(); });
+		other.join();
+		VULC_EXPECT(!otherGotIt);
+
+		mutex.unlock();
+		VULC_EXPECT(mutex.try_lock());
+		mutex.unlock();
+	}
+
+	// A thread blocked in lock() has to get in once the holder lets go, however long it was held.
+	template <typename Mutex>
+	void CheckBlockedLockerGetsIn()
+	{
+		Mutex             mutex;
+		std::atomic<bool> acquired = false;
+
+		mutex.lock();
+		std::thread other([&]()
+		{
+			std::lock_guard lock(mutex);
+			acquired = true;
+		});
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		VULC_EXPECT(!acquired);
+		mutex.unlock();
+		other.join();
+		VULC_EXPECT(acquired);
+	}
+}
+
+VULC_TEST(SpinMutex_IsMutuallyExclusive)
+{
+	CheckMutualExclusion<SpinMutex>();
+}
+
+VULC_TEST(SpinMutex_TryLockFailsWhileHeld)
+{
+	CheckTryLock<SpinMutex>();
+}
+
+VULC_TEST(SpinMutex_BlockedLockerGetsIn)
+{
+	CheckBlockedLockerGetsIn<SpinMutex>();
+}
+
+VULC_TEST(FutexMutex_IsMutuallyExclusive)
+{
+	CheckMutualExclusion<FutexMutex>();
+}
+
+VULC_TEST(FutexMutex_TryLockFailsWhileHeld)
+{
+	CheckTryLock<FutexMutex>();
+}
+
+VULC_TEST(FutexMutex_BlockedLockerGetsIn)
+{
+	CheckBlockedLockerGetsIn<FutexMutex>();
+}
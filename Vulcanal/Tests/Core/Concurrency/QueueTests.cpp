@@ -0,0 +1,343 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <mutex>
+#include <thread>
+
+#include "Core/Concurrency/SPSCQueue.h"
+#include "Core/Concurrency/MPSCQueue.h"
+#include "Core/Concurrency/MPMCQueue.h"
+#include "Core/Concurrency/BoundedQueue.h"
+
+namespace
+{
+	constexpr u32 ItemsPerProducer = 200000;
+	constexpr u32 ProducerCount    = 4;
+	constexpr u32 ConsumerCount    = 4;
+
+	// Which producer it came from in the top bits, and where it came in that producer's sequence in the rest.
+	u64 Tag(u32 producer, u32 index) { return (static_cast<u64>(producer) << 32) | index; }
+
+	// The app's pipelined loop, with sleeps standing in for the work: the main thread builds a frame and hands it over
+	// through a queue of one, and the render thread renders and presents it while the next one's built. With the lock,
+	// it's the old scheme, where the main thread held the renderer's lock to build its frame and the render thread held
+	// it across render and present. Returns how many frames the main thread was halfway through building while the
+	// render thread was busy with the one before.
+	u32 CountOverlappingFrames(bool lockAcrossRender)
+	{
+		constexpr u32  FrameCount = 20;
+		constexpr auto StageTime  = std::chrono::milliseconds(4);
+
+		BoundedQueue<u32> packets(1);
+		std::mutex        state;
+		std::atomic<bool> rendering = false;
+
+		std::thread renderThread([&]()
+		{
+			while (packets.Pop())
+			{
+				std::unique_lock lock(state, std::defer_lock);
+				if (lockAcrossRender)
+					lock.lock();
+				rendering = true;
+				std::this_thread::sleep_for(StageTime);
+				rendering = false;
+			}
+		});
+
+		u32 overlaps = 0;
+		for (u32 frame = 0; frame < FrameCount; frame++)
+		{
+			{
+				std::unique_lock lock(state, std::defer_lock);
+				if (lockAcrossRender)
+					lock.lock();
+				std::this_thread::sleep_for(StageTime / 2);
+				overlaps += rendering.load() ? 1 : 0;
+				std::this_thread::sleep_for(StageTime / 2);
+			}
+			packets.Push(u32(frame));
+		}
+		packets.Close();
+		renderThread.join();
+		return overlaps;
+	}
+}
+
+VULC_TEST(SPSCQueue_FillsToCapacityAndDrainsInOrder)
+{
+	SPSCQueue<u32> queue(5);
+	VULC_EXPECT(queue.GetCapacity() == 8);
+	VULC_EXPECT(queue.IsEmpty());
+	VULC_EXPECT(!queue.TryPop());
+
+	for (u32 i = 0; i < queue.GetCapacity(); i++)
+		VULC_EXPECT(queue.TryPush(i));
+	VULC_EXPECT(!queue.TryPush(100));
+
+	for (u32 i = 0; i < queue.GetCapacity(); i++)
+	{
+		const std::optional<u32> item = queue.TryPop();
+		VULC_EXPECT(item && *item == i);
+	}
+	VULC_EXPECT(queue.IsEmpty());
+}
+
+VULC_TEST(SPSCQueue_DestroysWhatsLeft)
+{
+	const auto item = CreateRef<u32>(0u);
+	{
+		SPSCQueue<Ref<u32>> queue(4);
+		queue.TryPush(item);
+		queue.TryPush(item);
+		VULC_EXPECT(item.use_count() == 3);
+	}
+	VULC_EXPECT(item.use_count() == 1);
+}
+
+VULC_TEST(SPSCQueue_KeepsOrderAcrossThreads)
+{
+	// Small, so the two sides keep running into each other.
+	SPSCQueue<u32> queue(16);
+
+	std::thread producer([&queue]()
+	{
+		for (u32 i = 0; i < ItemsPerProducer; i++)
+		{
+			while (!queue.TryPush(i))
+				std::this_thread::yield();
+		}
+	});
+
+	u32 expected = 0;
+	while (expected < ItemsPerProducer)
+	{
+		if (std::optional<u32> item = queue.TryPop())
+		{
+			if (*item != expected)
+			{
+				VULC_EXPECT(*item == expected);
+				break;
+			}
+			expected++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	producer.join();
+	VULC_EXPECT(queue.IsEmpty());
+}
+
+VULC_TEST(MPSCQueue_KeepsEachProducersOrder)
+{
+	MPSCQueue<u64> queue(64);
+
+	std::vector<std::thread> producers;
+	for (u32 p = 0; p < ProducerCount; p++)
+	{
+		producers.emplace_back([&queue, p]()
+		{
+			for (u32 i = 0; i < ItemsPerProducer; i++)
+			{
+				while (!queue.TryPush(Tag(p, i)))
+					std::this_thread::yield();
+			}
+		});
+	}
+
+	std::vector<u32> next(ProducerCount, 0);
+	u64              received = 0;
+	bool             inOrder  = true;
+	while (received < static_cast<u64>(ItemsPerProducer) * ProducerCount)
+	{
+		if (std::optional<u64> item = queue.TryPop())
+		{
+			const u32 producer = static_cast<u32>(*item >> 32);
+			const u32 index    = static_cast<u32>(*item);
+			inOrder &= producer < ProducerCount && next[producer] == index;
+			if (producer < ProducerCount)
+				next[producer] = index + 1;
+			received++;
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	for (std::thread& producer : producers)
+		producer.join();
+
+	VULC_EXPECT(inOrder);
+	VULC_EXPECT(queue.IsEmpty());
+	for (u32 p = 0; p < ProducerCount; p++)
+		VULC_EXPECT(next[p] == ItemsPerProducer);
+}
+
+VULC_TEST(MPMCQueue_DeliversEverythingExactlyOnce)
+{
+	MPMCQueue<u64> queue(64);
+
+	std::atomic<u32>         producersLeft = ProducerCount;
+	std::vector<std::thread> threads;
+	for (u32 p = 0; p < ProducerCount; p++)
+	{
+		threads.emplace_back([&queue, &producersLeft, p]()
+		{
+			for (u32 i = 0; i < ItemsPerProducer; i++)
+			{
+				while (!queue.TryPush(Tag(p, i)))
+					std::this_thread::yield();
+			}
+			producersLeft.fetch_sub(1, std::memory_order_release);
+		});
+	}
+
+	// Each consumer keeps its own tally, and checks each producer's items still come out in order as far as it's
+	// concerned; a slot handed out twice, or read before it's written, breaks one or the other.
+	std::vector<std::vector<u32>> seen(ConsumerCount, std::vector<u32>(ProducerCount, 0));
+	std::vector<u64>              sums(ConsumerCount, 0);
+	std::atomic<bool>             inOrder = true;
+	for (u32 c = 0; c < ConsumerCount; c++)
+	{
+		threads.emplace_back([&, c]()
+		{
+			std::vector<s64> last(ProducerCount, -1);
+			while (true)
+			{
+				const bool done = producersLeft.load(std::memory_order_acquire) == 0;
+				if (std::optional<u64> item = queue.TryPop())
+				{
+					const u32 producer = static_cast<u32>(*item >> 32);
+					const u32 index    = static_cast<u32>(*item);
+					if (producer >= ProducerCount || static_cast<s64>(index) <= last[producer])
+					{
+						inOrder = false;
+						continue;
+					}
+					last[producer] = index;
+					seen[c][producer]++;
+					sums[c] += index;
+				}
+				else if (done)
+				{
+					break;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	VULC_EXPECT(inOrder);
+	const u64 expectedSum = static_cast<u64>(ItemsPerProducer) * (ItemsPerProducer - 1) / 2 * ProducerCount;
+	u64       sum         = 0;
+	for (u32 p = 0; p < ProducerCount; p++)
+	{
+		u32 count = 0;
+		for (u32 c = 0; c < ConsumerCount; c++)
+			count += seen[c][p];
+		VULC_EXPECT(count == ItemsPerProducer);
+	}
+	for (u64 consumerSum : sums)
+		sum += consumerSum;
+	VULC_EXPECT(sum == expectedSum);
+}
+
+VULC_TEST(BoundedQueue_BlocksAtCapacityAndDrainsOnClose)
+{
+	BoundedQueue<Scope<u32>> queue(2);
+
+	std::atomic<u32> pushed = 0;
+	std::thread      producer([&]()
+	{
+		for (u32 i = 0; i < 3; i++)
+		{
+			VULC_EXPECT(queue.Push(CreateScope<u32>(i)));
+			pushed.fetch_add(1);
+		}
+		queue.Close();
+	});
+
+	// The third push has to wait for us.
+	while (pushed.load() < 2)
+		std::this_thread::yield();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	VULC_EXPECT(pushed.load() == 2);
+
+	for (u32 i = 0; i < 3; i++)
+	{
+		std::optional<Scope<u32>> item = queue.Pop();
+		VULC_EXPECT(item && **item == i);
+	}
+	producer.join();
+
+	// Closed and empty, so every pop fails now, as does any push.
+	VULC_EXPECT(!queue.Pop());
+	VULC_EXPECT(!queue.Pop());
+	VULC_EXPECT(!queue.Push(CreateScope<u32>(3)));
+
+	// And it's as good as new once it's reset.
+	queue.Reset();
+	VULC_EXPECT(queue.Push(CreateScope<u32>(4)));
+	VULC_EXPECT(queue.Push(CreateScope<u32>(5)));
+	std::optional<Scope<u32>> item = queue.Pop();
+	VULC_EXPECT(item && **item == 4);
+}
+
+VULC_TEST(BoundedQueue_KeepsOrderAcrossThreads)
+{
+	BoundedQueue<u32> queue(1);
+
+	std::thread producer([&queue]()
+	{
+		for (u32 i = 0; i < ItemsPerProducer; i++)
+			queue.Push(u32(i));
+		queue.Close();
+	});
+
+	u32  expected = 0;
+	bool inOrder  = true;
+	while (std::optional<u32> item = queue.Pop())
+		inOrder &= *item == expected++;
+
+	producer.join();
+	VULC_EXPECT(inOrder);
+	VULC_EXPECT(expected == ItemsPerProducer);
+}
+
+VULC_TEST(BoundedQueue_CloseWakesABlockedConsumer)
+{
+	BoundedQueue<u32> queue(1);
+
+	std::atomic<bool> finished = false;
+	std::thread       consumer([&]()
+	{
+		VULC_EXPECT(!queue.Pop());
+		finished = true;
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	VULC_EXPECT(!finished);
+	queue.Close();
+	consumer.join();
+	VULC_EXPECT(finished);
+}
+
+VULC_TEST(BoundedQueue_LetsTheFrameStagesOverlap)
+{
+	// Holding the lock across render and present serialises the two threads completely.
+	VULC_EXPECT(CountOverlappingFrames(true) == 0);
+
+	// Whereas with only the handoff between them, every frame but the first is built while the last one's rendering.
+	// There's plenty of slack for a loaded machine, but it should be most of them.
+	VULC_EXPECT(CountOverlappingFrames(false) > 10);
+}
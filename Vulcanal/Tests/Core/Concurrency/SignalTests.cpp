@@ -0,0 +1,153 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <thread>
+
+#include "Core/Concurrency/Event.h"
+#include "Core/Concurrency/Semaphore.h"
+
+namespace
+{
+	constexpr u32 PingPongRounds = 50000;
+}
+
+VULC_TEST(Event_AutoResetLetsOneWaiterThrough)
+{
+	Event event;
+	VULC_EXPECT(!event.IsSet());
+	VULC_EXPECT(!event.WaitFor(1000000)); // 1ms.
+
+	event.Set();
+	event.Set(); // Setting it twice is still only one.
+	VULC_EXPECT(event.IsSet());
+	VULC_EXPECT(event.WaitFor(0));
+	VULC_EXPECT(!event.IsSet());
+	VULC_EXPECT(!event.WaitFor(1000000));
+}
+
+VULC_TEST(Event_ManualResetLetsEveryoneThrough)
+{
+	Event event(true);
+
+	std::atomic<u32>         through = 0;
+	std::vector<std::thread> waiters;
+	for (u32 i = 0; i < 4; i++)
+	{
+		waiters.emplace_back([&]()
+		{
+			event.Wait();
+			through.fetch_add(1);
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	VULC_EXPECT(through.load() == 0);
+	event.Set();
+	for (std::thread& waiter : waiters)
+		waiter.join();
+	VULC_EXPECT(through.load() == 4);
+
+	// Still set until it's reset.
+	VULC_EXPECT(event.WaitFor(0));
+	event.Reset();
+	VULC_EXPECT(!event.WaitFor(1000000));
+}
+
+VULC_TEST(Event_PingPong)
+{
+	// Each side only goes once the other's set its event, so a lost wake-up hangs, and a spurious one shows up as a
+	// round out of step.
+	Event ping;
+	Event pong;
+	u32   ball    = 0;
+	bool  inOrder = true;
+
+	std::thread other([&]()
+	{
+		for (u32 i = 0; i < PingPongRounds; i++)
+		{
+			ping.Wait();
+			inOrder &= ball == i * 2 + 1;
+			ball++;
+			pong.Set();
+		}
+	});
+
+	for (u32 i = 0; i < PingPongRounds; i++)
+	{
+		inOrder &= ball == i * 2;
+		ball++;
+		ping.Set();
+		pong.Wait();
+	}
+
+	other.join();
+	VULC_EXPECT(inOrder);
+	VULC_EXPECT(ball == PingPongRounds * 2);
+}
+
+VULC_TEST(Semaphore_CountsAcquiresAndReleases)
+{
+	Semaphore semaphore(2);
+	VULC_EXPECT(semaphore.TryAcquire());
+	VULC_EXPECT(semaphore.TryAcquire());
+	VULC_EXPECT(!semaphore.TryAcquire());
+
+	semaphore.Release(3);
+	VULC_EXPECT(semaphore.GetCount() == 3);
+	semaphore.Acquire();
+	VULC_EXPECT(semaphore.GetCount() == 2);
+}
+
+VULC_TEST(Semaphore_NeverLetsMoreInThanItsCount)
+{
+	constexpr u32 Slots       = 3;
+	constexpr u32 ThreadCount = 8;
+	constexpr u32 Rounds      = 20000;
+
+	Semaphore        semaphore(Slots);
+	std::atomic<u32> inside  = 0;
+	std::atomic<u32> mostIn  = 0;
+	std::atomic<u32> entries = 0;
+
+	std::vector<std::thread> threads;
+	for (u32 t = 0; t < ThreadCount; t++)
+	{
+		threads.emplace_back([&]()
+		{
+			for (u32 i = 0; i < Rounds; i++)
+			{
+				semaphore.Acquire();
+				const u32 now  = inside.fetch_add(1) + 1;
+				u32       most = mostIn.load();
+				while (now > most && !mostIn.compare_exchange_weak(most, now))
+				{
+				}
+				entries.fetch_add(1, std::memory_order_relaxed);
+				inside.fetch_sub(1);
+				semaphore.Release();
+			}
+		});
+	}
+	for (std::thread& thread : threads)
+		thread.join();
+
+	VULC_EXPECT(mostIn.load() <= Slots);
+	VULC_EXPECT(entries.load() == ThreadCount * Rounds);
+	VULC_EXPECT(semaphore.GetCount() == Slots);
+}
+
+VULC_TEST(Semaphore_ReleaseWakesEveryWaiter)
+{
+	Semaphore semaphore;
+
+	std::vector<std::thread> waiters;
+	for (u32 i = 0; i < 4; i++)
+		waiters.emplace_back([&semaphore]() { semaphore.Acquire(); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	semaphore.Release(4);
+	for (std::thread& waiter : waiters)
+		waiter.join();
+	VULC_EXPECT(semaphore.GetCount() == 0);
+}
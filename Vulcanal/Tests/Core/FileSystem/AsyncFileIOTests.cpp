@@ -0,0 +1,100 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <fstream>
+
+#include "Core/FileSystem/AsyncFileIO.h"
+#include "Core/ThreadPool.h"
+
+namespace
+{
+	// A file that ends partway through a block, so a direct read of its last block comes back short.
+	constexpr u64 FileSize = 5 * AsyncFileIO::DirectAlignment + 1234;
+
+	u8 ExpectedByte(u64 offset)
+	{
+		return static_cast<u8>(offset * 31 + offset / 251);
+	}
+
+	class TestFile
+	{
+	public:
+		TestFile()
+			: m_Path(std::filesystem::temp_directory_path() / "VulcanalAsyncFileIOTests.bin")
+		{
+			std::vector<u8> bytes(FileSize);
+			for (u64 i = 0; i < FileSize; i++)
+				bytes[i] = ExpectedByte(i);
+			std::ofstream(m_Path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()), FileSize);
+		}
+
+		~TestFile()
+		{
+			std::error_code error;
+			std::filesystem::remove(m_Path, error);
+		}
+
+		NODISCARD const std::filesystem::path& GetPath() const { return m_Path; }
+
+	private:
+		std::filesystem::path m_Path;
+	};
+
+	// Reads the whole file in aligned pieces, the last of which runs past its end, and checks what comes back.
+	void ReadPastTheEnd(bool forceThreadPool, bool direct)
+	{
+		TestFile    testFile;
+		ThreadPool  threadPool(2);
+		AsyncFileIO io(threadPool, {.ForceThreadPool = forceThreadPool});
+
+		AsyncFile file;
+		VULC_EXPECT(file.Open(testFile.GetPath(), direct));
+		VULC_EXPECT(file.GetSize() == FileSize);
+
+		constexpr u64 PieceSize  = 2 * AsyncFileIO::DirectAlignment;
+		constexpr u64 PieceCount = (FileSize + PieceSize - 1) / PieceSize;
+		constexpr u64 BufferSize = PieceCount * PieceSize;
+		u8* buffer = static_cast<u8*>(::operator new(BufferSize, std::align_val_t(AsyncFileIO::DirectAlignment)));
+
+		std::atomic<s64> results[PieceCount] = {};
+		for (u64 i = 0; i < PieceCount; i++)
+		{
+			io.Read({.File        = &file,
+			         .Offset      = i * PieceSize,
+			         .Destination = {buffer + i * PieceSize, PieceSize},
+			         .OnComplete  = [&results, i](s64 result) { results[i].store(result); }});
+		}
+		io.WaitIdle();
+		VULC_EXPECT(io.GetInFlightCount() == 0);
+
+		for (u64 i = 0; i < PieceCount; i++)
+			VULC_EXPECT(results[i].load() == static_cast<s64>(std::min(PieceSize, FileSize - i * PieceSize)));
+
+		bool matches = true;
+		for (u64 i = 0; i < FileSize; i++)
+			matches &= buffer[i] == ExpectedByte(i);
+		VULC_EXPECT(matches);
+
+		::operator delete(buffer, std::align_val_t(AsyncFileIO::DirectAlignment));
+	}
+}
+
+VULC_TEST(AsyncFileIO_ReadsPastTheEnd)
+{
+	ReadPastTheEnd(false, false);
+}
+
+VULC_TEST(AsyncFileIO_ReadsPastTheEndDirect)
+{
+	ReadPastTheEnd(false, true);
+}
+
+VULC_TEST(AsyncFileIO_ReadsPastTheEndOnTheThreadPool)
+{
+	ReadPastTheEnd(true, false);
+}
+
+VULC_TEST(AsyncFileIO_ReadsPastTheEndDirectOnTheThreadPool)
+{
+	ReadPastTheEnd(true, true);
+}
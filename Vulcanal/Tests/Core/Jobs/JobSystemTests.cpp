@@ -0,0 +1,106 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <thread>
+
+#include "Core/Jobs/JobSystem.h"
+
+VULC_TEST(JobSystem_RunsJobsFromItsOwnThreads)
+{
+	JobSystem jobs({.WorkerCount = 3});
+
+	std::atomic<u32> ran = 0;
+	JobCounter       counter;
+	for (u32 i = 0; i < 1000; i++)
+	{
+		jobs.Run([&jobs, &ran]()
+		{
+			// Jobs queueing jobs go on the worker's own deque.
+			JobCounter inner;
+			jobs.Run([&ran]() { ran.fetch_add(1); }, &inner);
+			jobs.Wait(inner);
+			ran.fetch_add(1);
+		}, &counter);
+	}
+	jobs.Wait(counter);
+
+	VULC_EXPECT(ran.load() == 2000);
+	VULC_EXPECT(counter.IsDone());
+}
+
+VULC_TEST(JobSystem_TakesJobsFromOutsideThreads)
+{
+	JobSystem jobs({.WorkerCount = 3});
+
+	// Several threads that aren't the job system's, each queueing far more than the injection queue holds, so some
+	// have to wait for room.
+	constexpr u32 OutsideThreads = 4;
+	constexpr u32 JobsPerThread  = 20000;
+
+	std::atomic<u32>         ran = 0;
+	std::vector<std::thread> outsiders;
+	for (u32 t = 0; t < OutsideThreads; t++)
+	{
+		outsiders.emplace_back([&]()
+		{
+			VULC_EXPECT(jobs.GetCurrentThreadIndex() == -1);
+
+			JobCounter counter;
+			for (u32 i = 0; i < JobsPerThread; i++)
+				jobs.Run([&ran]() { ran.fetch_add(1, std::memory_order_relaxed); }, &counter);
+			jobs.Wait(counter);
+			VULC_EXPECT(counter.IsDone());
+		});
+	}
+
+	for (std::thread& outsider : outsiders)
+		outsider.join();
+	VULC_EXPECT(ran.load() == OutsideThreads * JobsPerThread);
+}
+
+VULC_TEST(JobSystem_HoldsJobsBackOnADependency)
+{
+	JobSystem jobs({.WorkerCount = 2});
+
+	std::atomic<u32>  firstDone = 0;
+	std::atomic<bool> ranEarly  = false;
+	JobCounter        first;
+	JobCounter        second;
+	for (u32 i = 0; i < 100; i++)
+	{
+		jobs.Run([&firstDone]()
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+			firstDone.fetch_add(1);
+		}, &first);
+	}
+
+	// Queued from outside, so the released jobs go through the injection queue too.
+	std::thread outsider([&]()
+	{
+		for (u32 i = 0; i < 100; i++)
+			jobs.Run([&]() { ranEarly = ranEarly || firstDone.load() != 100; }, &second, &first);
+	});
+	outsider.join();
+
+	jobs.Wait(first);
+	jobs.Wait(second);
+	VULC_EXPECT(!ranEarly);
+}
+
+VULC_TEST(JobSystem_ParallelForCoversTheRangeOnce)
+{
+	JobSystem jobs({.WorkerCount = 3});
+
+	std::vector<std::atomic<u32>> hits(10000);
+	jobs.ParallelFor(static_cast<u32>(hits.size()), [&hits](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; i++)
+			hits[i].fetch_add(1, std::memory_order_relaxed);
+	}, 16);
+
+	bool once = true;
+	for (const std::atomic<u32>& hit : hits)
+		once &= hit.load() == 1;
+	VULC_EXPECT(once);
+}
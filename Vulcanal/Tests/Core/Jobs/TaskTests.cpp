@@ -0,0 +1,228 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+
+#include "Core/Jobs/Task.h"
+#include "Core/ThreadPool.h"
+
+// Symmetric transfer's only a tail call, and so only keeps the stack flat, in optimised builds without the sanitizers;
+// otherwise the compilers don't promise it, and each hand-over's a call like any other.
+#if (defined(_MSC_VER) && defined(_DEBUG)) || (defined(__GNUC__) && !defined(__OPTIMIZE__)) ||                       \
+	defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+	#define VULC_TASKS_HAVE_FLAT_STACKS 0
+#else
+	#define VULC_TASKS_HAVE_FLAT_STACKS 1
+#endif
+
+namespace
+{
+	// How deep the stack was wherever this was last called. Called through a pointer so it's never inlined into a
+	// coroutine, whose locals can end up in its frame rather than on the stack.
+	uintptr_t s_StackPosition = 0;
+	void      NoteStackPosition()
+	{
+		volatile u8 marker = 0;
+		s_StackPosition    = reinterpret_cast<uintptr_t>(&marker);
+	}
+	void (*volatile s_NoteStackPosition)() = &NoteStackPosition;
+
+	uintptr_t GetStackDistance(uintptr_t a, uintptr_t b)
+	{
+		return a > b ? a - b : b - a;
+	}
+
+	// Starts the task on the job system, and waits here, on a thread that isn't one of its, for it to finish.
+	template <typename T>
+	void RunToCompletion(JobSystem& jobs, Task<T>& task)
+	{
+		task.Start(jobs);
+		while (!task.IsDone())
+			std::this_thread::yield();
+	}
+
+	Task<u32> Immediately(u32 value)
+	{
+		s_NoteStackPosition();
+		co_return value;
+	}
+
+	Task<u32> Depth(u32 depth)
+	{
+		if (depth == 0)
+		{
+			s_NoteStackPosition();
+			co_return 0;
+		}
+		co_return co_await Depth(depth - 1) + 1;
+	}
+
+	Task<u32> Throws()
+	{
+		throw std::runtime_error("Thrown from a task");
+		co_return 0;
+	}
+
+	Task<> ThrowsVoid()
+	{
+		throw std::runtime_error("Thrown from a void task");
+		co_return;
+	}
+}
+
+VULC_TEST(Task_SymmetricTransferKeepsTheStackFlat)
+{
+	// Few enough that it's fine without tail calls too, but plenty for the stack to show it if they're missing.
+	constexpr u32 Count = 1000;
+
+	JobSystem jobs({.WorkerCount = 1});
+
+	// Each child finishes without suspending, so every await is a hop into it and straight back, and with tail calls
+	// the first and the last run just as deep.
+	uintptr_t first = 0;
+	uintptr_t last  = 0;
+	Task<u32> loop  = [](uintptr_t& first, uintptr_t& last) -> Task<u32>
+	{
+		u32 sum = 0;
+		for (u32 i = 0; i < Count; i++)
+		{
+			sum += co_await Immediately(1);
+			(i == 0 ? first : last) = s_StackPosition;
+		}
+		co_return sum;
+	}(first, last);
+	RunToCompletion(jobs, loop);
+	VULC_EXPECT(loop.GetResult() == Count);
+
+	// Nesting's the same: each child runs where its parent was, rather than on top of it.
+	uintptr_t top    = 0;
+	Task<u32> nested = [](uintptr_t& top) -> Task<u32>
+	{
+		s_NoteStackPosition();
+		top = s_StackPosition;
+		co_return co_await Depth(Count);
+	}(top);
+	RunToCompletion(jobs, nested);
+	const uintptr_t bottom = s_StackPosition;
+	VULC_EXPECT(nested.GetResult() == Count);
+
+#if VULC_TASKS_HAVE_FLAT_STACKS
+	VULC_EXPECT(GetStackDistance(first, last) < 1024);
+	VULC_EXPECT(GetStackDistance(top, bottom) < 1024);
+#else
+	static_cast<void>(bottom);
+#endif
+}
+
+VULC_TEST(Task_ExceptionsReachWhoeverAwaits)
+{
+	JobSystem jobs({.WorkerCount = 2});
+
+	Task<std::string> catcher = []() -> Task<std::string>
+	{
+		try
+		{
+			co_await Throws();
+		}
+		catch (const std::runtime_error& error)
+		{
+			co_return error.what();
+		}
+		co_return "Nothing thrown";
+	}();
+	RunToCompletion(jobs, catcher);
+	VULC_EXPECT(catcher.GetResult() == "Thrown from a task");
+
+	// Nobody awaits these, so it's their results that rethrow, void or not.
+	Task<u32> thrower = Throws();
+	RunToCompletion(jobs, thrower);
+	bool threw = false;
+	try
+	{
+		static_cast<void>(thrower.GetResult());
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	VULC_EXPECT(threw);
+
+	Task<> voidThrower = ThrowsVoid();
+	RunToCompletion(jobs, voidThrower);
+	threw = false;
+	try
+	{
+		voidThrower.GetResult();
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	VULC_EXPECT(threw);
+
+	// And one that passes through a task that doesn't catch it, on the way up.
+	Task<u32> outer = []() -> Task<u32> { co_return co_await Throws() + 1; }();
+	RunToCompletion(jobs, outer);
+	threw = false;
+	try
+	{
+		static_cast<void>(outer.GetResult());
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+	VULC_EXPECT(threw);
+}
+
+VULC_TEST(Task_ResumesOnTheJobSystem)
+{
+	JobSystem   jobs({.WorkerCount = 2});
+	ThreadPool  threadPool(1);
+	AsyncFileIO asyncIO(threadPool);
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() / "VulcanalTaskTests.bin";
+	std::vector<u8>             contents(100'000);
+	for (size_t i = 0; i < contents.size(); i++)
+		contents[i] = static_cast<u8>(i * 7);
+	std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(contents.data()), contents.size());
+
+	std::atomic<bool> onJobs       = false;
+	std::atomic<bool> readOnJobs   = false;
+	std::atomic<bool> readMatches  = false;
+	std::atomic<bool> missingEmpty = false;
+
+	// Named, since a coroutine lambda's captures live in the lambda, not the coroutine's frame.
+	auto body = [&]() -> Task<>
+	{
+		co_await SwitchTo(jobs);
+		onJobs = jobs.GetCurrentThreadIndex() >= 0;
+
+		// Read by the I/O completion thread, or the thread pool, but carried on with on a job.
+		const std::optional<std::vector<u8>> data = co_await ReadFileAsync(path, asyncIO, jobs);
+		readOnJobs  = jobs.GetCurrentThreadIndex() >= 0;
+		readMatches = data && *data == contents;
+
+		const std::filesystem::path          missingPath = path.string() + ".missing";
+		const std::optional<std::vector<u8>> missing     = co_await ReadFileAsync(missingPath, asyncIO, jobs);
+		missingEmpty = !missing.has_value();
+	};
+	Task<> task = body();
+
+	// Started from here, outside the job system, so everything after the switch is on a job.
+	task.Start(jobs);
+	while (!task.IsDone())
+		std::this_thread::yield();
+	task.GetResult();
+
+	VULC_EXPECT(onJobs);
+	VULC_EXPECT(readOnJobs);
+	VULC_EXPECT(readMatches);
+	VULC_EXPECT(missingEmpty);
+
+	asyncIO.WaitIdle();
+	std::error_code error;
+	std::filesystem::remove(path, error);
+}
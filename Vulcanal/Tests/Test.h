@@ -0,0 +1,35 @@
+#pragma once
+
+// Just enough of a test framework for the engine's own tests. VULC_TEST registers a test with the runner in
+// TestMain.cpp, and VULC_EXPECT reports a failure without stopping the test, so one run shows everything that's wrong.
+// Checks are safe to make from any thread, which is the point for most of what's tested here.
+namespace Test
+{
+	using TestFunction = void (*)();
+
+	struct TestCase
+	{
+		const char*  Name     = nullptr;
+		TestFunction Function = nullptr;
+	};
+
+	std::vector<TestCase>& GetTests();
+	void                   ReportFailure(const char* expression, const char* file, s32 line);
+
+	struct Registrar
+	{
+		Registrar(const char* name, TestFunction function) { GetTests().push_back({name, function}); }
+	};
+}
+
+#define VULC_TEST(name)                                                                                                \
+	static void            VulcTest_##name();                                                                          \
+	static Test::Registrar s_VulcTestRegistrar_##name(#name, &VulcTest_##name);                                        \
+	static void            VulcTest_##name()
+
+#define VULC_EXPECT(expression)                                                                                        \
+	do                                                                                                                 \
+	{                                                                                                                  \
+		if (!(expression))                                                                                             \
+			Test::ReportFailure(#expression, __FILE__, __LINE__);                                                      \
+	} while (false)
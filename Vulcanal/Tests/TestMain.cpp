@@ -0,0 +1,68 @@
+#include "vulcpch.h"
+#include "Test.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	std::atomic<u32> s_Failures = 0;
+}
+
+// Assertions want a window to put their message box on; there isn't one here.
+SDL_Window* GetAppWindow()
+{
+	return nullptr;
+}
+
+std::vector<Test::TestCase>& Test::GetTests()
+{
+	static std::vector<TestCase> tests;
+	return tests;
+}
+
+void Test::ReportFailure(const char* expression, const char* file, s32 line)
+{
+	s_Failures.fetch_add(1, std::memory_order_relaxed);
+	fmt::print(stderr, "    {}:{}: check failed: {}\n", file, line, expression);
+}
+
+// Runs every test, or only those whose names contain the first argument. Returns the number of failed checks, so
+// anything but 0 fails the build step that runs it.
+int main(int argc, char** argv)
+{
+	g_VulcanalLogger = spdlog::stdout_color_mt("Tests");
+	g_VulcanalLogger->set_level(spdlog::level::warn);
+
+	const char* filter = argc > 1 ? argv[1] : nullptr;
+
+	u32 run    = 0;
+	u32 failed = 0;
+	for (const Test::TestCase& test : Test::GetTests())
+	{
+		if (filter && !std::strstr(test.Name, filter))
+			continue;
+
+		fmt::print("{}\n", test.Name);
+		const u32  failuresBefore = s_Failures.load();
+		const auto start          = std::chrono::steady_clock::now();
+		test.Function();
+		const f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		run++;
+		if (s_Failures.load() != failuresBefore)
+		{
+			failed++;
+			fmt::print("    FAILED ({:.1f}ms)\n", ms);
+		}
+		else
+		{
+			fmt::print("    passed ({:.1f}ms)\n", ms);
+		}
+	}
+
+	fmt::print("{} of {} tests passed\n", run - failed, run);
+	g_VulcanalLogger = nullptr;
+	return static_cast<int>(s_Failures.load());
+}
@@ -18,6 +18,26 @@ IncludeDir["vulkan"] = vulkansdk .. "/include/"
 IncludeDir["vkbootstrap"] = "Vulcanal/Vendor/vk-bootstrap/Include"
 IncludeDir["VMA"] = "Vulcanal/Vendor/VMA/Include"
 
+VulcanalIncludeDirs =
+{
+	"%{IncludeDir.spdlog}",
+	"%{IncludeDir.SDL}",
+	"%{IncludeDir.imgui}",
+	"%{IncludeDir.glm}",
+	"%{IncludeDir.stb}",
+	-- "%{IncludeDir.msdfgen}",
+	-- "Vulcanal/Vendor/msdfgen-custom/",
+	-- "%{IncludeDir.msdfatlasgen}",
+	-- "%{IncludeDir.steamworks}",
+	-- "%{IncludeDir.fmod}",
+	"%{IncludeDir.entt}",
+	"%{IncludeDir.vulkan}",
+	"%{IncludeDir.vkbootstrap}",
+	"%{IncludeDir.VMA}",
+
+	"Vulcanal/Include"
+}
+
 group "Vendor"
     include "Vulcanal/Vendor/imgui.lua"
 group ""
@@ -49,25 +69,7 @@ project "Vulcanal"
 		"TODO.md", "README.md",
 	}
 
-	includedirs 
-	{ 
-		"%{IncludeDir.spdlog}",
-		"%{IncludeDir.SDL}",
-		"%{IncludeDir.imgui}",
-		"%{IncludeDir.glm}",
-		"%{IncludeDir.stb}",
-		-- "%{IncludeDir.msdfgen}",
-		-- "Vulcanal/Vendor/msdfgen-custom/",
-		-- "%{IncludeDir.msdfatlasgen}",
-		-- "%{IncludeDir.steamworks}",
-		-- "%{IncludeDir.fmod}",
-		"%{IncludeDir.entt}",
-		"%{IncludeDir.vulkan}",
-		"%{IncludeDir.vkbootstrap}",
-		"%{IncludeDir.VMA}",
-
-		"Vulcanal/Include"
-	}
+	includedirs(VulcanalIncludeDirs)
 
 	libdirs
 	{
@@ -180,7 +182,8 @@ filter "system:windows"
 		"winmm",
 		"Imm32",
 		"Cfgmgr32",
-		"Setupapi"
+		"Setupapi",
+		"Synchronization" -- WaitOnAddress, for Core/Concurrency's futexes.
 	}
 
 filter "system:linux"
@@ -194,3 +197,92 @@ filter "platforms:Linux"
 	buildoptions { "-static-libstdc++" }
 	system "linux"
 	architecture "x64"
+
+-- The parts of the engine that don't need a window or a GPU (the concurrency primitives, the job system, the log
+-- sink, the BVH, the file system and asset manager), built on their own so they can be hammered by the tests and the benchmarks.
+StandaloneFiles =
+{
+	"Vulcanal/Source/vulcpch.cpp",
+	"Vulcanal/Source/Core/Concurrency/**.cpp",
+	"Vulcanal/Source/Core/Jobs/**.cpp",
+	"Vulcanal/Source/Core/VulcanalLog.cpp",
+	"Vulcanal/Source/Core/AsyncLogSink.cpp",
+	"Vulcanal/Source/Core/BVH.cpp",
+	"Vulcanal/Source/Core/ThreadPool.cpp",
+	"Vulcanal/Source/Core/Compression/**.cpp",
+	"Vulcanal/Source/Core/FileSystem/**.cpp",
+	"Vulcanal/Source/Core/Assets/AssetManager.cpp",
+}
+
+function StandaloneProject(name, projectFiles)
+	project(name)
+		cppdialect "C++20"
+		kind "ConsoleApp"
+		staticruntime "On"
+		language "C++"
+		characterset "Unicode"
+		location "Vulcanal"
+		targetdir ("Build/%{prj.name}/" .. outputdir)
+		objdir ("Build/%{prj.name}/Intermediates/" .. outputdir)
+		debugdir ("Build/%{prj.name}/" .. outputdir)
+
+		usestandardpreprocessor 'On'
+		pchheader("vulcpch.h")
+		pchsource "Vulcanal/Source/vulcpch.cpp"
+
+		files(StandaloneFiles)
+		files(projectFiles)
+
+		includedirs(VulcanalIncludeDirs)
+		includedirs { "Vulcanal/Tests" }
+
+		-- SDL's only here for the assertion message box.
+		links { "SDL3" }
+
+		defines { "_CRT_SECURE_NO_WARNINGS" }
+
+		filter "configurations:Debug"
+			defines { "VULC_DEBUG", "VULC_ENABLE_ASSERTS" }
+			symbols "On"
+			runtime "Debug"
+
+		filter "configurations:Release"
+			defines { "VULC_RELEASE", "VULC_ENABLE_ASSERTS" }
+			optimize "On"
+			symbols "On"
+			runtime "Release"
+
+		filter "configurations:Dist"
+			defines { "VULC_DIST", "VULC_DISABLE_ASSERTS" }
+			optimize "On"
+			symbols "Off"
+			runtime "Release"
+
+		filter "system:windows"
+			systemversion "latest"
+			defines { "VULC_PLATFORM_WINDOWS" }
+			libdirs { "Vulcanal/Vendor/SDL/Lib/Win64" }
+			links { "version", "winmm", "Imm32", "Cfgmgr32", "Setupapi", "Synchronization" }
+
+		filter "system:linux"
+			defines { "VULC_PLATFORM_LINUX" }
+			libdirs { "Vulcanal/Vendor/SDL/Lib/Linux64" }
+
+		filter "platforms:Win64"
+			system "Windows"
+			architecture "x64"
+
+		filter "platforms:Linux"
+			buildoptions { "-static-libstdc++" }
+			system "linux"
+			architecture "x64"
+
+		filter {}
+end
+
+group "Tests"
+	-- Returns the number of failed checks, so it can gate a build. Pass part of a test's name to run only those.
+	StandaloneProject("VulcanalTests", { "Vulcanal/Tests/**.h", "Vulcanal/Tests/**.cpp" })
+	-- Pass "queues", "locks" or "signals" to run only that group.
+	StandaloneProject("VulcanalBench", { "Vulcanal/Benchmarks/**.cpp" })
+group ""